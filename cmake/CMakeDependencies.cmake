@@ -39,4 +39,15 @@ if (${REDIS_SERVER} OR ${REDIS_CLIENT})
 endif()
 
 find_package(Threads REQUIRED)
+
+if(${WITH_SIMDJSON})
+    # the bundled FindThreads predates imported targets, simdjson links against Threads::Threads
+    if(NOT TARGET Threads::Threads)
+        add_library(Threads::Threads INTERFACE IMPORTED)
+        set_property(TARGET Threads::Threads PROPERTY INTERFACE_LINK_LIBRARIES "${CMAKE_THREAD_LIBS_INIT}")
+    endif()
+    find_package(simdjson REQUIRED)
+    message(STATUS "simdjson version: ${simdjson_VERSION}")
+endif()
+
 find_package(Doxygen)
\ No newline at end of file
@@ -0,0 +1,64 @@
+/**
+ * @file jsonparserbenchmark.cpp
+ * @date 19.10.2026
+ * @author Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @brief Compares the configured JsonReader backend with parsing through an istream.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <jsonrpccpp/common/jsonreader.h>
+#include <sstream>
+#include <stdlib.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+string Message(int elements) {
+  Json::Value request;
+  request["jsonrpc"] = "2.0";
+  request["id"] = 1;
+  request["method"] = "store";
+  for (int i = 0; i < elements; i++) {
+    Json::Value item;
+    item["id"] = i;
+    item["name"] = "item number " + to_string(i);
+    item["price"] = i * 0.25;
+    item["tags"].append("json");
+    item["tags"].append("rpc über utf-8");
+    item["active"] = i % 2 == 0;
+    request["params"].append(item);
+  }
+  Json::StreamWriterBuilder wbuilder;
+  wbuilder["indentation"] = "";
+  return Json::writeString(wbuilder, request);
+}
+
+template <typename F> double Run(const string &text, size_t iterations, F parse) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    Json::Value value;
+    parse(text, value);
+  }
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  return text.size() * iterations / seconds / (1024 * 1024);
+}
+
+int main(int argc, char **argv) {
+  size_t budget = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+  int sizes[] = {1, 100, 10000};
+
+  cout << "backend: " << JsonReader::GetBackend() << endl;
+  for (int elements : sizes) {
+    string text = Message(elements);
+    size_t iterations = budget * 1024 * 1024 / text.size() + 1;
+
+    double stream = Run(text, iterations, [](const string &t, Json::Value &v) { istringstream(t) >> v; });
+    double reader = Run(text, iterations, [](const string &t, Json::Value &v) { JsonReader::Parse(t, v); });
+    double utf8 = Run(text, iterations, [](const string &t, Json::Value &) { JsonReader::IsValidUtf8(t.data(), t.size()); });
+
+    cout << text.size() << " bytes x " << iterations << ": istream " << stream << " MB/s, JsonReader " << reader << " MB/s ("
+         << reader / stream << "x), UTF-8 validation " << utf8 << " MB/s" << endl;
+  }
+  return 0;
+}
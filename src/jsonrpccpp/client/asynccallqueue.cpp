@@ -0,0 +1,161 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    asynccallqueue.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "asynccallqueue.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/tracing.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+AsyncCallQueue::AsyncCallQueue(Client &client, bool batches) : client(client), batches(batches), stopping(false) {
+  this->worker = thread(&AsyncCallQueue::Run, this);
+}
+
+AsyncCallQueue::~AsyncCallQueue() {
+  {
+    lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->condition.notify_one();
+  this->worker.join();
+}
+
+void AsyncCallQueue::Add(const string &name, const Json::Value &parameter, bool notification, const asyncCallback_t &callback) {
+  AsyncCall call;
+  call.name = name;
+  call.parameter = parameter;
+  call.notification = notification;
+  call.callback = callback;
+  // The worker thread sends the call, so it needs the context of the caller.
+  call.traceid = TraceContext::GetCurrent();
+  const CancellationToken *token = CancellationToken::GetCurrent();
+  call.deadline = token != NULL ? token->GetDeadline() : 0;
+  {
+    lock_guard<std::mutex> lock(this->mutex);
+    this->pending.push_back(std::move(call));
+  }
+  this->condition.notify_one();
+}
+
+void AsyncCallQueue::Run() {
+  unique_lock<std::mutex> lock(this->mutex);
+  while (true) {
+    this->condition.wait(lock, [this] { return this->stopping || !this->pending.empty(); });
+    if (this->pending.empty())
+      return;
+
+    vector<AsyncCall> calls(make_move_iterator(this->pending.begin()), make_move_iterator(this->pending.end()));
+    this->pending.clear();
+    lock.unlock();
+    this->Send(calls);
+    lock.lock();
+  }
+}
+
+void AsyncCallQueue::Send(vector<AsyncCall> &calls) {
+  if (calls.size() == 1 || !this->batches) {
+    for (size_t i = 0; i < calls.size(); i++)
+      this->SendOne(calls[i]);
+    return;
+  }
+
+  for (size_t begin = 0, end = 0; begin < calls.size(); begin = end) {
+    for (end = begin + 1; end < calls.size(); end++) {
+      if (calls[end].traceid != calls[begin].traceid || calls[end].deadline != calls[begin].deadline)
+        break;
+    }
+    if (end - begin == 1)
+      this->SendOne(calls[begin]);
+    else
+      this->SendBatch(calls, begin, end);
+  }
+}
+
+void AsyncCallQueue::SendBatch(vector<AsyncCall> &calls, size_t begin, size_t end) {
+  TraceContext context(calls[begin].traceid);
+  CancellationToken token(calls[begin].deadline);
+  CancellationScope scope(token);
+
+  BatchCall batch;
+  vector<int> ids;
+  for (size_t i = begin; i < end; i++)
+    ids.push_back(batch.addCall(calls[i].name, calls[i].parameter, calls[i].notification));
+
+  BatchResponse response;
+  try {
+    this->client.CallProcedures(batch, response);
+  } catch (const JsonRpcException &e) {
+    for (size_t i = begin; i < end; i++)
+      Complete(calls[i], Json::nullValue, &e);
+    return;
+  } catch (const std::exception &e) {
+    JsonRpcException error(Errors::ERROR_CLIENT_CONNECTOR, e.what());
+    for (size_t i = begin; i < end; i++)
+      Complete(calls[i], Json::nullValue, &error);
+    return;
+  } catch (...) {
+    JsonRpcException error(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending calls");
+    for (size_t i = begin; i < end; i++)
+      Complete(calls[i], Json::nullValue, &error);
+    return;
+  }
+
+  for (size_t i = begin; i < end; i++) {
+    Json::Value id = ids[i - begin];
+    if (calls[i].notification) {
+      Complete(calls[i], Json::nullValue, NULL);
+    } else if (!response.hasResponse(id)) {
+      JsonRpcException error(Errors::ERROR_CLIENT_INVALID_RESPONSE, "No response for call in batch");
+      Complete(calls[i], Json::nullValue, &error);
+    } else if (response.getErrorCode(id) != 0) {
+      JsonRpcException error(response.getErrorCode(id), response.getErrorMessage(id));
+      Complete(calls[i], Json::nullValue, &error);
+    } else {
+      Complete(calls[i], response.getResult(ids[i - begin]), NULL);
+    }
+  }
+}
+
+void AsyncCallQueue::SendOne(AsyncCall &call) {
+  TraceContext context(call.traceid);
+  CancellationToken token(call.deadline);
+  CancellationScope scope(token);
+  Json::Value result;
+  try {
+    if (call.notification)
+      this->client.CallNotification(call.name, call.parameter);
+    else
+      this->client.CallMethod(call.name, call.parameter, result);
+  } catch (const JsonRpcException &e) {
+    Complete(call, Json::nullValue, &e);
+    return;
+  } catch (const std::exception &e) {
+    JsonRpcException error(Errors::ERROR_CLIENT_CONNECTOR, e.what());
+    Complete(call, Json::nullValue, &error);
+    return;
+  } catch (...) {
+    JsonRpcException error(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending call");
+    Complete(call, Json::nullValue, &error);
+    return;
+  }
+  Complete(call, result, NULL);
+}
+
+void AsyncCallQueue::Complete(const AsyncCall &call, const Json::Value &result, const JsonRpcException *error) {
+  if (!call.callback)
+    return;
+  // Calls failing with an exception are completed inside its handler, so
+  // callbacks can get hold of it with std::current_exception().
+  // The thread serves all calls of the client, so it must survive a throwing callback.
+  try {
+    call.callback(result, error);
+  } catch (...) {
+  }
+}
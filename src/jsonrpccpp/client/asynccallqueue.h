@@ -0,0 +1,70 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    asynccallqueue.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_ASYNCCALLQUEUE_H
+#define JSONRPC_CPP_ASYNCCALLQUEUE_H
+
+#include "client.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace jsonrpc {
+
+  /**
+   * Sends the asynchronous calls of a Client from a single background
+   * thread. Calls queued while a round trip is in flight are sent together
+   * as one batch afterwards, so any number of outstanding calls needs one
+   * thread and one connection. Without batches (JSON-RPC 1.0) they are
+   * sent one after another. The trace id and deadline of the thread that
+   * queued a call are applied when it is sent, calls with different ones
+   * are never sent in the same batch.
+   */
+  class AsyncCallQueue {
+  public:
+    AsyncCallQueue(Client &client, bool batches);
+
+    /**
+     * Sends the calls still queued, then stops the thread.
+     */
+    ~AsyncCallQueue();
+
+    void Add(const std::string &name, const Json::Value &parameter, bool notification, const asyncCallback_t &callback);
+
+  private:
+    struct AsyncCall {
+      std::string name;
+      Json::Value parameter;
+      bool notification;
+      asyncCallback_t callback;
+      std::string traceid;
+      uint64_t deadline;
+    };
+
+    Client &client;
+    bool batches;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<AsyncCall> pending;
+    bool stopping;
+    std::thread worker;
+
+    void Run();
+    void Send(std::vector<AsyncCall> &calls);
+    void SendBatch(std::vector<AsyncCall> &calls, size_t begin, size_t end);
+    void SendOne(AsyncCall &call);
+    static void Complete(const AsyncCall &call, const Json::Value &result, const JsonRpcException *error);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_ASYNCCALLQUEUE_H
@@ -9,6 +9,8 @@
 
 #include "batchcall.h"
 #include "rpcprotocolclient.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/tracing.h>
 
 using namespace jsonrpc;
 using namespace std;
@@ -26,6 +28,12 @@ int BatchCall::addCall(const string &methodname, const Json::Value &params, bool
   if (!isNotification) {
     call[RpcProtocolClient::KEY_ID] = this->id++;
   }
+
+  if (!TraceContext::GetCurrent().empty())
+    call[KEY_REQUEST_TRACEID] = TraceContext::GetCurrent();
+  const CancellationToken *token = CancellationToken::GetCurrent();
+  if (token != NULL && token->GetRemaining() >= 0)
+    call[KEY_REQUEST_DEADLINE] = static_cast<Json::Int64>(token->GetRemaining());
   result.append(call);
 
   if (isNotification)
@@ -33,6 +41,8 @@ int BatchCall::addCall(const string &methodname, const Json::Value &params, bool
   return call[RpcProtocolClient::KEY_ID].asInt();
 }
 
+bool BatchCall::hasMethodCalls() const { return this->id > 1; }
+
 string BatchCall::toString(bool fast) const {
   string result;
   if (fast) {
@@ -45,3 +55,9 @@ string BatchCall::toString(bool fast) const {
   }
   return result;
 }
+
+string BatchCall::encode(codec_t codec) const {
+  string result;
+  Codec::Encode(this->result, codec, result);
+  return result;
+}
@@ -10,6 +10,7 @@
 #ifndef JSONRPC_CPP_BATCHCALL_H
 #define JSONRPC_CPP_BATCHCALL_H
 
+#include <jsonrpccpp/common/codec.h>
 #include <jsonrpccpp/common/jsonparser.h>
 
 namespace jsonrpc {
@@ -18,7 +19,7 @@ namespace jsonrpc {
     BatchCall();
 
     /**
-     * @brief addCall
+     * @brief addCall, attaching the trace id and deadline of the calling thread like single requests
      * @param methodname
      * @param params
      * @param isNotification
@@ -27,6 +28,16 @@ namespace jsonrpc {
     int addCall(const std::string &methodname, const Json::Value &params, bool isNotification = false);
     std::string toString(bool fast = true) const;
 
+    /**
+     * @return false if the batch only contains notifications, which are not answered.
+     */
+    bool hasMethodCalls() const;
+
+    /**
+     * @return The batch in the given wire encoding, compact for CODEC_JSON.
+     */
+    std::string encode(codec_t codec) const;
+
   private:
     Json::Value result;
     int id;
@@ -56,3 +56,5 @@ string BatchResponse::getErrorMessage(int id) {
 }
 
 bool BatchResponse::hasErrors() { return !errorResponses.empty(); }
+
+bool BatchResponse::hasResponse(Json::Value &id) { return responses.find(id) != responses.end(); }
@@ -57,6 +57,11 @@ namespace jsonrpc {
 
     bool hasErrors();
 
+    /**
+     * @return true if a result or an error has been received for the given id.
+     */
+    bool hasResponse(Json::Value &id);
+
   private:
     std::map<Json::Value, Json::Value> responses;
     std::vector<Json::Value> errorResponses;
@@ -8,33 +8,91 @@
  ************************************************************************/
 
 #include "client.h"
+#include "asynccallqueue.h"
 #include "rpcprotocolclient.h"
 #include <sstream>
 
 using namespace jsonrpc;
 using namespace std;
 
-Client::Client(IClientConnector &connector, clientVersion_t version, bool omitEndingLineFeed) : connector(connector) {
+Client::Client(IClientConnector &connector, clientVersion_t version, bool omitEndingLineFeed)
+    : connector(connector), version(version), async(NULL), tracer(NULL), codec(CODEC_JSON) {
   this->protocol = new RpcProtocolClient(version, omitEndingLineFeed);
 }
 
-Client::~Client() { delete this->protocol; }
+Client::~Client() {
+  // Pending asynchronous calls still need the protocol.
+  delete this->async;
+  delete this->protocol;
+}
 
 void Client::CallMethod(const std::string &name, const Json::Value &parameter, Json::Value &result) {
-  std::string request, response;
+  std::string request;
+  uint64_t start = this->tracer != NULL ? ITracer::Now() : 0;
   protocol->BuildRequest(name, parameter, request, false);
-  connector.SendRPCMessage(request, response);
-  protocol->HandleResponse(response, result);
+  this->SendMethodCall(name, request, start, result);
+}
+
+void Client::CallMethod(const std::string &name, const ParameterWriter &parameter, Json::Value &result) {
+  std::string request;
+  uint64_t start = this->tracer != NULL ? ITracer::Now() : 0;
+  protocol->BuildRequest(name, parameter, request, false);
+  this->SendMethodCall(name, request, start, result);
+}
+
+void Client::SendMethodCall(const std::string &name, const std::string &request, uint64_t start, Json::Value &result) {
+  std::string response;
+  if (this->tracer == NULL) {
+    this->Send(request, response);
+    protocol->HandleResponse(response, result);
+    return;
+  }
+
+  start = this->Trace(STAGE_BUILD, name, 1, start);
+  try {
+    this->Send(request, response);
+  } catch (const JsonRpcException &e) {
+    this->Trace(STAGE_SEND, name, 1, start);
+    throw;
+  }
+  start = this->Trace(STAGE_SEND, name, 1, start);
+  try {
+    protocol->HandleResponse(response, result);
+  } catch (const JsonRpcException &e) {
+    this->Trace(STAGE_PARSE, name, 1, start);
+    throw;
+  }
+  this->Trace(STAGE_PARSE, name, 1, start);
 }
 
 void Client::CallProcedures(const BatchCall &calls, BatchResponse &result) {
   std::string request, response;
-  request = calls.toString();
-  connector.SendRPCMessage(request, response);
+  uint64_t start = this->tracer != NULL ? ITracer::Now() : 0;
+  request = this->codec == CODEC_JSON ? calls.toString() : calls.encode(this->codec);
+  if (this->tracer != NULL) {
+    start = this->Trace(STAGE_BUILD, "", Json::nullValue, start);
+    try {
+      this->Send(request, response);
+    } catch (const JsonRpcException &e) {
+      this->Trace(STAGE_SEND, "", Json::nullValue, start);
+      throw;
+    }
+    start = this->Trace(STAGE_SEND, "", Json::nullValue, start);
+  } else {
+    this->Send(request, response);
+  }
   Json::Value tmpresult;
 
+  // Servers answer batches of notifications with nothing at all.
+  if (response.empty() && !calls.hasMethodCalls()) {
+    if (this->tracer != NULL)
+      this->Trace(STAGE_PARSE, "", Json::nullValue, start);
+    return;
+  }
+
   try {
-    istringstream(response) >> tmpresult;
+    if (!Codec::Decode(response, this->codec, tmpresult))
+      throw Json::RuntimeError("Invalid message");
     if(!tmpresult.isArray()) {
       throw JsonRpcException(Errors::ERROR_CLIENT_INVALID_RESPONSE, "Array expected.");
     }
@@ -57,6 +115,9 @@ void Client::CallProcedures(const BatchCall &calls, BatchResponse &result) {
     } else
       throw JsonRpcException(Errors::ERROR_CLIENT_INVALID_RESPONSE, "Object in Array expected.");
   }
+
+  if (this->tracer != NULL)
+    this->Trace(STAGE_PARSE, "", Json::nullValue, start);
 }
 
 BatchResponse Client::CallProcedures(const BatchCall &calls) {
@@ -71,8 +132,96 @@ Json::Value Client::CallMethod(const std::string &name, const Json::Value &param
   return result;
 }
 
+Json::Value Client::CallMethod(const std::string &name, const ParameterWriter &parameter) {
+  Json::Value result;
+  this->CallMethod(name, parameter, result);
+  return result;
+}
+
 void Client::CallNotification(const std::string &name, const Json::Value &parameter) {
-  std::string request, response;
+  std::string request;
+  uint64_t start = this->tracer != NULL ? ITracer::Now() : 0;
   protocol->BuildRequest(name, parameter, request, true);
-  connector.SendRPCMessage(request, response);
+  this->SendNotification(name, request, start);
+}
+
+void Client::CallNotification(const std::string &name, const ParameterWriter &parameter) {
+  std::string request;
+  uint64_t start = this->tracer != NULL ? ITracer::Now() : 0;
+  protocol->BuildRequest(name, parameter, request, true);
+  this->SendNotification(name, request, start);
+}
+
+void Client::SendNotification(const std::string &name, const std::string &request, uint64_t start) {
+  std::string response;
+  if (this->tracer == NULL) {
+    this->Send(request, response);
+    return;
+  }
+
+  start = this->Trace(STAGE_BUILD, name, Json::nullValue, start);
+  try {
+    this->Send(request, response);
+  } catch (const JsonRpcException &e) {
+    this->Trace(STAGE_SEND, name, Json::nullValue, start);
+    throw;
+  }
+  this->Trace(STAGE_SEND, name, Json::nullValue, start);
+}
+
+void Client::CallMethodAsync(const std::string &name, const Json::Value &parameter, const asyncCallback_t &callback) {
+  this->GetAsyncCallQueue().Add(name, parameter, false, callback);
+}
+
+void Client::CallNotificationAsync(const std::string &name, const Json::Value &parameter, const asyncCallback_t &callback) {
+  this->GetAsyncCallQueue().Add(name, parameter, true, callback);
+}
+
+std::future<void> Client::CallNotificationAsync(const std::string &name, const Json::Value &parameter) {
+  std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+  this->CallNotificationAsync(name, parameter, [promise](const Json::Value &, const JsonRpcException *error) {
+    if (error != NULL)
+      promise->set_exception(std::current_exception() ? std::current_exception() : std::make_exception_ptr(*error));
+    else
+      promise->set_value();
+  });
+  return promise->get_future();
+}
+
+void Client::Send(const std::string &request, std::string &response) {
+  std::lock_guard<std::mutex> lock(this->sending);
+  connector.SendEncodedRPCMessage(request, response, this->codec);
+}
+
+AsyncCallQueue &Client::GetAsyncCallQueue() {
+  std::lock_guard<std::mutex> lock(this->starting);
+  if (this->async == NULL)
+    this->async = new AsyncCallQueue(*this, this->version == JSONRPC_CLIENT_V2);
+  return *this->async;
+}
+
+void Client::SetTracer(ITracer *tracer) { this->tracer = tracer; }
+
+void Client::SetDeadline(long deadline) { this->protocol->SetDeadline(deadline); }
+
+void Client::SetCodec(codec_t codec) {
+  this->codec = codec;
+  this->protocol->SetCodec(codec);
+}
+
+void Client::SetTraceId(const std::string &traceid) {
+  this->traceid = traceid;
+  this->protocol->SetTraceId(traceid);
+}
+
+uint64_t Client::Trace(stage_t stage, const std::string &name, const Json::Value &id, uint64_t start) {
+  TraceSpan span;
+  span.stage = stage;
+  span.method = name;
+  span.id = id;
+  span.traceid = this->traceid.empty() ? TraceContext::GetCurrent() : this->traceid;
+  span.start = start;
+  span.end = ITracer::Now();
+  this->tracer->OnSpan(span);
+  return span.end;
 }
@@ -13,16 +13,30 @@
 #include "batchcall.h"
 #include "batchresponse.h"
 #include "iclientconnector.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/jsonconversion.h>
 #include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/parameterwriter.h>
+#include <jsonrpccpp/common/tracing.h>
 
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace jsonrpc {
   class RpcProtocolClient;
+  class AsyncCallQueue;
 
   typedef enum { JSONRPC_CLIENT_V1, JSONRPC_CLIENT_V2 } clientVersion_t;
 
+  /**
+   * Receives the result of an asynchronous call, error is NULL on success.
+   */
+  typedef std::function<void(const Json::Value &result, const JsonRpcException *error)> asyncCallback_t;
+
   class Client {
   public:
     Client(IClientConnector &connector, clientVersion_t version = JSONRPC_CLIENT_V2, bool omitEndingLineFeed = false);
@@ -31,14 +45,103 @@ namespace jsonrpc {
     void CallMethod(const std::string &name, const Json::Value &parameter, Json::Value &result);
     Json::Value CallMethod(const std::string &name, const Json::Value &parameter);
 
+    /**
+     * Calls a method with params written as JSON text, without a Json::Value
+     * in between. Used by stubs generated with jsonrpcstub --cpp-client-direct.
+     */
+    void CallMethod(const std::string &name, const ParameterWriter &parameter, Json::Value &result);
+    Json::Value CallMethod(const std::string &name, const ParameterWriter &parameter);
+
     void CallProcedures(const BatchCall &calls, BatchResponse &response);
     BatchResponse CallProcedures(const BatchCall &calls);
 
     void CallNotification(const std::string &name, const Json::Value &parameter);
+    void CallNotification(const std::string &name, const ParameterWriter &parameter);
+
+    /**
+     * Queues a call and returns at once. All asynchronous calls of a client
+     * are sent by one background thread, started on first use. Calls queued
+     * while it waits for a response are sent together as one batch, so they
+     * overlap without a thread or connection each. Blocking calls can be
+     * made at the same time, the connector is used by one call at a time.
+     * @param callback Invoked on the background thread. Calls failing with
+     * another exception than JsonRpcException get an ERROR_CLIENT_CONNECTOR
+     * error with its message, the exception itself is std::current_exception().
+     */
+    void CallMethodAsync(const std::string &name, const Json::Value &parameter, const asyncCallback_t &callback);
+
+    /**
+     * @return A future for the result converted with FromJson. The future
+     * throws the exception the call failed with, or ERROR_CLIENT_INVALID_RESPONSE
+     * if the result has a different type.
+     */
+    template <typename T> std::future<T> CallMethodAsync(const std::string &name, const Json::Value &parameter) {
+      std::shared_ptr<std::promise<T>> promise = std::make_shared<std::promise<T>>();
+      this->CallMethodAsync(name, parameter, [promise](const Json::Value &result, const JsonRpcException *error) {
+        T value;
+        if (error != NULL)
+          promise->set_exception(std::current_exception() ? std::current_exception() : std::make_exception_ptr(*error));
+        else if (!FromJson(result, value))
+          promise->set_exception(std::make_exception_ptr(JsonRpcException(Errors::ERROR_CLIENT_INVALID_RESPONSE, result.toStyledString())));
+        else
+          promise->set_value(std::move(value));
+      });
+      return promise->get_future();
+    }
+
+    void CallNotificationAsync(const std::string &name, const Json::Value &parameter, const asyncCallback_t &callback);
+
+    /**
+     * @return A future that is ready once the notification has been sent.
+     */
+    std::future<void> CallNotificationAsync(const std::string &name, const Json::Value &parameter);
+
+    /**
+     * Reports the build, send and parse stage of every call to tracer, NULL disables tracing.
+     */
+    void SetTracer(ITracer *tracer);
+
+    /**
+     * Attaches traceid to every request in the reserved member "traceparent".
+     * If empty, the trace id of the calling thread's TraceContext is used, so
+     * calls made while a server procedure is invoked carry the caller's trace id.
+     */
+    void SetTraceId(const std::string &traceid);
+
+    /**
+     * Attaches the time in milliseconds the server has to answer a call to
+     * every request in the reserved member "deadline", 0 disables it. Servers
+     * drop requests that expired before they were invoked, procedures can
+     * poll CancellationToken::IsCurrentCancelled() to give up on them. Calls
+     * made while a server procedure is invoked inherit the time left of the
+     * caller if it is shorter. Use the connector's timeout to stop waiting.
+     */
+    void SetDeadline(long deadline);
+
+    /**
+     * Selects the wire encoding of requests and responses, CODEC_JSON by
+     * default. The server has to understand the encoding: the HttpClient
+     * announces it in the Content-Type header, stream connectors need
+     * FRAMING_LENGTH_PREFIX and a server connector using the same codec.
+     */
+    void SetCodec(codec_t codec);
 
   private:
     IClientConnector &connector;
     RpcProtocolClient *protocol;
+    clientVersion_t version;
+    std::mutex sending;
+    std::mutex starting;
+    AsyncCallQueue *async;
+    ITracer *tracer;
+    std::string traceid;
+    codec_t codec;
+
+    uint64_t Trace(stage_t stage, const std::string &name, const Json::Value &id, uint64_t start);
+    void SendMethodCall(const std::string &name, const std::string &request, uint64_t start, Json::Value &result);
+    void SendNotification(const std::string &name, const std::string &request, uint64_t start);
+    void Send(const std::string &request, std::string &response);
+    AsyncCallQueue &GetAsyncCallQueue();
   };
 
 } /* namespace jsonrpc */
@@ -25,16 +25,18 @@
 using namespace jsonrpc;
 using namespace std;
 
-FileDescriptorClient::FileDescriptorClient(int inputfd, int outputfd) : inputfd(inputfd), outputfd(outputfd) {}
+FileDescriptorClient::FileDescriptorClient(int inputfd, int outputfd) : inputfd(inputfd), outputfd(outputfd), framing(FRAMING_DELIMITER), timeout(0) {}
 
 FileDescriptorClient::~FileDescriptorClient() {}
 
 void FileDescriptorClient::SendRPCMessage(const std::string &message, std::string &result) {
 
-  string toSend = message + DEFAULT_DELIMITER_CHAR;
   StreamWriter writer;
+  writer.SetTimeout(this->timeout);
 
-  if (!writer.Write(toSend, outputfd)) {
+  if (!writer.WriteMessage(message, outputfd, this->framing)) {
+    if (errno == ETIMEDOUT)
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
     throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error occurred while writing to the output file descriptor");
   }
 
@@ -42,11 +44,18 @@ void FileDescriptorClient::SendRPCMessage(const std::string &message, std::strin
     throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "The input file descriptor is not readable");
 
   StreamReader reader(DEFAULT_BUFFER_SIZE);
-  if (!reader.Read(result, inputfd, DEFAULT_DELIMITER_CHAR)) {
+  reader.SetTimeout(this->timeout);
+  if (!reader.ReadMessage(result, inputfd, this->framing)) {
+    if (errno == ETIMEDOUT)
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
     throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error occurred while reading from input file descriptor");
   }
 }
 
+void FileDescriptorClient::SetFraming(framing_t framing) { this->framing = framing; }
+
+void FileDescriptorClient::SetTimeout(long timeout) { this->timeout = timeout; }
+
 bool FileDescriptorClient::IsReadable(int fd) {
   int o_accmode = 0;
   int ret = fcntl(fd, F_GETFL, &o_accmode);
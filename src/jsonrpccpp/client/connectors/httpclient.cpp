@@ -57,7 +57,9 @@ HttpClient::HttpClient(const std::string &url) : url(url) {
 
 HttpClient::~HttpClient() { curl_easy_cleanup(curl); }
 
-void HttpClient::SendRPCMessage(const std::string &message, std::string &result) {
+void HttpClient::SendRPCMessage(const std::string &message, std::string &result) { this->SendEncodedRPCMessage(message, result, CODEC_JSON); }
+
+void HttpClient::SendEncodedRPCMessage(const std::string &message, std::string &result, codec_t codec) {
 
   curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
   curl_easy_setopt(curl, CURLOPT_URL, this->url.c_str());
@@ -74,9 +76,15 @@ void HttpClient::SendRPCMessage(const std::string &message, std::string &result)
     headers = curl_slist_append(headers, (header->first + ": " + header->second).c_str());
   }
 
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "charsets: utf-8");
+  headers = curl_slist_append(headers, (std::string("Content-Type: ") + Codec::GetContentType(codec)).c_str());
+  if (codec == CODEC_JSON) {
+    headers = curl_slist_append(headers, "charsets: utf-8");
+  } else {
+    headers = curl_slist_append(headers, (std::string("Accept: ") + Codec::GetContentType(codec)).c_str());
+  }
 
+  // Binary messages may contain null bytes, so the sizes are passed explicitly.
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(message.size()));
   curl_easy_setopt(curl, CURLOPT_POSTFIELDS, message.c_str());
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s);
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -84,7 +92,7 @@ void HttpClient::SendRPCMessage(const std::string &message, std::string &result)
 
   res = curl_easy_perform(curl);
 
-  result = s.ptr;
+  result.assign(s.ptr, s.len);
   free(s.ptr);
   curl_slist_free_all(headers);
   if (res != CURLE_OK) {
@@ -22,6 +22,11 @@ namespace jsonrpc {
     virtual ~HttpClient();
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * Sends message with the Content-Type and Accept header of codec.
+     */
+    virtual void SendEncodedRPCMessage(const std::string &message, std::string &result, codec_t codec);
+
     void SetUrl(const std::string &url);
     void SetTimeout(long timeout);
 
@@ -23,7 +23,7 @@
 using namespace jsonrpc;
 using namespace std;
 
-LinuxSerialPortClient::LinuxSerialPortClient(const std::string &deviceName) : deviceName(deviceName) {}
+LinuxSerialPortClient::LinuxSerialPortClient(const std::string &deviceName) : deviceName(deviceName), framing(FRAMING_DELIMITER), timeout(0) {}
 
 LinuxSerialPortClient::~LinuxSerialPortClient() {}
 
@@ -31,18 +31,27 @@ void LinuxSerialPortClient::SendRPCMessage(const std::string &message, std::stri
   int serial_fd = this->Connect();
 
   StreamWriter writer;
-  string toSend = message + DEFAULT_DELIMITER_CHAR;
-  if (!writer.Write(toSend, serial_fd)) {
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not write request");
+  writer.SetTimeout(this->timeout);
+  if (!writer.WriteMessage(message, serial_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
+    close(serial_fd);
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not write request");
   }
 
   StreamReader reader(DEFAULT_BUFFER_SIZE);
-  if (!reader.Read(result, serial_fd, DEFAULT_DELIMITER_CHAR)) {
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not read response");
+  reader.SetTimeout(this->timeout);
+  if (!reader.ReadMessage(result, serial_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
+    close(serial_fd);
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not read response");
   }
   close(serial_fd);
 }
 
+void LinuxSerialPortClient::SetFraming(framing_t framing) { this->framing = framing; }
+
+void LinuxSerialPortClient::SetTimeout(long timeout) { this->timeout = timeout; }
+
 int LinuxSerialPortClient::Connect() {
 
   int serial_fd = open(deviceName.c_str(), O_RDWR);
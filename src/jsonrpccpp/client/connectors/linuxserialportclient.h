@@ -12,6 +12,7 @@
 
 #include "../iclientconnector.h"
 #include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/sharedconstants.h>
 #include <string>
 
 namespace jsonrpc {
@@ -38,9 +39,23 @@ namespace jsonrpc {
      */
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * @brief Selects how messages are separated on the stream, the server
+     * has to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
+
+    /**
+     * @brief Limits the time spent writing a request and reading its response.
+     * @param timeout The timeout for each of both in milliseconds, 0 waits forever (default).
+     */
+    void SetTimeout(long timeout);
+
   protected:
     int fd;
     std::string deviceName; /*!< The serial port device name on which the client should try to connect*/
+    framing_t framing;      /*!< How messages are separated on the stream*/
+    long timeout;           /*!< Timeout for writing a request and reading its response in milliseconds*/
     /**
      * @brief Connects to the serial port provided by constructor parameters.
      *
@@ -26,7 +26,7 @@
 using namespace jsonrpc;
 using namespace std;
 
-LinuxTcpSocketClient::LinuxTcpSocketClient(const std::string &hostToConnect, const unsigned int &port) : hostToConnect(hostToConnect), port(port) {}
+LinuxTcpSocketClient::LinuxTcpSocketClient(const std::string &hostToConnect, const unsigned int &port) : hostToConnect(hostToConnect), port(port), framing(FRAMING_DELIMITER), timeout(0) {}
 
 LinuxTcpSocketClient::~LinuxTcpSocketClient() {}
 
@@ -34,18 +34,27 @@ void LinuxTcpSocketClient::SendRPCMessage(const std::string &message, std::strin
   int socket_fd = this->Connect();
 
   StreamWriter writer;
-  string toSend = message + DEFAULT_DELIMITER_CHAR;
-  if (!writer.Write(toSend, socket_fd)) {
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not write request");
+  writer.SetTimeout(this->timeout);
+  if (!writer.WriteMessage(message, socket_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
+    close(socket_fd);
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not write request");
   }
 
   StreamReader reader(DEFAULT_BUFFER_SIZE);
-  if (!reader.Read(result, socket_fd, DEFAULT_DELIMITER_CHAR)) {
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not read response");
+  reader.SetTimeout(this->timeout);
+  if (!reader.ReadMessage(result, socket_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
+    close(socket_fd);
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not read response");
   }
   close(socket_fd);
 }
 
+void LinuxTcpSocketClient::SetFraming(framing_t framing) { this->framing = framing; }
+
+void LinuxTcpSocketClient::SetTimeout(long timeout) { this->timeout = timeout; }
+
 int LinuxTcpSocketClient::Connect() {
   if (this->IsIpv4Address(this->hostToConnect)) {
     return this->Connect(this->hostToConnect, this->port);
@@ -37,9 +37,23 @@ namespace jsonrpc {
      */
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * @brief Selects how messages are separated on the stream, the server
+     * has to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
+
+    /**
+     * @brief Limits the time spent writing a request and reading its response.
+     * @param timeout The timeout for each of both in milliseconds, 0 waits forever (default).
+     */
+    void SetTimeout(long timeout);
+
   protected:
     std::string hostToConnect; /*!< The hostname or the ipv4 address on which the client should try to connect*/
     unsigned int port;         /*!< The port on which the client should try to connect*/
+    framing_t framing;         /*!< How messages are separated on the stream*/
+    long timeout;              /*!< Timeout for writing a request and reading its response in milliseconds*/
     /**
      * @brief Connects to the host and port provided by constructor parameters.
      *
@@ -8,6 +8,9 @@
  ************************************************************************/
 
 #include "redisclient.h"
+#include <jsonrpccpp/common/jsonenvelope.h>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/jsonreader.h>
 
 #include <iostream>
 #include <stdlib.h>
@@ -61,8 +64,7 @@ void ProcessReply(redisReply *reply, std::string &result) {
     throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Item not a string");
   }
 
-  std::string json(data->str, data->str + data->len * sizeof data->str[0]);
-  result = json;
+  result.assign(data->str, data->len);
 }
 
 /**
@@ -97,7 +99,48 @@ void jsonrpc::GetReturnQueue(redisContext *con, const std::string &prefix, std::
   freeReplyObject(reply);
 }
 
-RedisClient::RedisClient(const std::string &host, int port, const std::string &queue) : queue(queue), con(NULL) {
+/**
+ * @return The id of a parsed request or response, the ids of a batch.
+ */
+static Json::Value GetIds(const Json::Value &root) {
+  Json::Value ids;
+  if (root.isObject()) {
+    ids = root.get("id", Json::nullValue);
+  } else if (root.isArray()) {
+    for (Json::ArrayIndex i = 0; i < root.size(); i++) {
+      if (root[i].isObject() && root[i].isMember("id") && !root[i]["id"].isNull()) {
+        ids.append(root[i]["id"]);
+      }
+    }
+  }
+  return ids;
+}
+
+std::string jsonrpc::GetMessageId(const std::string &message) {
+  size_t pos = message.find_first_not_of(" \t\r\n");
+  if (pos == std::string::npos || (message[pos] != '{' && message[pos] != '[')) {
+    return "";
+  }
+
+  // Only the ids are needed, skip everything else unparsed if possible.
+  Json::Value ids;
+  if (!JsonEnvelope::ParseMember(message, "id", ids)) {
+    Json::Value root;
+    if (!JsonReader::Parse(message, root)) {
+      return "";
+    }
+    ids = GetIds(root);
+  }
+  if (ids.isNull()) {
+    return "";
+  }
+
+  Json::StreamWriterBuilder wbuilder;
+  wbuilder["indentation"] = "";
+  return Json::writeString(wbuilder, ids);
+}
+
+RedisClient::RedisClient(const std::string &host, int port, const std::string &queue) : queue(queue), con(NULL), persistent(false) {
   this->timeout = 10;
 
   con = redisConnect(host.c_str(), port);
@@ -125,37 +168,166 @@ RedisClient::~RedisClient() {
 }
 
 void RedisClient::SendRPCMessage(const std::string &message, std::string &result) {
+  std::vector<const std::string *> messages(1, &message);
+  std::vector<std::string *> results(1, &result);
+  this->Call(messages, results);
+}
+
+void RedisClient::SendRPCMessages(const std::vector<std::string> &messages, std::vector<std::string> &results) {
+  results.assign(messages.size(), std::string());
+  std::vector<const std::string *> in;
+  std::vector<std::string *> out;
+  for (size_t i = 0; i < messages.size(); i++) {
+    in.push_back(&messages[i]);
+    out.push_back(&results[i]);
+  }
+  this->Call(in, out);
+}
+
+void RedisClient::SetQueue(const std::string &queue) { this->queue = queue; }
+
+void RedisClient::SetTimeout(long timeout) { this->timeout = timeout; }
+
+void RedisClient::SetPersistentReturnQueue(bool persistent) {
+  this->persistent = persistent;
+  this->ret_queue.clear();
+}
+
+void RedisClient::Call(const std::vector<const std::string *> &messages, const std::vector<std::string *> &results) {
+  if (messages.empty()) {
+    return;
+  }
+
   std::string ret_queue;
-  GetReturnQueue(con, queue, ret_queue);
+  if (this->persistent) {
+    if (this->ret_queue.empty()) {
+      GetReturnQueue(con, queue, this->ret_queue);
+    }
+    ret_queue = this->ret_queue;
+  } else {
+    GetReturnQueue(con, queue, ret_queue);
+  }
 
-  redisReply *ret;
-  std::string data = ret_queue + "!" + message;
-  ret = (redisReply *)redisCommand(con, "LPUSH %s %s", queue.c_str(), data.c_str());
+  // Queue all requests plus the first BRPOP, so the common single call
+  // completes in one round trip.
+  size_t appended = 0;
+  for (size_t i = 0; i < messages.size(); i++) {
+    const std::string &message = *messages[i];
+    if (redisAppendCommand(con, "LPUSH %b %b!%b", queue.data(), queue.size(), ret_queue.data(), ret_queue.size(), message.data(), message.size()) !=
+        REDIS_OK) {
+      break;
+    }
+    appended++;
+  }
+  bool pipelined = appended == messages.size() && redisAppendCommand(con, "BRPOP %b %ld", ret_queue.data(), ret_queue.size(), this->timeout) == REDIS_OK;
 
-  if (ret == NULL) {
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending request");
+  std::string error;
+  if (appended < messages.size()) {
+    error = "Unknown error while sending request";
   }
-  if (ret->type != REDIS_REPLY_INTEGER || ret->integer <= 0) {
+  for (size_t i = 0; i < appended; i++) {
+    redisReply *ret = NULL;
+    if (redisGetReply(con, (void **)&ret) != REDIS_OK || ret == NULL) {
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending request");
+    }
+    if (ret->type != REDIS_REPLY_INTEGER || ret->integer <= 0) {
+      error = "Error while sending request, queue not updated";
+    }
     freeReplyObject(ret);
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Error while sending request, queue not updated");
   }
 
-  freeReplyObject(ret);
+  std::string response;
+  if (!error.empty()) {
+    // Drain the pending BRPOP so the connection stays usable.
+    if (pipelined) {
+      try {
+        this->PopResponse(ret_queue, this->timeout, true, response);
+      } catch (JsonRpcException &e) {
+      }
+    }
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, error);
+  }
+
+  // Responses on a shared queue may belong to earlier, timed out calls and
+  // may arrive out of order, so they are matched up by id.
+  bool correlate = this->persistent || messages.size() > 1;
+  std::vector<std::string> keys;
+  std::vector<bool> done(messages.size(), false);
+  if (correlate) {
+    for (size_t i = 0; i < messages.size(); i++) {
+      keys.push_back(GetMessageId(*messages[i]));
+    }
+  }
+
+  time_t deadline = time(NULL) + this->timeout;
+  size_t missing = messages.size();
+  while (missing > 0) {
+    long remaining = this->timeout;
+    if (!pipelined && this->timeout > 0) {
+      remaining = static_cast<long>(deadline - time(NULL));
+      if (remaining <= 0) {
+        throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
+      }
+    }
+    if (!this->PopResponse(ret_queue, remaining, pipelined, response)) {
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
+    }
+    pipelined = false;
+
+    if (!correlate) {
+      results[0]->swap(response);
+      missing--;
+      continue;
+    }
+
+    std::string key = GetMessageId(response);
+    bool matched = false;
+    for (size_t i = 0; !matched && i < messages.size(); i++) {
+      if (!done[i] && keys[i] == key) {
+        results[i]->swap(response);
+        done[i] = true;
+        missing--;
+        matched = true;
+      }
+    }
 
+    // Errors about requests that couldn't be parsed have a null id, which no
+    // call waits for. Each of them answers one of the calls still waiting.
+    for (size_t i = 0; !matched && key.empty() && i < messages.size(); i++) {
+      if (!done[i]) {
+        results[i]->swap(response);
+        done[i] = true;
+        missing--;
+        matched = true;
+      }
+    }
+  }
+}
+
+bool RedisClient::PopResponse(const std::string &ret_queue, long timeout, bool pipelined, std::string &result) {
   redisReply *reply = NULL;
-  reply = (redisReply *)redisCommand(con, "BRPOP %s %d", ret_queue.c_str(), this->timeout);
+  if (pipelined) {
+    if (redisGetReply(con, (void **)&reply) != REDIS_OK) {
+      reply = NULL;
+    }
+  } else {
+    reply = (redisReply *)redisCommand(con, "BRPOP %b %ld", ret_queue.data(), ret_queue.size(), timeout);
+  }
+
   if (reply == NULL) {
     throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while getting response");
   }
   if (reply->type == REDIS_REPLY_NIL) {
     freeReplyObject(reply);
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
+    return false;
   }
 
-  ProcessReply(reply, result);
+  try {
+    ProcessReply(reply, result);
+  } catch (JsonRpcException &e) {
+    freeReplyObject(reply);
+    throw;
+  }
   freeReplyObject(reply);
+  return true;
 }
-
-void RedisClient::SetQueue(const std::string &queue) { this->queue = queue; }
-
-void RedisClient::SetTimeout(long timeout) { this->timeout = timeout; }
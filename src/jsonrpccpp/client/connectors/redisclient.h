@@ -13,6 +13,8 @@
 #include "../iclientconnector.h"
 #include <hiredis/hiredis.h>
 #include <jsonrpccpp/common/exception.h>
+#include <string>
+#include <vector>
 
 namespace jsonrpc {
   /**
@@ -30,6 +32,13 @@ namespace jsonrpc {
    * RedisServer's queue, and ensures that it is unique using EXISTS.
    * It then prepends the response/return queue name to the json string
    * with an exlimation mark used as a seperator.
+   *
+   * The LPUSH of the request and the BRPOP for the response are pipelined,
+   * so a call needs a single round trip once the return queue is known.
+   * With SetPersistentReturnQueue the client keeps one return queue for its
+   * whole lifetime, which also removes the EXISTS check from every call.
+   * Responses on a persistent queue are matched to their request by
+   * JSON-RPC id; stale responses (e.g. of timed out calls) are discarded.
    */
   class RedisClient : public IClientConnector {
   public:
@@ -49,6 +58,16 @@ namespace jsonrpc {
      */
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * This method sends several rpc messages in one pipelined round trip
+     * and collects their results. Responses are matched to requests by their
+     * JSON-RPC ids, so the messages should carry distinct ids. Messages
+     * sharing an id receive their responses in arrival order.
+     * @param messages The messages to send.
+     * @param results The returned messages, in the order of messages.
+     */
+    void SendRPCMessages(const std::vector<std::string> &messages, std::vector<std::string> &results);
+
     /**
      * Set the queue that we are messaging with.
      * @param queue The queue to send to.
@@ -61,7 +80,32 @@ namespace jsonrpc {
      */
     void SetTimeout(long timeout);
 
+    /**
+     * Keep a single return queue for all calls of this client instead of
+     * generating a new one per call.
+     * @param persistent Whether the return queue should be kept.
+     */
+    void SetPersistentReturnQueue(bool persistent);
+
   protected:
+    /**
+     * Pipelines the requests and the first BRPOP, then collects the
+     * responses. Both SendRPCMessage and SendRPCMessages end up here.
+     * @param messages The messages to send.
+     * @param results The results are returned here, one per message.
+     */
+    void Call(const std::vector<const std::string *> &messages, const std::vector<std::string *> &results);
+
+    /**
+     * Receives one response from ret_queue.
+     * @param ret_queue The queue to pop from.
+     * @param timeout The time to wait in seconds.
+     * @param pipelined Whether the BRPOP has already been appended to the pipeline.
+     * @param result The response is returned here.
+     * @return false if the operation timed out.
+     */
+    bool PopResponse(const std::string &ret_queue, long timeout, bool pipelined, std::string &result);
+
     /**
      * @brief Queue that we are messaging
      */
@@ -76,10 +120,29 @@ namespace jsonrpc {
      * @brief Our connection to the redis server
      */
     redisContext *con;
+
+    /**
+     * @brief Whether the return queue is kept between calls
+     */
+    bool persistent;
+
+    /**
+     * @brief The persistent return queue, empty until first use
+     */
+    std::string ret_queue;
   };
 
   // Exported here for unit testing purposes.
   void GetReturnQueue(redisContext *con, const std::string &prefix, std::string &ret_queue);
 
+  /**
+   * Extracts a key identifying a request or response by its JSON-RPC id.
+   * Batches yield the list of their member ids. Notifications, empty
+   * responses and non JSON messages all yield an empty key.
+   * @param message The JSON-RPC message.
+   * @return The correlation key.
+   */
+  std::string GetMessageId(const std::string &message);
+
 } /* namespace jsonrpc */
 #endif /* JSONRPC_CPP_REDISCLIENT_H_ */
@@ -0,0 +1,170 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    redisstreamclient.cpp
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "redisstreamclient.h"
+#include "redisclient.h"
+
+#include <sstream>
+#include <string.h>
+#include <time.h>
+
+using namespace jsonrpc;
+
+RedisStreamClient::RedisStreamClient(const std::string &host, int port, const std::string &stream) : stream(stream), con(NULL) {
+  this->timeout = 10;
+
+  con = redisConnect(host.c_str(), port);
+  if (con == NULL) {
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "redis error: Failed to connect");
+  }
+
+  if (con->err) {
+    std::stringstream err;
+    err << "redis error: " << con->err;
+    redisFree(con);
+    con = NULL;
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, err.str());
+  }
+}
+
+RedisStreamClient::~RedisStreamClient() {
+  if (con != NULL) {
+    if (!ret_stream.empty()) {
+      redisReply *reply = (redisReply *)redisCommand(con, "DEL %b", ret_stream.data(), ret_stream.size());
+      if (reply != NULL) {
+        freeReplyObject(reply);
+      }
+    }
+    redisFree(con);
+  }
+}
+
+void RedisStreamClient::SendRPCMessage(const std::string &message, std::string &result) {
+  if (ret_stream.empty()) {
+    GetReturnQueue(con, stream, ret_stream);
+    last_id = "0-0";
+  }
+
+  // Notifications and batches of them get no reply, so don't ask for one or wait for it.
+  std::string key = GetMessageId(message);
+  size_t start = message.find_first_not_of(" \t\r\n");
+  if (key.empty() && start != std::string::npos && (message[start] == '{' || message[start] == '[')) {
+    redisReply *ret = (redisReply *)redisCommand(con, "XADD %b * payload %b", stream.data(), stream.size(), message.data(), message.size());
+    if (ret == NULL) {
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending request");
+    }
+    bool sent = ret->type == REDIS_REPLY_STRING;
+    freeReplyObject(ret);
+    if (!sent) {
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Error while sending request, stream not updated");
+    }
+    result.clear();
+    return;
+  }
+
+  // The XADD and the first XREAD go out in a single round trip.
+  if (redisAppendCommand(con, "XADD %b * reply %b payload %b", stream.data(), stream.size(), ret_stream.data(), ret_stream.size(), message.data(),
+                         message.size()) != REDIS_OK) {
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending request");
+  }
+  bool pipelined = redisAppendCommand(con, "XREAD COUNT 1 BLOCK %ld STREAMS %b %b", this->timeout * 1000, ret_stream.data(), ret_stream.size(),
+                                      last_id.data(), last_id.size()) == REDIS_OK;
+
+  redisReply *ret = NULL;
+  if (redisGetReply(con, (void **)&ret) != REDIS_OK || ret == NULL) {
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while sending request");
+  }
+  bool sent = ret->type == REDIS_REPLY_STRING;
+  freeReplyObject(ret);
+
+  std::string response;
+  if (!sent) {
+    // Drain the pending XREAD so the connection stays usable.
+    if (pipelined) {
+      try {
+        this->ReadResponse(this->timeout, true, response);
+      } catch (JsonRpcException &e) {
+      }
+    }
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Error while sending request, stream not updated");
+  }
+
+  time_t deadline = time(NULL) + this->timeout;
+  while (true) {
+    long remaining = this->timeout;
+    if (!pipelined && this->timeout > 0) {
+      remaining = static_cast<long>(deadline - time(NULL));
+      if (remaining <= 0) {
+        throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
+      }
+    }
+    if (!this->ReadResponse(remaining, pipelined, response)) {
+      throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Operation timed out");
+    }
+    pipelined = false;
+
+    if (GetMessageId(response) == key) {
+      result.swap(response);
+      return;
+    }
+  }
+}
+
+void RedisStreamClient::SetStream(const std::string &stream) { this->stream = stream; }
+
+void RedisStreamClient::SetTimeout(long timeout) { this->timeout = timeout; }
+
+bool RedisStreamClient::ReadResponse(long timeout, bool pipelined, std::string &result) {
+  redisReply *reply = NULL;
+  if (pipelined) {
+    if (redisGetReply(con, (void **)&reply) != REDIS_OK) {
+      reply = NULL;
+    }
+  } else {
+    reply = (redisReply *)redisCommand(con, "XREAD COUNT 1 BLOCK %ld STREAMS %b %b", timeout * 1000, ret_stream.data(), ret_stream.size(),
+                                       last_id.data(), last_id.size());
+  }
+
+  if (reply == NULL) {
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Unknown error while getting response");
+  }
+  if (reply->type == REDIS_REPLY_NIL) {
+    freeReplyObject(reply);
+    return false;
+  }
+
+  // [[stream, [[id, [field, value, ...]]]]]
+  redisReply *entry = NULL;
+  if (reply->type == REDIS_REPLY_ARRAY && reply->elements == 1) {
+    redisReply *entries = reply->element[0];
+    if (entries->type == REDIS_REPLY_ARRAY && entries->elements == 2 && entries->element[1]->type == REDIS_REPLY_ARRAY &&
+        entries->element[1]->elements == 1) {
+      entry = entries->element[1]->element[0];
+    }
+  }
+  if (entry == NULL || entry->type != REDIS_REPLY_ARRAY || entry->elements != 2 || entry->element[0]->type != REDIS_REPLY_STRING ||
+      entry->element[1]->type != REDIS_REPLY_ARRAY) {
+    freeReplyObject(reply);
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Invalid reply stream entry");
+  }
+
+  last_id.assign(entry->element[0]->str, entry->element[0]->len);
+  result.clear();
+  redisReply *fields = entry->element[1];
+  for (size_t i = 0; i + 1 < fields->elements; i += 2) {
+    redisReply *name = fields->element[i];
+    redisReply *value = fields->element[i + 1];
+    if (name->type == REDIS_REPLY_STRING && name->len == 7 && memcmp(name->str, "payload", 7) == 0 && value->type == REDIS_REPLY_STRING) {
+      result.assign(value->str, value->len);
+    }
+  }
+
+  freeReplyObject(reply);
+  return true;
+}
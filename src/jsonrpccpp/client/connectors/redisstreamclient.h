@@ -0,0 +1,97 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    redisstreamclient.h
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_REDISSTREAMCLIENT_H_
+#define JSONRPC_CPP_REDISSTREAMCLIENT_H_
+
+#include "../iclientconnector.h"
+#include <hiredis/hiredis.h>
+#include <jsonrpccpp/common/exception.h>
+#include <string>
+
+namespace jsonrpc {
+  /**
+   * This class is the redis streams implementation of an
+   * AbstractClientConnector, the counterpart of the RedisStreamServer.
+   *
+   * Requests are appended to the server's stream with XADD, with the name
+   * of the client's reply stream and the request kept in the separate
+   * fields "reply" and "payload". The reply stream is created once per
+   * client and read with XREAD; responses are matched to their request by
+   * JSON-RPC id, so duplicates caused by redelivery are skipped. The reply
+   * stream is deleted when the client is destroyed.
+   */
+  class RedisStreamClient : public IClientConnector {
+  public:
+    /**
+     * RedisStreamClient
+     * @param host The ip address of the redis server.
+     * @param port The port of the redis server.
+     * @param stream The stream to send to.
+     */
+    RedisStreamClient(const std::string &host, int port, const std::string &stream);
+    virtual ~RedisStreamClient();
+
+    /**
+     * This method will send an rpc message to the RedisStreamServer and return the result.
+     * @param message The message to send.
+     * @param result The returned message from the server.
+     */
+    virtual void SendRPCMessage(const std::string &message, std::string &result);
+
+    /**
+     * Set the stream that we are messaging with.
+     * @param stream The stream to send to.
+     */
+    void SetStream(const std::string &stream);
+
+    /**
+     * Set how long we should wait for a response.
+     * @param timeout The length of time to wait in seconds
+     */
+    void SetTimeout(long timeout);
+
+  protected:
+    /**
+     * Receives the next entry of the reply stream.
+     * @param timeout The time to wait in seconds.
+     * @param pipelined Whether the XREAD has already been appended to the pipeline.
+     * @param result The payload of the entry is returned here.
+     * @return false if the operation timed out.
+     */
+    bool ReadResponse(long timeout, bool pipelined, std::string &result);
+
+    /**
+     * @brief Stream that we are messaging
+     */
+    std::string stream;
+
+    /**
+     * @brief Timeout for a response in seconds
+     */
+    long timeout;
+
+    /**
+     * @brief Our connection to the redis server
+     */
+    redisContext *con;
+
+    /**
+     * @brief The reply stream, empty until first use
+     */
+    std::string ret_stream;
+
+    /**
+     * @brief Id of the last entry read from the reply stream
+     */
+    std::string last_id;
+  };
+
+} /* namespace jsonrpc */
+#endif /* JSONRPC_CPP_REDISSTREAMCLIENT_H_ */
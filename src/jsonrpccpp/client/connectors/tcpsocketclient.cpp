@@ -28,6 +28,24 @@ TcpSocketClient::TcpSocketClient(const std::string &ipToConnect, const unsigned
 
 TcpSocketClient::~TcpSocketClient() { delete this->realSocket; }
 
+bool TcpSocketClient::SetFraming(framing_t framing) {
+#ifdef _WIN32
+  return framing == FRAMING_DELIMITER;
+#else
+  static_cast<LinuxTcpSocketClient *>(this->realSocket)->SetFraming(framing);
+  return true;
+#endif
+}
+
+bool TcpSocketClient::SetTimeout(long timeout) {
+#ifdef _WIN32
+  return timeout == 0;
+#else
+  static_cast<LinuxTcpSocketClient *>(this->realSocket)->SetTimeout(timeout);
+  return true;
+#endif
+}
+
 void TcpSocketClient::SendRPCMessage(const std::string &message, std::string &result) {
   if (this->realSocket != NULL) {
     this->realSocket->SendRPCMessage(message, result);
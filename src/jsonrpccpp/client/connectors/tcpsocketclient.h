@@ -12,6 +12,7 @@
 
 #include <jsonrpccpp/client/iclientconnector.h>
 #include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/sharedconstants.h>
 #include <string>
 
 namespace jsonrpc {
@@ -45,6 +46,22 @@ namespace jsonrpc {
      */
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * @brief Selects how messages are separated on the tcp flow, the server
+     * has to use the same framing. FRAMING_LENGTH_PREFIX is only available
+     * in the Linux/UNIX implementation.
+     * @return false if the framing is not supported.
+     */
+    bool SetFraming(framing_t framing);
+
+    /**
+     * @brief Limits the time spent writing a request and reading its response.
+     * Only available in the Linux/UNIX implementation.
+     * @param timeout The timeout for each of both in milliseconds, 0 waits forever (default).
+     * @return false if timeouts are not supported.
+     */
+    bool SetTimeout(long timeout);
+
   protected:
     IClientConnector *realSocket; /*!< A pointer to the real implementation of this class depending of running OS*/
   };
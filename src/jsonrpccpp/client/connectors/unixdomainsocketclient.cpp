@@ -13,6 +13,7 @@
 #include "../../common/streamwriter.h"
 #include <cstdio>
 #include <cstdlib>
+#include <errno.h>
 #include <iostream>
 #include <string.h>
 #include <string>
@@ -23,7 +24,7 @@
 using namespace jsonrpc;
 using namespace std;
 
-UnixDomainSocketClient::UnixDomainSocketClient(const std::string &path) : path(path) {}
+UnixDomainSocketClient::UnixDomainSocketClient(const std::string &path) : path(path), framing(FRAMING_DELIMITER), timeout(0) {}
 
 UnixDomainSocketClient::~UnixDomainSocketClient() {}
 
@@ -45,16 +46,23 @@ void UnixDomainSocketClient::SendRPCMessage(const std::string &message, std::str
   }
 
   StreamWriter writer;
-  string toSend = message + DEFAULT_DELIMITER_CHAR;
-  if (!writer.Write(toSend, socket_fd)) {
+  writer.SetTimeout(this->timeout);
+  if (!writer.WriteMessage(message, socket_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
     close(socket_fd);
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not write request");
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not write request");
   }
 
   StreamReader reader(DEFAULT_BUFFER_SIZE);
-  if (!reader.Read(result, socket_fd, DEFAULT_DELIMITER_CHAR)) {
+  reader.SetTimeout(this->timeout);
+  if (!reader.ReadMessage(result, socket_fd, this->framing)) {
+    bool timedout = errno == ETIMEDOUT;
     close(socket_fd);
-    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, "Could not read response");
+    throw JsonRpcException(Errors::ERROR_CLIENT_CONNECTOR, timedout ? "Operation timed out" : "Could not read response");
   }
   close(socket_fd);
 }
+
+void UnixDomainSocketClient::SetFraming(framing_t framing) { this->framing = framing; }
+
+void UnixDomainSocketClient::SetTimeout(long timeout) { this->timeout = timeout; }
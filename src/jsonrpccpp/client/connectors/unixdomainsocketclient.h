@@ -12,6 +12,7 @@
 
 #include "../iclientconnector.h"
 #include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/sharedconstants.h>
 
 namespace jsonrpc {
   class UnixDomainSocketClient : public IClientConnector {
@@ -20,8 +21,22 @@ namespace jsonrpc {
     virtual ~UnixDomainSocketClient();
     virtual void SendRPCMessage(const std::string &message, std::string &result);
 
+    /**
+     * @brief Selects how messages are separated on the stream, the server
+     * has to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
+
+    /**
+     * @brief Limits the time spent writing a request and reading its response.
+     * @param timeout The timeout for each of both in milliseconds, 0 waits forever (default).
+     */
+    void SetTimeout(long timeout);
+
   protected:
     std::string path;
+    framing_t framing;
+    long timeout;
   };
 
 } /* namespace jsonrpc */
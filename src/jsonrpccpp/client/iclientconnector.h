@@ -10,6 +10,7 @@
 #ifndef JSONRPC_CPP_CLIENTCONNECTOR_H_
 #define JSONRPC_CPP_CLIENTCONNECTOR_H_
 
+#include <jsonrpccpp/common/codec.h>
 #include <jsonrpccpp/common/exception.h>
 #include <string>
 
@@ -19,6 +20,17 @@ namespace jsonrpc {
     virtual ~IClientConnector() {}
 
     virtual void SendRPCMessage(const std::string &message, std::string &result) = 0;
+
+    /**
+     * Sends a message in the given wire encoding, the result uses the same one.
+     * Connectors that announce the encoding to the server, like the
+     * HttpClient, override this. Stream connectors carry the bytes as they are
+     * and need FRAMING_LENGTH_PREFIX for binary codecs.
+     */
+    virtual void SendEncodedRPCMessage(const std::string &message, std::string &result, codec_t codec) {
+      (void)codec;
+      this->SendRPCMessage(message, result);
+    }
   };
 } /* namespace jsonrpc */
 #endif /* JSONRPC_CPP_CLIENTCONNECTOR_H_ */
@@ -8,7 +8,9 @@
  ************************************************************************/
 
 #include "rpcprotocolclient.h"
+#include <jsonrpccpp/common/cancellation.h>
 #include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/tracing.h>
 
 using namespace jsonrpc;
 
@@ -23,7 +25,7 @@ const std::string RpcProtocolClient::KEY_ERROR_CODE = "code";
 const std::string RpcProtocolClient::KEY_ERROR_MESSAGE = "message";
 const std::string RpcProtocolClient::KEY_ERROR_DATA = "data";
 
-RpcProtocolClient::RpcProtocolClient(clientVersion_t version, bool omitEndingLineFeed) : version(version), omitEndingLineFeed(omitEndingLineFeed) {}
+RpcProtocolClient::RpcProtocolClient(clientVersion_t version, bool omitEndingLineFeed) : version(version), omitEndingLineFeed(omitEndingLineFeed), deadline(0), codec(CODEC_JSON) {}
 
 void RpcProtocolClient::BuildRequest(const std::string &method, const Json::Value &parameter, std::string &result, bool isNotification) {
   Json::Value request;
@@ -31,21 +33,57 @@ void RpcProtocolClient::BuildRequest(const std::string &method, const Json::Valu
   wbuilder["indentation"] = "";
   this->BuildRequest(1, method, parameter, request, isNotification);
 
-  result = Json::writeString(wbuilder, request);
+  if (this->codec == CODEC_JSON)
+    result = Json::writeString(wbuilder, request);
+  else
+    Codec::Encode(request, this->codec, result);
+}
+
+void RpcProtocolClient::BuildRequest(const std::string &method, const ParameterWriter &parameter, std::string &result, bool isNotification) {
+  if (this->codec != CODEC_JSON) {
+    this->BuildRequest(method, parameter.ToValue(), result, isNotification);
+    return;
+  }
+
+  // The envelope only holds strings, numbers and null, which are written
+  // directly as well, a Json::StreamWriter costs more than the whole request.
+  Json::Value request;
+  this->BuildRequest(1, method, Json::nullValue, request, isNotification);
+  result = "{";
+  for (Json::Value::const_iterator it = request.begin(); it != request.end(); ++it) {
+    if (result.size() > 1)
+      result += ',';
+    std::string key = it.name();
+    ParameterWriter::WriteString(key.data(), key.size(), result);
+    result += ':';
+    if (it->isString()) {
+      const char *begin, *end;
+      it->getString(&begin, &end);
+      ParameterWriter::WriteString(begin, end - begin, result);
+    } else if (it->isInt64()) {
+      result += Json::valueToString(it->asLargestInt());
+    } else if (it->isNull()) {
+      result += "null";
+    } else {
+      Json::StreamWriterBuilder wbuilder;
+      wbuilder["indentation"] = "";
+      result += Json::writeString(wbuilder, *it);
+    }
+  }
+  if (!parameter.IsEmpty())
+    result += ",\"" + KEY_PARAMETER + "\":" + parameter.GetText();
+  result += '}';
 }
 
 void RpcProtocolClient::HandleResponse(const std::string &response, Json::Value &result) {
   Json::Value value;
 
-  try {
-    if (std::istringstream(response) >> value) {
-      this->HandleResponse(value, result);
-    } else {
+  if (!Codec::Decode(response, this->codec, value)) {
+    if (this->codec == CODEC_JSON)
       throw JsonRpcException(Errors::ERROR_RPC_JSON_PARSE_ERROR, " " + response);
-    }
-  } catch (Json::Exception &e) {
-    throw JsonRpcException(Errors::ERROR_RPC_JSON_PARSE_ERROR, " " + response);
+    throw JsonRpcException(Errors::ERROR_RPC_JSON_PARSE_ERROR);
   }
+  this->HandleResponse(value, result);
 }
 
 Json::Value RpcProtocolClient::HandleResponse(const Json::Value &value, Json::Value &result) {
@@ -71,8 +109,27 @@ void RpcProtocolClient::BuildRequest(int id, const std::string &method, const Js
     result[KEY_ID] = id;
   else if (this->version == JSONRPC_CLIENT_V1)
     result[KEY_ID] = Json::nullValue;
+
+  const std::string &traceid = this->traceid.empty() ? TraceContext::GetCurrent() : this->traceid;
+  if (!traceid.empty())
+    result[KEY_REQUEST_TRACEID] = traceid;
+
+  long remaining = this->deadline > 0 ? this->deadline : -1;
+  const CancellationToken *token = CancellationToken::GetCurrent();
+  if (token != NULL && token->GetRemaining() >= 0 && (remaining < 0 || token->GetRemaining() < remaining))
+    remaining = token->GetRemaining();
+  if (remaining >= 0)
+    result[KEY_REQUEST_DEADLINE] = static_cast<Json::Int64>(remaining);
 }
 
+void RpcProtocolClient::SetTraceId(const std::string &traceid) { this->traceid = traceid; }
+
+void RpcProtocolClient::SetDeadline(long deadline) { this->deadline = deadline; }
+
+void RpcProtocolClient::SetCodec(codec_t codec) { this->codec = codec; }
+
+codec_t RpcProtocolClient::GetCodec() const { return this->codec; }
+
 void RpcProtocolClient::throwErrorException(const Json::Value &response) {
   if (response[KEY_ERROR].isMember(KEY_ERROR_MESSAGE) && response[KEY_ERROR][KEY_ERROR_MESSAGE].isString()) {
     if (response[KEY_ERROR].isMember(KEY_ERROR_DATA)) {
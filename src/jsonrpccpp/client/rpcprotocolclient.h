@@ -43,6 +43,12 @@ namespace jsonrpc {
      */
     void BuildRequest(const std::string &method, const Json::Value &parameter, std::string &result, bool isNotification);
 
+    /**
+     * @brief Builds a request whose params are already written as JSON text, they are
+     * copied into the request as they are.
+     */
+    void BuildRequest(const std::string &method, const ParameterWriter &parameter, std::string &result, bool isNotification);
+
     /**
      * @brief Does the same as Json::Value RpcProtocolClient::HandleResponse(const std::string& response) throw(Exception)
      * but returns result as reference for performance speed up.
@@ -57,6 +63,24 @@ namespace jsonrpc {
      */
     Json::Value HandleResponse(const Json::Value &response, Json::Value &result);
 
+    /**
+     * @brief Sets the trace id attached to each request. If empty, the trace id of the
+     * calling thread's TraceContext is attached, if there is one.
+     */
+    void SetTraceId(const std::string &traceid);
+
+    /**
+     * @brief Sets the time in milliseconds a request may take, 0 for none. The deadline of
+     * the calling thread's CancellationToken is attached instead if it is shorter.
+     */
+    void SetDeadline(long deadline);
+
+    /**
+     * @brief Selects the wire encoding of built requests and handled responses, CODEC_JSON by default.
+     */
+    void SetCodec(codec_t codec);
+    codec_t GetCodec() const;
+
     static const std::string KEY_PROTOCOL_VERSION;
     static const std::string KEY_PROCEDURE_NAME;
     static const std::string KEY_ID;
@@ -71,6 +95,9 @@ namespace jsonrpc {
   private:
     clientVersion_t version;
     bool omitEndingLineFeed;
+    std::string traceid;
+    long deadline;
+    codec_t codec;
 
     void BuildRequest(int id, const std::string &method, const Json::Value &parameter, Json::Value &result, bool isNotification);
     bool ValidateResponse(const Json::Value &response);
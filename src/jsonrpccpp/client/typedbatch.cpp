@@ -0,0 +1,57 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    typedbatch.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "typedbatch.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+TypedBatch::TypedBatch(Client &client) : client(client), count(0) {}
+
+TypedBatch::~TypedBatch() {}
+
+BatchResponse TypedBatch::send() {
+  BatchResponse response;
+  if (this->count == 0)
+    return response;
+
+  BatchCall calls = this->calls;
+  vector<pair<int, IBatchResult *>> results;
+  results.swap(this->results);
+  this->calls = BatchCall();
+  this->count = 0;
+
+  this->client.CallProcedures(calls, response);
+
+  for (vector<pair<int, IBatchResult *>>::const_iterator it = results.begin(); it != results.end(); ++it) {
+    Json::Value id = it->first;
+    if (!response.hasResponse(id))
+      it->second->SetError(Errors::ERROR_CLIENT_INVALID_RESPONSE, "No response for call in batch");
+    else if (response.getErrorCode(id) != 0)
+      it->second->SetError(response.getErrorCode(id), response.getErrorMessage(id));
+    else
+      it->second->SetResult(response.getResult(it->first));
+  }
+  return response;
+}
+
+size_t TypedBatch::size() const { return this->count; }
+
+int TypedBatch::addCall(const string &name, const Json::Value &params, IBatchResult *result) {
+  int id = this->calls.addCall(name, params, false);
+  this->count++;
+  if (result != NULL)
+    this->results.push_back(make_pair(id, result));
+  return id;
+}
+
+void TypedBatch::addNotification(const string &name, const Json::Value &params) {
+  this->calls.addCall(name, params, true);
+  this->count++;
+}
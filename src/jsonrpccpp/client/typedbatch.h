@@ -0,0 +1,129 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    typedbatch.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_TYPEDBATCH_H
+#define JSONRPC_CPP_TYPEDBATCH_H
+
+#include "client.h"
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/jsonconversion.h>
+#include <utility>
+#include <vector>
+
+namespace jsonrpc {
+
+  /**
+   * Outcome of a single call in a TypedBatch, filled in by TypedBatch::send.
+   */
+  class IBatchResult {
+  public:
+    IBatchResult() : received(false), code(0) {}
+    virtual ~IBatchResult() {}
+
+    /**
+     * @return true once a result or an error has been received for the call.
+     */
+    bool IsReceived() const { return this->received; }
+    bool HasError() const { return this->code != 0; }
+    int GetErrorCode() const { return this->code; }
+    const std::string &GetErrorMessage() const { return this->message; }
+
+    void SetError(int code, const std::string &message) {
+      this->received = true;
+      this->code = code;
+      this->message = message;
+    }
+
+    /**
+     * @return false if value doesn't have the expected type, which is recorded as an error.
+     */
+    virtual bool SetResult(const Json::Value &value) = 0;
+
+  protected:
+    bool received;
+    int code;
+    std::string message;
+  };
+
+  /**
+   * Typed result of a batched method call. Values are checked and converted
+   * with FromJson, which includes the structs of generated stubs.
+   */
+  template <typename T> class BatchResult : public IBatchResult {
+  public:
+    BatchResult() : value() {}
+
+    virtual bool SetResult(const Json::Value &value) {
+      if (!FromJson(value, this->value)) {
+        this->SetError(Errors::ERROR_CLIENT_INVALID_RESPONSE, value.toStyledString());
+        return false;
+      }
+      this->received = true;
+      this->code = 0;
+      this->message.clear();
+      return true;
+    }
+
+    /**
+     * @throws JsonRpcException with the error of the call, or if it hasn't been sent yet.
+     */
+    const T &Get() const {
+      if (!this->received)
+        throw JsonRpcException(Errors::ERROR_CLIENT_INVALID_RESPONSE, "Batch has not been sent");
+      if (this->code != 0)
+        throw JsonRpcException(this->code, this->message);
+      return this->value;
+    }
+
+  private:
+    T value;
+  };
+
+  /**
+   * Collects calls and sends them in a single batch request. Stubs generated
+   * by jsonrpcstub derive a Batch class with a chainable method per
+   * procedure, e.g. client.batch().getUser(1, first).getUser(2, second).send().
+   */
+  class TypedBatch {
+  public:
+    explicit TypedBatch(Client &client);
+    virtual ~TypedBatch();
+
+    /**
+     * Sends all calls added since the last send in one request and hands
+     * their results to the BatchResults they were added with. Calls without
+     * a response, e.g. because the server dropped them, get an error.
+     * @return The untyped responses, also for calls added without a BatchResult.
+     * @throws JsonRpcException if the batch can't be sent or its response is invalid.
+     */
+    BatchResponse send();
+
+    /**
+     * @return The number of calls and notifications waiting to be sent.
+     */
+    size_t size() const;
+
+  protected:
+    /**
+     * @param result Can be NULL if the result isn't needed. Has to live until send returns.
+     * @return The id of the call inside the batch.
+     */
+    int addCall(const std::string &name, const Json::Value &params, IBatchResult *result);
+    void addNotification(const std::string &name, const Json::Value &params);
+
+  private:
+    Client &client;
+    BatchCall calls;
+    size_t count;
+    std::vector<std::pair<int, IBatchResult *>> results;
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_TYPEDBATCH_H
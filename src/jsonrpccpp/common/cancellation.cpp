@@ -0,0 +1,52 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    cancellation.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "cancellation.h"
+#include "tracing.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+static thread_local const CancellationToken *currentToken = NULL;
+static thread_local uint64_t currentArrival = 0;
+
+CancellationToken::CancellationToken(uint64_t deadline) : deadline(deadline), cancelled(false) {}
+
+void CancellationToken::Cancel() { this->cancelled.store(true, memory_order_relaxed); }
+
+bool CancellationToken::IsCancelled() const {
+  if (this->cancelled.load(memory_order_relaxed))
+    return true;
+  return this->deadline != 0 && ITracer::Now() >= this->deadline;
+}
+
+uint64_t CancellationToken::GetDeadline() const { return this->deadline; }
+
+long CancellationToken::GetRemaining() const {
+  if (this->deadline == 0)
+    return -1;
+  uint64_t now = ITracer::Now();
+  if (now >= this->deadline)
+    return 0;
+  return static_cast<long>((this->deadline - now) / 1000000);
+}
+
+const CancellationToken *CancellationToken::GetCurrent() { return currentToken; }
+
+bool CancellationToken::IsCurrentCancelled() { return currentToken != NULL && currentToken->IsCancelled(); }
+
+CancellationScope::CancellationScope(const CancellationToken &token) : previous(currentToken) { currentToken = &token; }
+
+CancellationScope::~CancellationScope() { currentToken = this->previous; }
+
+ArrivalContext::ArrivalContext(uint64_t arrival) : previous(currentArrival) { currentArrival = arrival; }
+
+ArrivalContext::~ArrivalContext() { currentArrival = this->previous; }
+
+uint64_t ArrivalContext::GetCurrent() { return currentArrival; }
@@ -0,0 +1,103 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    cancellation.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_CANCELLATION_H
+#define JSONRPC_CPP_CANCELLATION_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Reserved request member carrying the time left for a request in milliseconds.
+#define KEY_REQUEST_DEADLINE "deadline"
+
+namespace jsonrpc {
+
+  /**
+   * Tells a procedure whether its caller is still waiting for the result.
+   * The token is cancelled once its deadline has passed or Cancel() was
+   * called. Long running procedures should poll it and give up early, see
+   * GetCurrent().
+   */
+  class CancellationToken {
+  public:
+    /**
+     * @param deadline The point in time of ITracer::Now() after which the token is cancelled, 0 for none.
+     */
+    explicit CancellationToken(uint64_t deadline = 0);
+
+    void Cancel();
+    bool IsCancelled() const;
+
+    uint64_t GetDeadline() const;
+
+    /**
+     * @return The milliseconds left until the deadline, -1 if there is none.
+     */
+    long GetRemaining() const;
+
+    /**
+     * @return The token of the request the calling thread is processing, NULL if there is none.
+     */
+    static const CancellationToken *GetCurrent();
+
+    /**
+     * @return Whether the token of the calling thread is cancelled, false if there is none.
+     */
+    static bool IsCurrentCancelled();
+
+  private:
+    uint64_t deadline;
+    std::atomic<bool> cancelled;
+
+    CancellationToken(const CancellationToken &);
+    CancellationToken &operator=(const CancellationToken &);
+  };
+
+  /**
+   * Makes a token the current one of the calling thread for the lifetime of
+   * the object. Clients attach the time left of the current token to their
+   * requests, so deadlines propagate to nested calls.
+   */
+  class CancellationScope {
+  public:
+    explicit CancellationScope(const CancellationToken &token);
+    ~CancellationScope();
+
+  private:
+    const CancellationToken *previous;
+
+    CancellationScope(const CancellationScope &);
+    CancellationScope &operator=(const CancellationScope &);
+  };
+
+  /**
+   * Records when the message the calling thread is processing was received,
+   * in nanoseconds of ITracer::Now(). Connectors that queue messages set it,
+   * so the time spent waiting counts against the deadline of a request.
+   */
+  class ArrivalContext {
+  public:
+    explicit ArrivalContext(uint64_t arrival);
+    ~ArrivalContext();
+
+    /**
+     * @return The arrival time of the current message, 0 if unknown.
+     */
+    static uint64_t GetCurrent();
+
+  private:
+    uint64_t previous;
+
+    ArrivalContext(const ArrivalContext &);
+    ArrivalContext &operator=(const ArrivalContext &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_CANCELLATION_H
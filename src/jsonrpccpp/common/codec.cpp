@@ -0,0 +1,619 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    codec.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "codec.h"
+#include "jsonreader.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+// Same nesting limit as the default of jsoncpp's reader.
+#define CODEC_MAX_DEPTH 1000
+
+namespace {
+  struct Cursor {
+    const unsigned char *pos;
+    const unsigned char *end;
+
+    size_t Remaining() const { return static_cast<size_t>(this->end - this->pos); }
+  };
+} // namespace
+
+static void AppendBigEndian(string &target, uint64_t value, size_t bytes) {
+  for (size_t i = bytes; i > 0; i--) {
+    target.push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xff));
+  }
+}
+
+static bool ReadBigEndian(Cursor &cursor, size_t bytes, uint64_t &value) {
+  if (cursor.Remaining() < bytes)
+    return false;
+  value = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    value = (value << 8) | *cursor.pos++;
+  }
+  return true;
+}
+
+static uint64_t DoubleBits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static Json::Value UnsignedValue(uint64_t value) {
+  if (value <= static_cast<uint64_t>(numeric_limits<Json::LargestInt>::max()))
+    return Json::Value(static_cast<Json::LargestInt>(value));
+  return Json::Value(static_cast<Json::LargestUInt>(value));
+}
+
+static bool ReadString(Cursor &cursor, uint64_t length, Json::Value &target) {
+  if (length > cursor.Remaining())
+    return false;
+  const char *begin = reinterpret_cast<const char *>(cursor.pos);
+  target = Json::Value(begin, begin + length);
+  cursor.pos += length;
+  return true;
+}
+
+/*
+ * MessagePack, see https://github.com/msgpack/msgpack/blob/master/spec.md
+ */
+
+static void PackLength(string &target, size_t length, unsigned char fix, size_t fixLimit, unsigned char length8, unsigned char length16) {
+  if (length < fixLimit) {
+    target.push_back(static_cast<char>(fix | length));
+  } else if (length8 != 0 && length <= 0xff) {
+    target.push_back(static_cast<char>(length8));
+    AppendBigEndian(target, length, 1);
+  } else if (length <= 0xffff) {
+    target.push_back(static_cast<char>(length16));
+    AppendBigEndian(target, length, 2);
+  } else {
+    target.push_back(static_cast<char>(length16 + 1));
+    AppendBigEndian(target, length, 4);
+  }
+}
+
+static void PackUnsigned(string &target, uint64_t value) {
+  if (value < 0x80) {
+    target.push_back(static_cast<char>(value));
+  } else if (value <= 0xff) {
+    target.push_back(static_cast<char>(0xcc));
+    AppendBigEndian(target, value, 1);
+  } else if (value <= 0xffff) {
+    target.push_back(static_cast<char>(0xcd));
+    AppendBigEndian(target, value, 2);
+  } else if (value <= 0xffffffff) {
+    target.push_back(static_cast<char>(0xce));
+    AppendBigEndian(target, value, 4);
+  } else {
+    target.push_back(static_cast<char>(0xcf));
+    AppendBigEndian(target, value, 8);
+  }
+}
+
+static void PackSigned(string &target, int64_t value) {
+  if (value >= 0) {
+    PackUnsigned(target, static_cast<uint64_t>(value));
+  } else if (value >= -32) {
+    target.push_back(static_cast<char>(value));
+  } else if (value >= numeric_limits<int8_t>::min()) {
+    target.push_back(static_cast<char>(0xd0));
+    AppendBigEndian(target, static_cast<uint64_t>(value), 1);
+  } else if (value >= numeric_limits<int16_t>::min()) {
+    target.push_back(static_cast<char>(0xd1));
+    AppendBigEndian(target, static_cast<uint64_t>(value), 2);
+  } else if (value >= numeric_limits<int32_t>::min()) {
+    target.push_back(static_cast<char>(0xd2));
+    AppendBigEndian(target, static_cast<uint64_t>(value), 4);
+  } else {
+    target.push_back(static_cast<char>(0xd3));
+    AppendBigEndian(target, static_cast<uint64_t>(value), 8);
+  }
+}
+
+static void Pack(const Json::Value &value, string &target) {
+  switch (value.type()) {
+  case Json::nullValue:
+    target.push_back(static_cast<char>(0xc0));
+    break;
+  case Json::booleanValue:
+    target.push_back(static_cast<char>(value.asBool() ? 0xc3 : 0xc2));
+    break;
+  case Json::intValue:
+    PackSigned(target, value.asLargestInt());
+    break;
+  case Json::uintValue:
+    PackUnsigned(target, value.asLargestUInt());
+    break;
+  case Json::realValue:
+    target.push_back(static_cast<char>(0xcb));
+    AppendBigEndian(target, DoubleBits(value.asDouble()), 8);
+    break;
+  case Json::stringValue: {
+    const char *begin = NULL;
+    const char *end = NULL;
+    value.getString(&begin, &end);
+    PackLength(target, static_cast<size_t>(end - begin), 0xa0, 32, 0xd9, 0xda);
+    target.append(begin, end);
+    break;
+  }
+  case Json::arrayValue:
+    PackLength(target, value.size(), 0x90, 16, 0, 0xdc);
+    for (Json::ArrayIndex i = 0; i < value.size(); i++) {
+      Pack(value[i], target);
+    }
+    break;
+  case Json::objectValue:
+    PackLength(target, value.size(), 0x80, 16, 0, 0xde);
+    for (Json::Value::const_iterator it = value.begin(); it != value.end(); ++it) {
+      const char *end = NULL;
+      const char *begin = it.memberName(&end);
+      PackLength(target, static_cast<size_t>(end - begin), 0xa0, 32, 0xd9, 0xda);
+      target.append(begin, end);
+      Pack(*it, target);
+    }
+    break;
+  }
+}
+
+static bool Unpack(Cursor &cursor, Json::Value &target, int depth);
+
+static bool UnpackArray(Cursor &cursor, uint64_t length, Json::Value &target, int depth) {
+  // Every element takes at least one byte, so the size can't be bogus.
+  if (length > cursor.Remaining())
+    return false;
+  target = Json::Value(Json::arrayValue);
+  if (length > 0)
+    target.resize(static_cast<Json::ArrayIndex>(length));
+  for (Json::ArrayIndex i = 0; i < length; i++) {
+    if (!Unpack(cursor, target[i], depth + 1))
+      return false;
+  }
+  return true;
+}
+
+static bool UnpackMap(Cursor &cursor, uint64_t length, Json::Value &target, int depth) {
+  if (length > cursor.Remaining() / 2)
+    return false;
+  target = Json::Value(Json::objectValue);
+  Json::Value key;
+  for (uint64_t i = 0; i < length; i++) {
+    if (!Unpack(cursor, key, depth + 1) || !key.isString())
+      return false;
+    const char *begin = NULL;
+    const char *end = NULL;
+    key.getString(&begin, &end);
+    if (!Unpack(cursor, target[string(begin, end)], depth + 1))
+      return false;
+  }
+  return true;
+}
+
+static bool Unpack(Cursor &cursor, Json::Value &target, int depth) {
+  if (depth > CODEC_MAX_DEPTH || cursor.Remaining() == 0)
+    return false;
+
+  unsigned char type = *cursor.pos++;
+  uint64_t value = 0;
+  if (type <= 0x7f) {
+    target = Json::Value(static_cast<Json::LargestInt>(type));
+    return true;
+  }
+  if (type >= 0xe0) {
+    target = Json::Value(static_cast<Json::LargestInt>(static_cast<int8_t>(type)));
+    return true;
+  }
+  if (type <= 0x8f)
+    return UnpackMap(cursor, type & 0x0f, target, depth);
+  if (type <= 0x9f)
+    return UnpackArray(cursor, type & 0x0f, target, depth);
+  if (type <= 0xbf)
+    return ReadString(cursor, type & 0x1f, target);
+
+  switch (type) {
+  case 0xc0:
+    target = Json::Value(Json::nullValue);
+    return true;
+  case 0xc2:
+  case 0xc3:
+    target = Json::Value(type == 0xc3);
+    return true;
+  case 0xc4:
+  case 0xc5:
+  case 0xc6:
+    return ReadBigEndian(cursor, static_cast<size_t>(1) << (type - 0xc4), value) && ReadString(cursor, value, target);
+  case 0xca: {
+    if (!ReadBigEndian(cursor, 4, value))
+      return false;
+    uint32_t bits = static_cast<uint32_t>(value);
+    float number;
+    memcpy(&number, &bits, sizeof(number));
+    target = Json::Value(static_cast<double>(number));
+    return true;
+  }
+  case 0xcb: {
+    if (!ReadBigEndian(cursor, 8, value))
+      return false;
+    double number;
+    memcpy(&number, &value, sizeof(number));
+    target = Json::Value(number);
+    return true;
+  }
+  case 0xcc:
+  case 0xcd:
+  case 0xce:
+  case 0xcf:
+    if (!ReadBigEndian(cursor, static_cast<size_t>(1) << (type - 0xcc), value))
+      return false;
+    target = UnsignedValue(value);
+    return true;
+  case 0xd0:
+  case 0xd1:
+  case 0xd2:
+  case 0xd3: {
+    size_t bytes = static_cast<size_t>(1) << (type - 0xd0);
+    if (!ReadBigEndian(cursor, bytes, value))
+      return false;
+    // Sign extend from the encoded width.
+    if (bytes < 8 && (value >> (bytes * 8 - 1)) != 0)
+      value |= ~static_cast<uint64_t>(0) << (bytes * 8);
+    target = Json::Value(static_cast<Json::LargestInt>(static_cast<int64_t>(value)));
+    return true;
+  }
+  case 0xd9:
+  case 0xda:
+  case 0xdb:
+    return ReadBigEndian(cursor, static_cast<size_t>(1) << (type - 0xd9), value) && ReadString(cursor, value, target);
+  case 0xdc:
+  case 0xdd:
+    return ReadBigEndian(cursor, type == 0xdc ? 2 : 4, value) && UnpackArray(cursor, value, target, depth);
+  case 0xde:
+  case 0xdf:
+    return ReadBigEndian(cursor, type == 0xde ? 2 : 4, value) && UnpackMap(cursor, value, target, depth);
+  default:
+    // 0xc1 is never used, extension types have no JSON counterpart.
+    return false;
+  }
+}
+
+/*
+ * CBOR, see RFC 8949
+ */
+
+#define CBOR_UNSIGNED 0
+#define CBOR_NEGATIVE 1
+#define CBOR_BYTES 2
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_TAG 6
+#define CBOR_SIMPLE 7
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK 0xff
+
+static void CborHeader(string &target, unsigned char major, uint64_t value) {
+  major = static_cast<unsigned char>(major << 5);
+  if (value < 24) {
+    target.push_back(static_cast<char>(major | value));
+  } else if (value <= 0xff) {
+    target.push_back(static_cast<char>(major | 24));
+    AppendBigEndian(target, value, 1);
+  } else if (value <= 0xffff) {
+    target.push_back(static_cast<char>(major | 25));
+    AppendBigEndian(target, value, 2);
+  } else if (value <= 0xffffffff) {
+    target.push_back(static_cast<char>(major | 26));
+    AppendBigEndian(target, value, 4);
+  } else {
+    target.push_back(static_cast<char>(major | 27));
+    AppendBigEndian(target, value, 8);
+  }
+}
+
+static void CborEncode(const Json::Value &value, string &target) {
+  switch (value.type()) {
+  case Json::nullValue:
+    target.push_back(static_cast<char>(0xf6));
+    break;
+  case Json::booleanValue:
+    target.push_back(static_cast<char>(value.asBool() ? 0xf5 : 0xf4));
+    break;
+  case Json::intValue: {
+    Json::LargestInt number = value.asLargestInt();
+    if (number >= 0)
+      CborHeader(target, CBOR_UNSIGNED, static_cast<uint64_t>(number));
+    else
+      CborHeader(target, CBOR_NEGATIVE, static_cast<uint64_t>(-(number + 1)));
+    break;
+  }
+  case Json::uintValue:
+    CborHeader(target, CBOR_UNSIGNED, value.asLargestUInt());
+    break;
+  case Json::realValue:
+    target.push_back(static_cast<char>(0xfb));
+    AppendBigEndian(target, DoubleBits(value.asDouble()), 8);
+    break;
+  case Json::stringValue: {
+    const char *begin = NULL;
+    const char *end = NULL;
+    value.getString(&begin, &end);
+    CborHeader(target, CBOR_TEXT, static_cast<uint64_t>(end - begin));
+    target.append(begin, end);
+    break;
+  }
+  case Json::arrayValue:
+    CborHeader(target, CBOR_ARRAY, value.size());
+    for (Json::ArrayIndex i = 0; i < value.size(); i++) {
+      CborEncode(value[i], target);
+    }
+    break;
+  case Json::objectValue:
+    CborHeader(target, CBOR_MAP, value.size());
+    for (Json::Value::const_iterator it = value.begin(); it != value.end(); ++it) {
+      const char *end = NULL;
+      const char *begin = it.memberName(&end);
+      CborHeader(target, CBOR_TEXT, static_cast<uint64_t>(end - begin));
+      target.append(begin, end);
+      CborEncode(*it, target);
+    }
+    break;
+  }
+}
+
+static bool CborArgument(Cursor &cursor, unsigned char info, uint64_t &value) {
+  if (info < 24) {
+    value = info;
+    return true;
+  }
+  if (info > 27)
+    return false;
+  return ReadBigEndian(cursor, static_cast<size_t>(1) << (info - 24), value);
+}
+
+static double CborHalf(uint16_t half) {
+  int exponent = (half >> 10) & 0x1f;
+  int mantissa = half & 0x3ff;
+  double value;
+  if (exponent == 0)
+    value = ldexp(mantissa, -24);
+  else if (exponent != 31)
+    value = ldexp(mantissa + 1024, exponent - 25);
+  else
+    value = mantissa == 0 ? numeric_limits<double>::infinity() : numeric_limits<double>::quiet_NaN();
+  return (half & 0x8000) ? -value : value;
+}
+
+static bool CborAtBreak(Cursor &cursor) {
+  if (cursor.Remaining() > 0 && *cursor.pos == CBOR_BREAK) {
+    cursor.pos++;
+    return true;
+  }
+  return false;
+}
+
+static bool CborDecode(Cursor &cursor, Json::Value &target, int depth);
+
+/**
+ * Reads the chunks of an indefinite length string, which have to be definite strings of the same type.
+ */
+static bool CborChunks(Cursor &cursor, unsigned char major, Json::Value &target) {
+  string result;
+  while (!CborAtBreak(cursor)) {
+    if (cursor.Remaining() == 0 || (*cursor.pos >> 5) != major)
+      return false;
+    uint64_t length = 0;
+    unsigned char info = *cursor.pos++ & 0x1f;
+    if (!CborArgument(cursor, info, length) || length > cursor.Remaining())
+      return false;
+    result.append(reinterpret_cast<const char *>(cursor.pos), static_cast<size_t>(length));
+    cursor.pos += length;
+  }
+  target = Json::Value(result);
+  return true;
+}
+
+static bool CborMapEntry(Cursor &cursor, Json::Value &target, int depth) {
+  Json::Value key;
+  if (!CborDecode(cursor, key, depth + 1) || !key.isString())
+    return false;
+  const char *begin = NULL;
+  const char *end = NULL;
+  key.getString(&begin, &end);
+  return CborDecode(cursor, target[string(begin, end)], depth + 1);
+}
+
+static bool CborDecode(Cursor &cursor, Json::Value &target, int depth) {
+  if (depth > CODEC_MAX_DEPTH || cursor.Remaining() == 0)
+    return false;
+
+  unsigned char major = *cursor.pos >> 5;
+  unsigned char info = *cursor.pos & 0x1f;
+  cursor.pos++;
+  uint64_t value = 0;
+
+  if (major == CBOR_SIMPLE) {
+    switch (info) {
+    case 20:
+    case 21:
+      target = Json::Value(info == 21);
+      return true;
+    case 22:
+    case 23:
+      target = Json::Value(Json::nullValue);
+      return true;
+    case 25:
+      if (!ReadBigEndian(cursor, 2, value))
+        return false;
+      target = Json::Value(CborHalf(static_cast<uint16_t>(value)));
+      return true;
+    case 26: {
+      if (!ReadBigEndian(cursor, 4, value))
+        return false;
+      uint32_t bits = static_cast<uint32_t>(value);
+      float number;
+      memcpy(&number, &bits, sizeof(number));
+      target = Json::Value(static_cast<double>(number));
+      return true;
+    }
+    case 27: {
+      if (!ReadBigEndian(cursor, 8, value))
+        return false;
+      double number;
+      memcpy(&number, &value, sizeof(number));
+      target = Json::Value(number);
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+
+  if (info == CBOR_INDEFINITE) {
+    switch (major) {
+    case CBOR_BYTES:
+    case CBOR_TEXT:
+      return CborChunks(cursor, major, target);
+    case CBOR_ARRAY:
+      target = Json::Value(Json::arrayValue);
+      while (!CborAtBreak(cursor)) {
+        if (!CborDecode(cursor, target[target.size()], depth + 1))
+          return false;
+      }
+      return true;
+    case CBOR_MAP:
+      target = Json::Value(Json::objectValue);
+      while (!CborAtBreak(cursor)) {
+        if (!CborMapEntry(cursor, target, depth))
+          return false;
+      }
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  if (!CborArgument(cursor, info, value))
+    return false;
+
+  switch (major) {
+  case CBOR_UNSIGNED:
+    target = UnsignedValue(value);
+    return true;
+  case CBOR_NEGATIVE:
+    if (value > static_cast<uint64_t>(numeric_limits<Json::LargestInt>::max()))
+      return false;
+    target = Json::Value(-1 - static_cast<Json::LargestInt>(value));
+    return true;
+  case CBOR_BYTES:
+  case CBOR_TEXT:
+    return ReadString(cursor, value, target);
+  case CBOR_ARRAY:
+    if (value > cursor.Remaining())
+      return false;
+    target = Json::Value(Json::arrayValue);
+    if (value > 0)
+      target.resize(static_cast<Json::ArrayIndex>(value));
+    for (Json::ArrayIndex i = 0; i < value; i++) {
+      if (!CborDecode(cursor, target[i], depth + 1))
+        return false;
+    }
+    return true;
+  case CBOR_MAP:
+    if (value > cursor.Remaining() / 2)
+      return false;
+    target = Json::Value(Json::objectValue);
+    for (uint64_t i = 0; i < value; i++) {
+      if (!CborMapEntry(cursor, target, depth))
+        return false;
+    }
+    return true;
+  default:
+    // Tags only add semantics, the tagged item is used as it is.
+    return CborDecode(cursor, target, depth + 1);
+  }
+}
+
+void Codec::Encode(const Json::Value &value, codec_t codec, string &target) {
+  target.clear();
+  switch (codec) {
+  case CODEC_MSGPACK:
+    Pack(value, target);
+    break;
+  case CODEC_CBOR:
+    CborEncode(value, target);
+    break;
+  default: {
+    Json::StreamWriterBuilder wbuilder;
+    wbuilder["indentation"] = "";
+    target = Json::writeString(wbuilder, value);
+    break;
+  }
+  }
+}
+
+bool Codec::Decode(const string &source, codec_t codec, Json::Value &target) {
+  if (codec == CODEC_JSON)
+    return JsonReader::Parse(source, target);
+
+  Cursor cursor;
+  cursor.pos = reinterpret_cast<const unsigned char *>(source.data());
+  cursor.end = cursor.pos + source.size();
+  bool valid = codec == CODEC_MSGPACK ? Unpack(cursor, target, 0) : CborDecode(cursor, target, 0);
+  return valid && cursor.pos == cursor.end;
+}
+
+bool Codec::Transcode(const string &source, codec_t from, codec_t to, string &target) {
+  if (from == to) {
+    target = source;
+    return true;
+  }
+  Json::Value value;
+  if (!Decode(source, from, value))
+    return false;
+  Encode(value, to, target);
+  return true;
+}
+
+const char *Codec::GetContentType(codec_t codec) {
+  switch (codec) {
+  case CODEC_MSGPACK:
+    return "application/msgpack";
+  case CODEC_CBOR:
+    return "application/cbor";
+  default:
+    return "application/json";
+  }
+}
+
+bool Codec::FromContentType(const string &contentType, codec_t &codec) {
+  string type = contentType.substr(0, contentType.find(';'));
+  type.erase(0, type.find_first_not_of(" \t"));
+  type.erase(type.find_last_not_of(" \t") + 1);
+  transform(type.begin(), type.end(), type.begin(), ::tolower);
+
+  if (type == "application/json") {
+    codec = CODEC_JSON;
+  } else if (type == "application/msgpack" || type == "application/x-msgpack" || type == "application/vnd.msgpack") {
+    codec = CODEC_MSGPACK;
+  } else if (type == "application/cbor") {
+    codec = CODEC_CBOR;
+  } else {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,62 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    codec.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_CODEC_H
+#define JSONRPC_CPP_CODEC_H
+
+#include "jsonparser.h"
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Wire encodings of JSON-RPC messages. CODEC_MSGPACK and CODEC_CBOR carry
+   * the same JSON-RPC envelope in binary form. Binary messages may contain
+   * any byte, so stream connectors have to use FRAMING_LENGTH_PREFIX.
+   */
+  typedef enum { CODEC_JSON, CODEC_MSGPACK, CODEC_CBOR } codec_t;
+
+  /**
+   * Converts between Json::Value and the supported wire encodings.
+   *
+   * Binary integers, strings, arrays, maps, booleans, null and floating point
+   * numbers map to their Json::Value counterparts. Byte strings are decoded
+   * as strings, tags are ignored. Maps with keys that are not strings and
+   * MessagePack extension types are rejected.
+   */
+  class Codec {
+  public:
+    static void Encode(const Json::Value &value, codec_t codec, std::string &target);
+
+    /**
+     * @return false if source isn't a single, complete value in the given encoding.
+     */
+    static bool Decode(const std::string &source, codec_t codec, Json::Value &target);
+
+    /**
+     * Re-encodes a message, e.g. for handlers that only understand JSON text.
+     * @return false if source can't be decoded.
+     */
+    static bool Transcode(const std::string &source, codec_t from, codec_t to, std::string &target);
+
+    /**
+     * @return The media type of codec, e.g. "application/msgpack".
+     */
+    static const char *GetContentType(codec_t codec);
+
+    /**
+     * Looks up the codec of a media type, parameters like "; charset=utf-8" are ignored.
+     * @return false if the media type isn't supported.
+     */
+    static bool FromContentType(const std::string &contentType, codec_t &codec);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_CODEC_H
@@ -27,6 +27,8 @@ const int Errors::ERROR_SERVER_PROCEDURE_POINTER_IS_NULL = -32606;
 const int Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND = -32000;
 const int Errors::ERROR_SERVER_CONNECTOR = -32002;
 const int Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX = -32007;
+const int Errors::ERROR_SERVER_OVERLOADED = -32004;
+const int Errors::ERROR_SERVER_DEADLINE_EXCEEDED = -32005;
 
 const int Errors::ERROR_CLIENT_CONNECTOR = -32003;
 const int Errors::ERROR_CLIENT_INVALID_RESPONSE = -32001;
@@ -56,6 +58,8 @@ Errors::_init::_init() {
   possibleErrors[ERROR_CLIENT_INVALID_RESPONSE] = "The response is invalid";
   possibleErrors[ERROR_CLIENT_CONNECTOR] = "Client connector error";
   possibleErrors[ERROR_SERVER_CONNECTOR] = "Server connector error";
+  possibleErrors[ERROR_SERVER_OVERLOADED] = "SERVER_OVERLOADED: The request was rejected, try again later";
+  possibleErrors[ERROR_SERVER_DEADLINE_EXCEEDED] = "DEADLINE_EXCEEDED: The deadline of the request expired before it was invoked";
 }
 
 std::string Errors::GetErrorMessage(int errorCode) {
@@ -48,6 +48,8 @@ namespace jsonrpc {
     static const int ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND;
     static const int ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX;
     static const int ERROR_SERVER_CONNECTOR;
+    static const int ERROR_SERVER_OVERLOADED;
+    static const int ERROR_SERVER_DEADLINE_EXCEEDED;
 
     /**
      * Client Library Errors
@@ -0,0 +1,99 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    jsonconversion.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_JSONCONVERSION_H
+#define JSONRPC_CPP_JSONCONVERSION_H
+
+#include "jsonparser.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jsonrpc {
+
+  /**
+   * Conversions between Json::Value and the C++ types of generated stubs.
+   * FromJson checks the type while it converts and returns false on the
+   * first mismatch. Stubs generate overloads for their structs next to them,
+   * which are found by argument dependent lookup, also for elements of
+   * std::vector.
+   */
+  inline bool FromJson(const Json::Value &value, bool &target) {
+    if (!value.isBool())
+      return false;
+    target = value.asBool();
+    return true;
+  }
+
+  inline bool FromJson(const Json::Value &value, int &target) {
+    if (!value.isInt())
+      return false;
+    target = value.asInt();
+    return true;
+  }
+
+  inline bool FromJson(const Json::Value &value, Json::Int64 &target) {
+    if (!value.isInt64())
+      return false;
+    target = value.asInt64();
+    return true;
+  }
+
+  inline bool FromJson(const Json::Value &value, double &target) {
+    if (!value.isNumeric())
+      return false;
+    target = value.asDouble();
+    return true;
+  }
+
+  inline bool FromJson(const Json::Value &value, std::string &target) {
+    if (!value.isString())
+      return false;
+    target = value.asString();
+    return true;
+  }
+
+  inline bool FromJson(const Json::Value &value, Json::Value &target) {
+    target = value;
+    return true;
+  }
+
+  template <typename T> bool FromJson(const Json::Value &value, std::vector<T> &target) {
+    if (!value.isArray())
+      return false;
+    target.clear();
+    target.reserve(value.size());
+    for (Json::ArrayIndex i = 0; i < value.size(); i++) {
+      // Not converted in place, std::vector<bool> has no references to its elements.
+      T element;
+      if (!FromJson(value[i], element))
+        return false;
+      target.push_back(std::move(element));
+    }
+    return true;
+  }
+
+  inline Json::Value ToJson(bool value) { return Json::Value(value); }
+  inline Json::Value ToJson(int value) { return Json::Value(value); }
+  inline Json::Value ToJson(Json::Int64 value) { return Json::Value(value); }
+  inline Json::Value ToJson(double value) { return Json::Value(value); }
+  inline Json::Value ToJson(const std::string &value) { return Json::Value(value); }
+  inline Json::Value ToJson(const Json::Value &value) { return value; }
+
+  template <typename T> Json::Value ToJson(const std::vector<T> &value) {
+    Json::Value result(Json::arrayValue);
+    result.resize(static_cast<Json::ArrayIndex>(value.size()));
+    for (size_t i = 0; i < value.size(); i++)
+      result[static_cast<Json::ArrayIndex>(i)] = ToJson(static_cast<const T &>(value[i]));
+    return result;
+  }
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_JSONCONVERSION_H
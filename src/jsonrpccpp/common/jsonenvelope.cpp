@@ -0,0 +1,236 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    jsonenvelope.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "jsonenvelope.h"
+#include "jsonreader.h"
+#include <algorithm>
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+  const char *SkipSpace(const char *pos, const char *end) {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+      pos++;
+    return pos;
+  }
+
+  /**
+   * @param pos Points to the opening quote.
+   * @return The position after the closing quote, NULL if there is none.
+   */
+  const char *SkipString(const char *pos, const char *end) {
+    for (pos++; pos < end; pos++) {
+      if (*pos == '\\')
+        pos++;
+      else if (*pos == '"')
+        return pos + 1;
+    }
+    return NULL;
+  }
+
+  /**
+   * @return The position after the value at pos, NULL if it can't be skipped.
+   */
+  const char *SkipValue(const char *pos, const char *end) {
+    if (*pos == '"')
+      return SkipString(pos, end);
+
+    if (*pos == '{' || *pos == '[') {
+      size_t depth = 0;
+      while (pos < end) {
+        switch (*pos) {
+        case '"':
+          pos = SkipString(pos, end);
+          if (pos == NULL)
+            return NULL;
+          continue;
+        case '{':
+        case '[':
+          depth++;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0)
+            return pos + 1;
+          break;
+        case '/':
+          // Comments may hide quotes and brackets.
+          return NULL;
+        }
+        pos++;
+      }
+      return NULL;
+    }
+
+    const char *start = pos;
+    while (pos < end && *pos != ',' && *pos != '}' && *pos != ']' && *pos != ' ' && *pos != '\t' && *pos != '\n' && *pos != '\r' && *pos != '/')
+      pos++;
+    return pos != start ? pos : NULL;
+  }
+
+  /**
+   * Skips the object at pos, parsing only its member name into target.
+   * @return The position after the object, NULL if it can't be scanned.
+   */
+  const char *ScanMember(const char *pos, const char *end, const string &name, Json::Value &target) {
+    target = Json::nullValue;
+    pos = SkipSpace(pos + 1, end);
+    if (pos < end && *pos == '}')
+      return pos + 1;
+
+    while (pos < end) {
+      if (*pos != '"')
+        return NULL;
+      const char *keyEnd = SkipString(pos, end);
+      if (keyEnd == NULL)
+        return NULL;
+      // Escaped keys would have to be decoded first, leave them to JsonReader.
+      if (find(pos + 1, keyEnd - 1, '\\') != keyEnd - 1)
+        return NULL;
+      bool wanted = name.compare(0, string::npos, pos + 1, keyEnd - pos - 2) == 0;
+
+      pos = SkipSpace(keyEnd, end);
+      if (pos == end || *pos != ':')
+        return NULL;
+      pos = SkipSpace(pos + 1, end);
+      if (pos == end)
+        return NULL;
+      const char *valueEnd = SkipValue(pos, end);
+      if (valueEnd == NULL)
+        return NULL;
+      if (wanted && !JsonReader::Parse(pos, valueEnd - pos, target))
+        return NULL;
+
+      pos = SkipSpace(valueEnd, end);
+      if (pos == end)
+        return NULL;
+      if (*pos == '}')
+        return pos + 1;
+      if (*pos != ',')
+        return NULL;
+      pos = SkipSpace(pos + 1, end);
+    }
+    return NULL;
+  }
+} // namespace
+
+JsonEnvelope::JsonEnvelope() : deferred(NULL), length(0) {}
+
+bool JsonEnvelope::Parse(const string &text, const string &deferred) {
+  this->members = Json::Value(Json::objectValue);
+  this->deferred = NULL;
+  this->length = 0;
+
+  // Keys are taken as they are, so check the encoding of everything once.
+  if (!JsonReader::IsValidUtf8(text.data(), text.size()))
+    return false;
+
+  const char *end = text.data() + text.size();
+  const char *pos = SkipSpace(text.data(), end);
+  if (pos == end || *pos != '{')
+    return false;
+  pos = SkipSpace(pos + 1, end);
+  if (pos < end && *pos == '}')
+    return true;
+
+  while (pos < end) {
+    if (*pos != '"')
+      return false;
+    const char *keyEnd = SkipString(pos, end);
+    if (keyEnd == NULL)
+      return false;
+    string key(pos + 1, keyEnd - 1);
+    if (key.find('\\') != string::npos) {
+      Json::Value unescaped;
+      if (!JsonReader::Parse(pos, keyEnd - pos, unescaped))
+        return false;
+      key = unescaped.asString();
+    }
+
+    pos = SkipSpace(keyEnd, end);
+    if (pos == end || *pos != ':')
+      return false;
+    pos = SkipSpace(pos + 1, end);
+    if (pos == end)
+      return false;
+    const char *valueEnd = SkipValue(pos, end);
+    if (valueEnd == NULL)
+      return false;
+
+    // Only objects and arrays are worth deferring. Later duplicates win, like in jsoncpp.
+    if (key == deferred && (*pos == '{' || *pos == '[')) {
+      this->members.removeMember(key);
+      this->deferred = pos;
+      this->length = valueEnd - pos;
+    } else {
+      if (key == deferred)
+        this->deferred = NULL;
+      if (!JsonReader::Parse(pos, valueEnd - pos, this->members[key]))
+        return false;
+    }
+
+    pos = SkipSpace(valueEnd, end);
+    if (pos == end)
+      return false;
+    if (*pos == '}')
+      return true;
+    if (*pos != ',')
+      return false;
+    pos = SkipSpace(pos + 1, end);
+  }
+  return false;
+}
+
+Json::Value &JsonEnvelope::GetMembers() { return this->members; }
+
+bool JsonEnvelope::HasDeferred() const { return this->deferred != NULL; }
+
+Json::Value JsonEnvelope::GetDeferredPlaceholder() const {
+  if (this->deferred == NULL)
+    return Json::nullValue;
+  return Json::Value(*this->deferred == '{' ? Json::objectValue : Json::arrayValue);
+}
+
+bool JsonEnvelope::ParseDeferred(Json::Value &target) const {
+  if (this->deferred == NULL)
+    return false;
+  return JsonReader::Parse(this->deferred, this->length, target);
+}
+
+bool JsonEnvelope::ParseMember(const string &text, const string &name, Json::Value &target) {
+  const char *end = text.data() + text.size();
+  const char *pos = SkipSpace(text.data(), end);
+  if (pos < end && *pos == '{') {
+    pos = ScanMember(pos, end, name, target);
+    return pos != NULL && SkipSpace(pos, end) == end;
+  }
+  if (pos == end || *pos != '[')
+    return false;
+
+  target = Json::nullValue;
+  pos = SkipSpace(pos + 1, end);
+  if (pos < end && *pos == ']')
+    return SkipSpace(pos + 1, end) == end;
+  while (pos < end && *pos == '{') {
+    Json::Value member;
+    pos = ScanMember(pos, end, name, member);
+    if (pos == NULL)
+      return false;
+    if (!member.isNull())
+      target.append(member);
+    pos = SkipSpace(pos, end);
+    if (pos < end && *pos == ']')
+      return SkipSpace(pos + 1, end) == end;
+    if (pos == end || *pos != ',')
+      return false;
+    pos = SkipSpace(pos + 1, end);
+  }
+  return false;
+}
@@ -0,0 +1,73 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    jsonenvelope.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_JSONENVELOPE_H
+#define JSONRPC_CPP_JSONENVELOPE_H
+
+#include "jsonparser.h"
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Parses the top-level members of a JSON object except one, which is only
+   * located and parsed on demand if it is an object or array. Used to look
+   * at the envelope of a request (jsonrpc, method, id, ...) without paying
+   * for a large params member.
+   *
+   * The deferred member is skipped by matching brackets and quotes only, it
+   * is fully checked once it is parsed. Anything the scanner isn't sure
+   * about, e.g. batches or comments, makes Parse fail, so callers can fall
+   * back to JsonReader.
+   */
+  class JsonEnvelope {
+  public:
+    JsonEnvelope();
+
+    /**
+     * @param text Has to outlive the envelope, the deferred member points into it.
+     * @return false if text isn't a single object or can't be scanned.
+     */
+    bool Parse(const std::string &text, const std::string &deferred);
+
+    /**
+     * @return All parsed members, without a deferred one.
+     */
+    Json::Value &GetMembers();
+
+    bool HasDeferred() const;
+
+    /**
+     * @return An empty object or array like the deferred member, to validate
+     * the envelope before it is parsed.
+     */
+    Json::Value GetDeferredPlaceholder() const;
+
+    /**
+     * @return false if the deferred member isn't valid JSON.
+     */
+    bool ParseDeferred(Json::Value &target) const;
+
+    /**
+     * Parses only the member name of the object in text, all others are
+     * skipped like a deferred member. For a batch, target becomes an array
+     * of the member of every object in it that has one.
+     * @return false if text can't be scanned, target is null if the member is missing.
+     */
+    static bool ParseMember(const std::string &text, const std::string &name, Json::Value &target);
+
+  private:
+    Json::Value members;
+    const char *deferred;
+    size_t length;
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_JSONENVELOPE_H
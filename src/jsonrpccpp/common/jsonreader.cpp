@@ -0,0 +1,154 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    jsonreader.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "jsonreader.h"
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+
+#ifdef JSONRPC_WITH_SIMDJSON
+#include <simdjson.h>
+#endif
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+  bool ParseJsoncpp(const char *text, size_t length, Json::Value &target) {
+    // CharReaders aren't reentrant, but cheap to keep around per thread.
+    static thread_local unique_ptr<Json::CharReader> reader;
+    if (!reader) {
+      Json::CharReaderBuilder builder;
+      reader.reset(builder.newCharReader());
+    }
+    return reader->parse(text, text + length, &target, NULL);
+  }
+} // namespace
+
+#ifdef JSONRPC_WITH_SIMDJSON
+
+namespace {
+  void Convert(simdjson::dom::element element, Json::Value &target) {
+    switch (element.type()) {
+    case simdjson::dom::element_type::OBJECT:
+      target = Json::Value(Json::objectValue);
+      for (simdjson::dom::key_value_pair field : simdjson::dom::object(element))
+        Convert(field.value, target[string(field.key)]);
+      break;
+    case simdjson::dom::element_type::ARRAY:
+      target = Json::Value(Json::arrayValue);
+      for (simdjson::dom::element value : simdjson::dom::array(element))
+        Convert(value, target.append(Json::Value()));
+      break;
+    case simdjson::dom::element_type::INT64:
+      target = Json::Value(static_cast<Json::Int64>(int64_t(element)));
+      break;
+    case simdjson::dom::element_type::UINT64:
+      target = Json::Value(static_cast<Json::UInt64>(uint64_t(element)));
+      break;
+    case simdjson::dom::element_type::DOUBLE:
+      target = double(element);
+      break;
+    case simdjson::dom::element_type::STRING: {
+      std::string_view text(element);
+      target = Json::Value(text.data(), text.data() + text.size());
+      break;
+    }
+    case simdjson::dom::element_type::BOOL:
+      target = bool(element);
+      break;
+    default:
+      target = Json::nullValue;
+      break;
+    }
+  }
+} // namespace
+
+bool JsonReader::Parse(const char *text, size_t length, Json::Value &target) {
+  // The parser keeps its buffers between calls, SIMD kernels are picked at runtime.
+  static thread_local simdjson::dom::parser parser;
+  simdjson::dom::element root;
+  if (!parser.parse(text, length).get(root)) {
+    Convert(root, target);
+    return true;
+  }
+
+  // Malformed documents and comments are left to jsoncpp, so both backends
+  // accept the same input and leave the same partial value in target, e.g.
+  // RpcProtocolServer12 picks the protocol version of its error from it.
+  return IsValidUtf8(text, length) && ParseJsoncpp(text, length, target);
+}
+
+bool JsonReader::IsValidUtf8(const char *text, size_t length) { return simdjson::validate_utf8(text, length); }
+
+const char *JsonReader::GetBackend() { return "simdjson"; }
+
+#else
+
+bool JsonReader::Parse(const char *text, size_t length, Json::Value &target) { return IsValidUtf8(text, length) && ParseJsoncpp(text, length, target); }
+
+bool JsonReader::IsValidUtf8(const char *text, size_t length) {
+  const unsigned char *pos = reinterpret_cast<const unsigned char *>(text);
+  const unsigned char *end = pos + length;
+
+  while (pos < end) {
+    // Skip ASCII a word at a time, it makes up most of a JSON-RPC message.
+    while (end - pos >= 8) {
+      uint64_t word;
+      memcpy(&word, pos, sizeof(word));
+      if (word & 0x8080808080808080ULL)
+        break;
+      pos += 8;
+    }
+    if (pos == end)
+      break;
+
+    unsigned char lead = *pos;
+    if (lead < 0x80) {
+      pos++;
+      continue;
+    }
+
+    // Valid ranges of the second byte depend on the lead byte (RFC 3629, section 4).
+    size_t size;
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      size = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      size = 3;
+      if (lead == 0xE0)
+        low = 0xA0;
+      else if (lead == 0xED)
+        high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      size = 4;
+      if (lead == 0xF0)
+        low = 0x90;
+      else if (lead == 0xF4)
+        high = 0x8F;
+    } else {
+      return false;
+    }
+
+    if (static_cast<size_t>(end - pos) < size || pos[1] < low || pos[1] > high)
+      return false;
+    for (size_t i = 2; i < size; i++) {
+      if ((pos[i] & 0xC0) != 0x80)
+        return false;
+    }
+    pos += size;
+  }
+  return true;
+}
+
+const char *JsonReader::GetBackend() { return "jsoncpp"; }
+
+#endif
+
+bool JsonReader::Parse(const string &text, Json::Value &target) { return JsonReader::Parse(text.data(), text.size(), target); }
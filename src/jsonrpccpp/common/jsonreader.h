@@ -0,0 +1,53 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    jsonreader.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_JSONREADER_H
+#define JSONRPC_CPP_JSONREADER_H
+
+#include "jsonparser.h"
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Parses JSON text into a Json::Value. This is the single entry point used
+   * for requests and responses, so the parser can be chosen at build time:
+   *
+   * - jsoncpp (default) parses from the buffer directly instead of going
+   *   through an istream.
+   * - simdjson (cmake -DWITH_SIMDJSON=YES) validates and indexes the text with
+   *   SIMD kernels picked at runtime and builds the Json::Value from that.
+   *   Documents it can't handle, i.e. malformed ones or those with comments,
+   *   are passed on to jsoncpp, so both backends accept the same input.
+   *
+   * Both backends reject text that isn't valid UTF-8.
+   */
+  class JsonReader {
+  public:
+    /**
+     * @return false if text isn't a valid JSON document, target is undefined in that case.
+     */
+    static bool Parse(const std::string &text, Json::Value &target);
+    static bool Parse(const char *text, size_t length, Json::Value &target);
+
+    /**
+     * Checks for well formed UTF-8 as defined by RFC 3629: no overlong
+     * sequences, no surrogates and nothing beyond U+10FFFF.
+     */
+    static bool IsValidUtf8(const char *text, size_t length);
+
+    /**
+     * @return "simdjson" or "jsoncpp".
+     */
+    static const char *GetBackend();
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_JSONREADER_H
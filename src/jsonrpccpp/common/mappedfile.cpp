@@ -0,0 +1,69 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    mappedfile.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "mappedfile.h"
+#include "exception.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace jsonrpc;
+using namespace std;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const string &filename) : data(NULL), size(0) {
+  ifstream file(filename.c_str(), ios::in | ios::binary);
+  if (!file)
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND, filename);
+  stringstream buffer;
+  buffer << file.rdbuf();
+  this->content = buffer.str();
+  this->data = this->content.data();
+  this->size = this->content.size();
+}
+
+MappedFile::~MappedFile() {}
+#else
+MappedFile::MappedFile(const string &filename) : data(NULL), size(0) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    if (fd >= 0)
+      close(fd);
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND, filename);
+  }
+  this->size = static_cast<size_t>(info.st_size);
+  // Empty files cannot be mapped.
+  if (this->size > 0) {
+    void *mapped = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND, filename);
+    }
+    this->data = static_cast<const char *>(mapped);
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (this->data != NULL)
+    munmap(const_cast<char *>(this->data), this->size);
+}
+#endif
+
+const char *MappedFile::GetData() const { return this->data != NULL ? this->data : ""; }
+
+size_t MappedFile::GetSize() const { return this->size; }
@@ -0,0 +1,44 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    mappedfile.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_MAPPEDFILE_H
+#define JSONRPC_CPP_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Read-only view of a whole file, memory-mapped where supported and read
+   * into memory otherwise. The data is valid as long as the object lives.
+   */
+  class MappedFile {
+  public:
+    /**
+     * @throws JsonRpcException with ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND if the file cannot be opened.
+     */
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    const char *GetData() const;
+    size_t GetSize() const;
+
+  private:
+    const char *data;
+    size_t size;
+    std::string content;
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_MAPPEDFILE_H
@@ -0,0 +1,131 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    parameterwriter.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "parameterwriter.h"
+#include "jsonreader.h"
+#include <cstring>
+
+using namespace jsonrpc;
+using namespace std;
+
+ParameterWriter::ParameterWriter(parameterDeclaration_t type) : type(type) {}
+
+void ParameterWriter::Add(const char *name, int value) {
+  this->BeginParameter(name);
+  this->text += Json::valueToString(static_cast<Json::Int>(value));
+}
+
+void ParameterWriter::Add(const char *name, Json::Int64 value) {
+  this->BeginParameter(name);
+  this->text += Json::valueToString(static_cast<Json::LargestInt>(value));
+}
+
+void ParameterWriter::Add(const char *name, Json::UInt64 value) {
+  this->BeginParameter(name);
+  this->text += Json::valueToString(static_cast<Json::LargestUInt>(value));
+}
+
+void ParameterWriter::Add(const char *name, double value) {
+  this->BeginParameter(name);
+  // Same precision as the Json::StreamWriter used for Json::Value params.
+  this->text += Json::valueToString(value);
+}
+
+void ParameterWriter::Add(const char *name, bool value) {
+  this->BeginParameter(name);
+  this->text += value ? "true" : "false";
+}
+
+void ParameterWriter::Add(const char *name, const char *value) {
+  this->BeginParameter(name);
+  WriteString(value, strlen(value), this->text);
+}
+
+void ParameterWriter::Add(const char *name, const string &value) {
+  this->BeginParameter(name);
+  WriteString(value.data(), value.size(), this->text);
+}
+
+void ParameterWriter::Add(const char *name, const Json::Value &value) {
+  this->BeginParameter(name);
+  Json::StreamWriterBuilder wbuilder;
+  wbuilder["indentation"] = "";
+  this->text += Json::writeString(wbuilder, value);
+}
+
+bool ParameterWriter::IsEmpty() const { return this->text.empty(); }
+
+string ParameterWriter::GetText() const {
+  if (this->text.empty())
+    return this->text;
+  return this->text + (this->type == PARAMS_BY_NAME ? '}' : ']');
+}
+
+Json::Value ParameterWriter::ToValue() const {
+  Json::Value result;
+  if (!this->text.empty())
+    JsonReader::Parse(this->GetText(), result);
+  return result;
+}
+
+void ParameterWriter::WriteString(const char *text, size_t length, string &out) {
+  static const char hex[] = "0123456789abcdef";
+  out += '"';
+  const char *start = text;
+  const char *end = text + length;
+  for (const char *pos = text; pos < end; pos++) {
+    unsigned char c = static_cast<unsigned char>(*pos);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    // Copy unescaped runs at once, UTF-8 sequences are passed on as they are.
+    out.append(start, pos);
+    start = pos + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += hex[c >> 4];
+      out += hex[c & 0xF];
+      break;
+    }
+  }
+  out.append(start, end);
+  out += '"';
+}
+
+void ParameterWriter::BeginParameter(const char *name) {
+  if (this->text.empty())
+    this->text += this->type == PARAMS_BY_NAME ? '{' : '[';
+  else
+    this->text += ',';
+  if (this->type == PARAMS_BY_NAME) {
+    WriteString(name, strlen(name), this->text);
+    this->text += ':';
+  }
+}
@@ -0,0 +1,74 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    parameterwriter.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_PARAMETERWRITER_H
+#define JSONRPC_CPP_PARAMETERWRITER_H
+
+#include "jsonparser.h"
+#include "procedure.h"
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Writes the params of a request as JSON text directly from native values,
+   * without building a Json::Value first. Used by client stubs generated
+   * with jsonrpcstub --cpp-client-direct, see Client::CallMethod. It only
+   * covers writing params on the client, servers read them from the parsed
+   * request and return results through Json::Value.
+   */
+  class ParameterWriter {
+  public:
+    /**
+     * @param type PARAMS_BY_NAME writes an object, PARAMS_BY_POSITION an array.
+     */
+    explicit ParameterWriter(parameterDeclaration_t type);
+
+    /**
+     * Appends a parameter, name is ignored for PARAMS_BY_POSITION.
+     */
+    void Add(const char *name, int value);
+    void Add(const char *name, Json::Int64 value);
+    void Add(const char *name, Json::UInt64 value);
+    void Add(const char *name, double value);
+    void Add(const char *name, bool value);
+    void Add(const char *name, const char *value);
+    void Add(const char *name, const std::string &value);
+    void Add(const char *name, const Json::Value &value);
+
+    /**
+     * @return true if no parameter has been added, the request has no params then.
+     */
+    bool IsEmpty() const;
+
+    /**
+     * @return The params as JSON text, empty if no parameter has been added.
+     */
+    std::string GetText() const;
+
+    /**
+     * @return The params parsed back into a Json::Value, for encodings other than JSON.
+     */
+    Json::Value ToValue() const;
+
+    /**
+     * Appends text as quoted and escaped JSON string to out.
+     */
+    static void WriteString(const char *text, size_t length, std::string &out);
+
+  private:
+    parameterDeclaration_t type;
+    std::string text;
+
+    void BeginParameter(const char *name);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_PARAMETERWRITER_H
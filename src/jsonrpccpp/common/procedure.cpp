@@ -16,9 +16,12 @@
 using namespace std;
 using namespace jsonrpc;
 
-Procedure::Procedure() : procedureName(""), procedureType(RPC_METHOD), returntype(JSON_BOOLEAN), paramDeclaration(PARAMS_BY_NAME) {}
+Procedure::Procedure()
+    : procedureName(""), descriptorParameters(NULL), descriptorCount(0), parametersBuilt(false), procedureType(RPC_METHOD), returntype(JSON_BOOLEAN),
+      paramDeclaration(PARAMS_BY_NAME), dispatchId(-1) {}
 
-Procedure::Procedure(const string &name, parameterDeclaration_t paramType, jsontype_t returntype, ...) {
+Procedure::Procedure(const string &name, parameterDeclaration_t paramType, jsontype_t returntype, ...)
+    : descriptorParameters(NULL), descriptorCount(0), parametersBuilt(false), dispatchId(-1) {
   va_list parameters;
   va_start(parameters, returntype);
   const char *paramname = va_arg(parameters, const char *);
@@ -34,7 +37,8 @@ Procedure::Procedure(const string &name, parameterDeclaration_t paramType, jsont
   this->procedureType = RPC_METHOD;
   this->paramDeclaration = paramType;
 }
-Procedure::Procedure(const string &name, parameterDeclaration_t paramType, ...) {
+Procedure::Procedure(const string &name, parameterDeclaration_t paramType, ...)
+    : descriptorParameters(NULL), descriptorCount(0), parametersBuilt(false), dispatchId(-1) {
   va_list parameters;
   va_start(parameters, paramType);
   const char *paramname = va_arg(parameters, const char *);
@@ -51,8 +55,57 @@ Procedure::Procedure(const string &name, parameterDeclaration_t paramType, ...)
   this->returntype = JSON_BOOLEAN;
 }
 
+Procedure::Procedure(const ProcedureDescriptor &descriptor)
+    : procedureName(descriptor.name), descriptorParameters(NULL), descriptorCount(0), parametersBuilt(false), procedureType(descriptor.type), returntype(descriptor.returntype),
+      paramDeclaration(descriptor.declaration), dispatchId(-1) {
+  if (descriptor.count > 0) {
+    this->descriptorParameters = descriptor.parameters;
+    this->descriptorCount = descriptor.count;
+  }
+}
+
+Procedure::Procedure(const Procedure &other)
+    : procedureName(other.procedureName), descriptorParameters(other.descriptorParameters), descriptorCount(other.descriptorCount), parametersBuilt(false),
+      returnSchema(other.returnSchema), procedureType(other.procedureType), returntype(other.returntype), paramDeclaration(other.paramDeclaration),
+      dispatchId(other.dispatchId) {
+  // Unless they are complete, the copy builds its own containers.
+  if (other.descriptorParameters == NULL || other.parametersBuilt.load(std::memory_order_acquire)) {
+    this->parametersName = other.parametersName;
+    this->parametersPosition = other.parametersPosition;
+    this->namesPosition = other.namesPosition;
+    this->schemasName = other.schemasName;
+    this->schemasPosition = other.schemasPosition;
+    this->parametersBuilt = other.parametersBuilt.load(std::memory_order_relaxed);
+  }
+}
+
+Procedure &Procedure::operator=(const Procedure &other) {
+  if (this == &other)
+    return *this;
+  // Registering a descriptor procedure assigns it, which keeps it lazy as
+  // long as the once flag of this procedure hasn't been spent.
+  bool lazy = other.descriptorParameters != NULL && !other.parametersBuilt.load(std::memory_order_acquire) && !this->parametersBuilt;
+  if (!lazy)
+    other.BuildParameters();
+  this->procedureName = other.procedureName;
+  this->parametersName = lazy ? parameterNameList_t() : other.parametersName;
+  this->parametersPosition = lazy ? parameterPositionList_t() : other.parametersPosition;
+  this->namesPosition = lazy ? vector<string>() : other.namesPosition;
+  this->descriptorParameters = other.descriptorParameters;
+  this->descriptorCount = other.descriptorCount;
+  this->parametersBuilt = !lazy;
+  this->schemasName = lazy ? map<string, TypeSchema>() : other.schemasName;
+  this->schemasPosition = lazy ? vector<TypeSchema>() : other.schemasPosition;
+  this->returnSchema = other.returnSchema;
+  this->procedureType = other.procedureType;
+  this->returntype = other.returntype;
+  this->paramDeclaration = other.paramDeclaration;
+  this->dispatchId = other.dispatchId;
+  return *this;
+}
+
 bool Procedure::ValdiateParameters(const Json::Value &parameters) const {
-  if (this->parametersName.empty()) {
+  if (this->descriptorParameters == NULL && this->parametersName.empty()) {
     return true;
   }
   if (parameters.isArray() && this->paramDeclaration == PARAMS_BY_POSITION) {
@@ -63,28 +116,98 @@ bool Procedure::ValdiateParameters(const Json::Value &parameters) const {
     return false;
   }
 }
-const parameterNameList_t &Procedure::GetParameters() const { return this->parametersName; }
+const parameterNameList_t &Procedure::GetParameters() const {
+  this->BuildParameters();
+  return this->parametersName;
+}
+const vector<string> &Procedure::GetParameterNames() const {
+  this->BuildParameters();
+  return this->namesPosition;
+}
 procedure_t Procedure::GetProcedureType() const { return this->procedureType; }
 const std::string &Procedure::GetProcedureName() const { return this->procedureName; }
 parameterDeclaration_t Procedure::GetParameterDeclarationType() const { return this->paramDeclaration; }
 jsontype_t Procedure::GetReturnType() const { return this->returntype; }
+int Procedure::GetDispatchId() const { return this->dispatchId; }
 
 void Procedure::SetProcedureName(const string &name) { this->procedureName = name; }
 void Procedure::SetProcedureType(procedure_t type) { this->procedureType = type; }
 void Procedure::SetReturnType(jsontype_t type) { this->returntype = type; }
 void Procedure::SetParameterDeclarationType(parameterDeclaration_t type) { this->paramDeclaration = type; }
+void Procedure::SetDispatchId(int id) { this->dispatchId = id; }
+
+void Procedure::AddParameter(const string &name, jsontype_t type) { this->AddParameter(name, TypeSchema(type)); }
+
+void Procedure::AddParameter(const string &name, const TypeSchema &type) {
+  this->BuildParameters();
+  this->descriptorParameters = NULL;
+  this->descriptorCount = 0;
+  this->AppendParameter(name, type);
+}
+
+void Procedure::BuildParameters() const {
+  if (this->descriptorParameters == NULL || this->parametersBuilt.load(std::memory_order_acquire))
+    return;
+  std::call_once(this->parametersOnce, [this] {
+    for (size_t i = 0; i < this->descriptorCount; i++) {
+      const ParameterDescriptor &parameter = this->descriptorParameters[i];
+      this->AppendParameter(parameter.name, parameter.schema != NULL ? *parameter.schema : TypeSchema(parameter.type));
+    }
+    this->parametersBuilt.store(true, std::memory_order_release);
+  });
+}
+
+void Procedure::AppendParameter(const string &name, const TypeSchema &type) const {
+  if (!type.IsNested()) {
+    this->parametersName[name] = type.GetType();
+    this->parametersPosition.push_back(type.GetType());
+    this->namesPosition.push_back(name);
+    if (!this->schemasPosition.empty())
+      this->schemasPosition.push_back(type);
+    return;
+  }
+  // Earlier parameters get their plain schema, so positions line up.
+  if (this->schemasPosition.empty()) {
+    for (size_t i = 0; i < this->parametersPosition.size(); i++)
+      this->schemasPosition.push_back(TypeSchema(this->parametersPosition[i]));
+  }
+  this->parametersName[name] = type.GetType();
+  this->parametersPosition.push_back(type.GetType());
+  this->namesPosition.push_back(name);
+  this->schemasName[name] = type;
+  this->schemasPosition.push_back(type);
+}
 
-void Procedure::AddParameter(const string &name, jsontype_t type) {
-  this->parametersName[name] = type;
-  this->parametersPosition.push_back(type);
+const TypeSchema &Procedure::GetParameterSchema(const string &name) const {
+  static const TypeSchema undefined;
+  this->BuildParameters();
+  map<string, TypeSchema>::const_iterator it = this->schemasName.find(name);
+  return it != this->schemasName.end() ? it->second : undefined;
 }
+
+void Procedure::SetReturnSchema(const TypeSchema &type) {
+  this->returntype = type.GetType();
+  this->returnSchema = type;
+}
+
+const TypeSchema &Procedure::GetReturnSchema() const { return this->returnSchema; }
 bool Procedure::ValidateNamedParameters(const Json::Value &parameters) const {
   bool ok = parameters.isObject() || parameters.isNull();
+  for (size_t i = 0; ok == true && i < this->descriptorCount; i++) {
+    const ParameterDescriptor &parameter = this->descriptorParameters[i];
+    ok = parameters.isMember(parameter.name) && this->ValidateDescriptorParameter(parameter, parameters[parameter.name]);
+  }
+  if (this->descriptorParameters != NULL)
+    return ok;
   for (map<string, jsontype_t>::const_iterator it = this->parametersName.begin(); ok == true && it != this->parametersName.end(); ++it) {
     if (!parameters.isMember(it->first)) {
       ok = false;
     } else {
-      ok = this->ValidateSingleParameter(it->second, parameters[it->first]);
+      map<string, TypeSchema>::const_iterator schema = this->schemasName.find(it->first);
+      if (schema != this->schemasName.end())
+        ok = schema->second.Validate(parameters[it->first]);
+      else
+        ok = this->ValidateSingleParameter(it->second, parameters[it->first]);
     }
   }
   return ok;
@@ -92,46 +215,29 @@ bool Procedure::ValidateNamedParameters(const Json::Value &parameters) const {
 bool Procedure::ValidatePositionalParameters(const Json::Value &parameters) const {
   bool ok = true;
 
+  if (this->descriptorParameters != NULL) {
+    if (parameters.size() != this->descriptorCount)
+      return false;
+    for (Json::ArrayIndex i = 0; ok && i < this->descriptorCount; i++)
+      ok = this->ValidateDescriptorParameter(this->descriptorParameters[i], parameters[i]);
+    return ok;
+  }
+
   if (parameters.size() != this->parametersPosition.size()) {
     return false;
   }
 
   for (unsigned int i = 0; ok && i < this->parametersPosition.size(); i++) {
-    ok = this->ValidateSingleParameter(this->parametersPosition.at(i), parameters[i]);
+    if (!this->schemasPosition.empty())
+      ok = this->schemasPosition.at(i).Validate(parameters[i]);
+    else
+      ok = this->ValidateSingleParameter(this->parametersPosition.at(i), parameters[i]);
   }
   return ok;
 }
-bool Procedure::ValidateSingleParameter(jsontype_t expectedType, const Json::Value &value) const {
-  bool ok = true;
-  switch (expectedType) {
-  case JSON_STRING:
-    if (!value.isString())
-      ok = false;
-    break;
-  case JSON_BOOLEAN:
-    if (!value.isBool())
-      ok = false;
-    break;
-  case JSON_INTEGER:
-    if (!value.isIntegral())
-      ok = false;
-    break;
-  case JSON_REAL:
-    if (!value.isDouble())
-      ok = false;
-    break;
-  case JSON_NUMERIC:
-    if (!value.isNumeric())
-      ok = false;
-    break;
-  case JSON_OBJECT:
-    if (!value.isObject())
-      ok = false;
-    break;
-  case JSON_ARRAY:
-    if (!value.isArray())
-      ok = false;
-    break;
-  }
-  return ok;
+bool Procedure::ValidateSingleParameter(jsontype_t expectedType, const Json::Value &value) const { return TypeSchema::ValidateType(expectedType, value); }
+bool Procedure::ValidateDescriptorParameter(const ParameterDescriptor &parameter, const Json::Value &value) const {
+  if (parameter.schema != NULL)
+    return parameter.schema->Validate(value);
+  return this->ValidateSingleParameter(parameter.type, value);
 }
@@ -10,11 +10,14 @@
 #ifndef JSONRPC_CPP_PROCEDURE_H_
 #define JSONRPC_CPP_PROCEDURE_H_
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "jsonparser.h"
 #include "specification.h"
+#include "typeschema.h"
 
 namespace jsonrpc {
   typedef std::map<std::string, jsontype_t> parameterNameList_t;
@@ -22,6 +25,30 @@ namespace jsonrpc {
 
   typedef enum { PARAMS_BY_NAME, PARAMS_BY_POSITION } parameterDeclaration_t;
 
+  struct ParameterDescriptor {
+    const char *name;
+    jsontype_t type;
+    /**
+     * Nested schema the value is checked against instead of type, NULL if type is enough.
+     */
+    const TypeSchema *schema;
+  };
+
+  /**
+   * Plain description of a procedure, which can be kept in constexpr tables,
+   * like the ones generated by jsonrpcstub --cpp-server-tables.
+   * Procedures created from it validate straight from its parameters, so
+   * the parameters and their schemas have to outlive them.
+   */
+  struct ProcedureDescriptor {
+    const char *name;
+    procedure_t type;
+    parameterDeclaration_t declaration;
+    jsontype_t returntype;
+    const ParameterDescriptor *parameters;
+    size_t count;
+  };
+
   class Procedure {
   public:
     Procedure();
@@ -41,28 +68,49 @@ namespace jsonrpc {
      */
     Procedure(const std::string &name, parameterDeclaration_t paramType, jsontype_t returntype, ...);
 
+    /**
+     * @brief Constructor validating parameters straight from the parameters of descriptor.
+     * The parameter maps are only built on the first call of a getter needing them.
+     */
+    explicit Procedure(const ProcedureDescriptor &descriptor);
+
+    Procedure(const Procedure &other);
+    Procedure &operator=(const Procedure &other);
+
     /**
      * This method is validating the incoming parameters for each procedure.
      * @param parameters - should contain the parameter-object of an valid json-rpc 2.0 request
      * @see http://groups.google.com/group/json-rpc/web/json-rpc-2-0
      * @return true on successful validation false otherwise.
      *
-     * If the valid parameters are of Type JSON_ARRAY or JSON_OBJECT, they can only be checked for name and not for their structure.
+     * If the valid parameters are of Type JSON_ARRAY or JSON_OBJECT, they can only be checked for name and not for their structure,
+     * unless they have been added with a nested TypeSchema.
      */
     bool ValdiateParameters(const Json::Value &parameters) const;
 
     // Various get methods.
     const parameterNameList_t &GetParameters() const;
+
+    /**
+     * @return The parameter names in the order they have been added, which is their position for PARAMS_BY_POSITION.
+     */
+    const std::vector<std::string> &GetParameterNames() const;
     procedure_t GetProcedureType() const;
     const std::string &GetProcedureName() const;
     jsontype_t GetReturnType() const;
     parameterDeclaration_t GetParameterDeclarationType() const;
 
+    /**
+     * @return The id a server dispatches calls of this procedure by, -1 if it has none.
+     */
+    int GetDispatchId() const;
+
     // Various set methods.
     void SetProcedureName(const std::string &name);
     void SetProcedureType(procedure_t type);
     void SetReturnType(jsontype_t type);
     void SetParameterDeclarationType(parameterDeclaration_t type);
+    void SetDispatchId(int id);
 
     /**
      * @brief AddParameter
@@ -71,6 +119,23 @@ namespace jsonrpc {
      */
     void AddParameter(const std::string &name, jsontype_t type);
 
+    /**
+     * @brief Adds a parameter whose value is checked against type, including nested structs and arrays.
+     */
+    void AddParameter(const std::string &name, const TypeSchema &type);
+
+    /**
+     * @return The schema a parameter has been added with, an undefined one if it only has a jsontype_t.
+     */
+    const TypeSchema &GetParameterSchema(const std::string &name) const;
+
+    void SetReturnSchema(const TypeSchema &type);
+
+    /**
+     * @return The schema of the result, an undefined one if it only has a jsontype_t.
+     */
+    const TypeSchema &GetReturnSchema() const;
+
     bool ValidateNamedParameters(const Json::Value &parameters) const;
     bool ValidatePositionalParameters(const Json::Value &parameters) const;
 
@@ -84,12 +149,39 @@ namespace jsonrpc {
      * This map represents all necessary Parameters of each Procedure.
      * The string represents the name of each parameter and JsonType the type it should have.
      */
-    parameterNameList_t parametersName;
+    mutable parameterNameList_t parametersName;
 
     /**
      * This vector holds all parametertypes by position.
      */
-    parameterPositionList_t parametersPosition;
+    mutable parameterPositionList_t parametersPosition;
+
+    /**
+     * Names of the parameters in the order of parametersPosition.
+     */
+    mutable std::vector<std::string> namesPosition;
+
+    /**
+     * Parameters of the ProcedureDescriptor this procedure has been created
+     * from, validated instead of the containers above until AddParameter() is called.
+     */
+    const ParameterDescriptor *descriptorParameters;
+    size_t descriptorCount;
+
+    /**
+     * Guard the containers above being filled from descriptorParameters,
+     * parametersBuilt is only set once they are complete.
+     */
+    mutable std::once_flag parametersOnce;
+    mutable std::atomic<bool> parametersBuilt;
+
+    /**
+     * Nested schemas of parameters by name and by position, only filled if there are any.
+     */
+    mutable std::map<std::string, TypeSchema> schemasName;
+    mutable std::vector<TypeSchema> schemasPosition;
+
+    TypeSchema returnSchema;
 
     /**
      * @brief defines whether the procedure is a method or a notification
@@ -106,7 +198,15 @@ namespace jsonrpc {
      */
     parameterDeclaration_t paramDeclaration;
 
+    /**
+     * Set by servers that switch over their procedures instead of looking them up by name.
+     */
+    int dispatchId;
+
+    void BuildParameters() const;
+    void AppendParameter(const std::string &name, const TypeSchema &type) const;
     bool ValidateSingleParameter(jsontype_t expectedType, const Json::Value &value) const;
+    bool ValidateDescriptorParameter(const ParameterDescriptor &parameter, const Json::Value &value) const;
   };
 } /* namespace jsonrpc */
 #endif /* JSONRPC_CPP_PROCEDURE_H_ */
@@ -11,5 +11,18 @@
 
 #define DEFAULT_DELIMITER_CHAR char(0x0A)
 #define DEFAULT_BUFFER_SIZE 1024
+#define FRAME_HEADER_SIZE 4
+#define DEFAULT_MAX_FRAME_SIZE (256 * 1024 * 1024)
+#define DEFAULT_REJECT_TIMEOUT_MS 10
+
+namespace jsonrpc {
+  /**
+   * This enum describes how messages are separated on stream based connectors.
+   * FRAMING_DELIMITER terminates every message with DEFAULT_DELIMITER_CHAR,
+   * FRAMING_LENGTH_PREFIX precedes it with its length as 4 byte big-endian
+   * integer, which allows arbitrary payloads and exact allocation.
+   */
+  typedef enum { FRAMING_DELIMITER, FRAMING_LENGTH_PREFIX } framing_t;
+} // namespace jsonrpc
 
 #endif // SHAREDCONSTANTS_H
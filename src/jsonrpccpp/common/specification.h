@@ -15,6 +15,9 @@
 #define KEY_SPEC_PROCEDURE_NOTIFICATION "notification" // legacy format -> use name now
 #define KEY_SPEC_PROCEDURE_PARAMETERS "params"
 #define KEY_SPEC_RETURN_TYPE "returns"
+#define KEY_SPEC_TYPE "$type"
+#define KEY_SPEC_STRUCT "struct"
+#define KEY_SPEC_STRUCT_FIELDS "fields"
 
 namespace jsonrpc {
   /**
@@ -26,7 +29,7 @@ namespace jsonrpc {
   /**
    * This enum represents all processable json Types of this framework.
    */
-  enum jsontype_t { JSON_STRING = 1, JSON_BOOLEAN = 2, JSON_INTEGER = 3, JSON_REAL = 4, JSON_OBJECT = 5, JSON_ARRAY = 6, JSON_NUMERIC = 7 };
+  enum jsontype_t { JSON_STRING = 1, JSON_BOOLEAN = 2, JSON_INTEGER = 3, JSON_REAL = 4, JSON_OBJECT = 5, JSON_ARRAY = 6, JSON_NUMERIC = 7, JSON_INTEGER64 = 8 };
 } // namespace jsonrpc
 
 #endif // JSONRPC_CPP_SPECIFICATION_H
@@ -0,0 +1,264 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    specificationcache.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "specificationcache.h"
+#include "exception.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+  const char MAGIC[] = "JRPCSPEC";
+  const size_t MAGIC_LENGTH = sizeof(MAGIC) - 1;
+  const unsigned char FORMAT_VERSION = 1;
+
+  enum { SCHEMA_UNDEFINED, SCHEMA_BUILTIN, SCHEMA_ARRAY, SCHEMA_STRUCT };
+
+  class BinaryWriter {
+  public:
+    void WriteByte(unsigned char value) { this->data.push_back(static_cast<char>(value)); }
+
+    void WriteInt(uint32_t value) {
+      for (int i = 0; i < 4; i++)
+        this->WriteByte(static_cast<unsigned char>(value >> (8 * i)));
+    }
+
+    void WriteString(const string &value) {
+      this->WriteInt(static_cast<uint32_t>(value.size()));
+      this->data.append(value);
+    }
+
+    string data;
+  };
+
+  class BinaryReader {
+  public:
+    BinaryReader(const char *data, size_t size) : data(data), size(size), position(0) {}
+
+    unsigned char ReadByte() {
+      this->Require(1);
+      return static_cast<unsigned char>(this->data[this->position++]);
+    }
+
+    uint32_t ReadInt() {
+      this->Require(4);
+      uint32_t value = 0;
+      for (int i = 0; i < 4; i++)
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(this->data[this->position++])) << (8 * i);
+      return value;
+    }
+
+    string ReadString() {
+      uint32_t length = this->ReadInt();
+      this->Require(length);
+      string value(this->data + this->position, length);
+      this->position += length;
+      return value;
+    }
+
+    jsontype_t ReadType() {
+      unsigned char type = this->ReadByte();
+      if (type < JSON_STRING || type > JSON_INTEGER64)
+        Corrupt();
+      return static_cast<jsontype_t>(type);
+    }
+
+    void Skip(size_t count) {
+      this->Require(count);
+      this->position += count;
+    }
+
+    bool AtEnd() const { return this->position == this->size; }
+
+    static void Corrupt() { throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "specification cache is corrupt"); }
+
+  private:
+    const char *data;
+    size_t size;
+    size_t position;
+
+    void Require(size_t count) {
+      if (this->size - this->position < count)
+        Corrupt();
+    }
+  };
+
+  typedef map<string, uint32_t> structIndex_t;
+
+  /**
+   * Assigns indices to the structs used by schema, the ones it depends on first.
+   */
+  void CollectStructs(const TypeSchema &schema, structIndex_t &indices, vector<TypeSchema> &structs) {
+    if (schema.IsArray()) {
+      CollectStructs(schema.GetElement(), indices, structs);
+    } else if (schema.IsStruct() && indices.find(schema.GetName()) == indices.end()) {
+      for (size_t i = 0; i < schema.GetFields().size(); i++)
+        CollectStructs(schema.GetFields()[i].type, indices, structs);
+      indices[schema.GetName()] = static_cast<uint32_t>(structs.size());
+      structs.push_back(schema);
+    }
+  }
+
+  void WriteSchema(BinaryWriter &writer, const TypeSchema &schema, const structIndex_t &indices, size_t depth = 0) {
+    if (depth > TypeSchema::MAX_ARRAY_DEPTH)
+      throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "schema nests arrays too deep to be cached: " + schema.ToString());
+    if (!schema.IsDefined()) {
+      writer.WriteByte(SCHEMA_UNDEFINED);
+    } else if (schema.IsArray()) {
+      writer.WriteByte(SCHEMA_ARRAY);
+      WriteSchema(writer, schema.GetElement(), indices, depth + 1);
+    } else if (schema.IsStruct()) {
+      writer.WriteByte(SCHEMA_STRUCT);
+      writer.WriteInt(indices.find(schema.GetName())->second);
+    } else {
+      writer.WriteByte(SCHEMA_BUILTIN);
+      writer.WriteByte(static_cast<unsigned char>(schema.GetType()));
+    }
+  }
+
+  TypeSchema ReadSchema(BinaryReader &reader, const vector<TypeSchema> &structs, size_t depth = 0) {
+    // The writer doesn't nest deeper, so deeper schemas come from a corrupt file.
+    if (depth > TypeSchema::MAX_ARRAY_DEPTH)
+      BinaryReader::Corrupt();
+    switch (reader.ReadByte()) {
+    case SCHEMA_UNDEFINED:
+      return TypeSchema();
+    case SCHEMA_BUILTIN:
+      return TypeSchema(reader.ReadType());
+    case SCHEMA_ARRAY:
+      return TypeSchema::ArrayOf(ReadSchema(reader, structs, depth + 1));
+    case SCHEMA_STRUCT: {
+      // Structs only refer to the ones written before them.
+      uint32_t index = reader.ReadInt();
+      if (index >= structs.size())
+        BinaryReader::Corrupt();
+      return structs[index];
+    }
+    }
+    BinaryReader::Corrupt();
+    return TypeSchema();
+  }
+} // namespace
+
+string SpecificationCache::toBinary(const vector<Procedure> &procedures) {
+  structIndex_t indices;
+  vector<TypeSchema> structs;
+  for (size_t i = 0; i < procedures.size(); i++) {
+    const Procedure &procedure = procedures[i];
+    for (parameterNameList_t::const_iterator it = procedure.GetParameters().begin(); it != procedure.GetParameters().end(); ++it)
+      CollectStructs(procedure.GetParameterSchema(it->first), indices, structs);
+    CollectStructs(procedure.GetReturnSchema(), indices, structs);
+  }
+
+  BinaryWriter writer;
+  writer.data.append(MAGIC, MAGIC_LENGTH);
+  writer.WriteByte(FORMAT_VERSION);
+
+  writer.WriteInt(static_cast<uint32_t>(structs.size()));
+  for (size_t i = 0; i < structs.size(); i++) {
+    const vector<TypeField> &fields = structs[i].GetFields();
+    writer.WriteString(structs[i].GetName());
+    writer.WriteInt(static_cast<uint32_t>(fields.size()));
+    for (size_t j = 0; j < fields.size(); j++) {
+      writer.WriteString(fields[j].name);
+      writer.WriteByte(fields[j].optional ? 1 : 0);
+      WriteSchema(writer, fields[j].type, indices);
+    }
+  }
+
+  writer.WriteInt(static_cast<uint32_t>(procedures.size()));
+  for (size_t i = 0; i < procedures.size(); i++) {
+    const Procedure &procedure = procedures[i];
+    writer.WriteString(procedure.GetProcedureName());
+    writer.WriteByte(static_cast<unsigned char>(procedure.GetProcedureType()));
+    writer.WriteByte(static_cast<unsigned char>(procedure.GetParameterDeclarationType()));
+    writer.WriteByte(static_cast<unsigned char>(procedure.GetReturnType()));
+    WriteSchema(writer, procedure.GetReturnSchema(), indices);
+    // Parameters are added back in this order, which keeps their positions.
+    const vector<string> &names = procedure.GetParameterNames();
+    writer.WriteInt(static_cast<uint32_t>(names.size()));
+    for (size_t j = 0; j < names.size(); j++) {
+      writer.WriteString(names[j]);
+      writer.WriteByte(static_cast<unsigned char>(procedure.GetParameters().find(names[j])->second));
+      WriteSchema(writer, procedure.GetParameterSchema(names[j]), indices);
+    }
+  }
+  return writer.data;
+}
+
+bool SpecificationCache::toFile(const string &filename, const vector<Procedure> &procedures) {
+  ofstream file(filename.c_str(), ios_base::out | ios_base::binary);
+  if (!file.is_open())
+    return false;
+  string data = toBinary(procedures);
+  file.write(data.data(), data.size());
+  return file.good();
+}
+
+bool SpecificationCache::isCache(const char *data, size_t size) { return size >= MAGIC_LENGTH && memcmp(data, MAGIC, MAGIC_LENGTH) == 0; }
+
+vector<Procedure> SpecificationCache::fromBinary(const char *data, size_t size) {
+  if (!isCache(data, size))
+    BinaryReader::Corrupt();
+  BinaryReader reader(data, size);
+  reader.Skip(MAGIC_LENGTH);
+  if (reader.ReadByte() != FORMAT_VERSION)
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "unsupported specification cache version, regenerate it with jsonrpcstub");
+
+  vector<TypeSchema> structs;
+  uint32_t count = reader.ReadInt();
+  for (uint32_t i = 0; i < count; i++) {
+    TypeSchema schema = TypeSchema::Struct(reader.ReadString());
+    uint32_t fields = reader.ReadInt();
+    for (uint32_t j = 0; j < fields; j++) {
+      string name = reader.ReadString();
+      bool optional = reader.ReadByte() != 0;
+      schema.AddField(name, ReadSchema(reader, structs), optional);
+    }
+    structs.push_back(schema);
+  }
+
+  vector<Procedure> result;
+  count = reader.ReadInt();
+  // Every procedure takes at least 12 bytes, which bounds the reservation for corrupt counts.
+  result.reserve(min<size_t>(count, size / 12));
+  for (uint32_t i = 0; i < count; i++) {
+    result.push_back(Procedure());
+    Procedure &procedure = result.back();
+    procedure.SetProcedureName(reader.ReadString());
+    unsigned char type = reader.ReadByte();
+    unsigned char declaration = reader.ReadByte();
+    if (type > RPC_NOTIFICATION || declaration > PARAMS_BY_POSITION)
+      BinaryReader::Corrupt();
+    procedure.SetProcedureType(static_cast<procedure_t>(type));
+    procedure.SetParameterDeclarationType(static_cast<parameterDeclaration_t>(declaration));
+    procedure.SetReturnType(reader.ReadType());
+    TypeSchema returns = ReadSchema(reader, structs);
+    if (returns.IsDefined())
+      procedure.SetReturnSchema(returns);
+
+    uint32_t parameters = reader.ReadInt();
+    for (uint32_t j = 0; j < parameters; j++) {
+      string name = reader.ReadString();
+      jsontype_t parameter = reader.ReadType();
+      TypeSchema schema = ReadSchema(reader, structs);
+      if (schema.IsNested())
+        procedure.AddParameter(name, schema);
+      else
+        procedure.AddParameter(name, parameter);
+    }
+  }
+  if (!reader.AtEnd())
+    BinaryReader::Corrupt();
+  return result;
+}
@@ -0,0 +1,44 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    specificationcache.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_SPECIFICATIONCACHE_H
+#define JSONRPC_CPP_SPECIFICATIONCACHE_H
+
+#include "procedure.h"
+#include <vector>
+
+namespace jsonrpc {
+
+  /**
+   * Compiled binary form of a specification, which loads without parsing
+   * JSON. SpecificationParser::GetProceduresFromFile() recognizes these files
+   * and reads them straight from a memory mapping.
+   *
+   * Files start with the magic "JRPCSPEC" and a format version, followed by
+   * the struct declarations and the procedures. Integers are little endian.
+   */
+  class SpecificationCache {
+  public:
+    static std::string toBinary(const std::vector<Procedure> &procedures);
+    static bool toFile(const std::string &filename, const std::vector<Procedure> &procedures);
+
+    /**
+     * @return true if data starts like a file written by toBinary().
+     */
+    static bool isCache(const char *data, size_t size);
+
+    /**
+     * @throws JsonRpcException with ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX if data is truncated or corrupt.
+     */
+    static std::vector<Procedure> fromBinary(const char *data, size_t size);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_SPECIFICATIONCACHE_H
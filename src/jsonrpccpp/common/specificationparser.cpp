@@ -8,17 +8,21 @@
  ************************************************************************/
 
 #include "specificationparser.h"
-#include <fstream>
+#include "mappedfile.h"
+#include "specificationcache.h"
 #include <iomanip>
+#include <sstream>
 #include <jsonrpccpp/common/jsonparser.h>
+#include <unordered_set>
 
 using namespace std;
 using namespace jsonrpc;
 
 vector<Procedure> SpecificationParser::GetProceduresFromFile(const string &filename) {
-  string content;
-  GetFileContent(filename, content);
-  return GetProceduresFromString(content);
+  MappedFile file(filename);
+  if (SpecificationCache::isCache(file.GetData(), file.GetSize()))
+    return SpecificationCache::fromBinary(file.GetData(), file.GetSize());
+  return GetProceduresFromString(string(file.GetData(), file.GetSize()));
 }
 vector<Procedure> SpecificationParser::GetProceduresFromString(const string &content) {
 
@@ -29,29 +33,36 @@ vector<Procedure> SpecificationParser::GetProceduresFromString(const string &con
   } catch (Json::Exception &e) {
     throw JsonRpcException(Errors::ERROR_RPC_JSON_PARSE_ERROR, " specification file contains syntax errors");
   }
+  return GetProcedures(val);
+}
+vector<Procedure> SpecificationParser::GetProcedures(const Json::Value &val) {
   if (!val.isArray()) {
     throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, " top level json value is not an array");
   }
 
   vector<Procedure> result;
-  map<string, Procedure> procnames;
+  result.reserve(val.size());
+  unordered_set<string> procnames;
+  structList_t structs;
   for (unsigned int i = 0; i < val.size(); i++) {
-    Procedure proc;
-    GetProcedure(val[i], proc);
-    if (procnames.find(proc.GetProcedureName()) != procnames.end()) {
-      throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Procedurename not unique: " + proc.GetProcedureName());
+    if (val[i].isObject() && val[i].isMember(KEY_SPEC_STRUCT)) {
+      GetStruct(val[i], structs);
+      continue;
+    }
+    result.push_back(Procedure());
+    GetProcedure(val[i], result.back(), structs);
+    if (!procnames.insert(result.back().GetProcedureName()).second) {
+      throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Procedurename not unique: " + result.back().GetProcedureName());
     }
-    procnames[proc.GetProcedureName()] = proc;
-    result.push_back(proc);
   }
   return result;
 }
-void SpecificationParser::GetProcedure(Json::Value &signature, Procedure &result) {
+void SpecificationParser::GetProcedure(const Json::Value &signature, Procedure &result, const structList_t &structs) {
   if (signature.isObject() && !GetProcedureName(signature).empty()) {
     result.SetProcedureName(GetProcedureName(signature));
     if (signature.isMember(KEY_SPEC_RETURN_TYPE)) {
       result.SetProcedureType(RPC_METHOD);
-      result.SetReturnType(toJsonType(signature[KEY_SPEC_RETURN_TYPE]));
+      result.SetReturnSchema(toTypeSchema(signature[KEY_SPEC_RETURN_TYPE], structs));
     } else {
       result.SetProcedureType(RPC_NOTIFICATION);
     }
@@ -59,10 +70,10 @@ void SpecificationParser::GetProcedure(Json::Value &signature, Procedure &result
       if (signature[KEY_SPEC_PROCEDURE_PARAMETERS].isObject() || signature[KEY_SPEC_PROCEDURE_PARAMETERS].isArray()) {
         if (signature[KEY_SPEC_PROCEDURE_PARAMETERS].isArray()) {
           result.SetParameterDeclarationType(PARAMS_BY_POSITION);
-          GetPositionalParameters(signature, result);
+          GetPositionalParameters(signature, result, structs);
         } else if (signature[KEY_SPEC_PROCEDURE_PARAMETERS].isObject()) {
           result.SetParameterDeclarationType(PARAMS_BY_NAME);
-          GetNamedParameters(signature, result);
+          GetNamedParameters(signature, result, structs);
         }
       } else {
         throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Invalid signature types in fileds: " + signature.toStyledString());
@@ -74,16 +85,10 @@ void SpecificationParser::GetProcedure(Json::Value &signature, Procedure &result
   }
 }
 void SpecificationParser::GetFileContent(const std::string &filename, std::string &target) {
-  ifstream config(filename.c_str());
-
-  if (config) {
-    config.open(filename.c_str(), ios::in);
-    target.assign((std::istreambuf_iterator<char>(config)), (std::istreambuf_iterator<char>()));
-  } else {
-    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_NOT_FOUND, filename);
-  }
+  MappedFile file(filename);
+  target.assign(file.GetData(), file.GetSize());
 }
-jsontype_t SpecificationParser::toJsonType(Json::Value &val) {
+jsontype_t SpecificationParser::toJsonType(const Json::Value &val) {
   jsontype_t result;
   switch (val.type()) {
   case Json::uintValue:
@@ -110,22 +115,75 @@ jsontype_t SpecificationParser::toJsonType(Json::Value &val) {
   }
   return result;
 }
-void SpecificationParser::GetPositionalParameters(Json::Value &val, Procedure &result) {
+TypeSchema SpecificationParser::toTypeSchema(const Json::Value &val, const structList_t &structs) {
+  if (val.isObject() && val.size() == 1 && val.isMember(KEY_SPEC_TYPE)) {
+    const Json::Value &type = val[KEY_SPEC_TYPE];
+    if (type.isString())
+      return GetTypeSchema(type.asString(), structs);
+  }
+  return TypeSchema(toJsonType(val));
+}
+TypeSchema SpecificationParser::GetTypeSchema(const string &name, const structList_t &structs) {
+  // Each trailing [] makes an array of what is in front of it.
+  size_t length = name.size();
+  size_t depth = 0;
+  while (length > 2 && name.compare(length - 2, 2, "[]") == 0) {
+    length -= 2;
+    depth++;
+  }
+  if (depth > TypeSchema::MAX_ARRAY_DEPTH)
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Type nests arrays too deep: " + name);
+
+  string element = name.substr(0, length);
+  TypeSchema result;
+  jsontype_t builtin = TypeSchema::GetBuiltinType(element);
+  if (builtin != 0) {
+    result = TypeSchema(builtin);
+  } else {
+    structList_t::const_iterator it = structs.find(element);
+    if (it == structs.end())
+      throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Unknown type, structs have to be declared before they are used: " + element);
+    result = it->second;
+  }
+  for (size_t i = 0; i < depth; i++)
+    result = TypeSchema::ArrayOf(result);
+  return result;
+}
+void SpecificationParser::GetStruct(const Json::Value &val, structList_t &structs) {
+  if (!val[KEY_SPEC_STRUCT].isString() || !val[KEY_SPEC_STRUCT_FIELDS].isObject())
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "struct declaration does not contain name or fields: " + val.toStyledString());
+  string name = val[KEY_SPEC_STRUCT].asString();
+  if (name.empty() || TypeSchema::GetBuiltinType(name) != 0 || structs.find(name) != structs.end())
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX, "Structname not unique: " + name);
+
+  TypeSchema schema = TypeSchema::Struct(name);
+  vector<string> fields = val[KEY_SPEC_STRUCT_FIELDS].getMemberNames();
+  for (unsigned int i = 0; i < fields.size(); ++i) {
+    // A trailing ? marks optional fields.
+    string field = fields.at(i);
+    bool optional = field.size() > 1 && field[field.size() - 1] == '?';
+    if (optional)
+      field.erase(field.size() - 1);
+    schema.AddField(field, toTypeSchema(val[KEY_SPEC_STRUCT_FIELDS][fields.at(i)], structs), optional);
+  }
+  structs[name] = schema;
+}
+void SpecificationParser::GetPositionalParameters(const Json::Value &val, Procedure &result, const structList_t &structs) {
   // Positional parameters
   for (unsigned int i = 0; i < val[KEY_SPEC_PROCEDURE_PARAMETERS].size(); i++) {
     stringstream paramname;
     paramname << "param" << std::setfill('0') << std::setw(2) << (i + 1);
-    result.AddParameter(paramname.str(), toJsonType(val[KEY_SPEC_PROCEDURE_PARAMETERS][i]));
+    result.AddParameter(paramname.str(), toTypeSchema(val[KEY_SPEC_PROCEDURE_PARAMETERS][i], structs));
   }
 }
-void SpecificationParser::GetNamedParameters(Json::Value &val, Procedure &result) {
+void SpecificationParser::GetNamedParameters(const Json::Value &val, Procedure &result, const structList_t &structs) {
   vector<string> parameters = val[KEY_SPEC_PROCEDURE_PARAMETERS].getMemberNames();
   for (unsigned int i = 0; i < parameters.size(); ++i) {
-    result.AddParameter(parameters.at(i), toJsonType(val[KEY_SPEC_PROCEDURE_PARAMETERS][parameters.at(i)]));
+    result.AddParameter(parameters.at(i), toTypeSchema(val[KEY_SPEC_PROCEDURE_PARAMETERS][parameters.at(i)], structs));
   }
 }
 
-string SpecificationParser::GetProcedureName(Json::Value &signature) {
+string SpecificationParser::GetProcedureName(const Json::Value &signature) {
   if (signature[KEY_SPEC_PROCEDURE_NAME].isString())
     return signature[KEY_SPEC_PROCEDURE_NAME].asString();
 
@@ -12,6 +12,7 @@
 
 #include "exception.h"
 #include "procedure.h"
+#include <map>
 
 namespace jsonrpc {
 
@@ -20,17 +21,31 @@ namespace jsonrpc {
     static std::vector<Procedure> GetProceduresFromFile(const std::string &filename);
     static std::vector<Procedure> GetProceduresFromString(const std::string &spec);
 
+    /**
+     * @param spec The already parsed specification, which is left unchanged.
+     */
+    static std::vector<Procedure> GetProcedures(const Json::Value &spec);
+
     static void GetFileContent(const std::string &filename, std::string &target);
 
   private:
-    static void GetProcedure(Json::Value &val, Procedure &target);
-    static void GetMethod(Json::Value &val, Procedure &target);
-    static void GetNotification(Json::Value &val, Procedure &target);
-    static jsontype_t toJsonType(Json::Value &val);
-
-    static void GetPositionalParameters(Json::Value &val, Procedure &target);
-    static void GetNamedParameters(Json::Value &val, Procedure &target);
-    static std::string GetProcedureName(Json::Value &signature);
+    typedef std::map<std::string, TypeSchema> structList_t;
+
+    static void GetProcedure(const Json::Value &val, Procedure &target, const structList_t &structs);
+    static void GetMethod(const Json::Value &val, Procedure &target);
+    static void GetNotification(const Json::Value &val, Procedure &target);
+    static jsontype_t toJsonType(const Json::Value &val);
+
+    /**
+     * @return The schema of {"$type": "<name>"}, or of the literal val otherwise.
+     */
+    static TypeSchema toTypeSchema(const Json::Value &val, const structList_t &structs);
+    static TypeSchema GetTypeSchema(const std::string &name, const structList_t &structs);
+    static void GetStruct(const Json::Value &val, structList_t &structs);
+
+    static void GetPositionalParameters(const Json::Value &val, Procedure &target, const structList_t &structs);
+    static void GetNamedParameters(const Json::Value &val, Procedure &target, const structList_t &structs);
+    static std::string GetProcedureName(const Json::Value &signature);
   };
 } // namespace jsonrpc
 #endif // JSONRPC_CPP_SPECIFICATIONPARSER_H
@@ -19,9 +19,16 @@ using namespace jsonrpc;
 Json::Value SpecificationWriter::toJsonValue(const vector<Procedure> &procedures) {
   Json::Value result;
   Json::Value row;
+  set<string> written;
+  for (unsigned int i = 0; i < procedures.size(); i++) {
+    const Procedure &procedure = procedures.at(i);
+    for (parameterNameList_t::const_iterator it = procedure.GetParameters().begin(); it != procedure.GetParameters().end(); ++it)
+      structsToJsonValue(procedure.GetParameterSchema(it->first), result, written);
+    structsToJsonValue(procedure.GetReturnSchema(), result, written);
+  }
   for (unsigned int i = 0; i < procedures.size(); i++) {
     procedureToJsonValue(procedures.at(i), row);
-    result[i] = row;
+    result.append(row);
     row.clear();
   }
   return result;
@@ -64,19 +71,47 @@ Json::Value SpecificationWriter::toJsonLiteral(jsontype_t type) {
   case JSON_INTEGER:
     literal = 1;
     break;
+  case JSON_INTEGER64:
+    literal[KEY_SPEC_TYPE] = TypeSchema(type).ToString();
+    break;
   }
   return literal;
 }
+Json::Value SpecificationWriter::toJsonLiteral(jsontype_t type, const TypeSchema &schema) {
+  if (!schema.IsNested())
+    return toJsonLiteral(type);
+  Json::Value literal;
+  literal[KEY_SPEC_TYPE] = schema.ToString();
+  return literal;
+}
+void SpecificationWriter::structsToJsonValue(const TypeSchema &schema, Json::Value &target, set<string> &written) {
+  if (schema.IsArray()) {
+    structsToJsonValue(schema.GetElement(), target, written);
+    return;
+  }
+  if (!schema.IsStruct() || written.count(schema.GetName()) > 0)
+    return;
+  written.insert(schema.GetName());
+
+  Json::Value declaration;
+  declaration[KEY_SPEC_STRUCT] = schema.GetName();
+  declaration[KEY_SPEC_STRUCT_FIELDS] = Json::objectValue;
+  for (vector<TypeField>::const_iterator it = schema.GetFields().begin(); it != schema.GetFields().end(); ++it) {
+    structsToJsonValue(it->type, target, written);
+    declaration[KEY_SPEC_STRUCT_FIELDS][it->optional ? it->name + "?" : it->name] = toJsonLiteral(it->type.GetType(), it->type);
+  }
+  target.append(declaration);
+}
 void SpecificationWriter::procedureToJsonValue(const Procedure &procedure, Json::Value &target) {
   target[KEY_SPEC_PROCEDURE_NAME] = procedure.GetProcedureName();
   if (procedure.GetProcedureType() == RPC_METHOD) {
-    target[KEY_SPEC_RETURN_TYPE] = toJsonLiteral(procedure.GetReturnType());
+    target[KEY_SPEC_RETURN_TYPE] = toJsonLiteral(procedure.GetReturnType(), procedure.GetReturnSchema());
   }
   for (parameterNameList_t::const_iterator it = procedure.GetParameters().begin(); it != procedure.GetParameters().end(); ++it) {
     if (procedure.GetParameterDeclarationType() == PARAMS_BY_NAME) {
-      target[KEY_SPEC_PROCEDURE_PARAMETERS][it->first] = toJsonLiteral(it->second);
+      target[KEY_SPEC_PROCEDURE_PARAMETERS][it->first] = toJsonLiteral(it->second, procedure.GetParameterSchema(it->first));
     } else {
-      target[KEY_SPEC_PROCEDURE_PARAMETERS].append(toJsonLiteral(it->second));
+      target[KEY_SPEC_PROCEDURE_PARAMETERS].append(toJsonLiteral(it->second, procedure.GetParameterSchema(it->first)));
     }
   }
 }
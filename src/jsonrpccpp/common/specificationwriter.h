@@ -12,6 +12,7 @@
 
 #include "procedure.h"
 #include "specification.h"
+#include <set>
 
 namespace jsonrpc {
   class SpecificationWriter {
@@ -22,7 +23,13 @@ namespace jsonrpc {
 
   private:
     static Json::Value toJsonLiteral(jsontype_t type);
+    static Json::Value toJsonLiteral(jsontype_t type, const TypeSchema &schema);
     static void procedureToJsonValue(const Procedure &procedure, Json::Value &target);
+
+    /**
+     * Appends the declarations of the structs used by schema to target, the ones it depends on first.
+     */
+    static void structsToJsonValue(const TypeSchema &schema, Json::Value &target, std::set<std::string> &written);
   };
 } // namespace jsonrpc
 
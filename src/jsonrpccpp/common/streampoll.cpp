@@ -0,0 +1,35 @@
+#include "streampoll.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <errno.h>
+#include <poll.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+static uint64_t Now() { return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count()); }
+
+uint64_t jsonrpc::StreamDeadline(long timeout) { return timeout > 0 ? Now() + static_cast<uint64_t>(timeout) : 0; }
+
+bool jsonrpc::WaitForStream(int fd, short events, uint64_t deadline) {
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = events;
+  while (true) {
+    uint64_t now = Now();
+    if (now >= deadline) {
+      errno = ETIMEDOUT;
+      return false;
+    }
+    pfd.revents = 0;
+    int ready = poll(&pfd, 1, static_cast<int>(min<uint64_t>(deadline - now, INT_MAX)));
+    if (ready > 0) {
+      // Errors and hang ups are reported by the following read or write.
+      return true;
+    }
+    if (ready < 0 && errno != EINTR) {
+      return false;
+    }
+  }
+}
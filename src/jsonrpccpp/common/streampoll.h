@@ -0,0 +1,20 @@
+#ifndef STREAMPOLL_H
+#define STREAMPOLL_H
+
+#include <stdint.h>
+
+namespace jsonrpc {
+  /**
+   * @param timeout A timeout in milliseconds, 0 for none.
+   * @return The point in time the timeout elapses in milliseconds of a monotonic clock, 0 for none.
+   */
+  uint64_t StreamDeadline(long timeout);
+
+  /**
+   * Waits until fd is ready for events, see poll(2).
+   * @param deadline As returned by StreamDeadline, must not be 0.
+   * @return false on errors or if deadline has passed, errno is set to ETIMEDOUT in the latter case.
+   */
+  bool WaitForStream(int fd, short events, uint64_t deadline);
+} // namespace jsonrpc
+#endif // STREAMPOLL_H
@@ -1,4 +1,7 @@
 #include "streamreader.h"
+#include "streampoll.h"
+#include <algorithm>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -6,21 +9,118 @@
 using namespace jsonrpc;
 using namespace std;
 
-StreamReader::StreamReader(size_t buffersize) : buffersize(buffersize), buffer(static_cast<char *>(malloc(buffersize))) {}
+#define MAX_READ_SIZE (1024 * 1024)
 
-StreamReader::~StreamReader() { free(buffer); }
+StreamReader::StreamReader(size_t buffersize) : buffersize(buffersize > 0 ? buffersize : DEFAULT_BUFFER_SIZE), readsize(this->buffersize), timeout(0) {}
+
+StreamReader::~StreamReader() {}
 
 bool StreamReader::Read(std::string &target, int fd, char delimiter) {
-  ssize_t bytesRead;
-  do {
-    bytesRead = read(fd, this->buffer, buffersize);
-    if (bytesRead < 0) {
+  uint64_t deadline = StreamDeadline(this->timeout);
+  size_t searched = target.size();
+  target.append(this->pending);
+  this->pending.clear();
+
+  while (true) {
+    const char *pos = static_cast<const char *>(memchr(target.data() + searched, delimiter, target.size() - searched));
+    if (pos != NULL) {
+      size_t end = static_cast<size_t>(pos - target.data());
+      // Payloads may end in delimiters, the terminator is the last one of a run.
+      do {
+        while (end + 1 < target.size() && target[end + 1] == delimiter) {
+          end++;
+        }
+      } while (end + 1 == target.size() && this->ReadAvailable(target, fd));
+      this->pending.assign(target, end + 1, string::npos);
+      target.resize(end);
+      return true;
+    }
+    searched = target.size();
+
+    // Read straight into the target instead of going through a buffer.
+    target.resize(searched + this->readsize);
+    ssize_t bytesRead = this->ReadSome(fd, &target[searched], this->readsize, deadline);
+    if (bytesRead <= 0) {
+      target.resize(searched);
       return false;
-    } else {
-      target.append(buffer, static_cast<size_t>(bytesRead));
     }
-  } while (memchr(buffer, delimiter, bytesRead) == NULL); //(target.find(delimiter) == string::npos && bytesRead > 0);
+    target.resize(searched + static_cast<size_t>(bytesRead));
+    this->AdaptReadSize(static_cast<size_t>(bytesRead));
+  }
+}
+
+bool StreamReader::ReadAvailable(std::string &target, int fd) {
+  struct pollfd readable;
+  readable.fd = fd;
+  readable.events = POLLIN;
+  readable.revents = 0;
+  if (poll(&readable, 1, 0) <= 0) {
+    return false;
+  }
+  size_t size = target.size();
+  target.resize(size + this->readsize);
+  ssize_t bytesRead = read(fd, &target[size], this->readsize);
+  target.resize(size + (bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0));
+  return bytesRead > 0;
+}
+
+bool StreamReader::ReadFrame(std::string &target, int fd) {
+  uint64_t deadline = StreamDeadline(this->timeout);
+  unsigned char header[FRAME_HEADER_SIZE];
+  if (!this->ReadExactly(reinterpret_cast<char *>(header), FRAME_HEADER_SIZE, fd, deadline)) {
+    return false;
+  }
+
+  size_t size = (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16) | (static_cast<size_t>(header[2]) << 8) |
+                static_cast<size_t>(header[3]);
+  if (size > DEFAULT_MAX_FRAME_SIZE) {
+    return false;
+  }
+
+  target.resize(size);
+  if (size == 0) {
+    return true;
+  }
+  return this->ReadExactly(&target[0], size, fd, deadline);
+}
 
-  target.pop_back();
+bool StreamReader::ReadMessage(std::string &target, int fd, framing_t framing) {
+  if (framing == FRAMING_LENGTH_PREFIX) {
+    return this->ReadFrame(target, fd);
+  }
+  return this->Read(target, fd, DEFAULT_DELIMITER_CHAR);
+}
+
+size_t StreamReader::Pending() const { return this->pending.size(); }
+
+void StreamReader::SetTimeout(long timeout) { this->timeout = timeout; }
+
+bool StreamReader::ReadExactly(char *target, size_t size, int fd, uint64_t deadline) {
+  size_t received = min(size, this->pending.size());
+  memcpy(target, this->pending.data(), received);
+  this->pending.erase(0, received);
+
+  while (received < size) {
+    ssize_t bytesRead = this->ReadSome(fd, target + received, size - received, deadline);
+    if (bytesRead <= 0) {
+      return false;
+    }
+    received += static_cast<size_t>(bytesRead);
+  }
   return true;
 }
+
+ssize_t StreamReader::ReadSome(int fd, char *target, size_t size, uint64_t deadline) {
+  if (deadline != 0 && !WaitForStream(fd, POLLIN, deadline)) {
+    return -1;
+  }
+  return read(fd, target, size);
+}
+
+void StreamReader::AdaptReadSize(size_t bytesRead) {
+  if (bytesRead == this->readsize && this->readsize < MAX_READ_SIZE) {
+    this->readsize *= 2;
+  } else if (bytesRead < this->readsize / 4 && this->readsize > this->buffersize) {
+    this->readsize /= 2;
+  }
+}
@@ -2,19 +2,69 @@
 #define STREAMREADER_H
 
 #include <memory>
+#include <stdint.h>
 #include <string>
+#include <sys/types.h>
+
+#include "sharedconstants.h"
 
 namespace jsonrpc {
+  /**
+   * Reads messages from a file descriptor directly into the target string.
+   * The read size starts at buffersize and adapts to the observed message
+   * sizes. Bytes received past the end of a message are kept for the next
+   * call, so a reader has to stay with its file descriptor.
+   *
+   * With a timeout set, a message has to be complete within the timeout,
+   * otherwise reading fails with errno set to ETIMEDOUT.
+   */
   class StreamReader {
   public:
     StreamReader(size_t buffersize);
     virtual ~StreamReader();
 
+    /**
+     * Reads until delimiter. Payloads may end in delimiter characters, the
+     * terminator is the last delimiter of a run. A run that reaches the end
+     * of the received bytes is completed with the bytes available without
+     * waiting, so a message written at once doesn't depend on how the
+     * kernel hands it over.
+     * @return false on errors or a premature end of stream, target then
+     * holds what has been received of the message.
+     */
     bool Read(std::string &target, int fd, char delimiter);
 
+    /**
+     * Reads a single length prefixed message, see FRAMING_LENGTH_PREFIX.
+     * @return false on errors, a premature end of stream or oversized frames.
+     */
+    bool ReadFrame(std::string &target, int fd);
+
+    /**
+     * Reads a single message using the given framing.
+     */
+    bool ReadMessage(std::string &target, int fd, framing_t framing);
+
+    /**
+     * @return The number of bytes already received for upcoming messages.
+     */
+    size_t Pending() const;
+
+    /**
+     * @param timeout The time to wait for a complete message in milliseconds, 0 waits forever.
+     */
+    void SetTimeout(long timeout);
+
   private:
+    bool ReadExactly(char *target, size_t size, int fd, uint64_t deadline);
+    bool ReadAvailable(std::string &target, int fd);
+    void AdaptReadSize(size_t bytesRead);
+    ssize_t ReadSome(int fd, char *target, size_t size, uint64_t deadline);
+
     size_t buffersize;
-    char *buffer;
+    size_t readsize;
+    std::string pending;
+    long timeout;
   };
 } // namespace jsonrpc
 #endif // STREAMREADER_H
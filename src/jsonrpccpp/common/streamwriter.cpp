@@ -1,21 +1,91 @@
 #include "streamwriter.h"
+#include "streampoll.h"
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 using namespace jsonrpc;
 using namespace std;
 
-bool StreamWriter::Write(const string &source, int fd) {
-  ssize_t bytesWritten;
-  size_t totalSize = source.size();
-  size_t remainingSize = totalSize;
+StreamWriter::StreamWriter() : timeout(0) {}
 
-  do {
-    bytesWritten = write(fd, source.c_str() + (totalSize - remainingSize), remainingSize);
+/**
+ * Writes all parts, continuing where the kernel stopped on partial writes.
+ */
+static bool WriteParts(int fd, struct iovec *parts, int count, uint64_t deadline) {
+  bool isSocket = true;
+  while (count > 0) {
+    if (deadline != 0 && !WaitForStream(fd, POLLOUT, deadline)) {
+      return false;
+    }
+    ssize_t bytesWritten = -1;
+#ifdef MSG_NOSIGNAL
+    // A peer that has given up must not terminate the process with SIGPIPE.
+    if (isSocket) {
+      struct msghdr message;
+      memset(&message, 0, sizeof(message));
+      message.msg_iov = parts;
+      message.msg_iovlen = count;
+      bytesWritten = sendmsg(fd, &message, MSG_NOSIGNAL);
+      isSocket = bytesWritten >= 0 || errno != ENOTSOCK;
+    }
+#else
+    isSocket = false;
+#endif
+    if (!isSocket) {
+      bytesWritten = writev(fd, parts, count);
+    }
     if (bytesWritten < 0) {
       return false;
-    } else {
-      remainingSize -= static_cast<size_t>(bytesWritten);
     }
-  } while (remainingSize > 0);
+    size_t remaining = static_cast<size_t>(bytesWritten);
+    while (count > 0 && remaining >= parts->iov_len) {
+      remaining -= parts->iov_len;
+      parts++;
+      count--;
+    }
+    if (count > 0) {
+      parts->iov_base = static_cast<char *>(parts->iov_base) + remaining;
+      parts->iov_len -= remaining;
+    }
+  }
   return true;
 }
+
+bool StreamWriter::WriteMessage(const string &source, int fd, framing_t framing) {
+  struct iovec parts[2];
+  unsigned char header[FRAME_HEADER_SIZE];
+  char delimiter = DEFAULT_DELIMITER_CHAR;
+
+  if (framing == FRAMING_LENGTH_PREFIX) {
+    if (source.size() > DEFAULT_MAX_FRAME_SIZE) {
+      return false;
+    }
+    header[0] = static_cast<unsigned char>(source.size() >> 24);
+    header[1] = static_cast<unsigned char>(source.size() >> 16);
+    header[2] = static_cast<unsigned char>(source.size() >> 8);
+    header[3] = static_cast<unsigned char>(source.size());
+    parts[0].iov_base = header;
+    parts[0].iov_len = FRAME_HEADER_SIZE;
+    parts[1].iov_base = const_cast<char *>(source.data());
+    parts[1].iov_len = source.size();
+  } else {
+    parts[0].iov_base = const_cast<char *>(source.data());
+    parts[0].iov_len = source.size();
+    parts[1].iov_base = &delimiter;
+    parts[1].iov_len = 1;
+  }
+  return WriteParts(fd, parts, 2, StreamDeadline(this->timeout));
+}
+
+bool StreamWriter::Write(const string &source, int fd) {
+  struct iovec part;
+  part.iov_base = const_cast<char *>(source.data());
+  part.iov_len = source.size();
+  return WriteParts(fd, &part, 1, StreamDeadline(this->timeout));
+}
+
+void StreamWriter::SetTimeout(long timeout) { this->timeout = timeout; }
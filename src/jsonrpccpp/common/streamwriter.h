@@ -4,10 +4,34 @@
 #include <memory>
 #include <string>
 
+#include "sharedconstants.h"
+
 namespace jsonrpc {
+  /**
+   * Writes messages to a file descriptor. With a timeout set, a message has
+   * to be handed to the kernel within the timeout, otherwise writing fails
+   * with errno set to ETIMEDOUT.
+   */
   class StreamWriter {
   public:
+    StreamWriter();
+
     bool Write(const std::string &source, int fd);
+
+    /**
+     * Writes a single message using the given framing. The delimiter or
+     * length header is handed to the kernel together with the payload,
+     * without copying the message.
+     */
+    bool WriteMessage(const std::string &source, int fd, framing_t framing);
+
+    /**
+     * @param timeout The time to wait for a message to be written in milliseconds, 0 waits forever.
+     */
+    void SetTimeout(long timeout);
+
+  private:
+    long timeout;
   };
 
 } // namespace jsonrpc
@@ -0,0 +1,24 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    tracing.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "tracing.h"
+#include <chrono>
+
+using namespace jsonrpc;
+using namespace std;
+
+static thread_local string current;
+
+uint64_t ITracer::Now() { return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count()); }
+
+TraceContext::TraceContext(const string &traceid) : previous(current) { current = traceid; }
+
+TraceContext::~TraceContext() { current.swap(previous); }
+
+const string &TraceContext::GetCurrent() { return current; }
@@ -0,0 +1,84 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    tracing.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_TRACING_H
+#define JSONRPC_CPP_TRACING_H
+
+#include "jsonparser.h"
+#include <stdint.h>
+#include <string>
+
+// Reserved request member and HTTP header carrying the trace id.
+#define KEY_REQUEST_TRACEID "traceparent"
+
+namespace jsonrpc {
+
+  /**
+   * The stages a request passes. Clients report STAGE_BUILD, STAGE_SEND and
+   * STAGE_PARSE, servers STAGE_PARSE, STAGE_VALIDATE, STAGE_INVOKE and
+   * STAGE_SERIALIZE.
+   */
+  typedef enum { STAGE_BUILD, STAGE_SEND, STAGE_PARSE, STAGE_VALIDATE, STAGE_INVOKE, STAGE_SERIALIZE } stage_t;
+
+  /**
+   * A completed stage of a request. Method and id are empty for stages that
+   * cover a whole batch or a message that could not be parsed.
+   */
+  struct TraceSpan {
+    stage_t stage;
+    std::string method;
+    Json::Value id;
+    std::string traceid;
+    uint64_t start;
+    uint64_t end;
+  };
+
+  /**
+   * Observer of request stages, see Client::SetTracer and AbstractServer::SetTracer.
+   * OnSpan is called from the threads processing requests, implementations
+   * have to be thread-safe and should return quickly.
+   */
+  class ITracer {
+  public:
+    virtual ~ITracer() {}
+
+    virtual void OnSpan(const TraceSpan &span) = 0;
+
+    /**
+     * @return Nanoseconds of the monotonic clock used for all spans.
+     */
+    static uint64_t Now();
+  };
+
+  /**
+   * Makes a trace id the current one of the calling thread for the lifetime
+   * of the object. Servers set it while a procedure is invoked, and clients
+   * attach the current trace id to their requests, so nested calls are
+   * propagated without further code.
+   */
+  class TraceContext {
+  public:
+    explicit TraceContext(const std::string &traceid);
+    ~TraceContext();
+
+    /**
+     * @return The trace id of the calling thread, empty if there is none.
+     */
+    static const std::string &GetCurrent();
+
+  private:
+    std::string previous;
+
+    TraceContext(const TraceContext &);
+    TraceContext &operator=(const TraceContext &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_TRACING_H
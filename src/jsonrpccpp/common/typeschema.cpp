@@ -0,0 +1,157 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    typeschema.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "typeschema.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+  const vector<TypeField> NO_FIELDS;
+  const TypeSchema UNDEFINED;
+} // namespace
+
+TypeSchema::TypeSchema() : type(JSON_OBJECT), defined(false) {}
+
+TypeSchema::TypeSchema(jsontype_t type) : type(type), defined(true) {}
+
+TypeSchema TypeSchema::ArrayOf(const TypeSchema &element) {
+  TypeSchema result(JSON_ARRAY);
+  result.element = make_shared<TypeSchema>(element);
+  return result;
+}
+
+TypeSchema TypeSchema::Struct(const string &name) {
+  TypeSchema result(JSON_OBJECT);
+  result.name = name;
+  result.fields = make_shared<vector<TypeField>>();
+  return result;
+}
+
+void TypeSchema::AddField(const string &name, const TypeSchema &type, bool optional) {
+  if (!this->fields)
+    return;
+  TypeField field;
+  field.name = name;
+  field.type = type;
+  field.optional = optional;
+  this->fields->push_back(field);
+}
+
+bool TypeSchema::IsDefined() const { return this->defined; }
+
+bool TypeSchema::IsStruct() const { return this->fields != nullptr; }
+
+bool TypeSchema::IsArray() const { return this->element != nullptr; }
+
+bool TypeSchema::IsNested() const { return this->IsStruct() || this->IsArray(); }
+
+jsontype_t TypeSchema::GetType() const { return this->type; }
+
+const string &TypeSchema::GetName() const { return this->name; }
+
+const TypeSchema &TypeSchema::GetElement() const { return this->element ? *this->element : UNDEFINED; }
+
+const vector<TypeField> &TypeSchema::GetFields() const { return this->fields ? *this->fields : NO_FIELDS; }
+
+bool TypeSchema::Validate(const Json::Value &value) const {
+  if (!this->defined)
+    return true;
+  if (this->fields) {
+    if (!value.isObject())
+      return false;
+    for (vector<TypeField>::const_iterator it = this->fields->begin(); it != this->fields->end(); ++it) {
+      // Missing members are looked up as null, without adding them.
+      const Json::Value &member = value[it->name];
+      if (member.isNull() && it->optional)
+        continue;
+      if (!it->type.Validate(member))
+        return false;
+    }
+    return true;
+  }
+  if (this->element) {
+    if (!value.isArray())
+      return false;
+    for (Json::ArrayIndex i = 0; i < value.size(); i++) {
+      if (!this->element->Validate(value[i]))
+        return false;
+    }
+    return true;
+  }
+  return ValidateType(this->type, value);
+}
+
+string TypeSchema::ToString() const {
+  if (this->fields)
+    return this->name;
+  if (this->element)
+    return this->element->ToString() + "[]";
+  switch (this->type) {
+  case JSON_STRING:
+    return "string";
+  case JSON_BOOLEAN:
+    return "boolean";
+  case JSON_INTEGER:
+    return "integer";
+  case JSON_INTEGER64:
+    return "int64";
+  case JSON_REAL:
+    return "real";
+  case JSON_NUMERIC:
+    return "number";
+  case JSON_ARRAY:
+    return "array";
+  case JSON_OBJECT:
+    break;
+  }
+  return "object";
+}
+
+jsontype_t TypeSchema::GetBuiltinType(const string &name) {
+  if (name == "string")
+    return JSON_STRING;
+  if (name == "boolean")
+    return JSON_BOOLEAN;
+  if (name == "integer")
+    return JSON_INTEGER;
+  if (name == "int64")
+    return JSON_INTEGER64;
+  if (name == "real")
+    return JSON_REAL;
+  if (name == "number")
+    return JSON_NUMERIC;
+  if (name == "object")
+    return JSON_OBJECT;
+  if (name == "array")
+    return JSON_ARRAY;
+  return static_cast<jsontype_t>(0);
+}
+
+bool TypeSchema::ValidateType(jsontype_t type, const Json::Value &value) {
+  switch (type) {
+  case JSON_STRING:
+    return value.isString();
+  case JSON_BOOLEAN:
+    return value.isBool();
+  case JSON_INTEGER:
+    return value.isIntegral();
+  case JSON_INTEGER64:
+    return value.isInt64();
+  case JSON_REAL:
+    return value.isDouble();
+  case JSON_NUMERIC:
+    return value.isNumeric();
+  case JSON_OBJECT:
+    return value.isObject();
+  case JSON_ARRAY:
+    return value.isArray();
+  }
+  return true;
+}
@@ -0,0 +1,106 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    typeschema.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_TYPESCHEMA_H
+#define JSONRPC_CPP_TYPESCHEMA_H
+
+#include "jsonparser.h"
+#include "specification.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jsonrpc {
+
+  struct TypeField;
+
+  /**
+   * Describes the shape of a value: a plain jsontype_t, a struct with named
+   * fields or a typed array. Declared in specifications with
+   * {"$type": "<name>"}, see SpecificationParser.
+   *
+   * Structs are shared between all schemas referring to them, so they must
+   * not be changed once they are used.
+   */
+  class TypeSchema {
+  public:
+    /**
+     * An undefined schema, which accepts any value.
+     */
+    TypeSchema();
+    explicit TypeSchema(jsontype_t type);
+
+    /**
+     * Deepest nesting of arrays in a single schema, e.g. "int[][]" has two.
+     * Specifications and the specification cache reject deeper ones.
+     */
+    static const size_t MAX_ARRAY_DEPTH = 64;
+
+    static TypeSchema ArrayOf(const TypeSchema &element);
+    static TypeSchema Struct(const std::string &name);
+
+    /**
+     * @param optional Optional fields may be missing or null.
+     */
+    void AddField(const std::string &name, const TypeSchema &type, bool optional);
+
+    bool IsDefined() const;
+    bool IsStruct() const;
+    bool IsArray() const;
+
+    /**
+     * @return true for structs and typed arrays, which a jsontype_t can't describe.
+     */
+    bool IsNested() const;
+
+    /**
+     * @return JSON_OBJECT for structs and JSON_ARRAY for typed arrays.
+     */
+    jsontype_t GetType() const;
+    const std::string &GetName() const;
+    const TypeSchema &GetElement() const;
+    const std::vector<TypeField> &GetFields() const;
+
+    /**
+     * Checks value and everything nested in it in a single pass.
+     */
+    bool Validate(const Json::Value &value) const;
+
+    /**
+     * @return The name used for $type in specifications, e.g. "int64" or "User[]".
+     */
+    std::string ToString() const;
+
+    /**
+     * @return The type of a $type name, 0 if it isn't a built-in type.
+     */
+    static jsontype_t GetBuiltinType(const std::string &name);
+
+    /**
+     * Checks a single value against a plain type, i.e. without nested shapes.
+     */
+    static bool ValidateType(jsontype_t type, const Json::Value &value);
+
+  private:
+    jsontype_t type;
+    bool defined;
+    std::string name;
+    std::shared_ptr<std::vector<TypeField>> fields;
+    std::shared_ptr<TypeSchema> element;
+  };
+
+  struct TypeField {
+    std::string name;
+    TypeSchema type;
+    bool optional;
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_TYPESCHEMA_H
@@ -9,67 +9,274 @@
 
 #include "abstractprotocolhandler.h"
 #include <jsonrpccpp/common/errors.h>
+#include <jsonrpccpp/common/exception.h>
 #include <sstream>
 #include <map>
 
 using namespace jsonrpc;
 using namespace std;
 
-AbstractProtocolHandler::AbstractProtocolHandler(IProcedureInvokationHandler &handler) : handler(handler) {}
+AbstractProtocolHandler::AbstractProtocolHandler(IProcedureInvokationHandler &handler) : handler(handler), statistics(NULL), exposeStatistics(false), tracer(NULL), lazy(false) {}
 
 AbstractProtocolHandler::~AbstractProtocolHandler() {}
 
-void AbstractProtocolHandler::AddProcedure(const Procedure &procedure) { this->procedures[procedure.GetProcedureName()] = procedure; }
+void AbstractProtocolHandler::AddProcedure(const Procedure &procedure) {
+  this->procedures[procedure.GetProcedureName()] = procedure;
+  if (this->statistics != NULL) {
+    this->statistics->Register(procedure.GetProcedureName());
+  }
+}
+
+void AbstractProtocolHandler::SetStatistics(ServerStatistics *statistics, bool expose) {
+  this->statistics = statistics;
+  this->exposeStatistics = statistics != NULL && expose;
+  if (this->exposeStatistics) {
+    this->procedures[RPC_STATS_METHOD] = Procedure(RPC_STATS_METHOD, PARAMS_BY_NAME, JSON_OBJECT, NULL);
+  }
+  if (this->statistics != NULL) {
+    for (map<string, Procedure>::iterator it = this->procedures.begin(); it != this->procedures.end(); ++it) {
+      this->statistics->Register(it->first);
+    }
+  }
+}
+
+void AbstractProtocolHandler::SetTracer(ITracer *tracer) { this->tracer = tracer; }
+
+void AbstractProtocolHandler::SetLazyParsing(bool enabled) { this->lazy = enabled; }
+
+void AbstractProtocolHandler::RecordDeferredInvocation(const Procedure &proc, uint64_t start, const JsonRpcException *error) {
+  if (this->statistics == NULL && this->tracer == NULL)
+    return;
+  Json::Value request;
+  request[KEY_REQUEST_METHODNAME] = proc.GetProcedureName();
+  this->RecordInvocation(proc, request, start, error);
+}
+
+void AbstractProtocolHandler::Trace(stage_t stage, const Json::Value &request, uint64_t start, uint64_t end) {
+  TraceSpan span;
+  span.stage = stage;
+  if (request.isObject()) {
+    if (request.isMember(KEY_REQUEST_METHODNAME) && request[KEY_REQUEST_METHODNAME].isString())
+      span.method = request[KEY_REQUEST_METHODNAME].asString();
+    if (request.isMember(KEY_REQUEST_ID))
+      span.id = request[KEY_REQUEST_ID];
+    if (request.isMember(KEY_REQUEST_TRACEID) && request[KEY_REQUEST_TRACEID].isString())
+      span.traceid = request[KEY_REQUEST_TRACEID].asString();
+  }
+  if (span.traceid.empty())
+    span.traceid = TraceContext::GetCurrent();
+  span.start = start;
+  span.end = end;
+  this->tracer->OnSpan(span);
+}
 
-void AbstractProtocolHandler::HandleRequest(const std::string &request, std::string &retValue) {
+void AbstractProtocolHandler::HandleRequest(const std::string &request, std::string &retValue) { this->HandleEncodedRequest(request, retValue, CODEC_JSON); }
+
+void AbstractProtocolHandler::HandleEncodedRequest(const std::string &request, std::string &retValue, codec_t codec) {
   Json::Value req;
   Json::Value resp;
   Json::StreamWriterBuilder wbuilder;
   wbuilder["indentation"] = "";
 
+  bool timed = this->statistics != NULL || this->tracer != NULL;
+  uint64_t start = timed ? ITracer::Now() : 0;
+  uint64_t parsed = start;
   try {
-    istringstream(request) >> req;
-    this->HandleJsonRequest(req, resp);
+    JsonEnvelope envelope;
+    bool accepted = true;
+    if (this->lazy && codec == CODEC_JSON && envelope.Parse(request, KEY_REQUEST_PARAMETERS))
+      accepted = this->AcceptEnvelope(envelope, req, resp);
+    else if (!Codec::Decode(request, codec, req))
+      throw Json::RuntimeError("Invalid message");
+    if (timed) {
+      parsed = ITracer::Now();
+      if (this->tracer != NULL)
+        this->Trace(STAGE_PARSE, req, start, parsed);
+    }
+    if (accepted)
+      this->HandleJsonRequest(req, resp);
   } catch (const Json::Exception &e) {
+    if (this->statistics != NULL)
+      this->statistics->GetTotal().RecordError(Errors::ERROR_RPC_JSON_PARSE_ERROR);
+    if (this->tracer != NULL)
+      this->Trace(STAGE_PARSE, Json::nullValue, start, ITracer::Now());
     this->WrapError(Json::nullValue, Errors::ERROR_RPC_JSON_PARSE_ERROR, Errors::GetErrorMessage(Errors::ERROR_RPC_JSON_PARSE_ERROR), resp);
   }
 
-  if (resp != Json::nullValue)
-    retValue = Json::writeString(wbuilder, resp);
+  uint64_t handled = timed ? ITracer::Now() : 0;
+  if (resp != Json::nullValue) {
+    if (codec == CODEC_JSON)
+      retValue = Json::writeString(wbuilder, resp);
+    else
+      Codec::Encode(resp, codec, retValue);
+  }
+
+  if (timed) {
+    uint64_t end = ITracer::Now();
+    if (this->statistics != NULL)
+      this->statistics->RecordMessage(req, request.size(), retValue.size(), parsed - start, end - handled);
+    if (this->tracer != NULL)
+      this->Trace(STAGE_SERIALIZE, req, handled, end);
+  }
+}
+
+/**
+ * @return The point in time the deadline of request expires, 0 if it has none.
+ * The time left is counted from the arrival of the message if it is known.
+ */
+static uint64_t GetDeadline(const Json::Value &request) {
+  if (!request.isMember(KEY_REQUEST_DEADLINE) || !request[KEY_REQUEST_DEADLINE].isNumeric())
+    return 0;
+  double remaining = request[KEY_REQUEST_DEADLINE].asDouble();
+  uint64_t start = ArrivalContext::GetCurrent();
+  if (start == 0)
+    start = ITracer::Now();
+  return start + (remaining > 0 ? static_cast<uint64_t>(remaining * 1000000) : 0);
+}
+
+bool AbstractProtocolHandler::AcceptEnvelope(JsonEnvelope &envelope, Json::Value &request, Json::Value &response) {
+  bool timed = this->statistics != NULL || this->tracer != NULL;
+  uint64_t start = timed ? ITracer::Now() : 0;
+  request.swap(envelope.GetMembers());
+  if (envelope.HasDeferred())
+    request[KEY_REQUEST_PARAMETERS] = envelope.GetDeferredPlaceholder();
+
+  Procedure *proc = NULL;
+  int error = this->ValidateEnvelope(request, proc);
+  if (error == 0 && CancellationToken(GetDeadline(request)).IsCancelled())
+    error = Errors::ERROR_SERVER_DEADLINE_EXCEEDED;
+  else if (error == 0 && !this->handler.AdmitCall(*proc))
+    error = Errors::ERROR_SERVER_OVERLOADED;
+
+  if (error != 0) {
+    if (timed)
+      this->FinishValidation(request, error, start);
+    this->WrapError(request, error, Errors::GetErrorMessage(error), response);
+    return false;
+  }
+  if (envelope.HasDeferred() && !envelope.ParseDeferred(request[KEY_REQUEST_PARAMETERS]))
+    throw Json::RuntimeError("Invalid params");
+  return true;
 }
 
 void AbstractProtocolHandler::ProcessRequest(const Json::Value &request, Json::Value &response) {
   Procedure &method = this->procedures[request[KEY_REQUEST_METHODNAME].asString()];
-  Json::Value result;
 
+  if (this->exposeStatistics && method.GetProcedureName() == RPC_STATS_METHOD) {
+    Json::Value result = this->statistics->ToJson();
+    this->WrapResult(request, response, result);
+    return;
+  }
+
+  bool timed = this->statistics != NULL || this->tracer != NULL;
+  uint64_t start = timed ? ITracer::Now() : 0;
+  bool invoked;
+  try {
+    // Drop requests whose caller has given up already, e.g. while they were queued.
+    CancellationToken token(GetDeadline(request));
+    if (token.IsCancelled())
+      throw JsonRpcException(Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+    CancellationScope scope(token);
+
+    // Make the caller's trace id available to clients used by the procedure.
+    if (request.isMember(KEY_REQUEST_TRACEID) && request[KEY_REQUEST_TRACEID].isString()) {
+      TraceContext context(request[KEY_REQUEST_TRACEID].asString());
+      invoked = this->InvokeProcedure(method, request, response);
+    } else {
+      invoked = this->InvokeProcedure(method, request, response);
+    }
+  } catch (const JsonRpcException &e) {
+    if (timed)
+      this->RecordInvocation(method, request, start, &e);
+    throw;
+  }
+  // Queued notifications are accounted by RecordDeferredInvocation once they are handled.
+  if (timed && invoked)
+    this->RecordInvocation(method, request, start, NULL);
+}
+
+bool AbstractProtocolHandler::InvokeProcedure(Procedure &method, const Json::Value &request, Json::Value &response) {
+  Json::Value result;
   if (method.GetProcedureType() == RPC_METHOD) {
     handler.HandleMethodCall(method, request[KEY_REQUEST_PARAMETERS], result);
     this->WrapResult(request, response, result);
-  } else {
-    handler.HandleNotificationCall(method, request[KEY_REQUEST_PARAMETERS]);
-    response = Json::nullValue;
+    return true;
+  }
+  response = Json::nullValue;
+  if (handler.QueueNotification(method, request[KEY_REQUEST_PARAMETERS]))
+    return false;
+  handler.HandleNotificationCall(method, request[KEY_REQUEST_PARAMETERS]);
+  return true;
+}
+
+void AbstractProtocolHandler::RecordInvocation(const Procedure &method, const Json::Value &request, uint64_t start, const JsonRpcException *error) {
+  uint64_t end = ITracer::Now();
+  if (this->tracer != NULL)
+    this->Trace(STAGE_INVOKE, request, start, end);
+
+  ProcedureStatistics *stats = this->statistics != NULL ? this->statistics->Find(method.GetProcedureName()) : NULL;
+  if (stats == NULL)
+    return;
+  stats->RecordLatency(PHASE_INVOKE, end - start);
+  this->statistics->GetTotal().RecordLatency(PHASE_INVOKE, end - start);
+  if (error != NULL) {
+    stats->RecordError(error->GetCode());
+    this->statistics->GetTotal().RecordError(error->GetCode());
   }
 }
 
 int AbstractProtocolHandler::ValidateRequest(const Json::Value &request) {
-  int error = 0;
-  Procedure proc;
-  if (!this->ValidateRequestFields(request)) {
-    error = Errors::ERROR_RPC_INVALID_REQUEST;
-  } else {
-    map<string, Procedure>::iterator it = this->procedures.find(request[KEY_REQUEST_METHODNAME].asString());
-    if (it != this->procedures.end()) {
-      proc = it->second;
-      if (this->GetRequestType(request) == RPC_METHOD && proc.GetProcedureType() == RPC_NOTIFICATION) {
-        error = Errors::ERROR_SERVER_PROCEDURE_IS_NOTIFICATION;
-      } else if (this->GetRequestType(request) == RPC_NOTIFICATION && proc.GetProcedureType() == RPC_METHOD) {
-        error = Errors::ERROR_SERVER_PROCEDURE_IS_METHOD;
-      } else if (!proc.ValdiateParameters(request[KEY_REQUEST_PARAMETERS])) {
-        error = Errors::ERROR_RPC_INVALID_PARAMS;
-      }
-    } else {
-      error = Errors::ERROR_RPC_METHOD_NOT_FOUND;
-    }
+  bool timed = this->statistics != NULL || this->tracer != NULL;
+  uint64_t start = timed ? ITracer::Now() : 0;
+  Procedure *proc = NULL;
+  int error = this->ValidateEnvelope(request, proc);
+  if (error == 0 && !proc->ValdiateParameters(request[KEY_REQUEST_PARAMETERS])) {
+    error = Errors::ERROR_RPC_INVALID_PARAMS;
   }
+
+  if (timed)
+    this->FinishValidation(request, error, start);
   return error;
 }
+
+int AbstractProtocolHandler::ValidateEnvelope(const Json::Value &request, Procedure *&proc) {
+  if (!this->ValidateRequestFields(request))
+    return Errors::ERROR_RPC_INVALID_REQUEST;
+  map<string, Procedure>::iterator it = this->procedures.find(request[KEY_REQUEST_METHODNAME].asString());
+  if (it == this->procedures.end())
+    return Errors::ERROR_RPC_METHOD_NOT_FOUND;
+  proc = &it->second;
+  if (this->GetRequestType(request) == RPC_METHOD && proc->GetProcedureType() == RPC_NOTIFICATION)
+    return Errors::ERROR_SERVER_PROCEDURE_IS_NOTIFICATION;
+  if (this->GetRequestType(request) == RPC_NOTIFICATION && proc->GetProcedureType() == RPC_METHOD)
+    return Errors::ERROR_SERVER_PROCEDURE_IS_METHOD;
+  return 0;
+}
+
+void AbstractProtocolHandler::FinishValidation(const Json::Value &request, int error, uint64_t start) {
+  uint64_t end = ITracer::Now();
+  if (this->statistics != NULL)
+    this->RecordValidation(request, error, end - start);
+  if (this->tracer != NULL)
+    this->Trace(STAGE_VALIDATE, request, start, end);
+}
+
+void AbstractProtocolHandler::RecordValidation(const Json::Value &request, int error, uint64_t elapsed) {
+  ProcedureStatistics *stats = NULL;
+  if (request.isObject() && request.isMember(KEY_REQUEST_METHODNAME) && request[KEY_REQUEST_METHODNAME].isString()) {
+    stats = this->statistics->Find(request[KEY_REQUEST_METHODNAME].asString());
+  }
+
+  ProcedureStatistics &total = this->statistics->GetTotal();
+  total.RecordCall();
+  total.RecordLatency(PHASE_VALIDATE, elapsed);
+  if (error != 0)
+    total.RecordError(error);
+
+  if (stats != NULL) {
+    stats->RecordCall();
+    stats->RecordLatency(PHASE_VALIDATE, elapsed);
+    if (error != 0)
+      stats->RecordError(error);
+  }
+}
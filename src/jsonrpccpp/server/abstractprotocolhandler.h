@@ -12,7 +12,12 @@
 
 #include "iclientconnectionhandler.h"
 #include "iprocedureinvokationhandler.h"
+#include "serverstatistics.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/jsonenvelope.h>
 #include <jsonrpccpp/common/procedure.h>
+#include <jsonrpccpp/common/tracing.h>
 #include <map>
 #include <string>
 
@@ -21,6 +26,7 @@
 #define KEY_REQUEST_PARAMETERS "params"
 #define KEY_RESPONSE_ERROR "error"
 #define KEY_RESPONSE_RESULT "result"
+#define RPC_STATS_METHOD "rpc.stats"
 
 namespace jsonrpc {
 
@@ -30,8 +36,26 @@ namespace jsonrpc {
     virtual ~AbstractProtocolHandler();
 
     void HandleRequest(const std::string &request, std::string &retValue);
+    void HandleEncodedRequest(const std::string &request, std::string &retValue, codec_t codec);
 
     virtual void AddProcedure(const Procedure &procedure);
+    virtual void SetStatistics(ServerStatistics *statistics, bool expose);
+    virtual void SetTracer(ITracer *tracer);
+    virtual void SetLazyParsing(bool enabled);
+    virtual void RecordDeferredInvocation(const Procedure &proc, uint64_t start, const JsonRpcException *error);
+
+    /**
+     * Reports a span of request to the tracer, which must be set.
+     */
+    void Trace(stage_t stage, const Json::Value &request, uint64_t start, uint64_t end);
+
+    /**
+     * Validates a single request by its envelope and admits it, only then
+     * its params are parsed into request.
+     * @return false if the request was rejected, response holds the error.
+     * @throws Json::Exception if the params turn out to be malformed.
+     */
+    bool AcceptEnvelope(JsonEnvelope &envelope, Json::Value &request, Json::Value &response);
 
     virtual void HandleJsonRequest(const Json::Value &request, Json::Value &response) = 0;
     virtual bool ValidateRequestFields(const Json::Value &val) = 0;
@@ -42,9 +66,29 @@ namespace jsonrpc {
   protected:
     IProcedureInvokationHandler &handler;
     std::map<std::string, Procedure> procedures;
+    ServerStatistics *statistics;
+    bool exposeStatistics;
+    ITracer *tracer;
+    bool lazy;
 
     void ProcessRequest(const Json::Value &request, Json::Value &retValue);
     int ValidateRequest(const Json::Value &val);
+    void RecordValidation(const Json::Value &request, int error, uint64_t elapsed);
+
+    /**
+     * Checks everything but the params of a request.
+     * @param proc Set to the called procedure if it exists.
+     * @return 0 or the error code.
+     */
+    int ValidateEnvelope(const Json::Value &request, Procedure *&proc);
+
+  private:
+    /**
+     * @return false if a notification has been queued instead of being invoked.
+     */
+    bool InvokeProcedure(Procedure &method, const Json::Value &request, Json::Value &response);
+    void RecordInvocation(const Procedure &method, const Json::Value &request, uint64_t start, const JsonRpcException *error);
+    void FinishValidation(const Json::Value &request, int error, uint64_t start);
   };
 
 } // namespace jsonrpc
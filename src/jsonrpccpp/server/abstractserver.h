@@ -11,10 +11,19 @@
 #define JSONRPC_CPP_ABSTRACTSERVER_H_
 
 #include "abstractserverconnector.h"
+#include "concurrencylimiter.h"
 #include "iclientconnectionhandler.h"
 #include "iprocedureinvokationhandler.h"
+#include "notificationqueue.h"
 #include "requesthandlerfactory.h"
+#include "resultcache.h"
+#include "singleflight.h"
+#include "serverstatistics.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/tracing.h>
 #include <jsonrpccpp/common/procedure.h>
+#include <exception>
 #include <map>
 #include <string>
 #include <vector>
@@ -27,28 +36,287 @@ namespace jsonrpc {
     typedef void (S::*methodPointer_t)(const Json::Value &parameter, Json::Value &result);
     typedef void (S::*notificationPointer_t)(const Json::Value &parameter);
 
-    AbstractServer(AbstractServerConnector &connector, serverVersion_t type = JSONRPC_SERVER_V2) : connection(connector) {
+    AbstractServer(AbstractServerConnector &connector, serverVersion_t type = JSONRPC_SERVER_V2) : connection(connector), statistics(NULL), notificationQueue(NULL) {
       this->handler = RequestHandlerFactory::createProtocolHandler(type, *this);
       connector.SetHandler(this->handler);
     }
 
-    virtual ~AbstractServer() { delete this->handler; }
+    /**
+     * Servers using EnableAsyncNotifications have to call StopNotifications()
+     * in the destructor of the most derived class. By the time this destructor
+     * runs S has been destroyed, notifications still queued are discarded,
+     * but a batch the queue is handling would run on the destroyed parts.
+     */
+    virtual ~AbstractServer() {
+      delete this->notificationQueue;
+      delete this->handler;
+      delete this->statistics;
+      for (std::map<std::string, ResultCache *>::iterator it = this->caches.begin(); it != this->caches.end(); ++it)
+        delete it->second;
+      for (std::map<std::string, SingleFlight *>::iterator it = this->flights.begin(); it != this->flights.end(); ++it)
+        delete it->second;
+      for (std::map<std::string, ConcurrencyLimiter *>::iterator it = this->limiters.begin(); it != this->limiters.end(); ++it)
+        delete it->second;
+    }
 
     bool StartListening() { return connection.StartListening(); }
 
-    bool StopListening() { return connection.StopListening(); }
+    /**
+     * Stops the connector and, with EnableAsyncNotifications, waits for the
+     * queued notifications to be handled. Call it before destroying the
+     * server, queued notifications are handled by its methods.
+     */
+    bool StopListening() {
+      bool result = connection.StopListening();
+      if (this->notificationQueue != NULL)
+        this->notificationQueue->Flush();
+      return result;
+    }
+
+    /**
+     * Handles the notifications queued by EnableAsyncNotifications and stops
+     * its background thread, later notifications are handled synchronously.
+     * Has to be called from the destructor of the most derived class, while
+     * the methods handling the notifications still exist, or once the
+     * connector has been stopped.
+     */
+    void StopNotifications() {
+      if (this->notificationQueue == NULL)
+        return;
+      this->notificationQueue->Flush();
+      delete this->notificationQueue;
+      this->notificationQueue = NULL;
+    }
+
+    /**
+     * Starts collecting per procedure call counts, errors, sizes and latencies.
+     * Has to be called before StartListening.
+     * @param expose Whether to answer the built-in rpc.stats method with the statistics.
+     */
+    void EnableStatistics(bool expose = false) {
+      if (this->statistics == NULL)
+        this->statistics = new ServerStatistics();
+      this->handler->SetStatistics(this->statistics, expose);
+    }
+
+    /**
+     * @return The collected statistics or NULL if EnableStatistics has not been called.
+     */
+    const ServerStatistics *GetStatistics() const { return this->statistics; }
+
+    /**
+     * Reports the parse, validate, invoke and serialize stage of every request
+     * to tracer. Has to be called before StartListening, NULL disables tracing.
+     */
+    void SetTracer(ITracer *tracer) { this->handler->SetTracer(tracer); }
+
+    /**
+     * Parses only the envelope of single JSON requests (jsonrpc, method, id,
+     * deadline, ...) first. Requests that are invalid, call unknown
+     * procedures, have expired or exceed a concurrency limit are rejected
+     * before their params are parsed. Has to be called before StartListening.
+     */
+    void SetLazyParsing(bool enabled) { this->handler->SetLazyParsing(enabled); }
+
+    /**
+     * Queues validated notifications and returns to the connection right
+     * away, they are handled in order by a single background thread. While
+     * the queue is full notifications are handled by the connection's thread
+     * as before. With batch > 1, consecutive notifications of a procedure
+     * that queued up are handed to invokeNotificationBatch together.
+     * The background thread has the trace id and deadline of the request,
+     * and its invocations are accounted in the statistics and traced.
+     * Has to be called before StartListening, see StopNotifications for
+     * destroying the server.
+     * @param capacity Maximum number of queued notifications.
+     * @param batch Maximum number of notifications handled at once.
+     */
+    void EnableAsyncNotifications(size_t capacity = NOTIFICATION_QUEUE_DEFAULT_CAPACITY, size_t batch = 1) {
+      delete this->notificationQueue;
+      this->notificationQueue =
+          new NotificationQueue([this](Procedure &proc, const std::vector<Json::Value> &inputs) { this->handleQueuedNotifications(proc, inputs); }, capacity, batch);
+    }
+
+    /**
+     * @return The queue of EnableAsyncNotifications, to Flush it or read its
+     * counters, or NULL if notifications are handled synchronously.
+     */
+    NotificationQueue *GetNotificationQueue() { return this->notificationQueue; }
+
+    /**
+     * Caches the results of a method by its parameters, for procedures whose
+     * result only depends on them. Errors are never cached.
+     * Has to be called before StartListening.
+     * @param procedure The name of a bound method.
+     * @param ttl Time to live of a result in milliseconds, 0 keeps it until it is evicted.
+     * @param capacity Maximum number of cached results.
+     * @return false if procedure is not a bound method.
+     */
+    bool EnableCache(const std::string &procedure, long ttl = 0, size_t capacity = RESULT_CACHE_DEFAULT_CAPACITY) {
+      if (!this->methodExists(procedure))
+        return false;
+      delete this->caches[procedure];
+      this->caches[procedure] = new ResultCache(capacity, ttl);
+      return true;
+    }
+
+    /**
+     * @return The cache of procedure, to invalidate entries or read its hit
+     * and miss counters, or NULL if caching is not enabled for it.
+     */
+    ResultCache *GetCache(const std::string &procedure) {
+      std::map<std::string, ResultCache *>::iterator it = this->caches.find(procedure);
+      return it != this->caches.end() ? it->second : NULL;
+    }
+
+    /**
+     * Lets concurrent calls of a method with identical parameters wait for a
+     * single execution and share its result or error. Combined with
+     * EnableCache, only one of the calls missing the cache executes.
+     * Has to be called before StartListening.
+     * @param procedure The name of a bound method.
+     * @return false if procedure is not a bound method.
+     */
+    bool EnableCoalescing(const std::string &procedure) {
+      if (!this->methodExists(procedure))
+        return false;
+      if (this->flights.find(procedure) == this->flights.end())
+        this->flights[procedure] = new SingleFlight();
+      return true;
+    }
+
+    /**
+     * @return The coalescing state of procedure, to read its counters, or
+     * NULL if coalescing is not enabled for it.
+     */
+    SingleFlight *GetCoalescing(const std::string &procedure) {
+      std::map<std::string, SingleFlight *>::iterator it = this->flights.find(procedure);
+      return it != this->flights.end() ? it->second : NULL;
+    }
+
+    /**
+     * Limits the number of concurrent calls of a procedure. Calls beyond the
+     * limit fail immediately with Errors::ERROR_SERVER_OVERLOADED.
+     * If target is given, the limit adapts between min and max to keep the
+     * latency of the procedure below target milliseconds.
+     * Has to be called before StartListening.
+     * @return false if procedure is not bound.
+     */
+    bool SetConcurrencyLimit(const std::string &procedure, size_t min, size_t max, long target = 0) {
+      if (!this->symbolExists(procedure))
+        return false;
+      delete this->limiters[procedure];
+      this->limiters[procedure] = new ConcurrencyLimiter(min, max, target);
+      return true;
+    }
+
+    bool SetConcurrencyLimit(const std::string &procedure, size_t limit) { return this->SetConcurrencyLimit(procedure, limit, limit); }
+
+    /**
+     * @return The limiter of procedure, to read its current limit and
+     * counters, or NULL if it is not limited.
+     */
+    ConcurrencyLimiter *GetConcurrencyLimit(const std::string &procedure) {
+      std::map<std::string, ConcurrencyLimiter *>::iterator it = this->limiters.find(procedure);
+      return it != this->limiters.end() ? it->second : NULL;
+    }
 
     virtual void HandleMethodCall(Procedure &proc, const Json::Value &input, Json::Value &output) {
+      ResultCache *cache = this->caches.empty() ? NULL : this->GetCache(proc.GetProcedureName());
+      SingleFlight *flight = this->flights.empty() ? NULL : this->GetCoalescing(proc.GetProcedureName());
+      ConcurrencyLimiter *limiter = this->limiters.empty() ? NULL : this->GetConcurrencyLimit(proc.GetProcedureName());
+      if (cache == NULL && flight == NULL) {
+        ConcurrencyPermit permit(limiter);
+        this->invokeMethod(proc, input, output);
+        return;
+      }
+
+      std::string key = ResultCache::GetKey(input);
+      if (cache != NULL && cache->Get(key, output))
+        return;
+      // Coalesced calls wait for the running one and don't need a slot of their own.
+      if (flight != NULL) {
+        bool shared = flight->Do(key,
+                                 [this, &proc, limiter, &input](Json::Value &result) {
+                                   ConcurrencyPermit permit(limiter);
+                                   this->invokeMethod(proc, input, result);
+                                 },
+                                 output);
+        if (shared)
+          return;
+      } else {
+        ConcurrencyPermit permit(limiter);
+        this->invokeMethod(proc, input, output);
+      }
+      if (cache != NULL)
+        cache->Put(key, output);
+    }
+
+    virtual bool QueueNotification(Procedure &proc, const Json::Value &input) {
+      return this->notificationQueue != NULL && this->notificationQueue->Push(proc, input);
+    }
+
+    virtual void HandleNotificationCall(Procedure &proc, const Json::Value &input) {
+      ConcurrencyPermit permit(this->limiters.empty() ? NULL : this->GetConcurrencyLimit(proc.GetProcedureName()));
+      this->invokeNotification(proc, input);
+    }
+
+    virtual bool AdmitCall(Procedure &proc) {
+      ConcurrencyLimiter *limiter = this->limiters.empty() ? NULL : this->GetConcurrencyLimit(proc.GetProcedureName());
+      return limiter == NULL || limiter->Admit();
+    }
+
+  protected:
+    /**
+     * Calls the method bound to proc. Servers generated with
+     * jsonrpcstub --cpp-server-dispatch override this with a switch over the
+     * dispatch id of proc, which calls the method without the map lookup and cast.
+     */
+    virtual void invokeMethod(const Procedure &proc, const Json::Value &input, Json::Value &output) {
       S *instance = dynamic_cast<S *>(this);
       (instance->*methods[proc.GetProcedureName()])(input, output);
     }
 
-    virtual void HandleNotificationCall(Procedure &proc, const Json::Value &input) {
+    virtual void invokeNotification(const Procedure &proc, const Json::Value &input) {
       S *instance = dynamic_cast<S *>(this);
       (instance->*notifications[proc.GetProcedureName()])(input);
     }
 
-  protected:
+    /**
+     * Handles notifications of proc queued by EnableAsyncNotifications, in
+     * the order they arrived. Override it to process batches at once, e.g.
+     * to store them with a single write.
+     */
+    virtual void invokeNotificationBatch(const Procedure &proc, const std::vector<Json::Value> &inputs) {
+      // A failing notification must not keep the rest of the batch from being handled.
+      std::exception_ptr error;
+      for (size_t i = 0; i < inputs.size(); i++) {
+        try {
+          this->invokeNotification(proc, inputs[i]);
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    /**
+     * Adds a procedure without binding it, calls of it have to be handled by
+     * an override of invokeMethod or invokeNotification.
+     * @param id Passed on to those as Procedure::GetDispatchId().
+     */
+    bool addDispatchedProcedure(const Procedure &proc, int id = -1) {
+      if (!this->symbolExists(proc.GetProcedureName())) {
+        Procedure dispatchable(proc);
+        dispatchable.SetDispatchId(id);
+        this->handler->AddProcedure(dispatchable);
+        this->dispatched[proc.GetProcedureName()] = proc.GetProcedureType();
+        return true;
+      }
+      return false;
+    }
+
     bool bindAndAddMethod(const Procedure &proc, methodPointer_t pointer) {
       if (proc.GetProcedureType() == RPC_METHOD && !this->symbolExists(proc.GetProcedureName())) {
         this->handler->AddProcedure(proc);
@@ -70,16 +338,53 @@ namespace jsonrpc {
   private:
     AbstractServerConnector &connection;
     IProtocolHandler *handler;
+    ServerStatistics *statistics;
+    NotificationQueue *notificationQueue;
     std::map<std::string, methodPointer_t> methods;
     std::map<std::string, notificationPointer_t> notifications;
+    std::map<std::string, procedure_t> dispatched;
+    std::map<std::string, ResultCache *> caches;
+    std::map<std::string, SingleFlight *> flights;
+    std::map<std::string, ConcurrencyLimiter *> limiters;
 
     bool symbolExists(const std::string &name) {
       if (methods.find(name) != methods.end())
         return true;
       if (notifications.find(name) != notifications.end())
         return true;
+      if (dispatched.find(name) != dispatched.end())
+        return true;
       return false;
     }
+
+    bool methodExists(const std::string &name) {
+      if (methods.find(name) != methods.end())
+        return true;
+      std::map<std::string, procedure_t>::iterator it = dispatched.find(name);
+      return it != dispatched.end() && it->second == RPC_METHOD;
+    }
+
+    /**
+     * Runs on the thread of the notification queue, which has the trace id
+     * and deadline of the notifications, and accounts them like requests.
+     */
+    void handleQueuedNotifications(Procedure &proc, const std::vector<Json::Value> &inputs) {
+      uint64_t start = ITracer::Now();
+      try {
+        // Drop notifications whose deadline expired while they were queued.
+        if (CancellationToken::IsCurrentCancelled())
+          throw JsonRpcException(Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+        this->invokeNotificationBatch(proc, inputs);
+      } catch (const JsonRpcException &e) {
+        this->handler->RecordDeferredInvocation(proc, start, &e);
+        throw;
+      } catch (...) {
+        JsonRpcException error(Errors::ERROR_RPC_INTERNAL_ERROR);
+        this->handler->RecordDeferredInvocation(proc, start, &error);
+        throw;
+      }
+      this->handler->RecordDeferredInvocation(proc, start, NULL);
+    }
   };
 
 } /* namespace jsonrpc */
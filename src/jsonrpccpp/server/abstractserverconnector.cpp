@@ -14,16 +14,26 @@
 using namespace std;
 using namespace jsonrpc;
 
-AbstractServerConnector::AbstractServerConnector() { this->handler = NULL; }
+AbstractServerConnector::AbstractServerConnector() : handler(NULL), codec(CODEC_JSON), acknowledgeNotifications(true) {}
 
 AbstractServerConnector::~AbstractServerConnector() {}
 
-void AbstractServerConnector::ProcessRequest(const string &request, string &response) {
+void AbstractServerConnector::ProcessRequest(const string &request, string &response) { this->ProcessRequest(request, response, this->codec); }
+
+void AbstractServerConnector::ProcessRequest(const string &request, string &response, codec_t codec) {
   if (this->handler != NULL) {
-    this->handler->HandleRequest(request, response);
+    this->handler->HandleEncodedRequest(request, response, codec);
   }
 }
 
+void AbstractServerConnector::SetCodec(codec_t codec) { this->codec = codec; }
+
+codec_t AbstractServerConnector::GetCodec() const { return this->codec; }
+
+void AbstractServerConnector::SetAcknowledgeNotifications(bool enabled) { this->acknowledgeNotifications = enabled; }
+
+bool AbstractServerConnector::GetAcknowledgeNotifications() const { return this->acknowledgeNotifications; }
+
 void AbstractServerConnector::SetHandler(IClientConnectionHandler *handler) { this->handler = handler; }
 
 IClientConnectionHandler *AbstractServerConnector::GetHandler() { return this->handler; }
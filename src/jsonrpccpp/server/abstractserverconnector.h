@@ -35,11 +35,35 @@ namespace jsonrpc {
 
     void ProcessRequest(const std::string &request, std::string &response);
 
+    /**
+     * Processes a request in the given wire encoding, the response uses the same one.
+     */
+    void ProcessRequest(const std::string &request, std::string &response, codec_t codec);
+
+    /**
+     * Selects the wire encoding of the messages, CODEC_JSON by default.
+     * Stream connectors need FRAMING_LENGTH_PREFIX for binary codecs, the
+     * HttpServer uses it for requests without a known Content-Type.
+     */
+    void SetCodec(codec_t codec);
+    codec_t GetCodec() const;
+
+    /**
+     * Stream connectors answer requests without a response, e.g.
+     * notifications, with an empty message, which the bundled clients wait
+     * for. Servers whose clients don't read a reply to notifications can
+     * turn this off, so nothing is written back for them.
+     */
+    void SetAcknowledgeNotifications(bool enabled);
+    bool GetAcknowledgeNotifications() const;
+
     void SetHandler(IClientConnectionHandler *handler);
     IClientConnectionHandler *GetHandler();
 
   private:
     IClientConnectionHandler *handler;
+    codec_t codec;
+    bool acknowledgeNotifications;
   };
 
 } /* namespace jsonrpc */
@@ -1,9 +1,14 @@
 #include "abstractthreadedserver.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/errors.h>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/tracing.h>
 
 using namespace jsonrpc;
 using namespace std;
 
-AbstractThreadedServer::AbstractThreadedServer(size_t threads) : running(false), threadPool(threads), threads(threads) {}
+AbstractThreadedServer::AbstractThreadedServer(size_t threads)
+    : running(false), threadPool(threads), threads(threads), maxqueue(0), queued(0), rejected(0) {}
 
 AbstractThreadedServer::~AbstractThreadedServer() { this->StopListening(); }
 
@@ -37,7 +42,13 @@ void AbstractThreadedServer::ListenLoop() {
 
     if (conn > 0) {
       if (this->threads > 0) {
-        this->threadPool.enqueue(&AbstractThreadedServer::HandleConnection, this, conn);
+        if (this->maxqueue > 0 && this->queued.load(memory_order_relaxed) >= this->maxqueue) {
+          this->rejected.fetch_add(1, memory_order_relaxed);
+          this->RejectConnection(conn);
+        } else {
+          this->queued.fetch_add(1, memory_order_relaxed);
+          this->threadPool.enqueue(&AbstractThreadedServer::ProcessConnection, this, conn, ITracer::Now());
+        }
       } else {
         this->HandleConnection(conn);
       }
@@ -46,3 +57,32 @@ void AbstractThreadedServer::ListenLoop() {
     }
   }
 }
+
+void AbstractThreadedServer::ProcessConnection(int connection, uint64_t accepted) {
+  this->queued.fetch_sub(1, memory_order_relaxed);
+  // Deadlines of the requests include the time spent in the queue.
+  ArrivalContext arrival(accepted);
+  this->HandleConnection(connection);
+}
+
+void AbstractThreadedServer::RejectConnection(int connection) { this->HandleConnection(connection); }
+
+void AbstractThreadedServer::SetMaxQueueDepth(size_t depth) { this->maxqueue = depth; }
+
+size_t AbstractThreadedServer::GetQueueDepth() const { return this->queued.load(memory_order_relaxed); }
+
+uint64_t AbstractThreadedServer::GetRejected() const { return this->rejected.load(memory_order_relaxed); }
+
+const string &AbstractThreadedServer::GetOverloadedResponse() {
+  static const string response = [] {
+    Json::Value error;
+    error["jsonrpc"] = "2.0";
+    error["error"]["code"] = Errors::ERROR_SERVER_OVERLOADED;
+    error["error"]["message"] = Errors::GetErrorMessage(Errors::ERROR_SERVER_OVERLOADED);
+    error["id"] = Json::nullValue;
+    Json::StreamWriterBuilder wbuilder;
+    wbuilder["indentation"] = "";
+    return Json::writeString(wbuilder, error);
+  }();
+  return response;
+}
@@ -3,7 +3,9 @@
 
 #include "abstractserverconnector.h"
 #include "threadpool.h"
+#include <atomic>
 #include <memory>
+#include <stdint.h>
 #include <thread>
 
 namespace jsonrpc {
@@ -15,6 +17,23 @@ namespace jsonrpc {
     virtual bool StartListening();
     virtual bool StopListening();
 
+    /**
+     * @brief Bounds the number of accepted connections waiting for a worker
+     * thread. Connections beyond it are passed to RejectConnection.
+     * @param depth The maximum queue depth, 0 for no limit (default).
+     */
+    void SetMaxQueueDepth(size_t depth);
+
+    /**
+     * @return The number of connections waiting for a worker thread.
+     */
+    size_t GetQueueDepth() const;
+
+    /**
+     * @return The number of connections passed to RejectConnection.
+     */
+    uint64_t GetRejected() const;
+
   protected:
     /**
      * @brief InitializeListener should initialize sockets, file descriptors etc.
@@ -36,13 +55,31 @@ namespace jsonrpc {
      */
     virtual void HandleConnection(int connection) = 0;
 
+    /**
+     * @brief RejectConnection is called in the listener thread instead of
+     * HandleConnection when the queue is full, so it must not block. The
+     * default handles the connection in the listener thread, which keeps
+     * further clients waiting until a worker is free.
+     * @param connection
+     */
+    virtual void RejectConnection(int connection);
+
+    /**
+     * @return A JSON-RPC error response with Errors::ERROR_SERVER_OVERLOADED for rejected requests.
+     */
+    static const std::string &GetOverloadedResponse();
+
   private:
     bool running;
     std::unique_ptr<std::thread> listenerThread;
     ThreadPool threadPool;
     size_t threads;
+    size_t maxqueue;
+    std::atomic<size_t> queued;
+    std::atomic<uint64_t> rejected;
 
     void ListenLoop();
+    void ProcessConnection(int connection, uint64_t accepted);
   };
 } // namespace jsonrpc
 
@@ -0,0 +1,82 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    concurrencylimiter.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "concurrencylimiter.h"
+#include <algorithm>
+#include <jsonrpccpp/common/errors.h>
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/tracing.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+ConcurrencyLimiter::ConcurrencyLimiter(size_t min, size_t max, long target)
+    : min(std::max<size_t>(1, min)), max(std::max(std::max<size_t>(1, min), max)), target(target > 0 ? static_cast<uint64_t>(target) * 1000000 : 0),
+      limit(this->max), inflight(0), succeeded(0), lastdecrease(0), rejected(0) {}
+
+bool ConcurrencyLimiter::TryAcquire() {
+  size_t current = this->inflight.load(memory_order_relaxed);
+  do {
+    if (current >= this->limit.load(memory_order_relaxed)) {
+      this->rejected.fetch_add(1, memory_order_relaxed);
+      return false;
+    }
+  } while (!this->inflight.compare_exchange_weak(current, current + 1, memory_order_acquire, memory_order_relaxed));
+  return true;
+}
+
+bool ConcurrencyLimiter::Admit() {
+  if (this->inflight.load(memory_order_relaxed) < this->limit.load(memory_order_relaxed))
+    return true;
+  this->rejected.fetch_add(1, memory_order_relaxed);
+  return false;
+}
+
+void ConcurrencyLimiter::Release(uint64_t latency) {
+  this->inflight.fetch_sub(1, memory_order_release);
+  if (this->target == 0) {
+    return;
+  }
+
+  size_t current = this->limit.load(memory_order_relaxed);
+  if (latency > this->target) {
+    uint64_t now = ITracer::Now();
+    uint64_t last = this->lastdecrease.load(memory_order_relaxed);
+    if (now - last >= this->target && this->lastdecrease.compare_exchange_strong(last, now, memory_order_relaxed)) {
+      size_t decreased = current - std::max<size_t>(1, current / 10);
+      this->limit.store(std::max(this->min, decreased), memory_order_relaxed);
+      this->succeeded.store(0, memory_order_relaxed);
+    }
+  } else if (this->succeeded.fetch_add(1, memory_order_relaxed) + 1 >= current && current < this->max) {
+    this->succeeded.store(0, memory_order_relaxed);
+    this->limit.compare_exchange_strong(current, current + 1, memory_order_relaxed);
+  }
+}
+
+size_t ConcurrencyLimiter::GetLimit() const { return this->limit.load(memory_order_relaxed); }
+
+size_t ConcurrencyLimiter::GetInFlight() const { return this->inflight.load(memory_order_relaxed); }
+
+uint64_t ConcurrencyLimiter::GetRejected() const { return this->rejected.load(memory_order_relaxed); }
+
+ConcurrencyPermit::ConcurrencyPermit(ConcurrencyLimiter *limiter) : limiter(limiter), start(0) {
+  if (limiter == NULL) {
+    return;
+  }
+  if (!limiter->TryAcquire()) {
+    throw JsonRpcException(Errors::ERROR_SERVER_OVERLOADED);
+  }
+  this->start = ITracer::Now();
+}
+
+ConcurrencyPermit::~ConcurrencyPermit() {
+  if (this->limiter != NULL) {
+    this->limiter->Release(ITracer::Now() - this->start);
+  }
+}
@@ -0,0 +1,93 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    concurrencylimiter.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_CONCURRENCYLIMITER_H
+#define JSONRPC_CPP_CONCURRENCYLIMITER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace jsonrpc {
+
+  /**
+   * Limits the number of concurrent executions of a procedure.
+   *
+   * With a fixed limit (min == max) calls beyond it are rejected. With a
+   * target latency the limit adapts between min and max: it grows by one
+   * after a limit's worth of calls finished within the target and shrinks
+   * by 10% when a call takes longer, at most once per target latency.
+   */
+  class ConcurrencyLimiter {
+  public:
+    /**
+     * @param min The lowest limit.
+     * @param max The highest and initial limit.
+     * @param target Latency in milliseconds to adapt to, 0 for a fixed limit.
+     */
+    ConcurrencyLimiter(size_t min, size_t max, long target = 0);
+
+    /**
+     * @return false if the limit is reached, otherwise the call has to Release.
+     */
+    bool TryAcquire();
+
+    /**
+     * Checks for a free slot without taking it, to turn calls away before
+     * any work is spent on them. A rejection is counted like in TryAcquire.
+     * @return false if the limit is reached right now.
+     */
+    bool Admit();
+
+    /**
+     * @param latency Duration of the call in nanoseconds.
+     */
+    void Release(uint64_t latency);
+
+    size_t GetLimit() const;
+    size_t GetInFlight() const;
+    uint64_t GetRejected() const;
+
+  private:
+    size_t min;
+    size_t max;
+    uint64_t target;
+    std::atomic<size_t> limit;
+    std::atomic<size_t> inflight;
+    std::atomic<size_t> succeeded;
+    std::atomic<uint64_t> lastdecrease;
+    std::atomic<uint64_t> rejected;
+
+    ConcurrencyLimiter(const ConcurrencyLimiter &);
+    ConcurrencyLimiter &operator=(const ConcurrencyLimiter &);
+  };
+
+  /**
+   * Holds a slot of a ConcurrencyLimiter for its lifetime.
+   */
+  class ConcurrencyPermit {
+  public:
+    /**
+     * @param limiter May be NULL, then there is no limit.
+     * @throws JsonRpcException ERROR_SERVER_OVERLOADED if the limit is reached.
+     */
+    explicit ConcurrencyPermit(ConcurrencyLimiter *limiter);
+    ~ConcurrencyPermit();
+
+  private:
+    ConcurrencyLimiter *limiter;
+    uint64_t start;
+
+    ConcurrencyPermit(const ConcurrencyPermit &);
+    ConcurrencyPermit &operator=(const ConcurrencyPermit &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_CONCURRENCYLIMITER_H
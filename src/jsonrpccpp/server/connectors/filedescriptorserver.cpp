@@ -27,15 +27,21 @@ using namespace std;
 #define READ_TIMEOUT 0.001 // Set timeout in seconds
 
 FileDescriptorServer::FileDescriptorServer(int inputfd, int outputfd)
-    : AbstractThreadedServer(0), inputfd(inputfd), outputfd(outputfd), reader(DEFAULT_BUFFER_SIZE) {}
+    : AbstractThreadedServer(0), inputfd(inputfd), outputfd(outputfd), reader(DEFAULT_BUFFER_SIZE), framing(FRAMING_DELIMITER), ended(false) {}
 
 bool FileDescriptorServer::InitializeListener() {
   if (!IsReadable(inputfd) || !IsWritable(outputfd))
     return false;
+  this->ended = false;
   return true;
 }
 
 int FileDescriptorServer::CheckForConnection() {
+  if (this->ended)
+    return 0;
+  // A previous read may already have received the next request.
+  if (reader.Pending() > 0)
+    return 1;
   FD_ZERO(&read_fds);
   FD_ZERO(&write_fds);
   FD_ZERO(&except_fds);
@@ -49,12 +55,20 @@ int FileDescriptorServer::CheckForConnection() {
 void FileDescriptorServer::HandleConnection(int connection) {
   (void)(connection);
   string request, response;
-  reader.Read(request, inputfd, DEFAULT_DELIMITER_CHAR);
-  this->ProcessRequest(request, response);
-  response.append(1, DEFAULT_DELIMITER_CHAR);
-  writer.Write(response, outputfd);
+  bool complete = reader.ReadMessage(request, inputfd, this->framing);
+  // The input is exhausted, select keeps reporting it readable from now on.
+  if (!complete)
+    this->ended = true;
+  // A last message may be terminated by the end of the stream instead of a delimiter.
+  if (complete || (this->framing == FRAMING_DELIMITER && !request.empty())) {
+    this->ProcessRequest(request, response);
+    if (!response.empty() || this->GetAcknowledgeNotifications())
+      writer.WriteMessage(response, outputfd, this->framing);
+  }
 }
 
+void FileDescriptorServer::SetFraming(framing_t framing) { this->framing = framing; }
+
 bool FileDescriptorServer::IsReadable(int fd) {
   int o_accmode = 0;
   int ret = fcntl(fd, F_GETFL, &o_accmode);
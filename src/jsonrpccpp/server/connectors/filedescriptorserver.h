@@ -13,6 +13,7 @@
 #include "../../common/streamreader.h"
 #include "../../common/streamwriter.h"
 #include "../abstractthreadedserver.h"
+#include <atomic>
 #include <pthread.h>
 #include <string>
 #include <sys/select.h>
@@ -38,11 +39,22 @@ namespace jsonrpc {
     virtual int CheckForConnection();
     virtual void HandleConnection(int connection);
 
+    /**
+     * @brief Selects how messages are separated on the stream, clients have
+     * to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
+
   protected:
     int inputfd;
     int outputfd;
     StreamReader reader;
     StreamWriter writer;
+    framing_t framing;
+    /**
+     * Set once the input has ended, a closed input never becomes readable again.
+     */
+    std::atomic<bool> ended;
 
     bool IsReadable(int fd);
     bool IsWritable(int fd);
@@ -8,10 +8,12 @@
  ************************************************************************/
 
 #include "httpserver.h"
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <jsonrpccpp/common/specificationparser.h>
+#include <jsonrpccpp/common/tracing.h>
 #include <sstream>
 
 using namespace jsonrpc;
@@ -25,10 +27,12 @@ struct mhd_coninfo {
   stringstream request;
   HttpServer *server;
   int code;
+  codec_t codec;
 };
 
 HttpServer::HttpServer(int port, const std::string &sslcert, const std::string &sslkey, int threads)
-    : AbstractServerConnector(), port(port), threads(threads), running(false), path_sslcert(sslcert), path_sslkey(sslkey), daemon(NULL), bindlocalhost(false) {}
+    : AbstractServerConnector(), port(port), threads(threads), running(false), path_sslcert(sslcert), path_sslkey(sslkey), daemon(NULL), bindlocalhost(false),
+      metrics(false), statistics(NULL), requests(0), inflight(0) {}
 
 HttpServer::~HttpServer() {}
 
@@ -106,7 +110,7 @@ bool HttpServer::SendResponse(const string &response, void *addInfo) {
   struct mhd_coninfo *client_connection = static_cast<struct mhd_coninfo *>(addInfo);
   struct MHD_Response *result = MHD_create_response_from_buffer(response.size(), (void *)response.c_str(), MHD_RESPMEM_MUST_COPY);
 
-  MHD_add_response_header(result, "Content-Type", "application/json");
+  MHD_add_response_header(result, "Content-Type", Codec::GetContentType(client_connection->codec));
   MHD_add_response_header(result, "Access-Control-Allow-Origin", "*");
 
   int ret = MHD_queue_response(client_connection->connection, client_connection->code, result);
@@ -128,6 +132,56 @@ bool HttpServer::SendOptionsResponse(void *addInfo) {
   return ret == MHD_YES;
 }
 
+HttpServer &HttpServer::EnableMetrics(const ServerStatistics *statistics, const std::string &url) {
+  this->metrics = true;
+  this->metricsurl = url;
+  this->statistics = statistics;
+  return *this;
+}
+
+bool HttpServer::SendMetricsResponse(void *addInfo) {
+  struct mhd_coninfo *client_connection = static_cast<struct mhd_coninfo *>(addInfo);
+
+  // Everything below is a relaxed atomic load, scrapes never block request threads.
+  string body;
+  body.reserve(BUFFERSIZE);
+#if MHD_VERSION >= 0x00095300
+  const union MHD_DaemonInfo *info = MHD_get_daemon_info(this->daemon, MHD_DAEMON_INFO_CURRENT_CONNECTIONS);
+  if (info != NULL) {
+    char value[32];
+    snprintf(value, sizeof(value), "%u", info->num_connections);
+    body.append("# TYPE jsonrpc_http_connections gauge\n# HELP jsonrpc_http_connections Open client connections.\n");
+    body.append("jsonrpc_http_connections ").append(value).append("\n");
+  }
+#endif
+  char line[128];
+  snprintf(line, sizeof(line), "jsonrpc_http_threads %d\n", this->threads);
+  body.append("# TYPE jsonrpc_http_threads gauge\n# HELP jsonrpc_http_threads Size of the connection thread pool.\n").append(line);
+  snprintf(line, sizeof(line), "jsonrpc_http_requests_in_flight %ld\n", this->inflight.load(memory_order_relaxed));
+  body.append("# TYPE jsonrpc_http_requests_in_flight gauge\n# HELP jsonrpc_http_requests_in_flight Requests currently being processed.\n")
+      .append(line);
+  snprintf(line, sizeof(line), "jsonrpc_http_requests_total %llu\n", static_cast<unsigned long long>(this->requests.load(memory_order_relaxed)));
+  body.append("# TYPE jsonrpc_http_requests counter\n# HELP jsonrpc_http_requests POST requests received.\n").append(line);
+
+  // 64 bytes up to 16 MiB
+  body.append("# TYPE jsonrpc_http_request_size_bytes histogram\n# HELP jsonrpc_http_request_size_bytes Size of POST bodies.\n");
+  this->requestsizes.ToOpenMetrics("jsonrpc_http_request_size_bytes", "", 6, 24, body);
+  body.append("# TYPE jsonrpc_http_response_size_bytes histogram\n# HELP jsonrpc_http_response_size_bytes Size of responses to POST requests.\n");
+  this->responsesizes.ToOpenMetrics("jsonrpc_http_response_size_bytes", "", 6, 24, body);
+
+  if (this->statistics != NULL) {
+    this->statistics->ToOpenMetrics(body);
+  }
+  body.append("# EOF\n");
+
+  struct MHD_Response *result = MHD_create_response_from_buffer(body.size(), (void *)body.c_str(), MHD_RESPMEM_MUST_COPY);
+  MHD_add_response_header(result, "Content-Type", "application/openmetrics-text; version=1.0.0; charset=utf-8");
+
+  int ret = MHD_queue_response(client_connection->connection, client_connection->code, result);
+  MHD_destroy_response(result);
+  return ret == MHD_YES;
+}
+
 void HttpServer::SetUrlHandler(const string &url, IClientConnectionHandler *handler) {
   this->urlhandler[url] = handler;
   this->SetHandler(NULL);
@@ -140,6 +194,7 @@ HttpServer::MicroHttpdResult HttpServer::callback(void *cls, MHD_Connection *con
     struct mhd_coninfo *client_connection = new mhd_coninfo;
     client_connection->connection = connection;
     client_connection->server = static_cast<HttpServer *>(cls);
+    client_connection->codec = CODEC_JSON;
     *con_cls = client_connection;
     return MHD_YES;
   }
@@ -157,11 +212,35 @@ HttpServer::MicroHttpdResult HttpServer::callback(void *cls, MHD_Connection *con
         client_connection->code = MHD_HTTP_INTERNAL_SERVER_ERROR;
         client_connection->server->SendResponse("No client connection handler found", client_connection);
       } else {
+        HttpServer *server = client_connection->server;
+        string request = client_connection->request.str();
+        if (server->metrics) {
+          server->requests.fetch_add(1, memory_order_relaxed);
+          server->inflight.fetch_add(1, memory_order_relaxed);
+        }
         client_connection->code = MHD_HTTP_OK;
-        handler->HandleRequest(client_connection->request.str(), response);
-        client_connection->server->SendResponse(response, client_connection);
+
+        // Binary capable clients announce their encoding, the response uses the same one.
+        const char *contenttype = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Content-Type");
+        if (contenttype == NULL || !Codec::FromContentType(contenttype, client_connection->codec))
+          client_connection->codec = server->GetCodec();
+        {
+          // A trace id in the request itself takes precedence over the header.
+          const char *traceid = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, KEY_REQUEST_TRACEID);
+          TraceContext context(traceid != NULL ? traceid : "");
+          handler->HandleEncodedRequest(request, response, client_connection->codec);
+        }
+        if (server->metrics) {
+          server->inflight.fetch_sub(1, memory_order_relaxed);
+          server->requestsizes.Record(request.size());
+          server->responsesizes.Record(response.size());
+        }
+        server->SendResponse(response, client_connection);
       }
     }
+  } else if (string("GET") == method && client_connection->server->metrics && client_connection->server->metricsurl == url) {
+    client_connection->code = MHD_HTTP_OK;
+    client_connection->server->SendMetricsResponse(client_connection);
   } else if (string("OPTIONS") == method) {
     client_connection->code = MHD_HTTP_OK;
     client_connection->server->SendOptionsResponse(client_connection);
@@ -29,6 +29,8 @@ typedef intptr_t ssize_t;
 #endif
 
 #include "../abstractserverconnector.h"
+#include "../serverstatistics.h"
+#include <atomic>
 #include <map>
 #include <microhttpd.h>
 
@@ -38,6 +40,10 @@ namespace jsonrpc {
    * handle incoming Requests and send HTTP 1.1 valid responses. Note that this
    * class will always send HTTP-Status 200, even though an JSON-RPC Error might
    * have occurred. Please always check for the JSON-RPC Error Header.
+   *
+   * Requests with the Content-Type application/msgpack or application/cbor
+   * are decoded as such and answered in the same encoding, all others use
+   * the codec of SetCodec(), which defaults to JSON.
    */
   class HttpServer : public AbstractServerConnector {
   public:
@@ -64,6 +70,16 @@ namespace jsonrpc {
 
     void SetUrlHandler(const std::string &url, IClientConnectionHandler *handler);
 
+    /**
+     * Answers GET requests on url with metrics in OpenMetrics text format:
+     * open connections, requests in flight, request and response sizes and,
+     * if given, the per procedure counters of statistics.
+     * Has to be called before StartListening.
+     * @param statistics Usually AbstractServer::GetStatistics(), may be NULL.
+     * @param url The path to serve the metrics on.
+     */
+    HttpServer &EnableMetrics(const ServerStatistics *statistics = NULL, const std::string &url = "/metrics");
+
   private:
 #if MHD_VERSION >= 0x00097002
     typedef MHD_Result MicroHttpdResult;
@@ -87,7 +103,16 @@ namespace jsonrpc {
     static MicroHttpdResult callback(void *cls, struct MHD_Connection *connection, const char *url, const char *method, const char *version,
                                      const char *upload_data, size_t *upload_data_size, void **con_cls);
 
+    bool metrics;
+    std::string metricsurl;
+    const ServerStatistics *statistics;
+    std::atomic<uint64_t> requests;
+    std::atomic<long> inflight;
+    SizeHistogram requestsizes;
+    SizeHistogram responsesizes;
+
     IClientConnectionHandler *GetHandler(const std::string &url);
+    bool SendMetricsResponse(void *addInfo);
   };
 
 } /* namespace jsonrpc */
@@ -34,18 +34,26 @@ using namespace std;
 #define READ_TIMEOUT 0.001 // Set timeout in seconds
 
 LinuxSerialPortServer::LinuxSerialPortServer(const std::string &deviceName, size_t threads)
-    : AbstractThreadedServer(threads), deviceName(deviceName), reader(DEFAULT_BUFFER_SIZE) {}
+    : AbstractThreadedServer(threads), deviceName(deviceName), reader(DEFAULT_BUFFER_SIZE), framing(FRAMING_DELIMITER), failed(false) {}
 
 LinuxSerialPortServer::~LinuxSerialPortServer() { close(this->serial_fd); }
 
 bool LinuxSerialPortServer::InitializeListener() {
 
   serial_fd = open(deviceName.c_str(), O_RDWR);
+  this->failed = false;
 
   return serial_fd >= 0;
 }
 
 int LinuxSerialPortServer::CheckForConnection() {
+  // Back off for a round after a failed read instead of spinning on a device
+  // that keeps being reported readable.
+  if (this->failed.exchange(false))
+    return 0;
+  // A previous read may already have received the next request.
+  if (reader.Pending() > 0)
+    return 1;
   FD_SET(serial_fd, &read_fds);
   timeout.tv_sec = 0;
   timeout.tv_usec = (suseconds_t)(READ_TIMEOUT * 1000000);
@@ -56,8 +64,15 @@ int LinuxSerialPortServer::CheckForConnection() {
 void LinuxSerialPortServer::HandleConnection(int connection) {
   (void)(connection);
   string request, response;
-  reader.Read(request, serial_fd, DEFAULT_DELIMITER_CHAR);
-  this->ProcessRequest(request, response);
-  response.append(1, DEFAULT_DELIMITER_CHAR);
-  writer.Write(response, serial_fd);
+  bool complete = reader.ReadMessage(request, serial_fd, this->framing);
+  if (!complete)
+    this->failed = true;
+  // A last message may be terminated by the end of the stream instead of a delimiter.
+  if (complete || (this->framing == FRAMING_DELIMITER && !request.empty())) {
+    this->ProcessRequest(request, response);
+    if (!response.empty() || this->GetAcknowledgeNotifications())
+      writer.WriteMessage(response, serial_fd, this->framing);
+  }
 }
+
+void LinuxSerialPortServer::SetFraming(framing_t framing) { this->framing = framing; }
@@ -13,6 +13,7 @@
 #include "../../common/streamreader.h"
 #include "../../common/streamwriter.h"
 
+#include <atomic>
 #include <pthread.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -44,12 +45,23 @@ namespace jsonrpc {
     virtual int CheckForConnection();
     virtual void HandleConnection(int connection);
 
+    /**
+     * @brief Selects how messages are separated on the stream, clients have
+     * to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
+
   protected:
     std::string deviceName;
     int serial_fd;
 
     StreamReader reader;
     StreamWriter writer;
+    framing_t framing;
+    /**
+     * Set by a failed read, the next check for requests backs off once.
+     */
+    std::atomic<bool> failed;
 
     // For select operation
     fd_set read_fds;
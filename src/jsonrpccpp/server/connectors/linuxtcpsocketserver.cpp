@@ -27,7 +27,7 @@ using namespace jsonrpc;
 using namespace std;
 
 LinuxTcpSocketServer::LinuxTcpSocketServer(const std::string &ipToBind, const unsigned int &port, size_t threads)
-    : AbstractThreadedServer(threads), ipToBind(ipToBind), port(port) {}
+    : AbstractThreadedServer(threads), ipToBind(ipToBind), port(port), framing(FRAMING_DELIMITER) {}
 
 LinuxTcpSocketServer::~LinuxTcpSocketServer() {
   shutdown(this->socket_fd, 2);
@@ -72,16 +72,43 @@ void LinuxTcpSocketServer::HandleConnection(int connection) {
   StreamReader reader(DEFAULT_BUFFER_SIZE);
   string request, response;
 
-  reader.Read(request, connection, DEFAULT_DELIMITER_CHAR);
+  bool complete = reader.ReadMessage(request, connection, this->framing);
+  // A last message may be terminated by the end of the stream instead of a delimiter.
+  if (complete || (this->framing == FRAMING_DELIMITER && !request.empty())) {
+    this->ProcessRequest(request, response);
 
-  this->ProcessRequest(request, response);
+    if (!response.empty() || this->GetAcknowledgeNotifications()) {
+      StreamWriter writer;
+      writer.WriteMessage(response, connection, this->framing);
+    }
+  }
+  CleanClose(connection);
+}
+
+void LinuxTcpSocketServer::RejectConnection(int connection) {
+  // Consume what has already arrived without waiting, so closing doesn't reset
+  // the connection before the client has read the error.
+  char buffer[DEFAULT_BUFFER_SIZE];
+  while (recv(connection, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+  }
 
-  response.append(1, DEFAULT_DELIMITER_CHAR);
+  // The listener thread must not wait for a client that doesn't read, so the
+  // error is only sent if the kernel takes it within a few milliseconds.
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = DEFAULT_REJECT_TIMEOUT_MS * 1000;
   StreamWriter writer;
-  writer.Write(response, connection);
-  CleanClose(connection);
+  if (setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0 ||
+      !writer.WriteMessage(GetOverloadedResponse(), connection, this->framing)) {
+    // Don't leave a partial message behind for the client to read.
+    CloseByReset(connection);
+    return;
+  }
+  close(connection);
 }
 
+void LinuxTcpSocketServer::SetFraming(framing_t framing) { this->framing = framing; }
+
 bool LinuxTcpSocketServer::WaitClientClose(const int &fd, const int &timeout) {
   bool ret = false;
   int i = 0;
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "../../common/sharedconstants.h"
 #include "../abstractthreadedserver.h"
 
 namespace jsonrpc {
@@ -44,12 +45,20 @@ namespace jsonrpc {
     virtual bool InitializeListener();
     virtual int CheckForConnection();
     virtual void HandleConnection(int connection);
+    virtual void RejectConnection(int connection);
+
+    /**
+     * @brief Selects how messages are separated on the stream, clients have
+     * to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
 
   protected:
     std::string ipToBind;
     unsigned int port;
     int socket_fd;
     struct sockaddr_in address;
+    framing_t framing;
 
     /**
      * @brief A method that wait for the client to close the tcp session
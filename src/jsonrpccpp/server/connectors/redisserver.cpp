@@ -8,9 +8,37 @@
  ************************************************************************/
 
 #include "redisserver.h"
+#include <string.h>
 
 using namespace jsonrpc;
 
+/**
+ * This is a helper method for the ListenLoop. Splits a single queue item
+ * into the queue to return the response to and the request string.
+ * @param data Redis string that has been popped off the queue.
+ * @param ret_queue The return queue is returned here.
+ * @param request The request is returned here.
+ * @return Returns true on success, false otherwise.
+ */
+bool ProcessRedisItem(redisReply *data, std::string &ret_queue, std::string &request) {
+
+  // It should be a json string
+  if (data->type != REDIS_REPLY_STRING) {
+    return false;
+  }
+
+  const char *pos = static_cast<const char *>(memchr(data->str, '!', data->len));
+  if (pos == NULL) {
+    return false;
+  }
+
+  size_t split = static_cast<size_t>(pos - data->str);
+  ret_queue.assign(data->str, split);
+  request.assign(pos + 1, data->len - split - 1);
+
+  return true;
+}
+
 /**
  * This is a helper method for the ListenLoop. Checks that the request is
  * valid and then retusn the request string and the queue to return the
@@ -34,65 +62,86 @@ bool ProcessRedisReply(redisReply *req, std::string &ret_queue, std::string &req
   }
 
   // It's the second element that we care about
-  redisReply *data = req->element[1];
+  return ProcessRedisItem(req->element[1], ret_queue, request);
+}
 
-  // It should be a json string
-  if (data->type != REDIS_REPLY_STRING) {
-    return false;
+/**
+ * Opens a new connection to the redis server.
+ * @return The connection or NULL on failure.
+ */
+redisContext *ConnectRedis(const std::string &host, int port) {
+  redisContext *con = redisConnect(host.c_str(), port);
+  if (con == NULL) {
+    return NULL;
   }
-
-  std::string json(data->str, data->str + data->len * sizeof data->str[0]);
-
-  size_t pos = json.find("!");
-  if (pos == std::string::npos) {
-    return false;
+  if (con->err != 0) {
+    redisFree(con);
+    return NULL;
   }
-
-  ret_queue = json.substr(0, pos);
-  request = json.substr(pos + 1);
-
-  return true;
+  return con;
 }
 
-RedisServer::RedisServer(std::string host, int port, std::string queue) : running(false), host(host), port(port), queue(queue), con(NULL) {}
+RedisServer::RedisServer(std::string host, int port, std::string queue, size_t threads)
+    : running(false), host(host), port(port), queue(queue), threads(threads > 0 ? threads : 1), batchsize(1), con(NULL) {}
 
 bool RedisServer::StartListening() {
   if (this->running) {
     return this->running;
   }
 
-  con = redisConnect(host.c_str(), port);
+  con = ConnectRedis(host, port);
   if (con == NULL) {
     return false;
   }
-  if (con->err != 0) {
-    redisFree(con);
-    con = NULL;
-    return false;
+
+  this->workers.resize(this->threads);
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    this->workers[i].server = this;
+    this->workers[i].con = ConnectRedis(host, port);
+    if (this->workers[i].con == NULL) {
+      this->workers.resize(i);
+      this->StopListening();
+      redisFree(con);
+      con = NULL;
+      return false;
+    }
   }
 
   this->running = true;
-  int ret = pthread_create(&(this->listenning_thread), NULL, RedisServer::LaunchLoop, this);
-  this->running = static_cast<bool>(ret == 0);
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    if (pthread_create(&(this->workers[i].thread), NULL, RedisServer::LaunchLoop, &(this->workers[i])) != 0) {
+      // Workers from i on have a connection but no thread to join.
+      for (size_t j = i; j < this->workers.size(); j++)
+        redisFree(this->workers[j].con);
+      this->workers.resize(i);
+      this->StopListening();
+      return false;
+    }
+  }
 
   return this->running;
 }
 
 bool RedisServer::StopListening() {
-  if (!this->running) {
-    return true;
-  }
+  bool wasRunning = this->running;
   this->running = false;
-  pthread_join(this->listenning_thread, NULL);
-  if (con != NULL) {
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    if (wasRunning) {
+      pthread_join(this->workers[i].thread, NULL);
+    }
+    redisFree(this->workers[i].con);
+  }
+  this->workers.clear();
+  if (wasRunning && con != NULL) {
     redisFree(con);
+    con = NULL;
   }
   return !(this->running);
 }
 
 bool RedisServer::SendResponse(const std::string &response, const std::string &ret_queue) {
   redisReply *ret;
-  ret = (redisReply *)redisCommand(con, "LPUSH %s %s", ret_queue.c_str(), response.c_str());
+  ret = (redisReply *)redisCommand(con, "LPUSH %b %b", ret_queue.data(), ret_queue.size(), response.data(), response.size());
 
   if (ret == NULL) {
     return false;
@@ -107,18 +156,22 @@ bool RedisServer::SendResponse(const std::string &response, const std::string &r
   return true;
 }
 
+void RedisServer::SetBatchSize(size_t batchsize) { this->batchsize = batchsize > 0 ? batchsize : 1; }
+
 void *RedisServer::LaunchLoop(void *p_data) {
-  RedisServer *instance = reinterpret_cast<RedisServer *>(p_data);
-  ;
-  instance->ListenLoop();
+  Worker *worker = reinterpret_cast<Worker *>(p_data);
+  worker->server->ListenLoop(worker->con);
   return NULL;
 }
 
-void RedisServer::ListenLoop() {
+void RedisServer::ListenLoop(redisContext *connection) {
+  std::vector<std::string> ret_queues;
+  std::vector<std::string> requests;
+  std::string response;
+
   while (this->running) {
     redisReply *req = NULL;
-    std::string request;
-    req = (redisReply *)redisCommand(con, "BRPOP %s 1", queue.c_str());
+    req = (redisReply *)redisCommand(connection, "BRPOP %b 1", queue.data(), queue.size());
     if (req == NULL) {
       continue;
     }
@@ -128,17 +181,51 @@ void RedisServer::ListenLoop() {
       continue;
     }
 
-    std::string ret_queue;
-    bool ret = ProcessRedisReply(req, ret_queue, request);
+    ret_queues.resize(1);
+    requests.resize(1);
+    bool ret = ProcessRedisReply(req, ret_queues[0], requests[0]);
     freeReplyObject(req);
     if (ret == false) {
       continue;
     }
 
-    if (this->running) {
-      std::string response;
-      this->ProcessRequest(request, response);
-      this->SendResponse(response, ret_queue);
+    // Drain whatever else is already waiting, without blocking again.
+    if (this->batchsize > 1) {
+      req = (redisReply *)redisCommand(connection, "RPOP %b %d", queue.data(), queue.size(), static_cast<int>(this->batchsize - 1));
+      if (req != NULL) {
+        if (req->type == REDIS_REPLY_ARRAY) {
+          for (size_t i = 0; i < req->elements; i++) {
+            ret_queues.push_back(std::string());
+            requests.push_back(std::string());
+            if (!ProcessRedisItem(req->element[i], ret_queues.back(), requests.back())) {
+              ret_queues.pop_back();
+              requests.pop_back();
+            }
+          }
+        }
+        freeReplyObject(req);
+      }
+    }
+
+    if (!this->running) {
+      break;
+    }
+
+    size_t pending = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+      response.clear();
+      this->ProcessRequest(requests[i], response);
+      if (redisAppendCommand(connection, "LPUSH %b %b", ret_queues[i].data(), ret_queues[i].size(), response.data(), response.size()) == REDIS_OK) {
+        pending++;
+      }
+    }
+
+    for (size_t i = 0; i < pending; i++) {
+      void *reply = NULL;
+      if (redisGetReply(connection, &reply) != REDIS_OK) {
+        break;
+      }
+      freeReplyObject(reply);
     }
   }
 }
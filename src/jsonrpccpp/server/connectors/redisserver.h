@@ -10,9 +10,11 @@
 #ifndef JSONRPC_CPP_REDISSERVERCONNECTOR_H_
 #define JSONRPC_CPP_REDISSERVERCONNECTOR_H_
 
+#include <atomic>
 #include <hiredis/hiredis.h>
 #include <pthread.h>
 #include <string>
+#include <vector>
 
 #include "../abstractserverconnector.h"
 
@@ -25,6 +27,11 @@ namespace jsonrpc {
    * ListenLoop by trying BRPOP. When it does receive a request it grabs the
    * response/return queue name, processes the request and then uses LPUSH to
    * send the result back to the client.
+   *
+   * Every worker thread owns its own redis connection. After a successful
+   * BRPOP a worker drains up to batchsize - 1 further requests with
+   * RPOP count (redis >= 6.2) and pipelines all LPUSH replies of the batch
+   * in a single round trip.
    */
   class RedisServer : public AbstractServerConnector {
   public:
@@ -33,8 +40,9 @@ namespace jsonrpc {
      * @param host The ip address of the redis server.
      * @param port The port of the redis server.
      * @param queue The queue to listen on.
+     * @param threads The number of worker threads popping from the queue.
      */
-    RedisServer(std::string host, int port, std::string queue);
+    RedisServer(std::string host, int port, std::string queue, size_t threads = 1);
 
     /**
      * This method launches the listening loop that will handle client connections.
@@ -56,10 +64,26 @@ namespace jsonrpc {
      */
     bool SendResponse(const std::string &response, const std::string &ret_queue);
 
+    /**
+     * Set how many requests a worker may pop from the queue at once.
+     * Values greater than 1 require redis >= 6.2 (RPOP with count).
+     * @param batchsize The maximum number of requests handled per round trip.
+     */
+    void SetBatchSize(size_t batchsize);
+
   protected:
+    /**
+     * @brief State of a single listening thread.
+     */
+    struct Worker {
+      RedisServer *server;
+      redisContext *con;
+      pthread_t thread;
+    };
+
     /**
      * Callback for listening thread to start ListenLoop.
-     * @param p_data A pointer to this object.
+     * @param p_data A pointer to the Worker.
      * @return Nothing.
      */
     static void *LaunchLoop(void *p_data);
@@ -67,20 +91,21 @@ namespace jsonrpc {
     /**
      * Main loop listening for connections. The loop pops requests off the
      * servers' queue and processes them. It then calls this class's
-     * OnRequest method which handles the request and sends the response
-     * using this classes' SendResponse method.
+     * OnRequest method which handles the request and pipelines the responses
+     * back to the return queues.
+     * @param connection The connection owned by the calling worker.
      */
-    void ListenLoop();
+    void ListenLoop(redisContext *connection);
 
     /**
      * @brief Keeps track of whether the server is running.
      */
-    bool running;
+    std::atomic<bool> running;
 
     /**
-     * @brief Our listening thread
+     * @brief Our listening threads
      */
-    pthread_t listenning_thread;
+    std::vector<Worker> workers;
 
     /**
      * @brief Ip address of the redis server
@@ -98,7 +123,17 @@ namespace jsonrpc {
     std::string queue;
 
     /**
-     * @brief Our connection to the redis server
+     * @brief Number of listening threads.
+     */
+    size_t threads;
+
+    /**
+     * @brief Maximum number of requests popped per round trip.
+     */
+    size_t batchsize;
+
+    /**
+     * @brief Our connection to the redis server, used by SendResponse
      */
     redisContext *con;
   };
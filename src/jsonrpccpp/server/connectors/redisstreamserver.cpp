@@ -0,0 +1,254 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    redisstreamserver.cpp
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "redisstreamserver.h"
+#include <sstream>
+#include <string.h>
+
+using namespace jsonrpc;
+
+// Reply streams are capped, clients only ever need the latest entries.
+#define REPLY_STREAM_MAXLEN 1000
+#define READ_BLOCK_MS 1000
+
+/**
+ * Checks whether a reply element is a string equal to value.
+ */
+static bool ReplyEquals(redisReply *reply, const char *value) {
+  return reply != NULL && reply->type == REDIS_REPLY_STRING && reply->len == strlen(value) && memcmp(reply->str, value, reply->len) == 0;
+}
+
+/**
+ * Extracts the entry list of the first stream of an XREADGROUP reply.
+ * @return The entries or NULL if there are none.
+ */
+static redisReply *StreamEntries(redisReply *reply) {
+  if (reply->type != REDIS_REPLY_ARRAY || reply->elements == 0) {
+    return NULL;
+  }
+  redisReply *stream = reply->element[0];
+  if (stream->type != REDIS_REPLY_ARRAY || stream->elements != 2 || stream->element[1]->type != REDIS_REPLY_ARRAY) {
+    return NULL;
+  }
+  return stream->element[1];
+}
+
+RedisStreamServer::RedisStreamServer(std::string host, int port, std::string stream, std::string group, std::string consumer, size_t threads)
+    : running(false), host(host), port(port), stream(stream), group(group), consumer(consumer), threads(threads > 0 ? threads : 1), batchsize(1),
+      claimtimeout(0), con(NULL) {}
+
+bool RedisStreamServer::StartListening() {
+  if (this->running) {
+    return this->running;
+  }
+
+  con = redisConnect(host.c_str(), port);
+  if (con == NULL) {
+    return false;
+  }
+  if (con->err != 0 || !this->CreateGroup()) {
+    redisFree(con);
+    con = NULL;
+    return false;
+  }
+
+  this->workers.resize(this->threads);
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    Worker &worker = this->workers[i];
+    worker.server = this;
+    worker.consumer = this->consumer;
+    if (this->threads > 1) {
+      std::stringstream name;
+      name << this->consumer << "-" << i;
+      worker.consumer = name.str();
+    }
+    worker.con = redisConnect(host.c_str(), port);
+    if (worker.con == NULL || worker.con->err != 0) {
+      if (worker.con != NULL) {
+        redisFree(worker.con);
+      }
+      this->workers.resize(i);
+      this->StopListening();
+      redisFree(con);
+      con = NULL;
+      return false;
+    }
+  }
+
+  this->running = true;
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    if (pthread_create(&(this->workers[i].thread), NULL, RedisStreamServer::LaunchLoop, &(this->workers[i])) != 0) {
+      // Workers from i on have a connection but no thread to join.
+      for (size_t j = i; j < this->workers.size(); j++)
+        redisFree(this->workers[j].con);
+      this->workers.resize(i);
+      this->StopListening();
+      return false;
+    }
+  }
+
+  return this->running;
+}
+
+bool RedisStreamServer::StopListening() {
+  bool wasRunning = this->running;
+  this->running = false;
+  for (size_t i = 0; i < this->workers.size(); i++) {
+    if (wasRunning) {
+      pthread_join(this->workers[i].thread, NULL);
+    }
+    redisFree(this->workers[i].con);
+  }
+  this->workers.clear();
+  if (wasRunning && con != NULL) {
+    redisFree(con);
+    con = NULL;
+  }
+  return !(this->running);
+}
+
+bool RedisStreamServer::SendResponse(const std::string &response, const std::string &ret_stream) {
+  redisReply *ret;
+  ret = (redisReply *)redisCommand(con, "XADD %b MAXLEN ~ %d * payload %b", ret_stream.data(), ret_stream.size(), REPLY_STREAM_MAXLEN, response.data(),
+                                   response.size());
+
+  if (ret == NULL) {
+    return false;
+  }
+
+  if (ret->type != REDIS_REPLY_STRING) {
+    freeReplyObject(ret);
+    return false;
+  }
+
+  freeReplyObject(ret);
+  return true;
+}
+
+void RedisStreamServer::SetBatchSize(size_t batchsize) { this->batchsize = batchsize > 0 ? batchsize : 1; }
+
+void RedisStreamServer::SetClaimTimeout(long claimtimeout) { this->claimtimeout = claimtimeout > 0 ? claimtimeout : 0; }
+
+bool RedisStreamServer::CreateGroup() {
+  redisReply *ret;
+  ret = (redisReply *)redisCommand(con, "XGROUP CREATE %b %b $ MKSTREAM", stream.data(), stream.size(), group.data(), group.size());
+  if (ret == NULL) {
+    return false;
+  }
+
+  bool result = ret->type == REDIS_REPLY_STATUS || (ret->type == REDIS_REPLY_ERROR && strncmp(ret->str, "BUSYGROUP", 9) == 0);
+  freeReplyObject(ret);
+  return result;
+}
+
+void *RedisStreamServer::LaunchLoop(void *p_data) {
+  Worker *worker = reinterpret_cast<Worker *>(p_data);
+  worker->server->ListenLoop(*worker);
+  return NULL;
+}
+
+void RedisStreamServer::ListenLoop(Worker &worker) {
+  // Start with the requests that were delivered to this consumer but never
+  // acknowledged, then switch over to new ones.
+  const char *start = "0";
+
+  while (this->running) {
+    redisReply *reply = NULL;
+    reply = (redisReply *)redisCommand(worker.con, "XREADGROUP GROUP %b %b COUNT %d BLOCK %d STREAMS %b %s", group.data(), group.size(),
+                                       worker.consumer.data(), worker.consumer.size(), static_cast<int>(this->batchsize), READ_BLOCK_MS,
+                                       stream.data(), stream.size(), start);
+    if (reply == NULL) {
+      continue;
+    }
+
+    size_t handled = 0;
+    redisReply *entries = StreamEntries(reply);
+    if (entries != NULL) {
+      handled = this->HandleEntries(worker.con, entries);
+    }
+    freeReplyObject(reply);
+
+    if (handled > 0 || !this->running) {
+      continue;
+    }
+    start = ">";
+
+    // Nothing to do, take over requests another consumer has given up on.
+    if (this->claimtimeout > 0) {
+      reply = (redisReply *)redisCommand(worker.con, "XAUTOCLAIM %b %b %b %ld 0-0 COUNT %d", stream.data(), stream.size(), group.data(), group.size(),
+                                         worker.consumer.data(), worker.consumer.size(), this->claimtimeout, static_cast<int>(this->batchsize));
+      if (reply == NULL) {
+        continue;
+      }
+      if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 2 && reply->element[1]->type == REDIS_REPLY_ARRAY) {
+        this->HandleEntries(worker.con, reply->element[1]);
+      }
+      freeReplyObject(reply);
+    }
+  }
+}
+
+size_t RedisStreamServer::HandleEntries(redisContext *connection, redisReply *entries) {
+  std::string ret_stream;
+  std::string request;
+  std::string response;
+
+  size_t pending = 0;
+  for (size_t i = 0; i < entries->elements && this->running; i++) {
+    redisReply *entry = entries->element[i];
+    if (entry->type != REDIS_REPLY_ARRAY || entry->elements != 2 || entry->element[0]->type != REDIS_REPLY_STRING) {
+      continue;
+    }
+
+    // Entries deleted while pending come without fields, they are only acknowledged.
+    redisReply *fields = entry->element[1];
+    bool hasReply = false;
+    bool hasPayload = false;
+    if (fields->type == REDIS_REPLY_ARRAY) {
+      for (size_t j = 0; j + 1 < fields->elements; j += 2) {
+        redisReply *value = fields->element[j + 1];
+        if (value->type != REDIS_REPLY_STRING) {
+          continue;
+        }
+        if (ReplyEquals(fields->element[j], "reply")) {
+          ret_stream.assign(value->str, value->len);
+          hasReply = true;
+        } else if (ReplyEquals(fields->element[j], "payload")) {
+          request.assign(value->str, value->len);
+          hasPayload = true;
+        }
+      }
+    }
+
+    if (hasPayload) {
+      response.clear();
+      this->ProcessRequest(request, response);
+      if (hasReply && !response.empty() &&
+          redisAppendCommand(connection, "XADD %b MAXLEN ~ %d * payload %b", ret_stream.data(), ret_stream.size(), REPLY_STREAM_MAXLEN,
+                             response.data(), response.size()) == REDIS_OK) {
+        pending++;
+      }
+    }
+
+    redisReply *id = entry->element[0];
+    if (redisAppendCommand(connection, "XACK %b %b %b", stream.data(), stream.size(), group.data(), group.size(), id->str, id->len) == REDIS_OK) {
+      pending++;
+    }
+  }
+
+  for (size_t i = 0; i < pending; i++) {
+    void *reply = NULL;
+    if (redisGetReply(connection, &reply) != REDIS_OK) {
+      break;
+    }
+    freeReplyObject(reply);
+  }
+
+  return entries->elements;
+}
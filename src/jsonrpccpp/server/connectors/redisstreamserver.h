@@ -0,0 +1,181 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    redisstreamserver.h
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_REDISSTREAMSERVERCONNECTOR_H_
+#define JSONRPC_CPP_REDISSTREAMSERVERCONNECTOR_H_
+
+#include <atomic>
+#include <hiredis/hiredis.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "../abstractserverconnector.h"
+
+namespace jsonrpc {
+  /**
+   * This class is the redis streams implementation of an
+   * AbstractServerConnector. It uses hiredis to connect to a designated
+   * redis server (>= 5.0, claiming of abandoned requests needs >= 6.2).
+   *
+   * Clients append requests to a stream with XADD, storing the stream to
+   * reply to and the request in the separate fields "reply" and "payload".
+   * Every RedisStreamServer joins a consumer group on that stream and reads
+   * with XREADGROUP, so several servers share the load. A request is
+   * acknowledged with XACK only after its response has been appended to
+   * the reply stream, which gives at-least-once delivery: on startup a
+   * consumer first works off its own pending requests, and with
+   * SetClaimTimeout idle consumers take over requests that another,
+   * crashed consumer never acknowledged.
+   */
+  class RedisStreamServer : public AbstractServerConnector {
+  public:
+    /**
+     * RedisStreamServer
+     * @param host The ip address of the redis server.
+     * @param port The port of the redis server.
+     * @param stream The stream to read requests from.
+     * @param group The consumer group shared by all servers of the stream.
+     * @param consumer The name of this consumer, unique within the group.
+     * @param threads The number of worker threads reading from the stream.
+     */
+    RedisStreamServer(std::string host, int port, std::string stream, std::string group, std::string consumer, size_t threads = 1);
+
+    /**
+     * This method creates the consumer group if needed and launches the
+     * listening loop.
+     * @return true for success, false otherwise.
+     */
+    bool StartListening();
+
+    /**
+     * This method stops the listening loop.
+     * @return True if successful, false otherwise or if not listening.
+     */
+    bool StopListening();
+
+    /**
+     * This method sends the result of the RPC Call back to the client
+     * @param response The response to send to the client.
+     * @param ret_stream The stream to append the response to.
+     * @return A boolean that indicates the success or the failure of the operation.
+     */
+    bool SendResponse(const std::string &response, const std::string &ret_stream);
+
+    /**
+     * Set how many requests a worker may read from the stream at once.
+     * @param batchsize The maximum number of requests handled per round trip.
+     */
+    void SetBatchSize(size_t batchsize);
+
+    /**
+     * Set after how long an unacknowledged request of another consumer is
+     * claimed and processed again. Requires redis >= 6.2.
+     * @param claimtimeout Idle time in milliseconds, 0 disables claiming.
+     */
+    void SetClaimTimeout(long claimtimeout);
+
+  protected:
+    /**
+     * @brief State of a single listening thread.
+     */
+    struct Worker {
+      RedisStreamServer *server;
+      redisContext *con;
+      std::string consumer;
+      pthread_t thread;
+    };
+
+    /**
+     * Callback for listening thread to start ListenLoop.
+     * @param p_data A pointer to the Worker.
+     * @return Nothing.
+     */
+    static void *LaunchLoop(void *p_data);
+
+    /**
+     * Main loop reading requests of the consumer group, processing them and
+     * pipelining the responses and acknowledgements.
+     * @param worker The calling worker.
+     */
+    void ListenLoop(Worker &worker);
+
+    /**
+     * Processes a list of stream entries and pipelines an XADD of the
+     * response plus an XACK for every entry.
+     * @param connection The connection owned by the calling worker.
+     * @param entries The entries as returned by XREADGROUP or XAUTOCLAIM.
+     * @return The number of entries that have been handled.
+     */
+    size_t HandleEntries(redisContext *connection, redisReply *entries);
+
+    /**
+     * Creates the consumer group, an already existing group is fine.
+     * @return true for success, false otherwise.
+     */
+    bool CreateGroup();
+
+    /**
+     * @brief Keeps track of whether the server is running.
+     */
+    std::atomic<bool> running;
+
+    /**
+     * @brief Our listening threads
+     */
+    std::vector<Worker> workers;
+
+    /**
+     * @brief Ip address of the redis server
+     */
+    std::string host;
+
+    /**
+     * @brief port of the redis server
+     */
+    int port;
+
+    /**
+     * @brief Stream that we are reading requests from.
+     */
+    std::string stream;
+
+    /**
+     * @brief Consumer group of the stream.
+     */
+    std::string group;
+
+    /**
+     * @brief Name of this consumer within the group.
+     */
+    std::string consumer;
+
+    /**
+     * @brief Number of listening threads.
+     */
+    size_t threads;
+
+    /**
+     * @brief Maximum number of requests read per round trip.
+     */
+    size_t batchsize;
+
+    /**
+     * @brief Idle time in milliseconds before foreign requests are claimed.
+     */
+    long claimtimeout;
+
+    /**
+     * @brief Our connection to the redis server, used by SendResponse
+     */
+    redisContext *con;
+  };
+} // namespace jsonrpc
+
+#endif /* JSONRPC_CPP_REDISSTREAMSERVERCONNECTOR_H_ */
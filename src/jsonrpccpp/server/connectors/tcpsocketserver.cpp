@@ -31,11 +31,31 @@ TcpSocketServer::~TcpSocketServer() { delete this->realSocket; }
 bool TcpSocketServer::StartListening() {
   if (this->realSocket != NULL) {
     this->realSocket->SetHandler(this->GetHandler());
+    this->realSocket->SetAcknowledgeNotifications(this->GetAcknowledgeNotifications());
     return this->realSocket->StartListening();
   } else
     return false;
 }
 
+bool TcpSocketServer::SetFraming(framing_t framing) {
+#ifdef _WIN32
+  return framing == FRAMING_DELIMITER;
+#else
+  static_cast<LinuxTcpSocketServer *>(this->realSocket)->SetFraming(framing);
+  return true;
+#endif
+}
+
+bool TcpSocketServer::SetMaxQueueDepth(size_t depth) {
+#ifdef _WIN32
+  (void)depth;
+  return false;
+#else
+  static_cast<LinuxTcpSocketServer *>(this->realSocket)->SetMaxQueueDepth(depth);
+  return true;
+#endif
+}
+
 bool TcpSocketServer::StopListening() {
   if (this->realSocket != NULL)
     return this->realSocket->StopListening();
@@ -10,6 +10,7 @@
 #ifndef JSONRPC_CPP_TCPSOCKETSERVERCONNECTOR_H_
 #define JSONRPC_CPP_TCPSOCKETSERVERCONNECTOR_H_
 
+#include "../../common/sharedconstants.h"
 #include "../abstractserverconnector.h"
 
 namespace jsonrpc {
@@ -67,6 +68,22 @@ namespace jsonrpc {
      */
     bool StopListening();
 
+    /**
+     * @brief Selects how messages are separated on the tcp flow, clients
+     * have to use the same framing. FRAMING_LENGTH_PREFIX is only available
+     * in the Linux/UNIX implementation.
+     * @return false if the framing is not supported.
+     */
+    bool SetFraming(framing_t framing);
+
+    /**
+     * @brief Bounds the number of connections waiting for a worker thread,
+     * further ones are answered with Errors::ERROR_SERVER_OVERLOADED. Only
+     * available in the Linux/UNIX implementation.
+     * @return false if not supported.
+     */
+    bool SetMaxQueueDepth(size_t depth);
+
   protected:
     AbstractServerConnector *realSocket;
   };
@@ -23,7 +23,7 @@ using namespace jsonrpc;
 using namespace std;
 
 UnixDomainSocketServer::UnixDomainSocketServer(const string &socket_path, size_t threads)
-    : AbstractThreadedServer(threads), socket_path(socket_path), socket_fd(-1) {}
+    : AbstractThreadedServer(threads), socket_path(socket_path), socket_fd(-1), framing(FRAMING_DELIMITER) {}
 
 UnixDomainSocketServer::~UnixDomainSocketServer() {
   if (this->socket_fd != -1)
@@ -69,12 +69,37 @@ int UnixDomainSocketServer::CheckForConnection() {
 void UnixDomainSocketServer::HandleConnection(int connection) {
   string request, response;
   StreamReader reader(DEFAULT_BUFFER_SIZE);
-  reader.Read(request, connection, DEFAULT_DELIMITER_CHAR);
-  this->ProcessRequest(request, response);
+  bool complete = reader.ReadMessage(request, connection, this->framing);
+  // A last message may be terminated by the end of the stream instead of a delimiter.
+  if (complete || (this->framing == FRAMING_DELIMITER && !request.empty())) {
+    this->ProcessRequest(request, response);
+
+    if (!response.empty() || this->GetAcknowledgeNotifications()) {
+      StreamWriter writer;
+      writer.WriteMessage(response, connection, this->framing);
+    }
+  }
 
-  response.append(1, DEFAULT_DELIMITER_CHAR);
-  StreamWriter writer;
-  writer.Write(response, connection);
+  close(connection);
+}
 
+void UnixDomainSocketServer::RejectConnection(int connection) {
+  // Consume what has already arrived without waiting, so closing doesn't reset
+  // the connection before the client has read the error.
+  char buffer[DEFAULT_BUFFER_SIZE];
+  while (recv(connection, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+  }
+
+  // The listener thread must not wait for a client that doesn't read, so the
+  // error is only sent if the kernel takes it within a few milliseconds.
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = DEFAULT_REJECT_TIMEOUT_MS * 1000;
+  StreamWriter writer;
+  if (setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0) {
+    writer.WriteMessage(GetOverloadedResponse(), connection, this->framing);
+  }
   close(connection);
 }
+
+void UnixDomainSocketServer::SetFraming(framing_t framing) { this->framing = framing; }
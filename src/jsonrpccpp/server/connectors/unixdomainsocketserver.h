@@ -41,11 +41,19 @@ namespace jsonrpc {
     virtual bool InitializeListener();
     virtual int CheckForConnection();
     virtual void HandleConnection(int connection);
+    virtual void RejectConnection(int connection);
+
+    /**
+     * @brief Selects how messages are separated on the stream, clients have
+     * to use the same framing. Defaults to FRAMING_DELIMITER.
+     */
+    void SetFraming(framing_t framing);
 
   protected:
     std::string socket_path;
     int socket_fd;
     struct sockaddr_un address;
+    framing_t framing;
   };
 
 } /* namespace jsonrpc */
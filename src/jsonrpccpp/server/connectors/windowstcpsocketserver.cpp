@@ -165,7 +165,10 @@ DWORD WINAPI WindowsTcpSocketServer::GenerateResponse(LPVOID lp_data) {
   } while (request.find(DELIMITER_CHAR) == string::npos);
   std::string response;
   instance->ProcessRequest(request, response);
-  instance->SendResponse(response, reinterpret_cast<void *>(connection_fd));
+  if (!response.empty() || instance->GetAcknowledgeNotifications())
+    instance->SendResponse(response, reinterpret_cast<void *>(connection_fd));
+  else
+    instance->CleanClose(connection_fd);
   CloseHandle(GetCurrentThread());
   return 0; // DO NOT USE ExitThread function here! ExitThread does not call
             // destructors for allocated objects and therefore it would lead to
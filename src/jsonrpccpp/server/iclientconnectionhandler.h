@@ -10,15 +10,38 @@
 #ifndef JSONRPC_CPP_ICLIENTCONNECTIONHANDLER_H
 #define JSONRPC_CPP_ICLIENTCONNECTIONHANDLER_H
 
+#include <jsonrpccpp/common/codec.h>
+#include <stdint.h>
 #include <string>
 
 namespace jsonrpc {
   class Procedure;
+  class ServerStatistics;
+  class ITracer;
+  class JsonRpcException;
   class IClientConnectionHandler {
   public:
     virtual ~IClientConnectionHandler() {}
 
     virtual void HandleRequest(const std::string &request, std::string &retValue) = 0;
+
+    /**
+     * Handles a request in the given wire encoding and answers in the same
+     * one. The default transcodes to and from JSON text, protocol handlers
+     * decode binary messages directly.
+     */
+    virtual void HandleEncodedRequest(const std::string &request, std::string &retValue, codec_t codec) {
+      if (codec == CODEC_JSON) {
+        this->HandleRequest(request, retValue);
+        return;
+      }
+      std::string text, response;
+      // Undecodable requests are passed on empty, so the handler reports a parse error.
+      Codec::Transcode(request, codec, CODEC_JSON, text);
+      this->HandleRequest(text, response);
+      if (!response.empty())
+        Codec::Transcode(response, CODEC_JSON, codec, retValue);
+    }
   };
 
   class IProtocolHandler : public IClientConnectionHandler {
@@ -26,6 +49,37 @@ namespace jsonrpc {
     virtual ~IProtocolHandler() {}
 
     virtual void AddProcedure(const Procedure &procedure) = 0;
+
+    /**
+     * Starts accounting requests in statistics, NULL stops it.
+     * @param expose Whether to answer the built-in rpc.stats method.
+     */
+    virtual void SetStatistics(ServerStatistics *statistics, bool expose) {
+      (void)statistics;
+      (void)expose;
+    }
+
+    /**
+     * Reports the stages of each request to tracer, NULL stops it.
+     */
+    virtual void SetTracer(ITracer *tracer) { (void)tracer; }
+
+    /**
+     * Validates and admits single requests by their envelope before params are parsed.
+     */
+    virtual void SetLazyParsing(bool enabled) { (void)enabled; }
+
+    /**
+     * Accounts a notification handled after its request has been answered,
+     * like the invocation of a request, with the trace id of the calling thread.
+     * @param start When the invocation started, see ITracer::Now().
+     * @param error The error it failed with, NULL on success.
+     */
+    virtual void RecordDeferredInvocation(const Procedure &proc, uint64_t start, const JsonRpcException *error) {
+      (void)proc;
+      (void)start;
+      (void)error;
+    }
   };
 } // namespace jsonrpc
 
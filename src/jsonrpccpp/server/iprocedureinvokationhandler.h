@@ -23,6 +23,25 @@ namespace jsonrpc {
     virtual ~IProcedureInvokationHandler() {}
     virtual void HandleMethodCall(Procedure &proc, const Json::Value &input, Json::Value &output) = 0;
     virtual void HandleNotificationCall(Procedure &proc, const Json::Value &input) = 0;
+
+    /**
+     * Lets protocol handlers turn a call away before its parameters are parsed.
+     * @return false if proc can't take another call right now.
+     */
+    virtual bool AdmitCall(Procedure &proc) {
+      (void)proc;
+      return true;
+    }
+
+    /**
+     * Lets the handler take over a validated notification to handle it later.
+     * @return true if it has been queued, HandleNotificationCall is not called then.
+     */
+    virtual bool QueueNotification(Procedure &proc, const Json::Value &input) {
+      (void)proc;
+      (void)input;
+      return false;
+    }
   };
 } // namespace jsonrpc
 
@@ -0,0 +1,102 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    notificationqueue.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "notificationqueue.h"
+#include <jsonrpccpp/common/cancellation.h>
+#include <jsonrpccpp/common/tracing.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+NotificationQueue::NotificationQueue(const handler_t &handler, size_t capacity, size_t batch)
+    : handler(handler), capacity(capacity > 0 ? capacity : 1), batch(batch > 0 ? batch : 1), busy(false), stopping(false), failed(0) {
+  this->worker = thread(&NotificationQueue::Run, this);
+}
+
+NotificationQueue::~NotificationQueue() {
+  {
+    lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+    this->pending.clear();
+  }
+  this->condition.notify_one();
+  this->worker.join();
+}
+
+bool NotificationQueue::Push(Procedure &proc, const Json::Value &input) {
+  {
+    lock_guard<std::mutex> lock(this->mutex);
+    if (this->pending.size() >= this->capacity)
+      return false;
+    Notification notification;
+    notification.proc = &proc;
+    notification.input = input;
+    notification.traceid = TraceContext::GetCurrent();
+    const CancellationToken *token = CancellationToken::GetCurrent();
+    notification.deadline = token != NULL ? token->GetDeadline() : 0;
+    this->pending.push_back(std::move(notification));
+  }
+  this->condition.notify_one();
+  return true;
+}
+
+void NotificationQueue::Flush() {
+  unique_lock<std::mutex> lock(this->mutex);
+  this->drained.wait(lock, [this] { return this->pending.empty() && !this->busy; });
+}
+
+size_t NotificationQueue::GetPending() {
+  lock_guard<std::mutex> lock(this->mutex);
+  return this->pending.size();
+}
+
+uint64_t NotificationQueue::GetFailed() const { return this->failed; }
+
+void NotificationQueue::Run() {
+  unique_lock<std::mutex> lock(this->mutex);
+  while (true) {
+    this->condition.wait(lock, [this] { return this->stopping || !this->pending.empty(); });
+    if (this->pending.empty())
+      return;
+
+    size_t count = min(this->pending.size(), this->batch);
+    vector<Notification> notifications(make_move_iterator(this->pending.begin()), make_move_iterator(this->pending.begin() + count));
+    this->pending.erase(this->pending.begin(), this->pending.begin() + count);
+    this->busy = true;
+    lock.unlock();
+    this->Handle(notifications);
+    lock.lock();
+    this->busy = false;
+    if (this->pending.empty())
+      this->drained.notify_all();
+  }
+}
+
+void NotificationQueue::Handle(vector<Notification> &notifications) {
+  vector<Json::Value> inputs;
+  for (size_t i = 0; i < notifications.size(); i += inputs.size()) {
+    const Notification &first = notifications[i];
+    inputs.clear();
+    for (size_t j = i; j < notifications.size(); j++) {
+      if (notifications[j].proc != first.proc || notifications[j].traceid != first.traceid || notifications[j].deadline != first.deadline)
+        break;
+      inputs.push_back(std::move(notifications[j].input));
+    }
+    Procedure &proc = *first.proc;
+    TraceContext context(first.traceid);
+    CancellationToken token(first.deadline);
+    CancellationScope scope(token);
+    // Nobody waits for the outcome of a notification, the thread has to survive it.
+    try {
+      this->handler(proc, inputs);
+    } catch (...) {
+      this->failed++;
+    }
+  }
+}
@@ -0,0 +1,97 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    notificationqueue.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_NOTIFICATIONQUEUE_H
+#define JSONRPC_CPP_NOTIFICATIONQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/procedure.h>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#define NOTIFICATION_QUEUE_DEFAULT_CAPACITY 4096
+
+namespace jsonrpc {
+
+  /**
+   * Handles validated notifications on a single background thread, so the
+   * connection that sent them is free again as soon as they are queued.
+   * Notifications are handled in the order they were queued. Consecutive
+   * notifications of the same procedure that were queued while the thread
+   * was busy are handed over together, up to a maximum batch size.
+   * The handler runs with the TraceContext and the deadline of the thread
+   * that queued the notifications, ones that differ in them are not batched.
+   */
+  class NotificationQueue {
+  public:
+    typedef std::function<void(Procedure &proc, const std::vector<Json::Value> &inputs)> handler_t;
+
+    /**
+     * @param capacity Maximum number of queued notifications.
+     * @param batch Maximum number of notifications handed to handler at once.
+     */
+    NotificationQueue(const handler_t &handler, size_t capacity = NOTIFICATION_QUEUE_DEFAULT_CAPACITY, size_t batch = 1);
+
+    /**
+     * Discards the notifications still queued and stops the thread once the
+     * batch it is handling is done. Call Flush() first to handle them.
+     */
+    ~NotificationQueue();
+
+    /**
+     * @param proc Has to outlive the queue, e.g. be registered at the server.
+     * @return false if the queue is full, the caller has to handle input itself.
+     */
+    bool Push(Procedure &proc, const Json::Value &input);
+
+    /**
+     * Waits until every notification queued so far has been handled.
+     */
+    void Flush();
+
+    size_t GetPending();
+
+    /**
+     * @return The number of times the handler has thrown, once per batch.
+     */
+    uint64_t GetFailed() const;
+
+  private:
+    struct Notification {
+      Procedure *proc;
+      Json::Value input;
+      std::string traceid;
+      uint64_t deadline;
+    };
+
+    handler_t handler;
+    size_t capacity;
+    size_t batch;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable drained;
+    std::deque<Notification> pending;
+    bool busy;
+    bool stopping;
+    std::atomic<uint64_t> failed;
+    std::thread worker;
+
+    void Run();
+    void Handle(std::vector<Notification> &notifications);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_NOTIFICATIONQUEUE_H
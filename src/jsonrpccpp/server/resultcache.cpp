@@ -0,0 +1,102 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    resultcache.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "resultcache.h"
+#include <functional>
+
+using namespace jsonrpc;
+using namespace std;
+
+ResultCache::ResultCache(size_t capacity, long ttl, size_t shards)
+    : shards(max<size_t>(1, min(shards, capacity))), shardcapacity(0), ttl(ttl > 0 ? ttl : 0), hits(0), misses(0) {
+  this->shardcapacity = max<size_t>(1, (capacity + this->shards.size() - 1) / this->shards.size());
+}
+
+string ResultCache::GetKey(const Json::Value &params) {
+  Json::StreamWriterBuilder wbuilder;
+  wbuilder["indentation"] = "";
+  return Json::writeString(wbuilder, params);
+}
+
+bool ResultCache::Get(const string &key, Json::Value &result) {
+  Shard &shard = this->GetShard(key);
+  {
+    lock_guard<mutex> lock(shard.lock);
+    unordered_map<string, list<Entry>::iterator>::iterator it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      list<Entry>::iterator entry = it->second;
+      if (this->ttl == 0 || entry->expires > clock::now()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+        result = entry->result;
+        this->hits.fetch_add(1, memory_order_relaxed);
+        return true;
+      }
+      shard.entries.erase(entry);
+      shard.index.erase(it);
+    }
+  }
+  this->misses.fetch_add(1, memory_order_relaxed);
+  return false;
+}
+
+void ResultCache::Put(const string &key, const Json::Value &result) {
+  Shard &shard = this->GetShard(key);
+  lock_guard<mutex> lock(shard.lock);
+
+  unordered_map<string, list<Entry>::iterator>::iterator it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+  }
+  while (shard.entries.size() >= this->shardcapacity) {
+    shard.index.erase(shard.entries.back().key);
+    shard.entries.pop_back();
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.result = result;
+  entry.expires = clock::now() + chrono::milliseconds(this->ttl);
+  shard.entries.push_front(entry);
+  shard.index[key] = shard.entries.begin();
+}
+
+void ResultCache::Invalidate(const Json::Value &params) {
+  string key = GetKey(params);
+  Shard &shard = this->GetShard(key);
+  lock_guard<mutex> lock(shard.lock);
+  unordered_map<string, list<Entry>::iterator>::iterator it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+  }
+}
+
+void ResultCache::Clear() {
+  for (size_t i = 0; i < this->shards.size(); i++) {
+    lock_guard<mutex> lock(this->shards[i].lock);
+    this->shards[i].entries.clear();
+    this->shards[i].index.clear();
+  }
+}
+
+uint64_t ResultCache::GetHits() const { return this->hits.load(memory_order_relaxed); }
+
+uint64_t ResultCache::GetMisses() const { return this->misses.load(memory_order_relaxed); }
+
+size_t ResultCache::GetSize() const {
+  size_t size = 0;
+  for (size_t i = 0; i < this->shards.size(); i++) {
+    lock_guard<mutex> lock(this->shards[i].lock);
+    size += this->shards[i].entries.size();
+  }
+  return size;
+}
+
+ResultCache::Shard &ResultCache::GetShard(const string &key) { return this->shards[hash<string>()(key) % this->shards.size()]; }
@@ -0,0 +1,99 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    resultcache.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_RESULTCACHE_H
+#define JSONRPC_CPP_RESULTCACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define RESULT_CACHE_DEFAULT_CAPACITY 1024
+#define RESULT_CACHE_SHARDS 16
+
+namespace jsonrpc {
+
+  /**
+   * Size bounded LRU cache of procedure results, keyed by the canonical
+   * serialization of the parameters. Entries are spread over independently
+   * locked shards, so concurrent lookups of different parameters rarely
+   * contend. Each shard evicts its least recently used entry once it holds
+   * its share of the capacity.
+   */
+  class ResultCache {
+  public:
+    /**
+     * @param capacity Maximum number of cached results.
+     * @param ttl Time to live of an entry in milliseconds, 0 keeps entries until they are evicted.
+     * @param shards Number of independently locked shards.
+     */
+    ResultCache(size_t capacity = RESULT_CACHE_DEFAULT_CAPACITY, long ttl = 0, size_t shards = RESULT_CACHE_SHARDS);
+
+    /**
+     * @return The cache key of params. Object members are sorted by jsoncpp,
+     * so equal parameters always map to the same key.
+     */
+    static std::string GetKey(const Json::Value &params);
+
+    /**
+     * @return true if a valid entry for key was found and copied into result.
+     */
+    bool Get(const std::string &key, Json::Value &result);
+    void Put(const std::string &key, const Json::Value &result);
+
+    /**
+     * Removes the entry of a single parameter set.
+     */
+    void Invalidate(const Json::Value &params);
+
+    /**
+     * Removes all entries.
+     */
+    void Clear();
+
+    uint64_t GetHits() const;
+    uint64_t GetMisses() const;
+    size_t GetSize() const;
+
+  private:
+    typedef std::chrono::steady_clock clock;
+
+    struct Entry {
+      std::string key;
+      Json::Value result;
+      clock::time_point expires;
+    };
+
+    struct Shard {
+      mutable std::mutex lock;
+      std::list<Entry> entries;
+      std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    std::vector<Shard> shards;
+    size_t shardcapacity;
+    long ttl;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+    Shard &GetShard(const std::string &key);
+
+    ResultCache(const ResultCache &);
+    ResultCache &operator=(const ResultCache &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_RESULTCACHE_H
@@ -13,28 +13,75 @@
 using namespace jsonrpc;
 using namespace std;
 
-RpcProtocolServer12::RpcProtocolServer12(IProcedureInvokationHandler &handler) : rpc1(handler), rpc2(handler) {}
+RpcProtocolServer12::RpcProtocolServer12(IProcedureInvokationHandler &handler) : rpc1(handler), rpc2(handler), statistics(NULL), tracer(NULL), lazy(false) {}
 
 void RpcProtocolServer12::AddProcedure(const Procedure &procedure) {
   this->rpc1.AddProcedure(procedure);
   this->rpc2.AddProcedure(procedure);
 }
 
-void RpcProtocolServer12::HandleRequest(const std::string &request, std::string &retValue) {
+void RpcProtocolServer12::SetStatistics(ServerStatistics *statistics, bool expose) {
+  this->statistics = statistics;
+  this->rpc1.SetStatistics(statistics, expose);
+  this->rpc2.SetStatistics(statistics, expose);
+}
+
+void RpcProtocolServer12::SetTracer(ITracer *tracer) {
+  this->tracer = tracer;
+  this->rpc1.SetTracer(tracer);
+  this->rpc2.SetTracer(tracer);
+}
+
+void RpcProtocolServer12::SetLazyParsing(bool enabled) { this->lazy = enabled; }
+
+void RpcProtocolServer12::HandleRequest(const std::string &request, std::string &retValue) { this->HandleEncodedRequest(request, retValue, CODEC_JSON); }
+
+void RpcProtocolServer12::HandleEncodedRequest(const std::string &request, std::string &retValue, codec_t codec) {
   Json::Value req;
   Json::Value resp;
   Json::StreamWriterBuilder wbuilder;
   wbuilder["indentation"] = "";
 
+  bool timed = this->statistics != NULL || this->tracer != NULL;
+  uint64_t start = timed ? ITracer::Now() : 0;
+  uint64_t parsed = start;
   try {
-    istringstream(request) >> req;
-    this->GetHandler(req).HandleJsonRequest(req, resp);
+    JsonEnvelope envelope;
+    bool accepted = true;
+    if (this->lazy && codec == CODEC_JSON && envelope.Parse(request, KEY_REQUEST_PARAMETERS))
+      accepted = this->GetHandler(envelope.GetMembers()).AcceptEnvelope(envelope, req, resp);
+    else if (!Codec::Decode(request, codec, req))
+      throw Json::RuntimeError("Invalid message");
+    if (timed) {
+      parsed = ITracer::Now();
+      if (this->tracer != NULL)
+        this->GetHandler(req).Trace(STAGE_PARSE, req, start, parsed);
+    }
+    if (accepted)
+      this->GetHandler(req).HandleJsonRequest(req, resp);
   } catch (const Json::Exception &e) {
+    if (this->statistics != NULL)
+      this->statistics->GetTotal().RecordError(Errors::ERROR_RPC_JSON_PARSE_ERROR);
+    if (this->tracer != NULL)
+      this->GetHandler(req).Trace(STAGE_PARSE, Json::nullValue, start, ITracer::Now());
     this->GetHandler(req).WrapError(Json::nullValue, Errors::ERROR_RPC_JSON_PARSE_ERROR, Errors::GetErrorMessage(Errors::ERROR_RPC_JSON_PARSE_ERROR), resp);
   }
 
-  if (resp != Json::nullValue)
-    retValue = Json::writeString(wbuilder, resp);
+  uint64_t handled = timed ? ITracer::Now() : 0;
+  if (resp != Json::nullValue) {
+    if (codec == CODEC_JSON)
+      retValue = Json::writeString(wbuilder, resp);
+    else
+      Codec::Encode(resp, codec, retValue);
+  }
+
+  if (timed) {
+    uint64_t end = ITracer::Now();
+    if (this->statistics != NULL)
+      this->statistics->RecordMessage(req, request.size(), retValue.size(), parsed - start, end - handled);
+    if (this->tracer != NULL)
+      this->GetHandler(req).Trace(STAGE_SERIALIZE, req, handled, end);
+  }
 }
 
 AbstractProtocolHandler &RpcProtocolServer12::GetHandler(const Json::Value &request) {
@@ -22,10 +22,17 @@ namespace jsonrpc {
 
     void AddProcedure(const Procedure &procedure);
     void HandleRequest(const std::string &request, std::string &retValue);
+    void HandleEncodedRequest(const std::string &request, std::string &retValue, codec_t codec);
+    void SetStatistics(ServerStatistics *statistics, bool expose);
+    void SetTracer(ITracer *tracer);
+    void SetLazyParsing(bool enabled);
 
   private:
     RpcProtocolServerV1 rpc1;
     RpcProtocolServerV2 rpc2;
+    ServerStatistics *statistics;
+    ITracer *tracer;
+    bool lazy;
 
     AbstractProtocolHandler &GetHandler(const Json::Value &request);
   };
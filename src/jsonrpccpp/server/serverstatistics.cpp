@@ -0,0 +1,437 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    serverstatistics.cpp
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "serverstatistics.h"
+#include <jsonrpccpp/common/tracing.h>
+#include <sstream>
+#include <stdio.h>
+#include <vector>
+
+using namespace jsonrpc;
+using namespace std;
+
+#define SUB_BUCKETS (1 << STATISTICS_SUB_BUCKET_BITS)
+
+static const char *phaseNames[PHASE_COUNT] = {"parse", "validate", "invoke", "serialize"};
+
+LatencyHistogram::LatencyHistogram() : count(0), sum(0), max(0) {
+  for (size_t i = 0; i < STATISTICS_BUCKETS; i++) {
+    buckets[i].store(0, memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds) {
+  buckets[GetBucketIndex(nanoseconds)].fetch_add(1, memory_order_relaxed);
+  count.fetch_add(1, memory_order_relaxed);
+  sum.fetch_add(nanoseconds, memory_order_relaxed);
+
+  uint64_t current = max.load(memory_order_relaxed);
+  while (nanoseconds > current && !max.compare_exchange_weak(current, nanoseconds, memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::GetCount() const { return count.load(memory_order_relaxed); }
+
+uint64_t LatencyHistogram::GetSum() const { return sum.load(memory_order_relaxed); }
+
+uint64_t LatencyHistogram::GetMax() const { return max.load(memory_order_relaxed); }
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < STATISTICS_BUCKETS; i++) {
+    total += GetBucket(i);
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < STATISTICS_BUCKETS; i++) {
+    seen += GetBucket(i);
+    if (seen >= rank) {
+      return GetBucketUpperBound(i);
+    }
+  }
+  return GetBucketUpperBound(STATISTICS_BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::GetBucket(size_t index) const { return buckets[index].load(memory_order_relaxed); }
+
+size_t LatencyHistogram::GetBucketCount() { return STATISTICS_BUCKETS; }
+
+uint64_t LatencyHistogram::GetBucketUpperBound(size_t index) {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  size_t exponent = index / SUB_BUCKETS + STATISTICS_SUB_BUCKET_BITS - 1;
+  size_t shift = exponent - STATISTICS_SUB_BUCKET_BITS;
+  uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+  return lower + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+size_t LatencyHistogram::GetBucketIndex(uint64_t nanoseconds) {
+  if (nanoseconds < SUB_BUCKETS) {
+    return static_cast<size_t>(nanoseconds);
+  }
+#if defined(__GNUC__)
+  size_t exponent = static_cast<size_t>(63 - __builtin_clzll(nanoseconds));
+#else
+  size_t exponent = 0;
+  for (uint64_t value = nanoseconds; value > 1; value >>= 1) {
+    exponent++;
+  }
+#endif
+  size_t shift = exponent - STATISTICS_SUB_BUCKET_BITS;
+  size_t index = (exponent - STATISTICS_SUB_BUCKET_BITS + 1) * SUB_BUCKETS + static_cast<size_t>((nanoseconds >> shift) & (SUB_BUCKETS - 1));
+  return index < STATISTICS_BUCKETS ? index : STATISTICS_BUCKETS - 1;
+}
+
+Json::Value LatencyHistogram::ToJson() const {
+  Json::Value result;
+  uint64_t samples = GetCount();
+  result["count"] = Json::UInt64(samples);
+  result["mean"] = Json::UInt64(samples > 0 ? GetSum() / samples : 0);
+  result["p50"] = Json::UInt64(GetPercentile(50));
+  result["p90"] = Json::UInt64(GetPercentile(90));
+  result["p99"] = Json::UInt64(GetPercentile(99));
+  result["p999"] = Json::UInt64(GetPercentile(99.9));
+  result["max"] = Json::UInt64(GetMax());
+  return result;
+}
+
+/**
+ * Appends a single OpenMetrics sample line.
+ */
+static void AppendSample(string &target, const string &name, const string &labels, const char *value) {
+  target.append(name);
+  if (!labels.empty()) {
+    target.append("{").append(labels).append("}");
+  }
+  target.append(" ").append(value).append("\n");
+}
+
+static void AppendSample(string &target, const string &name, const string &labels, uint64_t value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+  AppendSample(target, name, labels, buffer);
+}
+
+static void AppendSample(string &target, const string &name, const string &labels, double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9g", value);
+  AppendSample(target, name, labels, buffer);
+}
+
+static void AppendType(string &target, const char *name, const char *type, const char *help) {
+  target.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+  target.append("# HELP ").append(name).append(" ").append(help).append("\n");
+}
+
+void LatencyHistogram::ToOpenMetrics(const string &name, const string &labels, double scale, size_t firstExponent, size_t lastExponent,
+                                     string &target) const {
+  string separator = labels.empty() ? "" : ",";
+  uint64_t cumulative = 0;
+  size_t bucket = 0;
+  for (size_t exponent = firstExponent; exponent <= lastExponent; exponent += 2) {
+    // Everything below 2^exponent is in the buckets up to the one ending at 2^exponent - 1.
+    uint64_t bound = static_cast<uint64_t>(1) << exponent;
+    size_t last = GetBucketIndex(bound - 1);
+    for (; bucket <= last && bucket < STATISTICS_BUCKETS; bucket++) {
+      cumulative += GetBucket(bucket);
+    }
+    char le[32];
+    snprintf(le, sizeof(le), "%.9g", static_cast<double>(bound) * scale);
+    AppendSample(target, name + "_bucket", labels + separator + "le=\"" + le + "\"", cumulative);
+  }
+  for (; bucket < STATISTICS_BUCKETS; bucket++) {
+    cumulative += GetBucket(bucket);
+  }
+  AppendSample(target, name + "_bucket", labels + separator + "le=\"+Inf\"", cumulative);
+  AppendSample(target, name + "_count", labels, cumulative);
+  AppendSample(target, name + "_sum", labels, static_cast<double>(GetSum()) * scale);
+}
+
+SizeHistogram::SizeHistogram() : count(0), sum(0) {
+  for (size_t i = 0; i < STATISTICS_SIZE_BUCKETS; i++) {
+    buckets[i].store(0, memory_order_relaxed);
+  }
+}
+
+void SizeHistogram::Record(uint64_t bytes) {
+  buckets[GetBucketIndex(bytes)].fetch_add(1, memory_order_relaxed);
+  count.fetch_add(1, memory_order_relaxed);
+  sum.fetch_add(bytes, memory_order_relaxed);
+}
+
+uint64_t SizeHistogram::GetCount() const { return count.load(memory_order_relaxed); }
+
+uint64_t SizeHistogram::GetSum() const { return sum.load(memory_order_relaxed); }
+
+uint64_t SizeHistogram::GetBucket(size_t index) const { return buckets[index].load(memory_order_relaxed); }
+
+size_t SizeHistogram::GetBucketCount() { return STATISTICS_SIZE_BUCKETS; }
+
+uint64_t SizeHistogram::GetBucketUpperBound(size_t index) { return static_cast<uint64_t>(1) << index; }
+
+size_t SizeHistogram::GetBucketIndex(uint64_t bytes) {
+  if (bytes <= 1) {
+    return 0;
+  }
+  // The smallest n with bytes <= 2^n, so the upper bounds are inclusive like OpenMetrics' le.
+#if defined(__GNUC__)
+  size_t index = static_cast<size_t>(64 - __builtin_clzll(bytes - 1));
+#else
+  size_t index = 0;
+  for (uint64_t value = bytes - 1; value > 0; value >>= 1) {
+    index++;
+  }
+#endif
+  return index < STATISTICS_SIZE_BUCKETS ? index : STATISTICS_SIZE_BUCKETS - 1;
+}
+
+void SizeHistogram::ToOpenMetrics(const string &name, const string &labels, size_t firstExponent, size_t lastExponent, string &target) const {
+  string separator = labels.empty() ? "" : ",";
+  uint64_t cumulative = 0;
+  size_t bucket = 0;
+  for (size_t exponent = firstExponent; exponent <= lastExponent && exponent < STATISTICS_SIZE_BUCKETS; exponent++) {
+    for (; bucket <= exponent; bucket++) {
+      cumulative += GetBucket(bucket);
+    }
+    AppendSample(target, name + "_bucket", labels + separator + "le=\"" + to_string(GetBucketUpperBound(exponent)) + "\"", cumulative);
+  }
+  for (; bucket < STATISTICS_SIZE_BUCKETS; bucket++) {
+    cumulative += GetBucket(bucket);
+  }
+  AppendSample(target, name + "_bucket", labels + separator + "le=\"+Inf\"", cumulative);
+  AppendSample(target, name + "_count", labels, cumulative);
+  AppendSample(target, name + "_sum", labels, GetSum());
+}
+
+ProcedureStatistics::ProcedureStatistics() : calls(0), errors(0), bytesIn(0), bytesOut(0) {
+  for (size_t i = 0; i < STATISTICS_ERROR_SLOTS; i++) {
+    errorCodes[i].store(0, memory_order_relaxed);
+    errorCounts[i].store(0, memory_order_relaxed);
+  }
+}
+
+void ProcedureStatistics::RecordCall() { calls.fetch_add(1, memory_order_relaxed); }
+
+void ProcedureStatistics::RecordError(int code) {
+  errors.fetch_add(1, memory_order_relaxed);
+  if (code == 0) {
+    return;
+  }
+
+  // Slots are claimed once and never released, 0 marks a free slot.
+  for (size_t i = 0; i < STATISTICS_ERROR_SLOTS; i++) {
+    int slot = errorCodes[i].load(memory_order_acquire);
+    if (slot == 0) {
+      int expected = 0;
+      if (errorCodes[i].compare_exchange_strong(expected, code, memory_order_acq_rel)) {
+        slot = code;
+      } else {
+        slot = expected;
+      }
+    }
+    if (slot == code) {
+      errorCounts[i].fetch_add(1, memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+void ProcedureStatistics::RecordBytes(size_t in, size_t out) {
+  bytesIn.fetch_add(in, memory_order_relaxed);
+  bytesOut.fetch_add(out, memory_order_relaxed);
+}
+
+void ProcedureStatistics::RecordLatency(phase_t phase, uint64_t nanoseconds) { latency[phase].Record(nanoseconds); }
+
+uint64_t ProcedureStatistics::GetCalls() const { return calls.load(memory_order_relaxed); }
+
+uint64_t ProcedureStatistics::GetErrors() const { return errors.load(memory_order_relaxed); }
+
+uint64_t ProcedureStatistics::GetErrors(int code) const {
+  for (size_t i = 0; i < STATISTICS_ERROR_SLOTS; i++) {
+    if (errorCodes[i].load(memory_order_acquire) == code) {
+      return errorCounts[i].load(memory_order_relaxed);
+    }
+  }
+  return 0;
+}
+
+uint64_t ProcedureStatistics::GetBytesIn() const { return bytesIn.load(memory_order_relaxed); }
+
+uint64_t ProcedureStatistics::GetBytesOut() const { return bytesOut.load(memory_order_relaxed); }
+
+const LatencyHistogram &ProcedureStatistics::GetLatency(phase_t phase) const { return latency[phase]; }
+
+map<int, uint64_t> ProcedureStatistics::GetErrorsByCode() const {
+  map<int, uint64_t> result;
+  for (size_t i = 0; i < STATISTICS_ERROR_SLOTS; i++) {
+    int code = errorCodes[i].load(memory_order_acquire);
+    if (code != 0) {
+      result[code] = errorCounts[i].load(memory_order_relaxed);
+    }
+  }
+  return result;
+}
+
+Json::Value ProcedureStatistics::ToJson() const {
+  Json::Value result;
+  result["calls"] = Json::UInt64(GetCalls());
+  result["errors"] = Json::UInt64(GetErrors());
+  result["errorsByCode"] = Json::Value(Json::objectValue);
+  map<int, uint64_t> codes = GetErrorsByCode();
+  for (map<int, uint64_t>::iterator it = codes.begin(); it != codes.end(); ++it) {
+    stringstream code;
+    code << it->first;
+    result["errorsByCode"][code.str()] = Json::UInt64(it->second);
+  }
+  result["bytesIn"] = Json::UInt64(GetBytesIn());
+  result["bytesOut"] = Json::UInt64(GetBytesOut());
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    result["latency"][phaseNames[i]] = latency[i].ToJson();
+  }
+  return result;
+}
+
+ServerStatistics::ServerStatistics() {}
+
+ServerStatistics::~ServerStatistics() {
+  for (map<string, ProcedureStatistics *>::iterator it = procedures.begin(); it != procedures.end(); ++it) {
+    delete it->second;
+  }
+}
+
+void ServerStatistics::Register(const string &procedure) {
+  if (procedures.find(procedure) == procedures.end()) {
+    procedures[procedure] = new ProcedureStatistics();
+  }
+}
+
+ProcedureStatistics *ServerStatistics::Find(const string &procedure) {
+  map<string, ProcedureStatistics *>::iterator it = procedures.find(procedure);
+  return it != procedures.end() ? it->second : NULL;
+}
+
+const ProcedureStatistics *ServerStatistics::Find(const string &procedure) const {
+  map<string, ProcedureStatistics *>::const_iterator it = procedures.find(procedure);
+  return it != procedures.end() ? it->second : NULL;
+}
+
+ProcedureStatistics &ServerStatistics::GetTotal() { return total; }
+
+const ProcedureStatistics &ServerStatistics::GetTotal() const { return total; }
+
+const map<string, ProcedureStatistics *> &ServerStatistics::GetProcedures() const { return procedures; }
+
+void ServerStatistics::RecordMessage(const Json::Value &request, size_t in, size_t out, uint64_t parse, uint64_t serialize) {
+  total.RecordBytes(in, out);
+  total.RecordLatency(PHASE_PARSE, parse);
+  total.RecordLatency(PHASE_SERIALIZE, serialize);
+
+  if (request.isObject() && request.isMember("method") && request["method"].isString()) {
+    ProcedureStatistics *procedure = this->Find(request["method"].asString());
+    if (procedure != NULL) {
+      procedure->RecordBytes(in, out);
+      procedure->RecordLatency(PHASE_PARSE, parse);
+      procedure->RecordLatency(PHASE_SERIALIZE, serialize);
+    }
+  }
+}
+
+uint64_t ServerStatistics::Now() { return ITracer::Now(); }
+
+Json::Value ServerStatistics::ToJson() const {
+  Json::Value result;
+  result["total"] = total.ToJson();
+  result["procedures"] = Json::Value(Json::objectValue);
+  for (map<string, ProcedureStatistics *>::const_iterator it = procedures.begin(); it != procedures.end(); ++it) {
+    result["procedures"][it->first] = it->second->ToJson();
+  }
+  return result;
+}
+
+void ServerStatistics::ToOpenMetrics(string &target) const {
+  map<string, ProcedureStatistics *>::const_iterator it;
+  vector<string> labels;
+  for (it = procedures.begin(); it != procedures.end(); ++it) {
+    labels.push_back("procedure=\"" + EscapeLabel(it->first) + "\"");
+  }
+
+  AppendType(target, "jsonrpc_requests", "counter", "JSON-RPC requests received, including invalid ones.");
+  AppendSample(target, "jsonrpc_requests_total", "", total.GetCalls());
+  AppendType(target, "jsonrpc_request_errors", "counter", "JSON-RPC requests answered with an error.");
+  AppendSample(target, "jsonrpc_request_errors_total", "", total.GetErrors());
+
+  AppendType(target, "jsonrpc_calls", "counter", "Calls by procedure.");
+  size_t i = 0;
+  for (it = procedures.begin(); it != procedures.end(); ++it, ++i) {
+    AppendSample(target, "jsonrpc_calls_total", labels[i], it->second->GetCalls());
+  }
+
+  AppendType(target, "jsonrpc_errors", "counter", "Errors by procedure and JSON-RPC error code.");
+  i = 0;
+  for (it = procedures.begin(); it != procedures.end(); ++it, ++i) {
+    map<int, uint64_t> codes = it->second->GetErrorsByCode();
+    for (map<int, uint64_t>::iterator code = codes.begin(); code != codes.end(); ++code) {
+      char value[16];
+      snprintf(value, sizeof(value), "%d", code->first);
+      AppendSample(target, "jsonrpc_errors_total", labels[i] + ",code=\"" + value + "\"", code->second);
+    }
+  }
+
+  AppendType(target, "jsonrpc_request_bytes", "counter", "Size of single requests by procedure.");
+  i = 0;
+  for (it = procedures.begin(); it != procedures.end(); ++it, ++i) {
+    AppendSample(target, "jsonrpc_request_bytes_total", labels[i], it->second->GetBytesIn());
+  }
+
+  AppendType(target, "jsonrpc_response_bytes", "counter", "Size of responses to single requests by procedure.");
+  i = 0;
+  for (it = procedures.begin(); it != procedures.end(); ++it, ++i) {
+    AppendSample(target, "jsonrpc_response_bytes_total", labels[i], it->second->GetBytesOut());
+  }
+
+  // 2^10 ns (~1us) up to 2^34 ns (~17s)
+  AppendType(target, "jsonrpc_duration_seconds", "histogram", "Time spent by procedure and processing phase.");
+  i = 0;
+  for (it = procedures.begin(); it != procedures.end(); ++it, ++i) {
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+      it->second->GetLatency(static_cast<phase_t>(phase))
+          .ToOpenMetrics("jsonrpc_duration_seconds", labels[i] + ",phase=\"" + phaseNames[phase] + "\"", 1e-9, 10, 34, target);
+    }
+  }
+}
+
+string ServerStatistics::EscapeLabel(const string &value) {
+  string result;
+  result.reserve(value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    switch (value[i]) {
+    case '\\':
+      result.append("\\\\");
+      break;
+    case '"':
+      result.append("\\\"");
+      break;
+    case '\n':
+      result.append("\\n");
+      break;
+    default:
+      result.push_back(value[i]);
+    }
+  }
+  return result;
+}
@@ -0,0 +1,224 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    serverstatistics.h
+ * @date    18.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_SERVERSTATISTICS_H
+#define JSONRPC_CPP_SERVERSTATISTICS_H
+
+#include <atomic>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <map>
+#include <stdint.h>
+#include <string>
+
+#define STATISTICS_SUB_BUCKET_BITS 2
+#define STATISTICS_MAX_EXPONENT 40
+#define STATISTICS_BUCKETS ((1 << STATISTICS_SUB_BUCKET_BITS) * (STATISTICS_MAX_EXPONENT))
+#define STATISTICS_ERROR_SLOTS 16
+#define STATISTICS_SIZE_BUCKETS 41
+
+namespace jsonrpc {
+
+  /**
+   * The stages a request passes on the server side.
+   */
+  typedef enum { PHASE_PARSE, PHASE_VALIDATE, PHASE_INVOKE, PHASE_SERIALIZE, PHASE_COUNT } phase_t;
+
+  /**
+   * Lock-free latency histogram with log-linear buckets in nanoseconds.
+   * Every power of two is split into four buckets, so a reported value is at
+   * most 25% above the measured one. Values beyond 2^40 ns (~18 minutes) end
+   * up in the last bucket.
+   */
+  class LatencyHistogram {
+  public:
+    LatencyHistogram();
+
+    void Record(uint64_t nanoseconds);
+
+    uint64_t GetCount() const;
+    uint64_t GetSum() const;
+    uint64_t GetMax() const;
+
+    /**
+     * @param percentile Between 0 and 100.
+     * @return The upper bound of the bucket holding the percentile in nanoseconds, 0 if empty.
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+    uint64_t GetBucket(size_t index) const;
+    static size_t GetBucketCount();
+    static uint64_t GetBucketUpperBound(size_t index);
+    static size_t GetBucketIndex(uint64_t nanoseconds);
+
+    Json::Value ToJson() const;
+
+    /**
+     * Appends the histogram in OpenMetrics text format, without the TYPE line.
+     * Bucket bounds are every second power of two from 2^firstExponent to
+     * 2^lastExponent, so they match bucket boundaries exactly.
+     * @param name The metric family name.
+     * @param labels Already rendered labels, separated by commas, may be empty.
+     * @param scale Factor to convert the recorded values to the metric's unit.
+     */
+    void ToOpenMetrics(const std::string &name, const std::string &labels, double scale, size_t firstExponent, size_t lastExponent,
+                       std::string &target) const;
+
+  private:
+    std::atomic<uint64_t> buckets[STATISTICS_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+
+    LatencyHistogram(const LatencyHistogram &);
+    LatencyHistogram &operator=(const LatencyHistogram &);
+  };
+
+  /**
+   * Lock-free size histogram with one bucket per power of two in bytes.
+   * Bucket 0 holds sizes up to 1 byte, bucket n those above 2^(n-1) up to
+   * 2^n bytes. Sizes beyond 2^40 bytes end up in the last bucket.
+   */
+  class SizeHistogram {
+  public:
+    SizeHistogram();
+
+    void Record(uint64_t bytes);
+
+    uint64_t GetCount() const;
+    uint64_t GetSum() const;
+
+    uint64_t GetBucket(size_t index) const;
+    static size_t GetBucketCount();
+    static uint64_t GetBucketUpperBound(size_t index);
+    static size_t GetBucketIndex(uint64_t bytes);
+
+    /**
+     * Appends the histogram in OpenMetrics text format, without the TYPE line.
+     * Bucket bounds are every power of two in bytes from 2^firstExponent to
+     * 2^lastExponent.
+     * @param name The metric family name, which should end in _bytes.
+     * @param labels Already rendered labels, separated by commas, may be empty.
+     */
+    void ToOpenMetrics(const std::string &name, const std::string &labels, size_t firstExponent, size_t lastExponent, std::string &target) const;
+
+  private:
+    std::atomic<uint64_t> buckets[STATISTICS_SIZE_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+
+    SizeHistogram(const SizeHistogram &);
+    SizeHistogram &operator=(const SizeHistogram &);
+  };
+
+  /**
+   * Counters of a single procedure. All methods are lock-free and may be
+   * called concurrently.
+   */
+  class ProcedureStatistics {
+  public:
+    ProcedureStatistics();
+
+    void RecordCall();
+    void RecordError(int code);
+    void RecordBytes(size_t in, size_t out);
+    void RecordLatency(phase_t phase, uint64_t nanoseconds);
+
+    uint64_t GetCalls() const;
+    uint64_t GetErrors() const;
+    uint64_t GetErrors(int code) const;
+    uint64_t GetBytesIn() const;
+    uint64_t GetBytesOut() const;
+    const LatencyHistogram &GetLatency(phase_t phase) const;
+
+    /**
+     * @return Error counts by code. Codes beyond the first STATISTICS_ERROR_SLOTS
+     * distinct ones are only part of GetErrors().
+     */
+    std::map<int, uint64_t> GetErrorsByCode() const;
+
+    Json::Value ToJson() const;
+
+  private:
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> errors;
+    std::atomic<int> errorCodes[STATISTICS_ERROR_SLOTS];
+    std::atomic<uint64_t> errorCounts[STATISTICS_ERROR_SLOTS];
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+    LatencyHistogram latency[PHASE_COUNT];
+
+    ProcedureStatistics(const ProcedureStatistics &);
+    ProcedureStatistics &operator=(const ProcedureStatistics &);
+  };
+
+  /**
+   * Per procedure statistics of a server plus the totals of all requests.
+   *
+   * Procedures are registered while they are added to the server, so the
+   * lookup during request handling needs no locking. Bytes and the parse and
+   * serialize phases of batch requests can't be attributed to a single
+   * procedure and are only accounted in the totals.
+   */
+  class ServerStatistics {
+  public:
+    ServerStatistics();
+    virtual ~ServerStatistics();
+
+    void Register(const std::string &procedure);
+
+    /**
+     * @return The statistics of procedure or NULL if it is unknown.
+     */
+    ProcedureStatistics *Find(const std::string &procedure);
+    const ProcedureStatistics *Find(const std::string &procedure) const;
+
+    ProcedureStatistics &GetTotal();
+    const ProcedureStatistics &GetTotal() const;
+    const std::map<std::string, ProcedureStatistics *> &GetProcedures() const;
+
+    /**
+     * Accounts a complete message after it has been answered.
+     * @param request The parsed request, used to attribute single requests.
+     * @param in Size of the raw request.
+     * @param out Size of the raw response.
+     * @param parse Time spent parsing in nanoseconds.
+     * @param serialize Time spent serializing in nanoseconds.
+     */
+    void RecordMessage(const Json::Value &request, size_t in, size_t out, uint64_t parse, uint64_t serialize);
+
+    /**
+     * @return Nanoseconds of a monotonic clock, the same as ITracer::Now().
+     */
+    static uint64_t Now();
+
+    Json::Value ToJson() const;
+
+    /**
+     * Appends all counters in OpenMetrics text format, without the
+     * terminating "# EOF" line. Only atomic loads are involved, so this can
+     * be called while requests are processed.
+     */
+    void ToOpenMetrics(std::string &target) const;
+
+    /**
+     * Escapes a label value for the OpenMetrics text format.
+     */
+    static std::string EscapeLabel(const std::string &value);
+
+  private:
+    ProcedureStatistics total;
+    std::map<std::string, ProcedureStatistics *> procedures;
+
+    ServerStatistics(const ServerStatistics &);
+    ServerStatistics &operator=(const ServerStatistics &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_SERVERSTATISTICS_H
@@ -0,0 +1,65 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    singleflight.cpp
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "singleflight.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+SingleFlight::SingleFlight() : executed(0), shared(0) {}
+
+bool SingleFlight::Do(const string &key, const function<void(Json::Value &)> &call, Json::Value &result) {
+  shared_ptr<Call> flight;
+  {
+    unique_lock<mutex> guard(this->lock);
+    map<string, shared_ptr<Call>>::iterator it = this->calls.find(key);
+    if (it != this->calls.end()) {
+      flight = it->second;
+      flight->waiters++;
+      flight->done.wait(guard, [&flight] { return flight->finished; });
+      this->shared.fetch_add(1, memory_order_relaxed);
+      if (flight->error) {
+        rethrow_exception(flight->error);
+      }
+      result = flight->result;
+      return true;
+    }
+    flight = make_shared<Call>();
+    this->calls[key] = flight;
+  }
+
+  exception_ptr error;
+  try {
+    call(result);
+  } catch (...) {
+    error = current_exception();
+  }
+  this->executed.fetch_add(1, memory_order_relaxed);
+
+  {
+    lock_guard<mutex> guard(this->lock);
+    this->calls.erase(key);
+    // Only copy the result if somebody is waiting for it.
+    if (flight->waiters > 0) {
+      flight->result = result;
+      flight->error = error;
+    }
+    flight->finished = true;
+  }
+  flight->done.notify_all();
+
+  if (error) {
+    rethrow_exception(error);
+  }
+  return false;
+}
+
+uint64_t SingleFlight::GetExecuted() const { return this->executed.load(memory_order_relaxed); }
+
+uint64_t SingleFlight::GetShared() const { return this->shared.load(memory_order_relaxed); }
@@ -0,0 +1,75 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    singleflight.h
+ * @date    19.10.2026
+ * @author  Peter Spiess-Knafl <dev@spiessknafl.at>
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_SINGLEFLIGHT_H
+#define JSONRPC_CPP_SINGLEFLIGHT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+
+namespace jsonrpc {
+
+  /**
+   * Coalesces concurrent identical calls: while a call for a key is in
+   * flight, further calls for the same key wait for it and receive a copy of
+   * its result or exception instead of executing again. Nothing is kept once
+   * the call has finished, so results are never stale.
+   */
+  class SingleFlight {
+  public:
+    SingleFlight();
+
+    /**
+     * Executes call for key, unless an identical call is already in flight.
+     * @param result The result of call or of the call waited for.
+     * @return true if the result was shared from a call of another thread.
+     * @throws Whatever the executed call has thrown.
+     */
+    bool Do(const std::string &key, const std::function<void(Json::Value &)> &call, Json::Value &result);
+
+    /**
+     * @return The number of calls that have been executed.
+     */
+    uint64_t GetExecuted() const;
+
+    /**
+     * @return The number of calls that have waited for another one.
+     */
+    uint64_t GetShared() const;
+
+  private:
+    struct Call {
+      Call() : finished(false), waiters(0) {}
+      std::condition_variable done;
+      bool finished;
+      size_t waiters;
+      Json::Value result;
+      std::exception_ptr error;
+    };
+
+    std::mutex lock;
+    std::map<std::string, std::shared_ptr<Call>> calls;
+    std::atomic<uint64_t> executed;
+    std::atomic<uint64_t> shared;
+
+    SingleFlight(const SingleFlight &);
+    SingleFlight &operator=(const SingleFlight &);
+  };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_SINGLEFLIGHT_H
@@ -18,31 +18,53 @@
 
 #define TEMPLATE_CPPCLIENT_SIGMETHOD "<returntype> <methodname>(<parameters>) "
 
-#define TEMPLATE_NAMED_ASSIGNMENT "p[\"<paramname>\"] = <paramname>;"
-#define TEMPLATE_POSITION_ASSIGNMENT "p.append(<paramname>);"
+#define TEMPLATE_NAMED_ASSIGNMENT "p[\"<paramname>\"] = <paramvalue>;"
+#define TEMPLATE_POSITION_ASSIGNMENT "p.append(<paramvalue>);"
+#define TEMPLATE_DIRECT_ASSIGNMENT "p.Add(\"<paramname>\", <paramvalue>);"
 
 #define TEMPLATE_METHODCALL "Json::Value result = this->CallMethod(\"<name>\",p);"
 #define TEMPLATE_NOTIFICATIONCALL "this->CallNotification(\"<name>\",p);"
 
+#define TEMPLATE_CPPCLIENT_SIGASYNCMETHOD "std::future<<returntype>> <methodname>Async(<parameters>)"
+#define TEMPLATE_ASYNCMETHODCALL "return this->CallMethodAsync<<returntype>>(\"<name>\", p);"
+#define TEMPLATE_ASYNCNOTIFICATIONCALL "return this->CallNotificationAsync(\"<name>\", p);"
+
+#define TEMPLATE_BATCHCLASS "class Batch : public jsonrpc::TypedBatch"
+#define TEMPLATE_BATCHCONSTRUCTOR "explicit Batch(jsonrpc::Client &client) : jsonrpc::TypedBatch(client) {}"
+#define TEMPLATE_BATCHMETHOD "Batch &<methodname>(<parameters>)"
+#define TEMPLATE_BATCHRESULT "jsonrpc::BatchResult<<returntype>> *result = NULL"
+#define TEMPLATE_BATCHCALL "this->addCall(\"<name>\", p, result);"
+#define TEMPLATE_BATCHNOTIFICATION "this->addNotification(\"<name>\", p);"
+
 #define TEMPLATE_RETURNCHECK "if (result<cast>)"
 #define TEMPLATE_RETURN "return result<cast>;"
+#define TEMPLATE_CONVERTEDRETURNCHECK "if (<scope>FromJson(result, converted))"
 
 using namespace std;
 using namespace jsonrpc;
 
 CPPClientStubGenerator::CPPClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, std::ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+    : StubGenerator(stubname, procedures, outputstream), directParams(false), batch(false), async(false) {}
 
 CPPClientStubGenerator::CPPClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, const string filename)
-    : StubGenerator(stubname, procedures, filename) {}
+    : StubGenerator(stubname, procedures, filename), directParams(false), batch(false), async(false) {}
+
+void CPPClientStubGenerator::setDirectParams(bool enabled) { this->directParams = enabled; }
+
+void CPPClientStubGenerator::setBatch(bool enabled) { this->batch = enabled; }
+
+void CPPClientStubGenerator::setAsync(bool enabled) { this->async = enabled; }
 
 void CPPClientStubGenerator::generateStub() {
   vector<string> classname = CPPHelper::splitPackages(this->stubname);
   CPPHelper::prolog(*this, this->stubname);
   this->writeLine("#include <jsonrpccpp/client.h>");
+  if (CPPHelper::hasNestedTypes(this->procedures))
+    this->writeLine("#include <jsonrpccpp/common/jsonconversion.h>");
   this->writeNewLine();
 
   int depth = CPPHelper::namespaceOpen(*this, stubname);
+  CPPHelper::generateStructs(*this, this->stubname, this->procedures);
 
   this->writeLine(replaceAll(TEMPLATE_CPPCLIENT_SIGCLASS, "<stubname>", classname.at(classname.size() - 1)));
   this->writeLine("{");
@@ -57,6 +79,18 @@ void CPPClientStubGenerator::generateStub() {
     this->generateMethod(procedures[i]);
   }
 
+  if (this->async) {
+    this->writeNewLine();
+    for (unsigned int i = 0; i < procedures.size(); i++) {
+      this->generateAsyncMethod(procedures[i]);
+    }
+  }
+
+  if (this->batch) {
+    this->writeNewLine();
+    this->generateBatch();
+  }
+
   this->decreaseIndentation();
   this->decreaseIndentation();
   this->writeLine("};");
@@ -68,7 +102,7 @@ void CPPClientStubGenerator::generateStub() {
 
 void CPPClientStubGenerator::generateMethod(Procedure &proc) {
   string procsignature = TEMPLATE_CPPCLIENT_SIGMETHOD;
-  string returntype = CPPHelper::toCppReturntype(proc.GetReturnType());
+  string returntype = CPPHelper::toCppReturntype(proc);
   if (proc.GetProcedureType() == RPC_NOTIFICATION)
     returntype = "void";
 
@@ -80,7 +114,12 @@ void CPPClientStubGenerator::generateMethod(Procedure &proc) {
   this->writeLine("{");
   this->increaseIndentation();
 
-  this->writeLine("Json::Value p;");
+  if (!this->directParams)
+    this->writeLine("Json::Value p;");
+  else if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME)
+    this->writeLine("jsonrpc::ParameterWriter p(jsonrpc::PARAMS_BY_NAME);");
+  else
+    this->writeLine("jsonrpc::ParameterWriter p(jsonrpc::PARAMS_BY_POSITION);");
 
   generateAssignments(proc);
   generateProcCall(proc);
@@ -89,21 +128,30 @@ void CPPClientStubGenerator::generateMethod(Procedure &proc) {
   this->writeLine("}");
 }
 
-void CPPClientStubGenerator::generateAssignments(Procedure &proc) {
+void CPPClientStubGenerator::generateAssignments(Procedure &proc) { this->generateAssignments(proc, this->directParams); }
+
+void CPPClientStubGenerator::generateAssignments(Procedure &proc, bool direct) {
   string assignment;
   parameterNameList_t list = proc.GetParameters();
   if (!list.empty()) {
     for (parameterNameList_t::iterator it = list.begin(); it != list.end(); ++it) {
 
-      if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
+      if (direct) {
+        assignment = TEMPLATE_DIRECT_ASSIGNMENT;
+      } else if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
         assignment = TEMPLATE_NAMED_ASSIGNMENT;
       } else {
         assignment = TEMPLATE_POSITION_ASSIGNMENT;
       }
+      const TypeSchema &schema = proc.GetParameterSchema(it->first);
+      if (schema.IsNested())
+        replaceAll2(assignment, "<paramvalue>", CPPHelper::toConversionScope(schema) + "ToJson(" + it->first + ")");
+      else
+        replaceAll2(assignment, "<paramvalue>", it->first);
       replaceAll2(assignment, "<paramname>", it->first);
       this->writeLine(assignment);
     }
-  } else {
+  } else if (!direct) {
     this->writeLine("p = Json::nullValue;");
   }
 }
@@ -113,13 +161,22 @@ void CPPClientStubGenerator::generateProcCall(Procedure &proc) {
   if (proc.GetProcedureType() == RPC_METHOD) {
     call = TEMPLATE_METHODCALL;
     this->writeLine(replaceAll(call, "<name>", proc.GetProcedureName()));
-    call = TEMPLATE_RETURNCHECK;
-    replaceAll2(call, "<cast>", CPPHelper::isCppConversion(proc.GetReturnType()));
-    this->writeLine(call);
-    this->increaseIndentation();
-    call = TEMPLATE_RETURN;
-    replaceAll2(call, "<cast>", CPPHelper::toCppConversion(proc.GetReturnType()));
-    this->writeLine(call);
+    const TypeSchema &schema = proc.GetReturnSchema();
+    if (schema.IsNested()) {
+      // Checks the whole result while converting it.
+      this->writeLine(CPPHelper::toCppType(schema) + " converted;");
+      this->writeLine(replaceAll(TEMPLATE_CONVERTEDRETURNCHECK, "<scope>", CPPHelper::toConversionScope(schema)));
+      this->increaseIndentation();
+      this->writeLine("return converted;");
+    } else {
+      call = TEMPLATE_RETURNCHECK;
+      replaceAll2(call, "<cast>", CPPHelper::isCppConversion(proc.GetReturnType()));
+      this->writeLine(call);
+      this->increaseIndentation();
+      call = TEMPLATE_RETURN;
+      replaceAll2(call, "<cast>", CPPHelper::toCppConversion(proc.GetReturnType()));
+      this->writeLine(call);
+    }
     this->decreaseIndentation();
     this->writeLine("else");
     this->increaseIndentation();
@@ -133,3 +190,69 @@ void CPPClientStubGenerator::generateProcCall(Procedure &proc) {
     this->writeLine(call);
   }
 }
+
+void CPPClientStubGenerator::generateAsyncMethod(Procedure &proc) {
+  string returntype = proc.GetProcedureType() == RPC_METHOD ? CPPHelper::toCppReturntype(proc) : "void";
+  string signature = TEMPLATE_CPPCLIENT_SIGASYNCMETHOD;
+  replaceAll2(signature, "<returntype>", returntype);
+  replaceAll2(signature, "<methodname>", CPPHelper::normalizeString(proc.GetProcedureName()));
+  replaceAll2(signature, "<parameters>", CPPHelper::generateParameterDeclarationList(proc));
+  this->writeLine(signature);
+  this->writeLine("{");
+  this->increaseIndentation();
+
+  // Queued calls are sent as batches, which are built as a Json::Value.
+  this->writeLine("Json::Value p;");
+  this->generateAssignments(proc, false);
+  string call = proc.GetProcedureType() == RPC_METHOD ? TEMPLATE_ASYNCMETHODCALL : TEMPLATE_ASYNCNOTIFICATIONCALL;
+  replaceAll2(call, "<returntype>", returntype);
+  replaceAll2(call, "<name>", proc.GetProcedureName());
+  this->writeLine(call);
+
+  this->decreaseIndentation();
+  this->writeLine("}");
+}
+
+void CPPClientStubGenerator::generateBatch() {
+  this->writeLine(TEMPLATE_BATCHCLASS);
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("public:");
+  this->increaseIndentation();
+  this->writeLine(TEMPLATE_BATCHCONSTRUCTOR);
+  this->writeNewLine();
+  for (unsigned int i = 0; i < procedures.size(); i++) {
+    this->generateBatchMethod(procedures[i]);
+  }
+  this->decreaseIndentation();
+  this->decreaseIndentation();
+  this->writeLine("};");
+  this->writeNewLine();
+  this->writeLine("Batch batch() { return Batch(*this); }");
+}
+
+void CPPClientStubGenerator::generateBatchMethod(Procedure &proc) {
+  string parameters = CPPHelper::generateParameterDeclarationList(proc);
+  if (proc.GetProcedureType() == RPC_METHOD) {
+    if (!parameters.empty())
+      parameters += ", ";
+    parameters += replaceAll(TEMPLATE_BATCHRESULT, "<returntype>", CPPHelper::toCppReturntype(proc));
+  }
+
+  string signature = TEMPLATE_BATCHMETHOD;
+  replaceAll2(signature, "<methodname>", CPPHelper::normalizeString(proc.GetProcedureName()));
+  replaceAll2(signature, "<parameters>", parameters);
+  this->writeLine(signature);
+  this->writeLine("{");
+  this->increaseIndentation();
+
+  // Batches are built as a Json::Value, so params are never written directly.
+  this->writeLine("Json::Value p;");
+  this->generateAssignments(proc, false);
+  string call = proc.GetProcedureType() == RPC_METHOD ? TEMPLATE_BATCHCALL : TEMPLATE_BATCHNOTIFICATION;
+  this->writeLine(replaceAll(call, "<name>", proc.GetProcedureName()));
+  this->writeLine("return *this;");
+
+  this->decreaseIndentation();
+  this->writeLine("}");
+}
@@ -19,11 +19,40 @@ namespace jsonrpc {
     CPPClientStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, std::ostream &outputstream);
     CPPClientStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, const std::string filename);
 
+    /**
+     * Makes the stub write params as JSON text with a jsonrpc::ParameterWriter
+     * instead of assigning them to a Json::Value. Only covers writing params
+     * on the client, results are still read from a Json::Value.
+     */
+    void setDirectParams(bool enabled);
+
+    /**
+     * Adds a nested Batch class with a chainable method per procedure, see
+     * jsonrpc::TypedBatch, and a batch() method creating it.
+     */
+    void setBatch(bool enabled);
+
+    /**
+     * Adds a <name>Async variant of every method returning a std::future,
+     * see jsonrpc::Client::CallMethodAsync.
+     */
+    void setAsync(bool enabled);
+
     virtual void generateStub();
 
     void generateMethod(Procedure &proc);
     void generateAssignments(Procedure &proc);
     void generateProcCall(Procedure &proc);
+    void generateBatch();
+    void generateAsyncMethod(Procedure &proc);
+
+  private:
+    bool directParams;
+    bool batch;
+    bool async;
+
+    void generateAssignments(Procedure &proc, bool direct);
+    void generateBatchMethod(Procedure &proc);
   };
 } // namespace jsonrpc
 #endif // JSONRPC_CPP_CLIENTSTUBGENERATOR_H
@@ -59,9 +59,99 @@ using namespace std;
     }\n\
 }\n"
 
+#define TEMPLATE_JS_FETCH_PROLOG                                                                                                                               \
+  "function <class>(url) {\n\
+    this.url = url;\n\
+    var id = 1;\n\
+    var queue = [];\n\
+    \n\
+    function rpcError(code, message, data) {\n\
+        var error = new Error(message);\n\
+        error.code = code;\n\
+        error.data = data;\n\
+        return error;\n\
+    }\n\
+    \n\
+    function settle(calls, text) {\n\
+        var responses = [];\n\
+        if (text.length > 0) {\n\
+            try {\n\
+                responses = JSON.parse(text);\n\
+            } catch (e) {\n\
+                throw rpcError(-32001, \"Invalid Server response: \" + text);\n\
+            }\n\
+        }\n\
+        if (!Array.isArray(responses))\n\
+            responses = [responses];\n\
+        var byId = {};\n\
+        responses.forEach(function (response) {\n\
+            if (response !== null && typeof response === \"object\" && response.hasOwnProperty(\"id\"))\n\
+                byId[response.id] = response;\n\
+        });\n\
+        calls.forEach(function (call) {\n\
+            if (!call.request.hasOwnProperty(\"id\")) {\n\
+                call.resolve();\n\
+                return;\n\
+            }\n\
+            var response = byId[call.request.id];\n\
+            if (response === undefined)\n\
+                call.reject(rpcError(-32001, \"Invalid Server response: no response for id \" + call.request.id));\n\
+            else if (response.hasOwnProperty(\"error\") && response.error !== null)\n\
+                call.reject(rpcError(response.error.code, response.error.message, response.error.data));\n\
+            else if (response.hasOwnProperty(\"result\"))\n\
+                call.resolve(response.result);\n\
+            else\n\
+                call.reject(rpcError(-32001, \"Invalid Server response: \" + JSON.stringify(response)));\n\
+        });\n\
+    }\n\
+    \n\
+    function flush() {\n\
+        var calls = queue;\n\
+        queue = [];\n\
+        var requests = calls.map(function (call) { return call.request; });\n\
+        fetch(url, {\n\
+            method: \"POST\",\n\
+            headers: {\"Content-Type\": \"application/json\"},\n\
+            body: JSON.stringify(requests.length === 1 ? requests[0] : requests)\n\
+        }).then(function (response) {\n\
+            if (!response.ok)\n\
+                throw rpcError(-32002, \"HTTP Error: \" + response.status);\n\
+            return response.text();\n\
+        }).then(function (text) {\n\
+            settle(calls, text);\n\
+        }).catch(function (error) {\n\
+            if (!error.hasOwnProperty(\"code\"))\n\
+                error = rpcError(-32002, \"Fetch Error: \" + error.message);\n\
+            calls.forEach(function (call) {\n\
+                call.reject(error);\n\
+            });\n\
+        });\n\
+    }\n\
+    \n\
+    function doJsonRpcRequest(method, params, methodCall) {\n\
+        return new Promise(function (resolve, reject) {\n\
+            var request = {};\n\
+            if (methodCall)\n\
+                request.id = id++;\n\
+            request.jsonrpc = \"2.0\";\n\
+            request.method = method;\n\
+            if (params !== null) {\n\
+                request.params = params;\n\
+            }\n\
+            queue.push({request: request, resolve: resolve, reject: reject});\n\
+            if (queue.length === 1)\n\
+                Promise.resolve().then(flush);\n\
+        });\n\
+    }\n\
+    this.doRPC = function(method, params, methodCall) {\n\
+        return doJsonRpcRequest(method, params, methodCall);\n\
+    }\n\
+}\n"
+
 #define TEMPLATE_JS_METHOD                                                                                                                                     \
   "<class>.prototype.<procedure> = function(<params>callbackSuccess, "                                                                                         \
   "callbackError) {"
+#define TEMPLATE_JS_FETCH_METHOD "<class>.prototype.<procedure> = function(<params>) {"
 #define TEMPLATE_JS_PARAM_NAMED "var params = {<params>};"
 #define TEMPLATE_JS_PARAM_POSITIONAL "var params = [<params>];"
 #define TEMPLATE_JS_PARAM_EMPTY "var params = null;"
@@ -71,12 +161,14 @@ using namespace std;
 #define TEMPLATE_JS_CALL_NOTIFICATION                                                                                                                          \
   "this.doRPC(\"<procedure>\", params, false, callbackSuccess, "                                                                                               \
   "callbackError);"
+#define TEMPLATE_JS_FETCH_CALL_METHOD "return this.doRPC(\"<procedure>\", params, true);"
+#define TEMPLATE_JS_FETCH_CALL_NOTIFICATION "return this.doRPC(\"<procedure>\", params, false);"
 
 JSClientStubGenerator::JSClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+    : StubGenerator(stubname, procedures, outputstream), fetch(false) {}
 
 JSClientStubGenerator::JSClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, const string &filename)
-    : StubGenerator(stubname, procedures, filename) {}
+    : StubGenerator(stubname, procedures, filename), fetch(false) {}
 
 string JSClientStubGenerator::class2Filename(const string &classname) {
   string result = classname;
@@ -84,11 +176,13 @@ string JSClientStubGenerator::class2Filename(const string &classname) {
   return result + ".js";
 }
 
+void JSClientStubGenerator::setFetch(bool enabled) { this->fetch = enabled; }
+
 void JSClientStubGenerator::generateStub() {
   this->writeLine("/**");
   this->writeLine(" * This file is generated by jsonrpcstub, DO NOT CHANGE IT MANUALLY!");
   this->writeLine(" */");
-  this->write(replaceAll(TEMPLATE_JS_PROLOG, "<class>", stubname));
+  this->write(replaceAll(this->fetch ? TEMPLATE_JS_FETCH_PROLOG : TEMPLATE_JS_PROLOG, "<class>", stubname));
   this->writeNewLine();
 
   for (unsigned int i = 0; i < procedures.size(); i++) {
@@ -97,7 +191,7 @@ void JSClientStubGenerator::generateStub() {
 }
 
 void JSClientStubGenerator::generateMethod(Procedure &proc) {
-  string method = TEMPLATE_JS_METHOD;
+  string method = this->fetch ? TEMPLATE_JS_FETCH_METHOD : TEMPLATE_JS_METHOD;
   replaceAll2(method, "<class>", stubname);
   replaceAll2(method, "<procedure>", noramlizeJsLiteral(proc.GetProcedureName()));
 
@@ -115,8 +209,10 @@ void JSClientStubGenerator::generateMethod(Procedure &proc) {
 
     if (++it != list.end()) {
       params_assignment << ", ";
+      param_string << ", ";
+    } else if (!this->fetch) {
+      param_string << ", ";
     }
-    param_string << ", ";
   }
 
   replaceAll2(method, "<params>", param_string.str());
@@ -138,7 +234,9 @@ void JSClientStubGenerator::generateMethod(Procedure &proc) {
     this->writeLine(TEMPLATE_JS_PARAM_EMPTY);
   }
 
-  if (proc.GetProcedureType() == RPC_METHOD)
+  if (this->fetch)
+    method = proc.GetProcedureType() == RPC_METHOD ? TEMPLATE_JS_FETCH_CALL_METHOD : TEMPLATE_JS_FETCH_CALL_NOTIFICATION;
+  else if (proc.GetProcedureType() == RPC_METHOD)
     method = TEMPLATE_JS_CALL_METHOD;
   else
     method = TEMPLATE_JS_CALL_NOTIFICATION;
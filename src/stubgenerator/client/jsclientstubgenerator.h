@@ -21,9 +21,17 @@ namespace jsonrpc {
 
     static std::string class2Filename(const std::string &classname);
 
+    /**
+     * Generates a client using fetch, whose methods return Promises. Calls
+     * made in the same microtask are sent together as one batch request.
+     */
+    void setFetch(bool enabled);
+
     virtual void generateStub();
 
   private:
+    bool fetch;
+
     virtual void generateMethod(Procedure &proc);
     static std::string noramlizeJsLiteral(const std::string &literal);
   };
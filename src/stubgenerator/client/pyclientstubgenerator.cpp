@@ -8,27 +8,206 @@
   "self).__init__(connector, version)"
 
 #define TEMPLATE_PYTHON_CLIENT_SIGMETHOD "def <methodname>(self<parameters>):"
+#define TEMPLATE_PYTHON_ASYNCIO_SIGMETHOD "async def <methodname>(self<parameters>):"
+
+#define TEMPLATE_PYTHON_ASYNCIO_PROLOG                                                                                                                         \
+  "import asyncio\n\
+import json\n\
+import urllib.parse\n\
+\n\
+\n\
+class JsonRpcError(Exception):\n\
+    def __init__(self, code, message, data=None):\n\
+        super(JsonRpcError, self).__init__(message)\n\
+        self.code = code\n\
+        self.message = message\n\
+        self.data = data\n\
+\n\
+\n\
+class <stubname>(object):\n\
+    def __init__(self, url, max_batch=100):\n\
+        parsed = urllib.parse.urlsplit(url)\n\
+        self._host = parsed.hostname\n\
+        self._port = parsed.port or (443 if parsed.scheme == 'https' else 80)\n\
+        self._ssl = True if parsed.scheme == 'https' else None\n\
+        self._path = (parsed.path or '/') + ('?' + parsed.query if parsed.query else '')\n\
+        self._max_batch = max_batch\n\
+        self._id = 0\n\
+        self._queue = []\n\
+        self._sender = None\n\
+        self._reader = None\n\
+        self._writer = None\n\
+\n\
+    async def __aenter__(self):\n\
+        return self\n\
+\n\
+    async def __aexit__(self, *exc):\n\
+        await self.close()\n\
+\n\
+    async def close(self):\n\
+        writer, self._reader, self._writer = self._writer, None, None\n\
+        if writer is not None:\n\
+            writer.close()\n\
+            try:\n\
+                await writer.wait_closed()\n\
+            except (OSError, asyncio.IncompleteReadError):\n\
+                pass\n\
+\n\
+    def _call(self, method, parameters, notification):\n\
+        loop = asyncio.get_running_loop()\n\
+        request = {'jsonrpc': '2.0', 'method': method}\n\
+        if parameters is not None:\n\
+            request['params'] = parameters\n\
+        if not notification:\n\
+            self._id += 1\n\
+            request['id'] = self._id\n\
+        future = loop.create_future()\n\
+        self._queue.append((request, future))\n\
+        # Calls made until the sender runs, or while it waits for a\n\
+        # response, are sent together as one batch.\n\
+        if self._sender is None:\n\
+            self._sender = loop.create_task(self._send_queued())\n\
+        return future\n\
+\n\
+    async def _send_queued(self):\n\
+        try:\n\
+            while self._queue:\n\
+                calls = self._queue[:self._max_batch]\n\
+                self._queue = self._queue[self._max_batch:]\n\
+                await self._send(calls)\n\
+        finally:\n\
+            self._sender = None\n\
+\n\
+    async def _send(self, calls):\n\
+        requests = [request for request, _ in calls]\n\
+        body = json.dumps(requests[0] if len(requests) == 1 else requests)\n\
+        try:\n\
+            self._settle(calls, await self._post(body.encode('utf-8')))\n\
+        except Exception as e:\n\
+            if not isinstance(e, JsonRpcError):\n\
+                e = JsonRpcError(-32002, 'Connection Error: %s' % e)\n\
+            for _, future in calls:\n\
+                if not future.done():\n\
+                    future.set_exception(e)\n\
+\n\
+    async def _post(self, body):\n\
+        header = 'POST %s HTTP/1.1\\r\\nHost: %s\\r\\nContent-Type: application/json\\r\\nContent-Length: %d\\r\\n\\r\\n'\n\
+        header = header % (self._path, self._host, len(body))\n\
+        while True:\n\
+            reused = self._writer is not None\n\
+            if not reused:\n\
+                self._reader, self._writer = await asyncio.open_connection(self._host, self._port, ssl=self._ssl)\n\
+            try:\n\
+                self._writer.write(header.encode('ascii') + body)\n\
+                await self._writer.drain()\n\
+                return await self._read_response()\n\
+            except (OSError, asyncio.IncompleteReadError):\n\
+                await self.close()\n\
+                # The server may have closed the idle connection, retry once on a new one.\n\
+                if not reused:\n\
+                    raise\n\
+\n\
+    async def _read_response(self):\n\
+        status = await self._reader.readline()\n\
+        if not status:\n\
+            raise ConnectionResetError('connection closed by server')\n\
+        headers = {}\n\
+        while True:\n\
+            line = await self._reader.readline()\n\
+            if line in (b'\\r\\n', b'\\n', b''):\n\
+                break\n\
+            name, _, value = line.decode('latin-1').partition(':')\n\
+            headers[name.strip().lower()] = value.strip().lower()\n\
+        if headers.get('transfer-encoding') == 'chunked':\n\
+            body = b''\n\
+            while True:\n\
+                size = int((await self._reader.readline()).split(b';')[0], 16)\n\
+                if size == 0:\n\
+                    await self._reader.readline()\n\
+                    break\n\
+                body += await self._reader.readexactly(size)\n\
+                await self._reader.readexactly(2)\n\
+        elif 'content-length' in headers:\n\
+            body = await self._reader.readexactly(int(headers['content-length']))\n\
+        else:\n\
+            body = await self._reader.read()\n\
+            headers['connection'] = 'close'\n\
+        if headers.get('connection') == 'close':\n\
+            await self.close()\n\
+        code = int(status.split()[1])\n\
+        if code != 200:\n\
+            raise JsonRpcError(-32002, 'HTTP Error: %d' % code)\n\
+        return body.decode('utf-8')\n\
+\n\
+    def _settle(self, calls, text):\n\
+        try:\n\
+            responses = json.loads(text) if text else []\n\
+        except ValueError:\n\
+            raise JsonRpcError(-32001, 'Invalid Server response: ' + text)\n\
+        if not isinstance(responses, list):\n\
+            responses = [responses]\n\
+        found = {}\n\
+        for response in responses:\n\
+            if isinstance(response, dict) and 'id' in response:\n\
+                found[response['id']] = response\n\
+        for request, future in calls:\n\
+            if future.done():\n\
+                continue\n\
+            response = found.get(request.get('id'))\n\
+            if 'id' not in request:\n\
+                future.set_result(None)\n\
+            elif response is None:\n\
+                future.set_exception(JsonRpcError(-32001, 'Invalid Server response: no response for id %d' % request['id']))\n\
+            elif response.get('error') is not None:\n\
+                error = response['error']\n\
+                future.set_exception(JsonRpcError(error.get('code'), error.get('message'), error.get('data')))\n\
+            elif 'result' in response:\n\
+                future.set_result(response['result'])\n\
+            else:\n\
+                future.set_exception(JsonRpcError(-32001, 'Invalid Server response: %s' % json.dumps(response)))\n"
 
 #define TEMPLATE_NAMED_ASSIGNMENT "parameters[\'<paramname>\'] = <paramname>"
 #define TEMPLATE_POSITION_ASSIGNMENT "parameters.append(<paramname>)"
 
 #define TEMPLATE_METHODCALL "result = self.call_method(\'<name>\', parameters)"
 #define TEMPLATE_NOTIFICATIONCALL "self.call_notification(\'<name>\', parameters)"
+#define TEMPLATE_ASYNCIO_METHODCALL "result = await self._call(\'<name>\', parameters, False)"
+#define TEMPLATE_ASYNCIO_NOTIFICATIONCALL "await self._call(\'<name>\', parameters, True)"
 
 using namespace std;
 using namespace jsonrpc;
 
 PythonClientStubGenerator::PythonClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, std::ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+    : StubGenerator(stubname, procedures, outputstream), asyncio(false) {}
 
 PythonClientStubGenerator::PythonClientStubGenerator(const string &stubname, std::vector<Procedure> &procedures, const string filename)
-    : StubGenerator(stubname, procedures, filename) {}
+    : StubGenerator(stubname, procedures, filename), asyncio(false) {}
+
+void PythonClientStubGenerator::setAsyncio(bool enabled) { this->asyncio = enabled; }
 
 void PythonClientStubGenerator::generateStub() {
   this->writeLine("#");
   this->writeLine("# This file is generated by jsonrpcstub, DO NOT CHANGE IT MANUALLY!");
   this->writeLine("#");
   this->writeNewLine();
+
+  if (this->asyncio) {
+    this->writeLine("#");
+    this->writeLine("# This client only needs the Python standard library (3.7 or later):");
+    this->writeLine(replaceAll("# async with <stubname>('http://localhost:8383') as client:", "<stubname>", this->stubname));
+    this->writeLine("#     results = await asyncio.gather(client.first(), client.second())");
+    this->writeLine("#");
+    this->writeNewLine();
+    this->writeLine(replaceAll(TEMPLATE_PYTHON_ASYNCIO_PROLOG, "<stubname>", this->stubname));
+    this->increaseIndentation();
+    this->writeNewLine();
+    for (unsigned int i = 0; i < procedures.size(); i++) {
+      this->generateMethod(procedures[i]);
+    }
+    this->decreaseIndentation();
+    return;
+  }
+
   this->writeLine("#");
   this->writeLine("# To use this client, jsonrpc_pyclient must be installed:");
   this->writeLine("# pip install jsonrpc_pyclient");
@@ -52,7 +231,7 @@ void PythonClientStubGenerator::generateStub() {
 }
 
 void PythonClientStubGenerator::generateMethod(Procedure &proc) {
-  string procsignature = TEMPLATE_PYTHON_CLIENT_SIGMETHOD;
+  string procsignature = this->asyncio ? TEMPLATE_PYTHON_ASYNCIO_SIGMETHOD : TEMPLATE_PYTHON_CLIENT_SIGMETHOD;
   replaceAll2(procsignature, "<methodname>", normalizeString(proc.GetProcedureName()));
 
   // generate parameters string
@@ -111,11 +290,11 @@ void PythonClientStubGenerator::generateAssignments(Procedure &proc) {
 void PythonClientStubGenerator::generateProcCall(Procedure &proc) {
   string call;
   if (proc.GetProcedureType() == RPC_METHOD) {
-    call = TEMPLATE_METHODCALL;
+    call = this->asyncio ? TEMPLATE_ASYNCIO_METHODCALL : TEMPLATE_METHODCALL;
     this->writeLine(replaceAll(call, "<name>", proc.GetProcedureName()));
     this->writeLine("return result");
   } else {
-    call = TEMPLATE_NOTIFICATIONCALL;
+    call = this->asyncio ? TEMPLATE_ASYNCIO_NOTIFICATIONCALL : TEMPLATE_NOTIFICATIONCALL;
     replaceAll2(call, "<name>", proc.GetProcedureName());
     this->writeLine(call);
   }
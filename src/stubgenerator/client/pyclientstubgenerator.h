@@ -6,7 +6,7 @@
 namespace jsonrpc {
   /**
    * The stub client this class generates requires jsonrpc_pyclient
-   * to be installed from pypi.
+   * to be installed from pypi, unless setAsyncio() is used.
    * https://github.com/tvannoy/jsonrpc_pyclient
    */
   class PythonClientStubGenerator : public StubGenerator {
@@ -14,6 +14,13 @@ namespace jsonrpc {
     PythonClientStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, std::ostream &outputstream);
     PythonClientStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, const std::string filename);
 
+    /**
+     * Generates a self-contained asyncio client instead, which keeps one
+     * HTTP/1.1 connection open and sends all calls queued while a request
+     * is in flight together as one batch request.
+     */
+    void setAsyncio(bool enabled);
+
     virtual void generateStub();
 
     void generateMethod(Procedure &proc);
@@ -22,6 +29,9 @@ namespace jsonrpc {
     std::string generateParameterDeclarationList(Procedure &proc);
     static std::string class2Filename(const std::string &classname);
     static std::string normalizeString(const std::string &text);
+
+  private:
+    bool asyncio;
   };
 } // namespace jsonrpc
 #endif // PYTHON_CLIENT_STUB_GENERATOR_H
@@ -10,6 +10,7 @@
 #include "cpphelper.h"
 #include "../stubgenerator.h"
 #include <algorithm>
+#include <set>
 #include <sstream>
 
 using namespace std;
@@ -20,6 +21,48 @@ using namespace jsonrpc;
 
 #define TEMPLATE_EPILOG "#endif //JSONRPC_CPP_STUB_<STUBNAME>_H_"
 
+#define TEMPLATE_STRUCT_GUARD1 "#ifndef JSONRPC_CPP_STRUCT_<STRUCTNAME>"
+#define TEMPLATE_STRUCT_GUARD2 "#define JSONRPC_CPP_STRUCT_<STRUCTNAME>"
+#define TEMPLATE_STRUCT_EPILOG "#endif //JSONRPC_CPP_STRUCT_<STRUCTNAME>"
+#define TEMPLATE_STRUCT_FROMJSON "inline bool FromJson(const Json::Value &value, <structname> &target)"
+#define TEMPLATE_STRUCT_TOJSON "inline Json::Value ToJson(const <structname> &value)"
+
+namespace {
+  void collectStructs(const TypeSchema &schema, set<string> &seen, vector<TypeSchema> &target) {
+    if (schema.IsArray()) {
+      collectStructs(schema.GetElement(), seen, target);
+    } else if (schema.IsStruct() && seen.insert(schema.GetName()).second) {
+      const vector<TypeField> &fields = schema.GetFields();
+      for (vector<TypeField>::const_iterator it = fields.begin(); it != fields.end(); ++it)
+        collectStructs(it->type, seen, target);
+      target.push_back(schema);
+    }
+  }
+
+  void writeIndented(CodeGenerator &cg, const string &line) {
+    cg.increaseIndentation();
+    cg.writeLine(line);
+    cg.decreaseIndentation();
+  }
+
+  string defaultValue(const TypeSchema &schema) {
+    if (schema.IsNested())
+      return "";
+    switch (schema.GetType()) {
+    case JSON_BOOLEAN:
+      return "false";
+    case JSON_INTEGER:
+    case JSON_INTEGER64:
+      return "0";
+    case JSON_REAL:
+    case JSON_NUMERIC:
+      return "0.0";
+    default:
+      return "";
+    }
+  }
+} // namespace
+
 string CPPHelper::toCppType(jsontype_t type, bool isConst, bool isReference) {
   string result;
   switch (type) {
@@ -29,6 +72,9 @@ string CPPHelper::toCppType(jsontype_t type, bool isConst, bool isReference) {
   case JSON_INTEGER:
     result = "int";
     break;
+  case JSON_INTEGER64:
+    result = "Json::Int64";
+    break;
   case JSON_REAL:
     result = "double";
     break;
@@ -59,6 +105,9 @@ string CPPHelper::toCppConversion(jsontype_t type) {
   case JSON_INTEGER:
     result = ".asInt()";
     break;
+  case JSON_INTEGER64:
+    result = ".asInt64()";
+    break;
   case JSON_REAL:
     result = ".asDouble()";
     break;
@@ -83,6 +132,9 @@ string CPPHelper::toString(jsontype_t type) {
   case JSON_INTEGER:
     result = "jsonrpc::JSON_INTEGER";
     break;
+  case JSON_INTEGER64:
+    result = "jsonrpc::JSON_INTEGER64";
+    break;
   case JSON_REAL:
     result = "jsonrpc::JSON_REAL";
     break;
@@ -105,7 +157,11 @@ string CPPHelper::generateParameterDeclarationList(Procedure &proc) {
   stringstream param_string;
   parameterNameList_t list = proc.GetParameters();
   for (parameterNameList_t::iterator it = list.begin(); it != list.end();) {
-    param_string << toCppParamType(it->second) << " " << it->first;
+    const TypeSchema &schema = proc.GetParameterSchema(it->first);
+    if (schema.IsNested())
+      param_string << "const " << toCppType(schema) << "& " << it->first;
+    else
+      param_string << toCppParamType(it->second) << " " << it->first;
     if (++it != list.end()) {
       param_string << ", ";
     }
@@ -122,6 +178,124 @@ string CPPHelper::toCppParamType(jsontype_t type) {
     return toCppType(type, false, false);
 }
 
+string CPPHelper::toCppType(const TypeSchema &schema) {
+  if (schema.IsStruct())
+    return normalizeString(schema.GetName());
+  if (schema.IsArray())
+    return "std::vector<" + toCppType(schema.GetElement()) + ">";
+  return toCppType(schema.GetType());
+}
+
+string CPPHelper::toCppReturntype(const Procedure &proc) {
+  if (proc.GetReturnSchema().IsNested())
+    return toCppType(proc.GetReturnSchema());
+  return toCppReturntype(proc.GetReturnType());
+}
+
+string CPPHelper::toConversionScope(const TypeSchema &schema) { return schema.IsStruct() ? "" : "jsonrpc::"; }
+
+bool CPPHelper::hasNestedTypes(const vector<Procedure> &procedures) {
+  for (vector<Procedure>::const_iterator it = procedures.begin(); it != procedures.end(); ++it) {
+    if (it->GetReturnSchema().IsNested())
+      return true;
+    const parameterNameList_t &params = it->GetParameters();
+    for (parameterNameList_t::const_iterator param = params.begin(); param != params.end(); ++param) {
+      if (it->GetParameterSchema(param->first).IsNested())
+        return true;
+    }
+  }
+  return false;
+}
+
+void CPPHelper::generateStructs(CodeGenerator &cg, const string &stubname, const vector<Procedure> &procedures) {
+  set<string> seen;
+  vector<TypeSchema> structs;
+  for (vector<Procedure>::const_iterator it = procedures.begin(); it != procedures.end(); ++it) {
+    const parameterNameList_t &params = it->GetParameters();
+    for (parameterNameList_t::const_iterator param = params.begin(); param != params.end(); ++param)
+      collectStructs(it->GetParameterSchema(param->first), seen, structs);
+    collectStructs(it->GetReturnSchema(), seen, structs);
+  }
+
+  // Guards are per namespace, the same struct may be used by several stubs.
+  vector<string> packages = splitPackages(stubname);
+  string prefix;
+  for (size_t i = 0; i + 1 < packages.size(); i++)
+    prefix += packages[i] + "_";
+
+  for (vector<TypeSchema>::const_iterator it = structs.begin(); it != structs.end(); ++it) {
+    string name = normalizeString(it->GetName());
+    string guard = prefix + name;
+    std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+    const vector<TypeField> &fields = it->GetFields();
+
+    cg.writeLine(StubGenerator::replaceAll(TEMPLATE_STRUCT_GUARD1, "<STRUCTNAME>", guard));
+    cg.writeLine(StubGenerator::replaceAll(TEMPLATE_STRUCT_GUARD2, "<STRUCTNAME>", guard));
+    cg.writeLine("struct " + name);
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    string initializers;
+    for (vector<TypeField>::const_iterator field = fields.begin(); field != fields.end(); ++field) {
+      string member = normalizeString(field->name);
+      cg.writeLine(toCppType(field->type) + " " + member + ";");
+      if (!defaultValue(field->type).empty())
+        initializers += (initializers.empty() ? " : " : ", ") + member + "(" + defaultValue(field->type) + ")";
+    }
+    for (vector<TypeField>::const_iterator field = fields.begin(); field != fields.end(); ++field) {
+      if (field->optional) {
+        cg.writeLine("bool has_" + normalizeString(field->name) + ";");
+        initializers += (initializers.empty() ? " : " : ", ") + string("has_") + normalizeString(field->name) + "(false)";
+      }
+    }
+    cg.writeNewLine();
+    cg.writeLine(name + "()" + initializers + " {}");
+    cg.decreaseIndentation();
+    cg.writeLine("};");
+    cg.writeNewLine();
+
+    cg.writeLine(StubGenerator::replaceAll(TEMPLATE_STRUCT_FROMJSON, "<structname>", name));
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    cg.writeLine("if (!value.isObject())");
+    writeIndented(cg, "return false;");
+    for (vector<TypeField>::const_iterator field = fields.begin(); field != fields.end(); ++field) {
+      string member = normalizeString(field->name);
+      string conversion = toConversionScope(field->type) + "FromJson(value[\"" + field->name + "\"], target." + member + ")";
+      if (field->optional) {
+        cg.writeLine("target.has_" + member + " = !value[\"" + field->name + "\"].isNull();");
+        cg.writeLine("if (target.has_" + member + " && !" + conversion + ")");
+      } else {
+        cg.writeLine("if (!" + conversion + ")");
+      }
+      writeIndented(cg, "return false;");
+    }
+    cg.writeLine("return true;");
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+    cg.writeNewLine();
+
+    cg.writeLine(StubGenerator::replaceAll(TEMPLATE_STRUCT_TOJSON, "<structname>", name));
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    cg.writeLine("Json::Value result(Json::objectValue);");
+    for (vector<TypeField>::const_iterator field = fields.begin(); field != fields.end(); ++field) {
+      string member = normalizeString(field->name);
+      string assignment = "result[\"" + field->name + "\"] = " + toConversionScope(field->type) + "ToJson(value." + member + ");";
+      if (field->optional) {
+        cg.writeLine("if (value.has_" + member + ")");
+        writeIndented(cg, assignment);
+      } else {
+        cg.writeLine(assignment);
+      }
+    }
+    cg.writeLine("return result;");
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+    cg.writeLine(StubGenerator::replaceAll(TEMPLATE_STRUCT_EPILOG, "<STRUCTNAME>", guard));
+    cg.writeNewLine();
+  }
+}
+
 string CPPHelper::class2Filename(const string &classname) {
   vector<string> packages = splitPackages(classname);
   string data = packages.at(packages.size() - 1);
@@ -201,6 +375,9 @@ string CPPHelper::isCppConversion(jsontype_t type) {
   case JSON_INTEGER:
     result = ".isIntegral()";
     break;
+  case JSON_INTEGER64:
+    result = ".isInt64()";
+    break;
   case JSON_REAL:
     result = ".isDouble()";
     break;
@@ -28,6 +28,31 @@ namespace jsonrpc {
     static std::string toCppReturntype(jsontype_t type);
     static std::string toCppParamType(jsontype_t type);
 
+    /**
+     * @return The C++ type of a nested schema: the struct name or a std::vector of the element type.
+     */
+    static std::string toCppType(const TypeSchema &schema);
+
+    /**
+     * @return The return type of a method, using its nested schema if it has one.
+     */
+    static std::string toCppReturntype(const Procedure &proc);
+
+    /**
+     * @return "jsonrpc::" if FromJson and ToJson for schema come with the
+     * library, empty for generated structs, which are found in the stub namespace.
+     */
+    static std::string toConversionScope(const TypeSchema &schema);
+
+    static bool hasNestedTypes(const std::vector<Procedure> &procedures);
+
+    /**
+     * Writes the structs used by procedures in dependency order, together with
+     * their FromJson and ToJson overloads. Each struct is guarded, so server
+     * and client stubs of the same namespace can be included together.
+     */
+    static void generateStructs(CodeGenerator &cg, const std::string &stubname, const std::vector<Procedure> &procedures);
+
     static std::string class2Filename(const std::string &classname);
     static std::vector<std::string> splitPackages(const std::string &classname);
 
@@ -21,6 +21,17 @@
 #define TEMPLATE_CPPSERVER_NOTIFICATIONBINDING                                                                                                                 \
   "this->bindAndAddNotification(jsonrpc::Procedure(\"<rawprocedurename>\", "                                                                                   \
   "<paramtype>, <parameterlist> NULL), &<stubname>::<procedurename>I);"
+#define TEMPLATE_CPPSERVER_METHODDISPATCH                                                                                                                      \
+  "this->addDispatchedProcedure(jsonrpc::Procedure(\"<rawprocedurename>\", "                                                                                   \
+  "<paramtype>, <returntype>, <parameterlist> NULL), PROCEDURE_<procedurename>);"
+#define TEMPLATE_CPPSERVER_NOTIFICATIONDISPATCH                                                                                                                \
+  "this->addDispatchedProcedure(jsonrpc::Procedure(\"<rawprocedurename>\", "                                                                                   \
+  "<paramtype>, <parameterlist> NULL), PROCEDURE_<procedurename>);"
+#define TEMPLATE_CPPSERVER_PARAMETERTABLE "static constexpr jsonrpc::ParameterDescriptor <procedurename>Parameters[] = {<parameterlist>};"
+#define TEMPLATE_CPPSERVER_PROCEDUREDESCRIPTOR "{\"<rawprocedurename>\", <proceduretype>, <paramtype>, <returntype>, <parameters>, <count>},"
+#define TEMPLATE_CPPSERVER_METHODTABLEBINDING "this->bindAndAddMethod(jsonrpc::Procedure(procedures[<index>]), &<stubname>::<procedurename>I);"
+#define TEMPLATE_CPPSERVER_NOTIFICATIONTABLEBINDING "this->bindAndAddNotification(jsonrpc::Procedure(procedures[<index>]), &<stubname>::<procedurename>I);"
+#define TEMPLATE_CPPSERVER_TABLEDISPATCH "this->addDispatchedProcedure(jsonrpc::Procedure(procedures[<index>]), PROCEDURE_<procedurename>);"
 
 #define TEMPLATE_CPPSERVER_SIGCLASS "class <stubname> : public jsonrpc::AbstractServer<<stubname>>"
 #define TEMPLATE_CPPSERVER_SIGCONSTRUCTOR                                                                                                                      \
@@ -37,25 +48,36 @@
 #define TEMPLATE_CPPSERVER_SIGNOTIFICATION "inline virtual void <procedurename>I(const Json::Value &request)"
 #define TEMPLATE_CPPSERVER_SIGNOTIFICATION_WITHOUT_PARAMS "inline virtual void <procedurename>I(const Json::Value &/*request*/)"
 
+#define TEMPLATE_CPPSERVER_SIGINVOKEMETHOD                                                                                                                      \
+  "virtual void invokeMethod(const jsonrpc::Procedure &proc, const Json::Value &request, Json::Value &response)"
+#define TEMPLATE_CPPSERVER_SIGINVOKENOTIFICATION "virtual void invokeNotification(const jsonrpc::Procedure &proc, const Json::Value &request)"
+
 #define TEMPLATE_SERVER_ABSTRACTDEFINITION "virtual <returntype> <procedurename>(<parameterlist>) = 0;"
 
 using namespace std;
 using namespace jsonrpc;
 
 CPPServerStubGenerator::CPPServerStubGenerator(const std::string &stubname, vector<Procedure> &procedures, ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+    : StubGenerator(stubname, procedures, outputstream), switchDispatch(false), descriptorTables(false) {}
 
 CPPServerStubGenerator::CPPServerStubGenerator(const string &stubname, std::vector<Procedure> &procedures, const string &filename)
-    : StubGenerator(stubname, procedures, filename) {}
+    : StubGenerator(stubname, procedures, filename), switchDispatch(false), descriptorTables(false) {}
+
+void CPPServerStubGenerator::setSwitchDispatch(bool enabled) { this->switchDispatch = enabled; }
+
+void CPPServerStubGenerator::setDescriptorTables(bool enabled) { this->descriptorTables = enabled; }
 
 void CPPServerStubGenerator::generateStub() {
   vector<string> classname = CPPHelper::splitPackages(this->stubname);
   CPPHelper::prolog(*this, this->stubname);
 
   this->writeLine("#include <jsonrpccpp/server.h>");
+  if (CPPHelper::hasNestedTypes(this->procedures))
+    this->writeLine("#include <jsonrpccpp/common/jsonconversion.h>");
   this->writeNewLine();
 
   int depth = CPPHelper::namespaceOpen(*this, stubname);
+  CPPHelper::generateStructs(*this, this->stubname, this->procedures);
 
   this->writeLine(replaceAll(TEMPLATE_CPPSERVER_SIGCLASS, "<stubname>", classname.at(classname.size() - 1)));
   this->writeLine("{");
@@ -74,6 +96,11 @@ void CPPServerStubGenerator::generateStub() {
 
   this->generateAbstractDefinitions();
 
+  if (this->switchDispatch) {
+    this->writeNewLine();
+    this->generateDispatcher();
+  }
+
   this->decreaseIndentation();
   this->decreaseIndentation();
   this->writeLine("};");
@@ -86,13 +113,23 @@ void CPPServerStubGenerator::generateStub() {
 void CPPServerStubGenerator::generateBindings() {
   string tmp;
   this->increaseIndentation();
-  for (vector<Procedure>::const_iterator it = this->procedures.begin(); it != this->procedures.end(); ++it) {
-    const Procedure &proc = *it;
-    if (proc.GetProcedureType() == RPC_METHOD) {
-      tmp = TEMPLATE_CPPSERVER_METHODBINDING;
+  bool tables = this->descriptorTables && !this->procedures.empty();
+  if (tables)
+    this->generateDescriptorTable();
+  for (size_t i = 0; i < this->procedures.size(); i++) {
+    const Procedure &proc = this->procedures[i];
+    if (tables && this->switchDispatch) {
+      tmp = TEMPLATE_CPPSERVER_TABLEDISPATCH;
+    } else if (tables) {
+      tmp = proc.GetProcedureType() == RPC_METHOD ? TEMPLATE_CPPSERVER_METHODTABLEBINDING : TEMPLATE_CPPSERVER_NOTIFICATIONTABLEBINDING;
+    } else if (proc.GetProcedureType() == RPC_METHOD) {
+      tmp = this->switchDispatch ? TEMPLATE_CPPSERVER_METHODDISPATCH : TEMPLATE_CPPSERVER_METHODBINDING;
     } else {
-      tmp = TEMPLATE_CPPSERVER_NOTIFICATIONBINDING;
+      tmp = this->switchDispatch ? TEMPLATE_CPPSERVER_NOTIFICATIONDISPATCH : TEMPLATE_CPPSERVER_NOTIFICATIONBINDING;
     }
+    stringstream index;
+    index << i;
+    replaceAll2(tmp, "<index>", index.str());
     replaceAll2(tmp, "<rawprocedurename>", proc.GetProcedureName());
     replaceAll2(tmp, "<procedurename>", CPPHelper::normalizeString(proc.GetProcedureName()));
     replaceAll2(tmp, "<returntype>", CPPHelper::toString(proc.GetReturnType()));
@@ -130,12 +167,16 @@ void CPPServerStubGenerator::generateProcedureDefinitions() {
     this->writeLine("{");
     this->increaseIndentation();
 
-    if (proc.GetProcedureType() == RPC_METHOD)
+    this->generateParameterConversions(proc);
+    bool convertResult = proc.GetProcedureType() == RPC_METHOD && proc.GetReturnSchema().IsNested();
+    if (convertResult)
+      this->write("response = " + CPPHelper::toConversionScope(proc.GetReturnSchema()) + "ToJson(");
+    else if (proc.GetProcedureType() == RPC_METHOD)
       this->write("response = ");
     this->write("this->");
     this->write(CPPHelper::normalizeString(proc.GetProcedureName()) + "(");
     this->generateParameterMapping(proc);
-    this->writeLine(");");
+    this->writeLine(convertResult ? "));" : ");");
 
     this->decreaseIndentation();
     this->writeLine("}");
@@ -149,7 +190,7 @@ void CPPServerStubGenerator::generateAbstractDefinitions() {
     tmp = TEMPLATE_SERVER_ABSTRACTDEFINITION;
     string returntype = "void";
     if (proc.GetProcedureType() == RPC_METHOD) {
-      returntype = CPPHelper::toCppReturntype(proc.GetReturnType());
+      returntype = CPPHelper::toCppReturntype(proc);
     }
     replaceAll2(tmp, "<returntype>", returntype);
     replaceAll2(tmp, "<procedurename>", CPPHelper::normalizeString(proc.GetProcedureName()));
@@ -158,6 +199,41 @@ void CPPServerStubGenerator::generateAbstractDefinitions() {
   }
 }
 
+void CPPServerStubGenerator::generateDescriptorTable() {
+  for (vector<Procedure>::const_iterator it = this->procedures.begin(); it != this->procedures.end(); ++it) {
+    const parameterNameList_t &list = it->GetParameters();
+    if (list.empty())
+      continue;
+    stringstream parameters;
+    for (parameterNameList_t::const_iterator it2 = list.begin(); it2 != list.end(); ++it2) {
+      if (it2 != list.begin())
+        parameters << ", ";
+      parameters << "{\"" << it2->first << "\", " << CPPHelper::toString(it2->second) << ", NULL}";
+    }
+    string tmp = TEMPLATE_CPPSERVER_PARAMETERTABLE;
+    replaceAll2(tmp, "<procedurename>", CPPHelper::normalizeString(it->GetProcedureName()));
+    replaceAll2(tmp, "<parameterlist>", parameters.str());
+    this->writeLine(tmp);
+  }
+
+  this->writeLine("static constexpr jsonrpc::ProcedureDescriptor procedures[] = {");
+  this->increaseIndentation();
+  for (vector<Procedure>::const_iterator it = this->procedures.begin(); it != this->procedures.end(); ++it) {
+    stringstream count;
+    count << it->GetParameters().size();
+    string tmp = TEMPLATE_CPPSERVER_PROCEDUREDESCRIPTOR;
+    replaceAll2(tmp, "<rawprocedurename>", it->GetProcedureName());
+    replaceAll2(tmp, "<proceduretype>", it->GetProcedureType() == RPC_METHOD ? "jsonrpc::RPC_METHOD" : "jsonrpc::RPC_NOTIFICATION");
+    replaceAll2(tmp, "<paramtype>", it->GetParameterDeclarationType() == PARAMS_BY_NAME ? "jsonrpc::PARAMS_BY_NAME" : "jsonrpc::PARAMS_BY_POSITION");
+    replaceAll2(tmp, "<returntype>", CPPHelper::toString(it->GetReturnType()));
+    replaceAll2(tmp, "<parameters>", it->GetParameters().empty() ? "NULL" : CPPHelper::normalizeString(it->GetProcedureName()) + "Parameters");
+    replaceAll2(tmp, "<count>", count.str());
+    this->writeLine(tmp);
+  }
+  this->decreaseIndentation();
+  this->writeLine("};");
+}
+
 string CPPServerStubGenerator::generateBindingParameterlist(const Procedure &proc) {
   stringstream parameter;
   const parameterNameList_t &list = proc.GetParameters();
@@ -173,7 +249,9 @@ void CPPServerStubGenerator::generateParameterMapping(const Procedure &proc) {
   const parameterNameList_t &params = proc.GetParameters();
   int i = 0;
   for (parameterNameList_t::const_iterator it2 = params.begin(); it2 != params.end(); ++it2) {
-    if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
+    if (proc.GetParameterSchema(it2->first).IsNested()) {
+      tmp = "param_" + CPPHelper::normalizeString(it2->first);
+    } else if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
       tmp = "request[\"" + it2->first + "\"]" + CPPHelper::toCppConversion(it2->second);
     } else {
       stringstream tmp2;
@@ -187,3 +265,72 @@ void CPPServerStubGenerator::generateParameterMapping(const Procedure &proc) {
     i++;
   }
 }
+
+void CPPServerStubGenerator::generateParameterConversions(const Procedure &proc) {
+  const parameterNameList_t &params = proc.GetParameters();
+  int i = 0;
+  for (parameterNameList_t::const_iterator it = params.begin(); it != params.end(); ++it, i++) {
+    const TypeSchema &schema = proc.GetParameterSchema(it->first);
+    if (!schema.IsNested())
+      continue;
+    stringstream value;
+    if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME)
+      value << "request[\"" << it->first << "\"]";
+    else
+      value << "request[" << i << "u]";
+    string name = "param_" + CPPHelper::normalizeString(it->first);
+    this->writeLine(CPPHelper::toCppType(schema) + " " + name + ";");
+    this->writeLine("if (!" + CPPHelper::toConversionScope(schema) + "FromJson(" + value.str() + ", " + name + "))");
+    this->increaseIndentation();
+    this->writeLine("throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS);");
+    this->decreaseIndentation();
+  }
+}
+
+void CPPServerStubGenerator::generateDispatcher() {
+  vector<string> classname = CPPHelper::splitPackages(this->stubname);
+  string base = "jsonrpc::AbstractServer<" + classname.at(classname.size() - 1) + ">";
+
+  this->decreaseIndentation();
+  this->writeLine("protected:");
+  this->increaseIndentation();
+
+  // Procedures are registered with their id, so calls switch over it without comparing names.
+  this->writeLine("enum procedureId_t");
+  this->writeLine("{");
+  this->increaseIndentation();
+  for (vector<Procedure>::const_iterator it = this->procedures.begin(); it != this->procedures.end(); ++it)
+    this->writeLine("PROCEDURE_" + CPPHelper::normalizeString(it->GetProcedureName()) + ",");
+  this->decreaseIndentation();
+  this->writeLine("};");
+
+  for (int type = RPC_METHOD; type <= RPC_NOTIFICATION; type++) {
+    this->writeNewLine();
+    this->writeLine(type == RPC_METHOD ? TEMPLATE_CPPSERVER_SIGINVOKEMETHOD : TEMPLATE_CPPSERVER_SIGINVOKENOTIFICATION);
+    this->writeLine("{");
+    this->increaseIndentation();
+    this->writeLine("switch (proc.GetDispatchId())");
+    this->writeLine("{");
+    this->increaseIndentation();
+    for (vector<Procedure>::const_iterator it = this->procedures.begin(); it != this->procedures.end(); ++it) {
+      if (it->GetProcedureType() != type)
+        continue;
+      string name = CPPHelper::normalizeString(it->GetProcedureName());
+      this->writeLine("case PROCEDURE_" + name + ":");
+      this->increaseIndentation();
+      this->writeLine("this->" + name + (type == RPC_METHOD ? "I(request, response);" : "I(request);"));
+      this->writeLine("break;");
+      this->decreaseIndentation();
+    }
+    // Procedures bound by subclasses are left to the member pointer maps.
+    this->writeLine("default:");
+    this->increaseIndentation();
+    this->writeLine(base + (type == RPC_METHOD ? "::invokeMethod(proc, request, response);" : "::invokeNotification(proc, request);"));
+    this->writeLine("break;");
+    this->decreaseIndentation();
+    this->decreaseIndentation();
+    this->writeLine("}");
+    this->decreaseIndentation();
+    this->writeLine("}");
+  }
+}
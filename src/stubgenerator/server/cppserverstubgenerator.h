@@ -19,13 +19,45 @@ namespace jsonrpc {
     CPPServerStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, std::ostream &outputstream);
     CPPServerStubGenerator(const std::string &stubname, std::vector<Procedure> &procedures, const std::string &filename);
 
+    /**
+     * Makes the stub call its methods through a generated switch over the
+     * procedure names instead of the member pointer maps of AbstractServer.
+     */
+    void setSwitchDispatch(bool enabled);
+
+    /**
+     * Makes the stub register its procedures from static constexpr
+     * jsonrpc::ProcedureDescriptor tables instead of the varargs
+     * constructors of jsonrpc::Procedure. Like those, the tables carry no
+     * nested schemas, struct and array parameters are checked by the
+     * generated conversions instead.
+     */
+    void setDescriptorTables(bool enabled);
+
     virtual void generateStub();
 
     void generateBindings();
     void generateProcedureDefinitions();
     void generateAbstractDefinitions();
     std::string generateBindingParameterlist(const Procedure &proc);
+
+    /**
+     * Reads the arguments from the parsed Json::Value params, there is no
+     * server side counterpart of jsonrpcstub --cpp-client-direct.
+     */
     void generateParameterMapping(const Procedure &proc);
+
+    /**
+     * Converts parameters with nested schemas into locals before the call,
+     * the bound procedure only checks their top level type.
+     */
+    void generateParameterConversions(const Procedure &proc);
+    void generateDispatcher();
+    void generateDescriptorTable();
+
+  private:
+    bool switchDispatch;
+    bool descriptorTables;
   };
 } // namespace jsonrpc
 
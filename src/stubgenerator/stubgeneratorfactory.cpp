@@ -15,6 +15,7 @@
 #include "server/cppserverstubgenerator.h"
 #include <argtable2.h>
 #include <iostream>
+#include <jsonrpccpp/common/specificationcache.h>
 #include <jsonrpccpp/common/specificationparser.h>
 #include <jsonrpccpp/version.h>
 
@@ -29,16 +30,25 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
   struct arg_lit *verbose = arg_lit0("v", "verbose", "print more information about what is happening");
   struct arg_str *cppserver = arg_str0(NULL, "cpp-server", "<namespace::classname>", "name of the C++ server stub class");
   struct arg_str *cppserverfile = arg_str0(NULL, "cpp-server-file", "<filename.h>", "name of the C++ server stub file");
+  struct arg_lit *cppserverdispatch = arg_lit0(NULL, "cpp-server-dispatch", "dispatch calls in the C++ server stub through a generated switch");
+  struct arg_lit *cppservertables = arg_lit0(NULL, "cpp-server-tables", "register the procedures of the C++ server stub from constexpr descriptor tables");
   struct arg_str *cppclient = arg_str0(NULL, "cpp-client", "<namespace::classname>", "name of the C++ client stub class");
   struct arg_str *cppclientfile = arg_str0(NULL, "cpp-client-file", "<filename.h>", "name of the C++ client stub file");
+  struct arg_lit *cppclientdirect = arg_lit0(NULL, "cpp-client-direct", "write only the call params in the C++ client stub as JSON text");
+  struct arg_lit *cppclientbatch = arg_lit0(NULL, "cpp-client-batch", "add a typed batch builder to the C++ client stub");
+  struct arg_lit *cppclientasync = arg_lit0(NULL, "cpp-client-async", "add methods returning a std::future to the C++ client stub");
   struct arg_str *jsclient = arg_str0(NULL, "js-client", "<classname>", "name of the JavaScript client stub class");
   struct arg_str *jsclientfile = arg_str0(NULL, "js-client-file", "<filename.js>", "name of the JavaScript client stub file");
+  struct arg_lit *jsclientfetch = arg_lit0(NULL, "js-client-fetch", "generate a JavaScript client stub using fetch and Promises, batching calls");
   struct arg_str *pyclient = arg_str0(NULL, "py-client", "<classname>", "name of the Python client stub class");
   struct arg_str *pyclientfile = arg_str0(NULL, "py-client-file", "<filename.py>", "name of the Python client stub file");
+  struct arg_str *speccache = arg_str0(NULL, "spec-cache", "<filename>", "compile the specification to a binary cache file for fast loading");
+  struct arg_lit *pyclientasyncio = arg_lit0(NULL, "py-client-asyncio", "generate an asyncio Python client stub batching calls over one connection");
 
   struct arg_end *end = arg_end(20);
-  void *argtable[] = {inputfile, help,         version,  verbose,      cppserver, cppserverfile, cppclient, cppclientfile,
-                      jsclient,  jsclientfile, pyclient, pyclientfile, end};
+  void *argtable[] = {inputfile,       help,           version,         verbose,   cppserver,     cppserverfile,   cppserverdispatch, cppservertables,
+                      cppclient,       cppclientfile,  cppclientdirect, cppclientbatch, cppclientasync, jsclient,   jsclientfile,      jsclientfetch,
+                      pyclient,        pyclientfile,   pyclientasyncio, speccache,      end};
 
   if (arg_parse(argc, argv, argtable) > 0) {
     arg_print_errors(_stderr, end, argv[0]);
@@ -82,6 +92,16 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
       fprintf(_stdout, "\n");
     }
 
+    if (speccache->count > 0) {
+      if (verbose->count > 0)
+        fprintf(_stdout, "Compiling specification cache to: %s\n", speccache->sval[0]);
+      if (!SpecificationCache::toFile(speccache->sval[0], procedures)) {
+        fprintf(_stderr, "Could not write specification cache: %s\n", speccache->sval[0]);
+        arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
+        return false;
+      }
+    }
+
     if (cppserver->count > 0) {
       string filename;
       if (cppserverfile->count > 0)
@@ -90,7 +110,10 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
         filename = CPPHelper::class2Filename(cppserver->sval[0]);
       if (verbose->count > 0)
         fprintf(_stdout, "Generating C++ Serverstub to: %s\n", filename.c_str());
-      stubgenerators.push_back(new CPPServerStubGenerator(cppserver->sval[0], procedures, filename));
+      CPPServerStubGenerator *generator = new CPPServerStubGenerator(cppserver->sval[0], procedures, filename);
+      generator->setSwitchDispatch(cppserverdispatch->count > 0);
+      generator->setDescriptorTables(cppservertables->count > 0);
+      stubgenerators.push_back(generator);
     }
 
     if (cppclient->count > 0) {
@@ -101,7 +124,11 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
         filename = CPPHelper::class2Filename(cppclient->sval[0]);
       if (verbose->count > 0)
         fprintf(_stdout, "Generating C++ Clientstub to: %s\n", filename.c_str());
-      stubgenerators.push_back(new CPPClientStubGenerator(cppclient->sval[0], procedures, filename));
+      CPPClientStubGenerator *generator = new CPPClientStubGenerator(cppclient->sval[0], procedures, filename);
+      generator->setDirectParams(cppclientdirect->count > 0);
+      generator->setBatch(cppclientbatch->count > 0);
+      generator->setAsync(cppclientasync->count > 0);
+      stubgenerators.push_back(generator);
     }
 
     if (jsclient->count > 0) {
@@ -113,7 +140,9 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
 
       if (verbose->count > 0)
         fprintf(_stdout, "Generating JavaScript Clientstub to: %s\n", filename.c_str());
-      stubgenerators.push_back(new JSClientStubGenerator(jsclient->sval[0], procedures, filename));
+      JSClientStubGenerator *generator = new JSClientStubGenerator(jsclient->sval[0], procedures, filename);
+      generator->setFetch(jsclientfetch->count > 0);
+      stubgenerators.push_back(generator);
     }
 
     if (pyclient->count > 0) {
@@ -125,7 +154,9 @@ bool StubGeneratorFactory::createStubGenerators(int argc, char **argv, vector<Pr
 
       if (verbose->count > 0)
         fprintf(_stdout, "Generating Python Clientstub to: %s\n", filename.c_str());
-      stubgenerators.push_back(new PythonClientStubGenerator(pyclient->sval[0], procedures, filename));
+      PythonClientStubGenerator *generator = new PythonClientStubGenerator(pyclient->sval[0], procedures, filename);
+      generator->setAsyncio(pyclientasyncio->count > 0);
+      stubgenerators.push_back(generator);
     }
   } catch (const JsonRpcException &ex) {
     fprintf(_stderr, "%s\n", ex.what());
@@ -10,7 +10,12 @@
 #include "checkexception.h"
 #include "mockclientconnector.h"
 #include <catch2/catch.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <jsonrpccpp/client.h>
+#include <jsonrpccpp/common/jsonreader.h>
+#include <stdexcept>
+#include <thread>
 
 #define TEST_MODULE "[client]"
 
@@ -39,6 +44,107 @@ namespace testclient {
 
     F1() : client(c, JSONRPC_CLIENT_V1) {}
   };
+
+  class TestBatch : public TypedBatch {
+  public:
+    TestBatch(Client &client) : TypedBatch(client) {}
+
+    TestBatch &add(int a, int b, BatchResult<int> *result = NULL) {
+      Json::Value p;
+      p.append(a);
+      p.append(b);
+      this->addCall("add", p, result);
+      return *this;
+    }
+    TestBatch &log(const string &message) {
+      Json::Value p;
+      p["message"] = message;
+      this->addNotification("log", p);
+      return *this;
+    }
+  };
+
+  /**
+   * Answers every call with its first param, but only once it is opened.
+   */
+  class GatedConnector : public IClientConnector {
+  public:
+    GatedConnector() : open(false) {}
+
+    virtual void SendRPCMessage(const string &message, string &result) {
+      unique_lock<std::mutex> lock(this->access);
+      this->messages.push_back(message);
+      this->condition.notify_all();
+      this->condition.wait(lock, [this] { return this->open; });
+
+      Json::Value request, response(Json::arrayValue);
+      JsonReader::Parse(message, request);
+      Json::Value calls = request;
+      if (!request.isArray()) {
+        calls = Json::Value(Json::arrayValue);
+        calls.append(request);
+      }
+      for (Json::ArrayIndex i = 0; i < calls.size(); i++) {
+        if (!calls[i].isMember("id"))
+          continue;
+        Json::Value answer;
+        if (calls[i].isMember("jsonrpc"))
+          answer["jsonrpc"] = "2.0";
+        else
+          answer["error"] = Json::nullValue;
+        answer["id"] = calls[i]["id"];
+        answer["result"] = calls[i]["params"][0];
+        response.append(answer);
+      }
+      Json::StreamWriterBuilder builder;
+      if (request.isArray())
+        result = response.empty() ? "" : Json::writeString(builder, response);
+      else
+        result = response.empty() ? "" : Json::writeString(builder, response[0]);
+    }
+
+    void WaitForMessages(size_t count) {
+      unique_lock<std::mutex> lock(this->access);
+      this->condition.wait(lock, [this, count] { return this->messages.size() >= count; });
+    }
+
+    void Open() {
+      lock_guard<std::mutex> lock(this->access);
+      this->open = true;
+      this->condition.notify_all();
+    }
+
+    vector<string> messages;
+
+  private:
+    bool open;
+    std::mutex access;
+    condition_variable condition;
+  };
+
+  /**
+   * Fails every call with an exception that isn't a JsonRpcException, once it is opened.
+   */
+  class FailingConnector : public GatedConnector {
+  public:
+    virtual void SendRPCMessage(const string &message, string &result) {
+      GatedConnector::SendRPCMessage(message, result);
+      if (message.find("\"crash\"") != string::npos)
+        throw 42;
+      throw std::runtime_error("connection lost");
+    }
+  };
+
+  Json::Value Params(const Json::Value &value) {
+    Json::Value params(Json::arrayValue);
+    params.append(value);
+    return params;
+  }
+
+  struct SpanCollector : public ITracer {
+    vector<TraceSpan> spans;
+    virtual void OnSpan(const TraceSpan &span) { spans.push_back(span); }
+  };
 } // namespace testclient
 using namespace testclient;
 
@@ -169,6 +275,187 @@ TEST_CASE_METHOD(F, "test_client_v2_batchcall_error", TEST_MODULE) {
   CHECK_EXCEPTION_TYPE(client.CallProcedures(bc), JsonRpcException, check_exception2);
 }
 
+TEST_CASE_METHOD(F, "test_client_typedbatch", TEST_MODULE) {
+  BatchResult<int> first, second, third, fourth;
+  TestBatch batch(client);
+  CHECK(first.IsReceived() == false);
+  CHECK_EXCEPTION_TYPE(first.Get(), JsonRpcException, check_exception2);
+
+  c.SetResponse("[{\"jsonrpc\":\"2.0\", \"id\": 2, \"error\": {\"code\": -32001, \"message\": \"error1\"}},"
+                "{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 3},{\"jsonrpc\":\"2.0\", \"id\": 3, \"result\": \"7\"}]");
+  batch.add(1, 2, &first).log("hello").add(3, 4, &second).add(3, 4, &third).add(5, 6, &fourth).add(7, 8);
+  CHECK(batch.size() == 6);
+  BatchResponse response = batch.send();
+  CHECK(batch.size() == 0);
+
+  Json::Value request = c.GetJsonRequest();
+  REQUIRE(request.size() == 6);
+  CHECK(request[1]["method"] == "log");
+  CHECK(request[1].isMember("id") == false);
+  CHECK(request[2]["params"][1] == 4);
+
+  CHECK(first.IsReceived() == true);
+  CHECK(first.HasError() == false);
+  CHECK(first.Get() == 3);
+  CHECK(second.GetErrorCode() == -32001);
+  CHECK(second.GetErrorMessage() == "error1");
+  CHECK_THROWS_AS(second.Get(), JsonRpcException);
+  // Results of the wrong type and missing responses are errors of the single call.
+  CHECK(third.GetErrorCode() == Errors::ERROR_CLIENT_INVALID_RESPONSE);
+  CHECK(fourth.IsReceived() == true);
+  CHECK(fourth.GetErrorCode() == Errors::ERROR_CLIENT_INVALID_RESPONSE);
+  CHECK(response.getResult(1).asInt() == 3);
+
+  // Batches of notifications are not answered.
+  c.SetResponse("");
+  batch.log("a").log("b").send();
+  CHECK(c.GetJsonRequest().size() == 2);
+
+  c.SetResponse("");
+  batch.add(1, 2, &first);
+  CHECK_EXCEPTION_TYPE(batch.send(), JsonRpcException, check_exception1);
+  CHECK(batch.send().hasErrors() == false);
+}
+
+TEST_CASE_METHOD(F, "test_client_async", TEST_MODULE) {
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  future<int> single = client.CallMethodAsync<int>("abcd", Params(1));
+  CHECK(single.get() == 23);
+  CHECK(c.GetJsonRequest()["method"] == "abcd");
+
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"error\": {\"code\": -32001, \"message\": \"error1\"}}");
+  future<int> failed = client.CallMethodAsync<int>("abcd", Params(1));
+  CHECK_THROWS_AS(failed.get(), JsonRpcException);
+
+  c.SetResponse("");
+  client.CallNotificationAsync("abcd", Params(1)).get();
+  CHECK(c.GetJsonRequest().isMember("id") == false);
+}
+
+TEST_CASE("test_client_async_pipelining", TEST_MODULE) {
+  GatedConnector connector;
+  {
+    Client client(connector);
+    future<int> first = client.CallMethodAsync<int>("echo", Params(1));
+    connector.WaitForMessages(1);
+
+    // Queued while the first call is in flight, so sent as one batch.
+    future<int> second = client.CallMethodAsync<int>("echo", Params(2));
+    future<string> third = client.CallMethodAsync<string>("echo", Params(3));
+    future<void> notification = client.CallNotificationAsync("log", Params("hello"));
+    Json::Value value;
+    bool called = false;
+    client.CallMethodAsync("echo", Params("four"), [&value, &called](const Json::Value &result, const JsonRpcException *error) {
+      value = result;
+      called = error == NULL;
+    });
+    CHECK(connector.messages.size() == 1);
+
+    connector.Open();
+    CHECK(first.get() == 1);
+    CHECK(second.get() == 2);
+    CHECK_EXCEPTION_TYPE(third.get(), JsonRpcException, check_exception2);
+    notification.get();
+
+    // Blocking calls wait for the connector.
+    CHECK(client.CallMethod("echo", Params(5)).asInt() == 5);
+  }
+  // The client sends what is still queued before it is destroyed.
+  REQUIRE(connector.messages.size() == 3);
+  Json::Value batch;
+  JsonReader::Parse(connector.messages[1], batch);
+  REQUIRE(batch.size() == 4);
+  CHECK(batch[2]["method"] == "log");
+  CHECK(batch[3]["params"][0] == "four");
+}
+
+TEST_CASE_METHOD(F, "test_client_async_context", TEST_MODULE) {
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  {
+    TraceContext context("trace-async");
+    CancellationToken caller(ITracer::Now() + 1000000000ull);
+    CancellationScope scope(caller);
+    CHECK(client.CallMethodAsync<int>("abcd", Params(1)).get() == 23);
+  }
+  CHECK(c.GetJsonRequest()["traceparent"].asString() == "trace-async");
+  CHECK(c.GetJsonRequest()["deadline"].asInt() <= 1000);
+
+  CHECK(client.CallMethodAsync<int>("abcd", Params(1)).get() == 23);
+  CHECK(c.GetJsonRequest().isMember("traceparent") == false);
+  CHECK(c.GetJsonRequest().isMember("deadline") == false);
+}
+
+TEST_CASE("test_client_async_context_batches", TEST_MODULE) {
+  GatedConnector connector;
+  {
+    Client client(connector);
+    future<int> first = client.CallMethodAsync<int>("echo", Params(1));
+    connector.WaitForMessages(1);
+
+    vector<future<int>> results;
+    {
+      TraceContext context("a");
+      results.push_back(client.CallMethodAsync<int>("echo", Params(2)));
+      results.push_back(client.CallMethodAsync<int>("echo", Params(3)));
+    }
+    {
+      TraceContext context("b");
+      results.push_back(client.CallMethodAsync<int>("echo", Params(4)));
+    }
+    connector.Open();
+    CHECK(first.get() == 1);
+    for (size_t i = 0; i < results.size(); i++)
+      CHECK(results[i].get() == static_cast<int>(i) + 2);
+  }
+  // Calls of different traces are not sent in the same batch.
+  REQUIRE(connector.messages.size() == 3);
+  Json::Value batch, single;
+  JsonReader::Parse(connector.messages[1], batch);
+  REQUIRE(batch.size() == 2);
+  CHECK(batch[0]["traceparent"] == "a");
+  CHECK(batch[1]["traceparent"] == "a");
+  JsonReader::Parse(connector.messages[2], single);
+  CHECK(single["traceparent"] == "b");
+}
+
+TEST_CASE("test_client_async_foreign_exceptions", TEST_MODULE) {
+  FailingConnector connector;
+  int code = 0;
+  string message;
+  {
+    Client client(connector);
+    future<int> first = client.CallMethodAsync<int>("echo", Params(1));
+    connector.WaitForMessages(1);
+
+    // Queued while the first call is in flight, so sent as one batch.
+    future<int> second = client.CallMethodAsync<int>("echo", Params(2));
+    client.CallMethodAsync("echo", Params(3), [&code, &message](const Json::Value &, const JsonRpcException *error) {
+      code = error != NULL ? error->GetCode() : 0;
+      message = error != NULL ? error->GetMessage() : "";
+    });
+    connector.Open();
+    CHECK_THROWS_AS(first.get(), std::runtime_error);
+    CHECK_THROWS_AS(second.get(), std::runtime_error);
+    CHECK_THROWS_AS(client.CallNotificationAsync("crash", Params(4)).get(), int);
+  }
+  CHECK(code == Errors::ERROR_CLIENT_CONNECTOR);
+  CHECK(message.find("connection lost") != string::npos);
+}
+
+TEST_CASE("test_client_async_v1", TEST_MODULE) {
+  GatedConnector connector;
+  connector.Open();
+  Client client(connector, JSONRPC_CLIENT_V1);
+  vector<future<Json::Value>> results;
+  for (int i = 0; i < 3; i++)
+    results.push_back(client.CallMethodAsync<Json::Value>("echo", Params(i)));
+  for (int i = 0; i < 3; i++)
+    CHECK(results[i].get() == Json::Value(i));
+  // JSON-RPC 1.0 has no batches.
+  for (size_t i = 0; i < connector.messages.size(); i++)
+    CHECK(connector.messages[i][0] == '{');
+}
+
 TEST_CASE_METHOD(F1, "test_client_v1_method_success", TEST_MODULE) {
   params.append(23);
   c.SetResponse("{\"id\": 1, \"result\": 23, \"error\": null}");
@@ -227,3 +514,150 @@ TEST_CASE_METHOD(F1, "test_client_v1_invalidresponse", TEST_MODULE) {
   c.SetResponse("23");
   CHECK_EXCEPTION_TYPE(client.CallMethod("abcd", Json::nullValue), JsonRpcException, check_exception2);
 }
+
+TEST_CASE_METHOD(F, "test_client_tracing", TEST_MODULE) {
+  SpanCollector tracer;
+  client.SetTracer(&tracer);
+  client.SetTraceId("trace-1");
+
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  client.CallMethod("abcd", params);
+  CHECK(c.GetJsonRequest()["traceparent"].asString() == "trace-1");
+
+  REQUIRE(tracer.spans.size() == 3);
+  CHECK(tracer.spans[0].stage == STAGE_BUILD);
+  CHECK(tracer.spans[1].stage == STAGE_SEND);
+  CHECK(tracer.spans[2].stage == STAGE_PARSE);
+  for (size_t i = 0; i < tracer.spans.size(); i++) {
+    CHECK(tracer.spans[i].method == "abcd");
+    CHECK(tracer.spans[i].id == 1);
+    CHECK(tracer.spans[i].traceid == "trace-1");
+    CHECK(tracer.spans[i].start <= tracer.spans[i].end);
+  }
+  CHECK(tracer.spans[0].end <= tracer.spans[1].start);
+
+  tracer.spans.clear();
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"error\": {\"code\": -32602, \"message\": \"x\"}}");
+  CHECK_THROWS_AS(client.CallMethod("abcd", params), JsonRpcException);
+  CHECK(tracer.spans.size() == 3);
+
+  tracer.spans.clear();
+  client.CallNotification("abcd", params);
+  REQUIRE(tracer.spans.size() == 2);
+  CHECK(tracer.spans[1].id.isNull());
+}
+
+TEST_CASE_METHOD(F, "test_client_trace_context", TEST_MODULE) {
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  client.CallMethod("abcd", params);
+  CHECK(c.GetJsonRequest().isMember("traceparent") == false);
+
+  {
+    TraceContext outer("outer");
+    {
+      TraceContext inner("inner");
+      client.CallMethod("abcd", params);
+      CHECK(c.GetJsonRequest()["traceparent"].asString() == "inner");
+    }
+    client.CallMethod("abcd", params);
+    CHECK(c.GetJsonRequest()["traceparent"].asString() == "outer");
+
+    client.SetTraceId("explicit");
+    client.CallMethod("abcd", params);
+    CHECK(c.GetJsonRequest()["traceparent"].asString() == "explicit");
+    client.SetTraceId("");
+  }
+  CHECK(TraceContext::GetCurrent() == "");
+}
+
+TEST_CASE_METHOD(F, "test_client_deadline", TEST_MODULE) {
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  client.CallMethod("abcd", params);
+  CHECK(c.GetJsonRequest().isMember("deadline") == false);
+
+  client.SetDeadline(5000);
+  client.CallMethod("abcd", params);
+  CHECK(c.GetJsonRequest()["deadline"].asInt() == 5000);
+
+  // a shorter deadline of the caller wins
+  CancellationToken caller(ITracer::Now() + 1000000000ull);
+  {
+    CancellationScope scope(caller);
+    client.CallMethod("abcd", params);
+    CHECK(c.GetJsonRequest()["deadline"].asInt() <= 1000);
+    CHECK(c.GetJsonRequest()["deadline"].asInt() > 500);
+
+    client.SetDeadline(0);
+    client.CallNotification("abcd", params);
+    CHECK(c.GetJsonRequest()["deadline"].asInt() <= 1000);
+  }
+  client.CallMethod("abcd", params);
+  CHECK(c.GetJsonRequest().isMember("deadline") == false);
+}
+
+TEST_CASE_METHOD(F, "test_client_codec", TEST_MODULE) {
+  client.SetCodec(CODEC_CBOR);
+  Json::Value response;
+  response["jsonrpc"] = "2.0";
+  response["id"] = 1;
+  response["result"] = 23;
+  string encoded;
+  Codec::Encode(response, CODEC_CBOR, encoded);
+  c.SetResponse(encoded);
+
+  CHECK(client.CallMethod("abcd", params).asInt() == 23);
+  Json::Value request;
+  REQUIRE(Codec::Decode(c.GetRequest(), CODEC_CBOR, request) == true);
+  CHECK(request["method"].asString() == "abcd");
+  CHECK(request["params"] == params);
+
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  CHECK_EXCEPTION_TYPE(client.CallMethod("abcd", params), JsonRpcException, check_exception1);
+
+  // batches
+  Json::Value responses(Json::arrayValue);
+  responses.append(response);
+  Codec::Encode(responses, CODEC_CBOR, encoded);
+  c.SetResponse(encoded);
+  BatchCall batch;
+  int id = batch.addCall("abcd", params);
+  CHECK(client.CallProcedures(batch).getResult(id).asInt() == 23);
+  REQUIRE(Codec::Decode(c.GetRequest(), CODEC_CBOR, request) == true);
+  CHECK(request.isArray());
+}
+
+TEST_CASE_METHOD(F, "test_client_direct_params", TEST_MODULE) {
+  ParameterWriter writer(PARAMS_BY_NAME);
+  writer.Add("name", "Peter");
+  writer.Add("year", 1990);
+  params["name"] = "Peter";
+  params["year"] = 1990;
+
+  c.SetResponse("{\"jsonrpc\":\"2.0\", \"id\": 1, \"result\": 23}");
+  CHECK(client.CallMethod("abcd", writer).asInt() == 23);
+  Json::Value direct = c.GetJsonRequest();
+  client.CallMethod("abcd", params);
+  CHECK(direct == c.GetJsonRequest());
+
+  client.CallNotification("abcd", writer);
+  direct = c.GetJsonRequest();
+  client.CallNotification("abcd", params);
+  CHECK(direct == c.GetJsonRequest());
+
+  // Without params the member is left out, like for Json::nullValue.
+  client.CallMethod("abcd", ParameterWriter(PARAMS_BY_POSITION));
+  CHECK(c.GetJsonRequest().isMember("params") == false);
+
+  client.SetCodec(CODEC_MSGPACK);
+  Json::Value response;
+  response["jsonrpc"] = "2.0";
+  response["id"] = 1;
+  response["result"] = 23;
+  string encoded;
+  Codec::Encode(response, CODEC_MSGPACK, encoded);
+  c.SetResponse(encoded);
+  CHECK(client.CallMethod("abcd", writer).asInt() == 23);
+  Json::Value request;
+  REQUIRE(Codec::Decode(c.GetRequest(), CODEC_MSGPACK, request) == true);
+  CHECK(request["params"] == params);
+}
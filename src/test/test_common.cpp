@@ -9,10 +9,23 @@
 
 #include "checkexception.h"
 #include <catch2/catch.hpp>
+#include <jsonrpccpp/common/codec.h>
 #include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/jsonconversion.h>
+#include <jsonrpccpp/common/jsonenvelope.h>
+#include <jsonrpccpp/common/jsonreader.h>
+#include <jsonrpccpp/common/parameterwriter.h>
 #include <jsonrpccpp/common/procedure.h>
+#include <jsonrpccpp/common/specificationcache.h>
 #include <jsonrpccpp/common/specificationparser.h>
 #include <jsonrpccpp/common/specificationwriter.h>
+#include <jsonrpccpp/common/streamreader.h>
+#include <jsonrpccpp/common/streamwriter.h>
+#include <jsonrpccpp/common/typeschema.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
 
 #define TEST_MODULE "[common]"
 
@@ -89,6 +102,112 @@ TEST_CASE("test_procedure_parametervalidation", TEST_MODULE) {
   CHECK(proc2.ValidateNamedParameters(param4) == true);
 }
 
+TEST_CASE("test_procedure_descriptor", TEST_MODULE) {
+  static const ParameterDescriptor named[] = {{"name", JSON_STRING, NULL}, {"ssnr", JSON_INTEGER, NULL}};
+  static const ProcedureDescriptor descriptor = {"someprocedure", RPC_METHOD, PARAMS_BY_NAME, JSON_BOOLEAN, named, 2};
+  Procedure proc1(descriptor);
+  CHECK(proc1.GetProcedureName() == "someprocedure");
+  CHECK(proc1.GetProcedureType() == RPC_METHOD);
+  CHECK(proc1.GetReturnType() == JSON_BOOLEAN);
+
+  Json::Value param1;
+  param1["name"] = "Peter";
+  param1["ssnr"] = 4711;
+  CHECK(proc1.ValdiateParameters(param1) == true);
+  param1["ssnr"] = "4711";
+  CHECK(proc1.ValdiateParameters(param1) == false);
+  param1.removeMember("ssnr");
+  CHECK(proc1.ValdiateParameters(param1) == false);
+
+  REQUIRE(proc1.GetParameters().size() == 2);
+  CHECK(proc1.GetParameters().at("ssnr") == JSON_INTEGER);
+  CHECK(proc1.GetParameters().size() == 2);
+
+  static const ParameterDescriptor positional[] = {{"param01", JSON_STRING, NULL}, {"param02", JSON_REAL, NULL}};
+  static const ProcedureDescriptor descriptor2 = {"otherprocedure", RPC_NOTIFICATION, PARAMS_BY_POSITION, JSON_BOOLEAN, positional, 2};
+  Procedure proc2(descriptor2);
+  Json::Value param2;
+  param2.append("Peter");
+  param2.append(0.5);
+  CHECK(proc2.ValdiateParameters(param2) == true);
+  param2.append(1);
+  CHECK(proc2.ValdiateParameters(param2) == false);
+
+  // Adding a parameter leaves the descriptor behind.
+  proc2.AddParameter("param03", JSON_INTEGER);
+  CHECK(proc2.GetParameters().size() == 3);
+  CHECK(proc2.ValdiateParameters(param2) == true);
+
+  static const ProcedureDescriptor descriptor3 = {"noparameters", RPC_METHOD, PARAMS_BY_NAME, JSON_STRING, NULL, 0};
+  Procedure proc3(descriptor3);
+  CHECK(proc3.GetParameters().empty());
+  CHECK(proc3.ValdiateParameters(Json::Value()) == true);
+}
+
+TEST_CASE("test_procedure_descriptor_schema", TEST_MODULE) {
+  TypeSchema point = TypeSchema::Struct("Point");
+  point.AddField("x", TypeSchema(JSON_INTEGER), false);
+  const TypeSchema points = TypeSchema::ArrayOf(point);
+  const ParameterDescriptor named[] = {{"points", JSON_ARRAY, &points}, {"label", JSON_STRING, NULL}};
+  const ProcedureDescriptor descriptor = {"draw", RPC_METHOD, PARAMS_BY_NAME, JSON_BOOLEAN, named, 2};
+  Procedure proc(descriptor);
+  CHECK(proc.GetParameterSchema("points").ToString() == "Point[]");
+  CHECK(proc.GetParameterSchema("label").IsDefined() == false);
+  REQUIRE(proc.GetParameterNames().size() == 2);
+  CHECK(proc.GetParameterNames()[0] == "points");
+
+  Json::Value params;
+  params["label"] = "line";
+  params["points"][0]["x"] = 1;
+  CHECK(proc.ValdiateParameters(params) == true);
+  params["points"][0]["x"] = "far";
+  CHECK(proc.ValdiateParameters(params) == false);
+
+  const ParameterDescriptor positional[] = {{"param01", JSON_ARRAY, &points}};
+  const ProcedureDescriptor descriptor2 = {"move", RPC_NOTIFICATION, PARAMS_BY_POSITION, JSON_BOOLEAN, positional, 1};
+  Procedure proc2(descriptor2);
+  Json::Value param2;
+  param2.append(Json::Value(Json::arrayValue));
+  param2[0].append(Json::Value(Json::objectValue));
+  CHECK(proc2.ValdiateParameters(param2) == false);
+  param2[0][0]["x"] = 2;
+  CHECK(proc2.ValdiateParameters(param2) == true);
+
+  // The schemas are kept when the descriptor is left behind.
+  proc2.AddParameter("param02", JSON_INTEGER);
+  param2.append(3);
+  CHECK(proc2.ValdiateParameters(param2) == true);
+  param2[0][0]["x"] = "far";
+  CHECK(proc2.ValdiateParameters(param2) == false);
+}
+
+TEST_CASE("test_procedure_descriptor_lazy", TEST_MODULE) {
+  static const ParameterDescriptor named[] = {{"name", JSON_STRING, NULL}, {"ssnr", JSON_INTEGER, NULL}};
+  static const ProcedureDescriptor descriptor = {"someprocedure", RPC_METHOD, PARAMS_BY_NAME, JSON_BOOLEAN, named, 2};
+
+  // Copies taken before and after the parameters have been built both get them.
+  Procedure proc(descriptor);
+  Procedure early(proc);
+  vector<std::thread> threads;
+  for (int i = 0; i < 4; i++)
+    threads.push_back(std::thread([&proc] { CHECK(proc.GetParameters().size() == 2); }));
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  Procedure late(proc);
+  CHECK(early.GetParameterNames() == proc.GetParameterNames());
+  CHECK(late.GetParameters() == proc.GetParameters());
+
+  // Assigning, like registering at a server does, keeps procedures lazy.
+  Procedure assigned;
+  assigned = Procedure(descriptor);
+  CHECK(assigned.GetParameters() == proc.GetParameters());
+  assigned = early;
+  assigned.AddParameter("age", JSON_INTEGER);
+  REQUIRE(assigned.GetParameterNames().size() == 3);
+  CHECK(assigned.GetParameterNames()[2] == "age");
+  CHECK(early.GetParameters().size() == 2);
+}
+
 TEST_CASE("test_exception", TEST_MODULE) {
   JsonRpcException ex(Errors::ERROR_CLIENT_CONNECTOR);
   CHECK(string(ex.what()) == "Exception -32003 : Client connector error");
@@ -148,6 +267,152 @@ TEST_CASE("test_specificationparser_success", TEST_MODULE) {
   CHECK(procs[3].GetParameterDeclarationType() == PARAMS_BY_NAME);
 }
 
+TEST_CASE("test_typeschema", TEST_MODULE) {
+  TypeSchema address = TypeSchema::Struct("Address");
+  address.AddField("street", TypeSchema(JSON_STRING), false);
+  address.AddField("zip", TypeSchema(JSON_STRING), true);
+  TypeSchema user = TypeSchema::Struct("User");
+  user.AddField("id", TypeSchema(JSON_INTEGER64), false);
+  user.AddField("addresses", TypeSchema::ArrayOf(address), false);
+
+  CHECK(TypeSchema().IsDefined() == false);
+  CHECK(TypeSchema().Validate("anything") == true);
+  CHECK(user.IsStruct() == true);
+  CHECK(user.GetType() == JSON_OBJECT);
+  CHECK(user.GetFields().size() == 2);
+  CHECK(TypeSchema::ArrayOf(user).GetType() == JSON_ARRAY);
+  CHECK(TypeSchema::ArrayOf(TypeSchema::ArrayOf(TypeSchema(JSON_INTEGER))).ToString() == "integer[][]");
+  CHECK(TypeSchema::GetBuiltinType("int64") == JSON_INTEGER64);
+  CHECK(TypeSchema::GetBuiltinType("User") == 0);
+
+  Json::Value value;
+  value["id"] = static_cast<Json::Int64>(9007199254740993LL);
+  value["addresses"][0]["street"] = "Main Street";
+  value["addresses"][1]["street"] = "Side Street";
+  value["addresses"][1]["zip"] = "1010";
+  value["ignored"] = true;
+  CHECK(user.Validate(value) == true);
+
+  value["addresses"][1]["zip"] = 1010;
+  CHECK(user.Validate(value) == false);
+  value["addresses"][1]["zip"] = Json::nullValue;
+  CHECK(user.Validate(value) == true);
+  value["addresses"][0].removeMember("street");
+  CHECK(user.Validate(value) == false);
+  CHECK(TypeSchema(JSON_INTEGER64).Validate(1.5) == false);
+
+  Procedure proc("addUser", PARAMS_BY_POSITION, JSON_BOOLEAN, "param01", JSON_STRING, NULL);
+  proc.AddParameter("param02", user);
+  Json::Value params;
+  params.append("peter");
+  params.append(value);
+  CHECK(proc.ValdiateParameters(params) == false);
+  params[1]["addresses"][0]["street"] = "Main Street";
+  CHECK(proc.ValdiateParameters(params) == true);
+  params[0] = 1;
+  CHECK(proc.ValdiateParameters(params) == false);
+}
+
+TEST_CASE("test_specificationparser_types", TEST_MODULE) {
+  vector<Procedure> procs = SpecificationParser::GetProceduresFromFile("typedspec.json");
+  REQUIRE(procs.size() == 4);
+
+  CHECK(procs[0].GetProcedureName() == "addUser");
+  CHECK(procs[0].GetReturnType() == JSON_INTEGER64);
+  CHECK(procs[0].GetParameters().at("user") == JSON_OBJECT);
+  CHECK(procs[0].GetParameters().at("notify") == JSON_BOOLEAN);
+  const TypeSchema &user = procs[0].GetParameterSchema("user");
+  REQUIRE(user.IsStruct() == true);
+  CHECK(user.GetName() == "User");
+  CHECK(procs[0].GetParameterSchema("notify").IsDefined() == false);
+
+  CHECK(procs[1].GetReturnSchema().ToString() == "User");
+  CHECK(procs[2].GetParameterSchema("param01").ToString() == "string[]");
+  CHECK(procs[2].GetReturnSchema().ToString() == "User[]");
+  CHECK(procs[3].GetProcedureType() == RPC_NOTIFICATION);
+  CHECK(procs[3].GetParameterSchema("rows").ToString() == "integer[][]");
+
+  Json::Value params;
+  params["notify"] = true;
+  params["user"]["name"] = "peter";
+  params["user"]["id"] = 1;
+  params["user"]["admin"] = false;
+  params["user"]["address"]["street"] = "Main Street";
+  params["user"]["address"]["number"] = 1;
+  params["user"]["tags"] = Json::arrayValue;
+  CHECK(procs[0].ValdiateParameters(params) == true);
+  params["user"]["tags"].append(3);
+  CHECK(procs[0].ValdiateParameters(params) == false);
+
+  // Structs are written before the procedures using them and parsed back the same way.
+  Json::Value written = SpecificationWriter::toJsonValue(procs);
+  REQUIRE(written.size() == 6);
+  CHECK(written[0]["struct"] == "Address");
+  CHECK(written[1]["struct"] == "User");
+  CHECK(written[1]["fields"]["previous?"]["$type"] == "Address[]");
+  vector<Procedure> reparsed = SpecificationParser::GetProceduresFromString(SpecificationWriter::toString(procs));
+  REQUIRE(reparsed.size() == 4);
+  CHECK(reparsed[0].GetReturnType() == JSON_INTEGER64);
+  CHECK(reparsed[0].GetParameterSchema("user").GetFields().size() == 6);
+  CHECK(reparsed[2].GetReturnSchema().ToString() == "User[]");
+
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString("[{\"name\":\"proc1\", \"params\": {\"p\": {\"$type\": \"User\"}}}]"),
+                       JsonRpcException, check_exception2);
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString("[{\"struct\":\"A\", \"fields\": {\"b\": {\"$type\": \"B\"}}},"
+                                                                    "{\"struct\":\"B\", \"fields\": {}}]"),
+                       JsonRpcException, check_exception2);
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString("[{\"struct\":\"A\", \"fields\": {}},{\"struct\":\"A\", \"fields\": {}}]"),
+                       JsonRpcException, check_exception2);
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString("[{\"struct\":\"string\", \"fields\": {}}]"), JsonRpcException, check_exception2);
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString("[{\"struct\":\"A\"}]"), JsonRpcException, check_exception2);
+}
+
+TEST_CASE("test_specificationparser_const", TEST_MODULE) {
+  Json::Value spec;
+  istringstream("[{\"struct\":\"User\", \"fields\": {\"name\": \"\", \"address\": {\"street\": \"\"}}},"
+                "{\"name\":\"proc1\", \"params\": [{\"a\": 1}, {\"$type\": \"User\"}], \"returns\": {\"ok\": true}}]") >>
+      spec;
+  Json::Value original = spec;
+
+  vector<Procedure> procs = SpecificationParser::GetProcedures(spec);
+  REQUIRE(procs.size() == 1);
+  CHECK(procs[0].GetParameters().at("param01") == JSON_OBJECT);
+  CHECK(procs[0].GetParameterSchema("param02").GetName() == "User");
+  CHECK(spec == original);
+  CHECK(!spec[1]["params"][0].isMember("$type"));
+}
+
+TEST_CASE("test_jsonconversion", TEST_MODULE) {
+  vector<vector<int>> rows;
+  Json::Value value;
+  value[0].append(1);
+  value[0].append(2);
+  value[1] = Json::arrayValue;
+  REQUIRE(jsonrpc::FromJson(value, rows) == true);
+  REQUIRE(rows.size() == 2);
+  CHECK(rows[0][1] == 2);
+  CHECK(rows[1].empty() == true);
+  CHECK(jsonrpc::ToJson(rows) == value);
+
+  value[1].append("3");
+  CHECK(jsonrpc::FromJson(value, rows) == false);
+
+  vector<bool> flags;
+  CHECK(jsonrpc::FromJson(jsonrpc::ToJson(vector<bool>(3, true)), flags) == true);
+  CHECK(flags == vector<bool>(3, true));
+
+  Json::Int64 big = 0;
+  CHECK(jsonrpc::FromJson(Json::Value(static_cast<Json::Int64>(9007199254740993LL)), big) == true);
+  CHECK(big == 9007199254740993LL);
+  int small = 0;
+  CHECK(jsonrpc::FromJson(Json::Value(static_cast<Json::Int64>(9007199254740993LL)), small) == false);
+  double real = 0;
+  CHECK(jsonrpc::FromJson(Json::Value(3), real) == true);
+  CHECK(real == 3.0);
+  string text;
+  CHECK(jsonrpc::FromJson(Json::Value(3), text) == false);
+}
+
 TEST_CASE("test_specificationwriter", TEST_MODULE) {
   vector<Procedure> procedures;
 
@@ -192,5 +457,422 @@ TEST_CASE("test_specificationwriter", TEST_MODULE) {
   CHECK(result[1]["returns"].isIntegral() == true);
 
   CHECK(SpecificationWriter::toFile("testspec.json", procedures) == true);
+  unlink("testspec.json");
   CHECK(SpecificationWriter::toFile("/a/b/c/testspec.json", procedures) == false);
 }
+
+TEST_CASE("test_specificationcache", TEST_MODULE) {
+  vector<Procedure> procs = SpecificationParser::GetProceduresFromString(
+      "[{\"struct\": \"Point\", \"fields\": {\"x\": 1, \"y?\": 1.0}},"
+      " {\"struct\": \"Shape\", \"fields\": {\"points\": {\"$type\": \"Point[]\"}, \"origin\": {\"$type\": \"Point\"}}},"
+      " {\"name\": \"draw\", \"params\": {\"shape\": {\"$type\": \"Shape\"}, \"color\": \"red\"}, \"returns\": {\"$type\": \"int64\"}},"
+      " {\"name\": \"move\", \"params\": [{\"$type\": \"Point\"}, 1.0]},"
+      " {\"name\": \"count\", \"returns\": 1}]");
+
+  string binary = SpecificationCache::toBinary(procs);
+  CHECK(SpecificationCache::isCache(binary.data(), binary.size()) == true);
+  CHECK(SpecificationCache::isCache("[{}]", 4) == false);
+
+  vector<Procedure> loaded = SpecificationCache::fromBinary(binary.data(), binary.size());
+  REQUIRE(loaded.size() == 3);
+  CHECK(loaded[0].GetProcedureName() == "draw");
+  CHECK(loaded[0].GetProcedureType() == RPC_METHOD);
+  CHECK(loaded[0].GetReturnType() == JSON_INTEGER64);
+  CHECK(loaded[0].GetParameters().at("color") == JSON_STRING);
+  CHECK(loaded[0].GetParameterSchema("color").IsDefined() == false);
+  const TypeSchema &shape = loaded[0].GetParameterSchema("shape");
+  REQUIRE(shape.IsStruct() == true);
+  CHECK(shape.GetName() == "Shape");
+  CHECK(shape.GetFields()[1].type.ToString() == "Point[]");
+  CHECK(loaded[1].GetProcedureType() == RPC_NOTIFICATION);
+  CHECK(loaded[1].GetParameterDeclarationType() == PARAMS_BY_POSITION);
+  CHECK(loaded[1].GetParameterSchema("param01").ToString() == "Point");
+  CHECK(loaded[2].GetParameters().empty() == true);
+  CHECK(loaded[2].GetReturnSchema().ToString() == "integer");
+
+  // Loaded procedures validate like parsed ones.
+  Json::Value params;
+  params["color"] = "blue";
+  params["shape"]["origin"]["x"] = 1;
+  params["shape"]["points"].append(params["shape"]["origin"]);
+  CHECK(loaded[0].ValdiateParameters(params) == true);
+  params["shape"]["points"][0]["y"] = "far";
+  CHECK(loaded[0].ValdiateParameters(params) == false);
+  Json::Value positional;
+  positional.append(params["shape"]["origin"]);
+  positional.append(2.5);
+  CHECK(loaded[1].ValdiateParameters(positional) == true);
+  CHECK(SpecificationCache::toBinary(loaded) == binary);
+
+  // Files are told apart by their content.
+  REQUIRE(SpecificationCache::toFile("testspec.bin", procs) == true);
+  CHECK(SpecificationParser::GetProceduresFromFile("testspec.bin").size() == 3);
+  unlink("testspec.bin");
+  CHECK(SpecificationCache::toFile("/a/b/c/testspec.bin", procs) == false);
+
+  for (size_t i = 0; i < binary.size(); i++)
+    CHECK_EXCEPTION_TYPE(SpecificationCache::fromBinary(binary.data(), i), JsonRpcException, check_exception2);
+  string version = binary;
+  version[8] = 2;
+  CHECK_EXCEPTION_TYPE(SpecificationCache::fromBinary(version.data(), version.size()), JsonRpcException, check_exception2);
+  CHECK_EXCEPTION_TYPE(SpecificationCache::fromBinary((binary + "x").data(), binary.size() + 1), JsonRpcException, check_exception2);
+}
+
+TEST_CASE("test_specificationcache_limits", TEST_MODULE) {
+  // Positional parameters keep their positions, whatever their names.
+  Procedure move("move", PARAMS_BY_POSITION, JSON_BOOLEAN, "to", JSON_STRING, "by", JSON_INTEGER, NULL);
+  vector<Procedure> procs(1, move);
+  string binary = SpecificationCache::toBinary(procs);
+  vector<Procedure> loaded = SpecificationCache::fromBinary(binary.data(), binary.size());
+  REQUIRE(loaded.size() == 1);
+  REQUIRE(loaded[0].GetParameterNames().size() == 2);
+  CHECK(loaded[0].GetParameterNames()[0] == "to");
+  CHECK(loaded[0].GetParameterNames()[1] == "by");
+  Json::Value positional;
+  positional.append("home");
+  positional.append(3);
+  CHECK(loaded[0].ValdiateParameters(positional) == true);
+
+  // Schemas nesting arrays deeper than specifications can are neither written nor read.
+  TypeSchema nested(JSON_INTEGER);
+  for (size_t i = 0; i < TypeSchema::MAX_ARRAY_DEPTH; i++)
+    nested = TypeSchema::ArrayOf(nested);
+  procs[0].SetReturnSchema(nested);
+  binary = SpecificationCache::toBinary(procs);
+  CHECK(SpecificationCache::fromBinary(binary.data(), binary.size())[0].GetReturnSchema().IsArray() == true);
+  size_t arrays = binary.find(string(TypeSchema::MAX_ARRAY_DEPTH, '\x02'));
+  REQUIRE(arrays != string::npos);
+  binary.insert(arrays, 1, '\x02');
+  CHECK_EXCEPTION_TYPE(SpecificationCache::fromBinary(binary.data(), binary.size()), JsonRpcException, check_exception2);
+  procs[0].SetReturnSchema(TypeSchema::ArrayOf(nested));
+  CHECK_EXCEPTION_TYPE(SpecificationCache::toBinary(procs), JsonRpcException, check_exception2);
+
+  string type = "integer";
+  for (size_t i = 0; i < TypeSchema::MAX_ARRAY_DEPTH; i++)
+    type += "[]";
+  string spec = "[{\"name\": \"deep\", \"returns\": {\"$type\": \"" + type + "\"}}]";
+  CHECK(SpecificationParser::GetProceduresFromString(spec)[0].GetReturnSchema().ToString() == type);
+  spec = "[{\"name\": \"deep\", \"returns\": {\"$type\": \"" + type + "[]\"}}]";
+  CHECK_EXCEPTION_TYPE(SpecificationParser::GetProceduresFromString(spec), JsonRpcException, check_exception2);
+}
+
+TEST_CASE("test_streamreader_leftover", TEST_MODULE) {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+  string data = "first\nsecond\nthird";
+  REQUIRE(write(fds[1], data.c_str(), data.size()) == static_cast<ssize_t>(data.size()));
+
+  StreamReader reader(4);
+  string message;
+  CHECK(reader.Read(message, fds[0], '\n') == true);
+  CHECK(message == "first");
+  CHECK(reader.Pending() > 0);
+
+  message.clear();
+  CHECK(reader.Read(message, fds[0], '\n') == true);
+  CHECK(message == "second");
+
+  // The rest of the third message arrives later.
+  REQUIRE(write(fds[1], "\n", 1) == 1);
+  message.clear();
+  CHECK(reader.Read(message, fds[0], '\n') == true);
+  CHECK(message == "third");
+  CHECK(reader.Pending() == 0);
+
+  close(fds[1]);
+  message.clear();
+  CHECK(reader.Read(message, fds[0], '\n') == false);
+  close(fds[0]);
+}
+
+TEST_CASE("test_streamreader_chunking", TEST_MODULE) {
+  string data = "abc\n\ndef\nghi\n";
+  vector<string> expected;
+  expected.push_back("abc\n");
+  expected.push_back("def");
+  expected.push_back("ghi");
+
+  // Every split of the bytes into two writes yields the same messages, but
+  // the one inside the run of delimiters, which is written as two messages.
+  for (size_t split = 0; split <= data.size(); split++) {
+    if (split == 4)
+      continue;
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    std::thread sender([&data, split, &fds] {
+      CHECK(write(fds[1], data.data(), split) == static_cast<ssize_t>(split));
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      CHECK(write(fds[1], data.data() + split, data.size() - split) == static_cast<ssize_t>(data.size() - split));
+    });
+
+    StreamReader reader(64);
+    vector<string> messages;
+    for (size_t i = 0; i < expected.size(); i++) {
+      string message;
+      CHECK(reader.Read(message, fds[0], '\n') == true);
+      messages.push_back(message);
+    }
+    sender.join();
+    CHECK(messages == expected);
+    CHECK(reader.Pending() == 0);
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+
+TEST_CASE("test_streamreader_large", TEST_MODULE) {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+  StreamWriter writer;
+  StreamReader reader(16);
+
+  string payload(100000, 'x');
+  pid_t pid = fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    close(fds[0]);
+    writer.WriteMessage(payload, fds[1], FRAMING_DELIMITER);
+    writer.WriteMessage(payload, fds[1], FRAMING_LENGTH_PREFIX);
+    _exit(0);
+  }
+  close(fds[1]);
+
+  string message;
+  CHECK(reader.ReadMessage(message, fds[0], FRAMING_DELIMITER) == true);
+  CHECK(message == payload);
+  message.clear();
+  CHECK(reader.ReadMessage(message, fds[0], FRAMING_LENGTH_PREFIX) == true);
+  CHECK(message == payload);
+  close(fds[0]);
+}
+
+TEST_CASE("test_codec_roundtrip", TEST_MODULE) {
+  Json::Value value;
+  value["jsonrpc"] = "2.0";
+  value["method"] = "sum";
+  value["id"] = 1;
+  value["params"].append(-1);
+  value["params"].append(-33);
+  value["params"].append(200);
+  value["params"].append(-40000);
+  value["params"].append(Json::Value(Json::LargestInt(-5000000000LL)));
+  value["params"].append(Json::Value(Json::LargestUInt(18446744073709551615ULL)));
+  value["params"].append(3.25);
+  value["params"].append(true);
+  value["params"].append(Json::nullValue);
+  value["params"].append(string(300, 'x'));
+  value["params"].append(string("with\0null", 9));
+  value["nested"]["empty"] = Json::Value(Json::objectValue);
+  value["nested"]["list"] = Json::Value(Json::arrayValue);
+  for (int i = 0; i < 70000; i++)
+    value["nested"]["large"].append(i);
+
+  codec_t codecs[] = {CODEC_JSON, CODEC_MSGPACK, CODEC_CBOR};
+  for (size_t i = 0; i < 3; i++) {
+    string encoded;
+    Json::Value decoded;
+    Codec::Encode(value, codecs[i], encoded);
+    REQUIRE(Codec::Decode(encoded, codecs[i], decoded) == true);
+    CHECK(decoded == value);
+  }
+}
+
+TEST_CASE("test_codec_wire_format", TEST_MODULE) {
+  Json::Value value;
+  value["a"] = 1;
+  value["b"].append(-1);
+  value["b"].append(true);
+
+  string encoded;
+  Codec::Encode(value, CODEC_MSGPACK, encoded);
+  CHECK(encoded == string("\x82\xa1" "a" "\x01\xa1" "b" "\x92\xff\xc3"));
+  Codec::Encode(value, CODEC_CBOR, encoded);
+  CHECK(encoded == string("\xa2\x61" "a" "\x01\x61" "b" "\x82\x20\xf5"));
+
+  // CBOR features other encoders use: half floats, indefinite lengths, tags, byte strings
+  Json::Value decoded;
+  REQUIRE(Codec::Decode(string("\x9f\xf9\x3e\x00\x5f\x42" "ab" "\x41" "c" "\xff\xc1\x1a\x00\x00\x00\x01\xff", 18), CODEC_CBOR, decoded) == true);
+  REQUIRE(decoded.size() == 3);
+  CHECK(decoded[0].asDouble() == 1.5);
+  CHECK(decoded[1].asString() == "abc");
+  CHECK(decoded[2].asInt() == 1);
+
+  // MessagePack float32 and bin
+  REQUIRE(Codec::Decode(string("\x92\xca\x3f\xc0\x00\x00\xc4\x02" "ab", 10), CODEC_MSGPACK, decoded) == true);
+  CHECK(decoded[0].asDouble() == 1.5);
+  CHECK(decoded[1].asString() == "ab");
+}
+
+TEST_CASE("test_codec_invalid", TEST_MODULE) {
+  Json::Value decoded;
+  CHECK(Codec::Decode("", CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode("", CODEC_CBOR, decoded) == false);
+  CHECK(Codec::Decode("{\"a\":", CODEC_JSON, decoded) == false);
+
+  // truncated, trailing bytes and lengths beyond the message
+  CHECK(Codec::Decode(string("\x82\xa1" "a" "\x01", 4), CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode(string("\x01\x02", 2), CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode(string("\xdd\xff\xff\xff\xff", 5), CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode(string("\x9b\xff\xff\xff\xff\xff\xff\xff\xff", 9), CODEC_CBOR, decoded) == false);
+  CHECK(Codec::Decode(string("\x9f\x01", 2), CODEC_CBOR, decoded) == false);
+
+  // keys have to be strings, extension types aren't supported
+  CHECK(Codec::Decode(string("\x81\x01\x01", 3), CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode(string("\xa1\x01\x01", 3), CODEC_CBOR, decoded) == false);
+  CHECK(Codec::Decode(string("\xd4\x01\x01", 3), CODEC_MSGPACK, decoded) == false);
+
+  // nesting is limited
+  CHECK(Codec::Decode(string(100000, '\x91'), CODEC_MSGPACK, decoded) == false);
+  CHECK(Codec::Decode(string(100000, '\x81'), CODEC_CBOR, decoded) == false);
+}
+
+TEST_CASE("test_codec_content_type", TEST_MODULE) {
+  codec_t codec = CODEC_JSON;
+  CHECK(Codec::FromContentType("application/msgpack", codec) == true);
+  CHECK(codec == CODEC_MSGPACK);
+  CHECK(Codec::FromContentType(" Application/CBOR ; charset=binary", codec) == true);
+  CHECK(codec == CODEC_CBOR);
+  CHECK(Codec::FromContentType("application/json; charset=utf-8", codec) == true);
+  CHECK(codec == CODEC_JSON);
+  CHECK(Codec::FromContentType("text/plain", codec) == false);
+  CHECK(string(Codec::GetContentType(CODEC_CBOR)) == "application/cbor");
+}
+
+TEST_CASE("test_jsonreader_parse", TEST_MODULE) {
+  Json::Value value;
+  string text = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"x\",\"params\":[-5,18446744073709551615,1.5,true,null,\"a\\u0000b\",{\"\\u00fc\":[]}]}";
+  REQUIRE(JsonReader::Parse(text, value) == true);
+  CHECK(value["method"].asString() == "x");
+  CHECK(value["id"].isIntegral());
+  CHECK(value["params"][0].asInt() == -5);
+  CHECK(value["params"][1].asUInt64() == 18446744073709551615ULL);
+  CHECK(value["params"][2].asDouble() == 1.5);
+  CHECK(value["params"][3].asBool() == true);
+  CHECK(value["params"][4].isNull());
+  CHECK(value["params"][5].asString() == string("a\0b", 3));
+  CHECK(value["params"][6]["\xc3\xbc"].isArray());
+
+  REQUIRE(JsonReader::Parse("[1,2]", value) == true);
+  CHECK(value.size() == 2);
+  REQUIRE(JsonReader::Parse("42", value) == true);
+  CHECK(value.asInt() == 42);
+  REQUIRE(JsonReader::Parse("\"text\"", value) == true);
+  CHECK(value.asString() == "text");
+
+  CHECK(JsonReader::Parse("", value) == false);
+  CHECK(JsonReader::Parse("{\"a\":", value) == false);
+  CHECK(JsonReader::Parse("[1,2", value) == false);
+  CHECK(JsonReader::Parse("{\"a\":\"\xff\"}", value) == false);
+  CHECK(string(JsonReader::GetBackend()).size() > 0);
+}
+
+TEST_CASE("test_jsonreader_utf8", TEST_MODULE) {
+  const char *valid[] = {"", "plain ascii text longer than a word", "\xc3\xbc", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xed\x9f\xbf", "\xf4\x8f\xbf\xbf",
+                         "abcdefgh\xe2\x82\xac"};
+  for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    INFO(i);
+    CHECK(JsonReader::IsValidUtf8(valid[i], strlen(valid[i])) == true);
+  }
+
+  // lone continuation, overlong, surrogate, beyond U+10FFFF, truncated, invalid lead
+  const char *invalid[] = {"\x80", "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x82", "abcdefgh\xf0\x9f\x98", "\xf5\x80\x80\x80", "\xff"};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    INFO(i);
+    CHECK(JsonReader::IsValidUtf8(invalid[i], strlen(invalid[i])) == false);
+  }
+}
+
+TEST_CASE("test_jsonenvelope", TEST_MODULE) {
+  JsonEnvelope envelope;
+  string text = "{ \"jsonrpc\" : \"2.0\", \"params\": {\"a\": [\"]}\\\"{\", {\"b\": null}]},\"m\\u0065thod\":\"x\", \"id\":-1.5e3 }";
+  REQUIRE(envelope.Parse(text, "params") == true);
+  CHECK(envelope.GetMembers()["jsonrpc"].asString() == "2.0");
+  CHECK(envelope.GetMembers()["method"].asString() == "x");
+  CHECK(envelope.GetMembers()["id"].asDouble() == -1500);
+  CHECK(envelope.GetMembers().isMember("params") == false);
+  REQUIRE(envelope.HasDeferred() == true);
+  CHECK(envelope.GetDeferredPlaceholder().isObject());
+  Json::Value params;
+  REQUIRE(envelope.ParseDeferred(params) == true);
+  CHECK(params["a"][0].asString() == "]}\"{");
+  CHECK(params["a"][1]["b"].isNull());
+
+  // scalars aren't deferred, the last duplicate wins
+  REQUIRE(envelope.Parse("{\"params\":[1], \"params\":null}", "params") == true);
+  CHECK(envelope.HasDeferred() == false);
+  CHECK(envelope.GetMembers()["params"].isNull());
+  REQUIRE(envelope.Parse("{\"params\":null, \"params\":[1]}", "params") == true);
+  CHECK(envelope.HasDeferred() == true);
+  CHECK(envelope.GetDeferredPlaceholder().isArray());
+  REQUIRE(envelope.Parse("{}", "params") == true);
+  CHECK(envelope.GetMembers().empty());
+
+  // the deferred member is checked once it is parsed
+  REQUIRE(envelope.Parse("{\"params\":[1,,2]}", "params") == true);
+  CHECK(envelope.ParseDeferred(params) == false);
+
+  CHECK(envelope.Parse("[{\"params\":[1]}]", "params") == false);
+  CHECK(envelope.Parse("{\"params\":[1] /* comment */}", "params") == false);
+  CHECK(envelope.Parse("{\"params\":[1]", "params") == false);
+  CHECK(envelope.Parse("{\"params\":[1}", "params") == false);
+  CHECK(envelope.Parse("{\"id\":tru}", "params") == false);
+  CHECK(envelope.Parse("{\"id\":1,}", "params") == false);
+  CHECK(envelope.Parse("{\"id\":\"\xff\"}", "params") == false);
+  CHECK(envelope.Parse("", "params") == false);
+}
+
+TEST_CASE("test_jsonenvelope_member", TEST_MODULE) {
+  Json::Value id;
+  REQUIRE(JsonEnvelope::ParseMember("{\"result\": {\"id\": 7, \"s\": \"}\\\"\"}, \"id\" : \"abc\"}", "id", id) == true);
+  CHECK(id.asString() == "abc");
+  REQUIRE(JsonEnvelope::ParseMember(" {\"jsonrpc\":\"2.0\",\"method\":\"n\"} ", "id", id) == true);
+  CHECK(id.isNull());
+
+  REQUIRE(JsonEnvelope::ParseMember("[{\"id\":1,\"result\":[1,2]}, {\"method\":\"n\"}, {\"id\":null}, {\"id\":2}]", "id", id) == true);
+  REQUIRE(id.size() == 2);
+  CHECK(id[0].asInt() == 1);
+  CHECK(id[1].asInt() == 2);
+  REQUIRE(JsonEnvelope::ParseMember("[]", "id", id) == true);
+  CHECK(id.isNull());
+
+  // Only the member itself is parsed strictly.
+  CHECK(JsonEnvelope::ParseMember("{\"id\":1,,}", "id", id) == false);
+  CHECK(JsonEnvelope::ParseMember("{\"id\":tru}", "id", id) == false);
+  CHECK(JsonEnvelope::ParseMember("{\"i\\u0064\":1}", "id", id) == false);
+  CHECK(JsonEnvelope::ParseMember("[1, {\"id\":1}]", "id", id) == false);
+  CHECK(JsonEnvelope::ParseMember("{\"id\":1} x", "id", id) == false);
+  CHECK(JsonEnvelope::ParseMember("\"id\"", "id", id) == false);
+}
+
+TEST_CASE("test_parameterwriter", TEST_MODULE) {
+  ParameterWriter named(PARAMS_BY_NAME);
+  CHECK(named.IsEmpty() == true);
+  CHECK(named.GetText() == "");
+  CHECK(named.ToValue() == Json::nullValue);
+
+  Json::Value object;
+  object["a"].append(1);
+  named.Add("int", -3);
+  named.Add("int64", static_cast<Json::Int64>(-9007199254740993LL));
+  named.Add("uint64", static_cast<Json::UInt64>(18446744073709551615ULL));
+  named.Add("double", 0.1);
+  named.Add("bool", true);
+  named.Add("literal", "a\"b");
+  named.Add("string", string("tab\tnul\x01\\ \xc3\xbc", 12));
+  named.Add("object", object);
+  CHECK(named.IsEmpty() == false);
+  CHECK(named.GetText() == "{\"int\":-3,\"int64\":-9007199254740993,\"uint64\":18446744073709551615,\"double\":0.10000000000000001,"
+                           "\"bool\":true,\"literal\":\"a\\\"b\",\"string\":\"tab\\tnul\\u0001\\\\ \xc3\xbc\",\"object\":{\"a\":[1]}}");
+
+  Json::Value value = named.ToValue();
+  CHECK(value["int64"].asInt64() == -9007199254740993LL);
+  CHECK(value["uint64"].asUInt64() == 18446744073709551615ULL);
+  CHECK(value["double"].asDouble() == 0.1);
+  CHECK(value["string"].asString() == string("tab\tnul\x01\\ \xc3\xbc", 12));
+  CHECK(value["object"] == object);
+
+  ParameterWriter positional(PARAMS_BY_POSITION);
+  positional.Add("ignored", 1);
+  positional.Add("ignored", false);
+  CHECK(positional.GetText() == "[1,false]");
+}
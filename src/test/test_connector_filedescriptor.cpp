@@ -13,7 +13,10 @@
 #include <jsonrpccpp/client/connectors/filedescriptorclient.h>
 #include <jsonrpccpp/common/sharedconstants.h>
 #include <jsonrpccpp/server/connectors/filedescriptorserver.h>
+#include <chrono>
+#include <fcntl.h>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
 
 #include "checkexception.h"
@@ -106,6 +109,41 @@ TEST_CASE_METHOD(F, "test_filedescriptor_success_with_delimiter", TEST_MODULE) {
   CHECK(result == expectedResult);
 }
 
+TEST_CASE_METHOD(F, "test_filedescriptor_end_of_input", TEST_MODULE) {
+  handler.response = "x";
+  handler.timeout = 0;
+
+  // The last request is terminated by closing the input, which must neither
+  // drop it nor make the server answer empty requests from then on.
+  REQUIRE(write(c2sfd[1], "abc", 3) == 3);
+  close(c2sfd[1]);
+  c2sfd[1] = -1;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  REQUIRE(fcntl(s2cfd[0], F_SETFL, fcntl(s2cfd[0], F_GETFL) | O_NONBLOCK) == 0);
+  char buffer[64];
+  ssize_t received = read(s2cfd[0], buffer, sizeof(buffer));
+  REQUIRE(received > 0);
+  CHECK(string(buffer, static_cast<size_t>(received)) == "x\n");
+  CHECK(handler.request == "abc");
+}
+
+TEST_CASE_METHOD(F, "test_filedescriptor_length_prefix", TEST_MODULE) {
+  server->StopListening();
+  server->SetFraming(FRAMING_LENGTH_PREFIX);
+  client->SetFraming(FRAMING_LENGTH_PREFIX);
+  REQUIRE(server->StartListening());
+
+  handler.response = "example\nresponse";
+  string result;
+  string request = "example\nrequest";
+
+  client->SendRPCMessage(request, result);
+
+  CHECK(handler.request == request);
+  CHECK(result == handler.response);
+}
+
 TEST_CASE("test_filedescriptor_server_multiplestart", TEST_MODULE) {
   int fds[2];
   pipe(fds);
@@ -195,4 +233,22 @@ TEST_CASE("test_filedescriptor_client_input_fd_invalid", TEST_MODULE) {
   close(c2sfd[0]);
 }
 
+TEST_CASE("test_filedescriptor_client_timeout", TEST_MODULE) {
+  int c2sfd[2];
+  pipe(c2sfd);
+  int s2cfd[2];
+  pipe(s2cfd);
+
+  // Nobody answers on the server to client pipe.
+  FileDescriptorClient client(s2cfd[0], c2sfd[1]);
+  client.SetTimeout(20);
+  string result;
+  CHECK_EXCEPTION_TYPE(client.SendRPCMessage("foobar", result), JsonRpcException, check_exception1);
+
+  close(c2sfd[0]);
+  close(c2sfd[1]);
+  close(s2cfd[0]);
+  close(s2cfd[1]);
+}
+
 #endif // FILEDESCRIPTOR_TESTING
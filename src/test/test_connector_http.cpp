@@ -12,6 +12,7 @@
 #include <curl/curl.h>
 #include <jsonrpccpp/client/connectors/httpclient.h>
 #include <jsonrpccpp/server/connectors/httpserver.h>
+#include <jsonrpccpp/server/serverstatistics.h>
 
 #include "checkexception.h"
 #include "mockclientconnectionhandler.h"
@@ -171,6 +172,54 @@ TEST_CASE_METHOD(F, "test_http_get_options", TEST_MODULE) {
   curl_easy_cleanup(curl);
 }
 
+static size_t WriteToString(char *data, size_t size, size_t nmemb, void *target) {
+  static_cast<string *>(target)->append(data, size * nmemb);
+  return size * nmemb;
+}
+
+TEST_CASE("test_http_server_metrics", TEST_MODULE) {
+  MockClientConnectionHandler handler;
+  handler.response = "exampleresponse";
+  ServerStatistics statistics;
+  statistics.Register("sayHello");
+
+  HttpServer server(TEST_PORT);
+  server.SetHandler(&handler);
+  server.EnableMetrics(&statistics);
+  REQUIRE(server.StartListening() == true);
+
+  HttpClient client(CLIENT_URL);
+  string result;
+  client.SendRPCMessage("examplerequest", result);
+
+  CURL *curl = curl_easy_init();
+  string body;
+  curl_easy_setopt(curl, CURLOPT_URL, CLIENT_URL "/metrics");
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+  CURLcode code = curl_easy_perform(curl);
+  REQUIRE(code == CURLE_OK);
+
+  long http_code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+  CHECK(http_code == 200);
+  CHECK(body.find("jsonrpc_http_requests_total 1\n") != string::npos);
+  CHECK(body.find("jsonrpc_http_request_size_bytes_bucket{le=\"64\"} 1\n") != string::npos);
+  CHECK(body.find("jsonrpc_http_response_size_bytes_count 1\n") != string::npos);
+  CHECK(body.find("jsonrpc_calls_total{procedure=\"sayHello\"} 0\n") != string::npos);
+  CHECK(body.substr(body.size() - 6) == "# EOF\n");
+
+  // other paths are still rejected
+  curl_easy_setopt(curl, CURLOPT_URL, CLIENT_URL "/other");
+  curl_easy_setopt(curl, CURLOPT_NOBODY, 1);
+  REQUIRE(curl_easy_perform(curl) == CURLE_OK);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+  CHECK(http_code == 405);
+
+  curl_easy_cleanup(curl);
+  server.StopListening();
+}
+
 TEST_CASE("test_http_server_endpoints", TEST_MODULE) {
   MockClientConnectionHandler handler1;
   MockClientConnectionHandler handler2;
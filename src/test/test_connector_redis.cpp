@@ -10,11 +10,16 @@
 #ifdef REDIS_TESTING
 #include <catch2/catch.hpp>
 #include <jsonrpccpp/client/connectors/redisclient.h>
+#include <jsonrpccpp/client/connectors/redisstreamclient.h>
 #include <jsonrpccpp/server/connectors/redisserver.h>
+#include <jsonrpccpp/server/connectors/redisstreamserver.h>
 
 #include "checkexception.h"
 #include "mockclientconnectionhandler.h"
 #include "testredisserver.h"
+#include "testserver.h"
+#include <chrono>
+#include <thread>
 
 #include <iostream>
 #include <sstream>
@@ -125,6 +130,75 @@ TEST_CASE_METHOD(F, "test_redis_client_ret_queue", TEST_MODULE) {
   CHECK_EXCEPTION_TYPE(GetReturnQueue(con, TEST_QUEUE, retqueue), JsonRpcException, check_exception1);
 }
 
+TEST_CASE_METHOD(F, "test_redis_client_persistent_queue", TEST_MODULE) {
+  redisReply *reply;
+  client.SetPersistentReturnQueue(true);
+
+  // The first call creates the return queue, later calls reuse it.
+  srand(0);
+  handler.response = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":1}";
+  string result;
+  client.SendRPCMessage("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"a\"}", result);
+  CHECK(result == handler.response);
+
+  // A stale response left on the queue must be skipped.
+  reply = (redisReply *)redisCommand(con, "LPUSH %s %s", TEST_QUEUE "_" RAND_FIRST, "{\"jsonrpc\":\"2.0\",\"id\":99,\"result\":0}");
+  freeReplyObject(reply);
+
+  handler.response = "{\"jsonrpc\":\"2.0\",\"id\":2,\"result\":2}";
+  client.SendRPCMessage("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"a\"}", result);
+  CHECK(result == handler.response);
+
+  reply = (redisReply *)redisCommand(con, "LLEN %s", TEST_QUEUE "_" RAND_FIRST);
+  CHECK(reply->integer == 0);
+  freeReplyObject(reply);
+}
+
+TEST_CASE_METHOD(F, "test_redis_client_null_id_error", TEST_MODULE) {
+  client.SetPersistentReturnQueue(true);
+
+  // Errors with a null id go to the calls waiting for them instead of timing out.
+  handler.response = "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32600,\"message\":\"Invalid request\"}}";
+  string result;
+  client.SendRPCMessage("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"a\"}", result);
+  CHECK(result == handler.response);
+
+  vector<string> requests;
+  requests.push_back("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"a\"}");
+  requests.push_back("{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"a\"}");
+  vector<string> results;
+  client.SendRPCMessages(requests, results);
+  REQUIRE(results.size() == 2);
+  CHECK(results[0] == handler.response);
+  CHECK(results[1] == handler.response);
+}
+
+TEST_CASE_METHOD(F, "test_redis_client_pipeline", TEST_MODULE) {
+  handler.response = "exampleresponse";
+  vector<string> requests;
+  vector<string> results;
+  for (int i = 0; i < 10; i++) {
+    stringstream request;
+    request << "examplerequest" << i;
+    requests.push_back(request.str());
+  }
+
+  client.SendRPCMessages(requests, results);
+  REQUIRE(results.size() == requests.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    CHECK(results[i] == "exampleresponse");
+  }
+}
+
+TEST_CASE("test_redis_client_message_id", TEST_MODULE) {
+  CHECK(GetMessageId("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"a\"}") == "1");
+  CHECK(GetMessageId("{\"jsonrpc\":\"2.0\",\"id\":\"abc\",\"result\":3}") == "\"abc\"");
+  CHECK(GetMessageId("[{\"id\":1},{\"method\":\"n\"},{\"id\":2}]") == "[1,2]");
+  CHECK(GetMessageId("{\"jsonrpc\":\"2.0\",\"method\":\"n\"}") == "");
+  CHECK(GetMessageId("") == "");
+  CHECK(GetMessageId("{invalid") == "");
+}
+
 TEST_CASE_METHOD(F, "test_redis_client_set_queue", TEST_MODULE) {
   RedisServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_other");
   MockClientConnectionHandler handler2;
@@ -172,6 +246,61 @@ TEST_CASE_METHOD(F, "test_redis_server_bad_request", TEST_MODULE) {
   freeReplyObject(reply);
 }
 
+TEST_CASE_METHOD(F, "test_redis_server_batch", TEST_MODULE) {
+  RedisServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_batch");
+  MockClientConnectionHandler handler2;
+  server2.SetHandler(&handler2);
+  server2.SetBatchSize(8);
+  handler2.response = "exampleresponse";
+
+  // Queue requests before the server starts, so they are popped in bulk.
+  redisReply *reply;
+  for (int i = 0; i < 20; i++) {
+    stringstream item;
+    item << TEST_QUEUE "_ret" << i << "!examplerequest";
+    reply = (redisReply *)redisCommand(con, "LPUSH %s %s", TEST_QUEUE "_batch", item.str().c_str());
+    freeReplyObject(reply);
+  }
+
+  CHECK(server2.StartListening() == true);
+
+  for (int i = 0; i < 20; i++) {
+    stringstream ret_queue;
+    ret_queue << TEST_QUEUE "_ret" << i;
+    reply = (redisReply *)redisCommand(con, "BRPOP %s 2", ret_queue.str().c_str());
+    REQUIRE(reply != NULL);
+    REQUIRE(reply->type == REDIS_REPLY_ARRAY);
+    CHECK(string(reply->element[1]->str, reply->element[1]->len) == "exampleresponse");
+    freeReplyObject(reply);
+  }
+  CHECK(handler2.request == "examplerequest");
+
+  CHECK(server2.StopListening() == true);
+}
+
+TEST_CASE_METHOD(F, "test_redis_server_threads", TEST_MODULE) {
+  RedisServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_threads", 4);
+  MockClientConnectionHandler handler2;
+  server2.SetHandler(&handler2);
+  CHECK(server2.StartListening() == true);
+
+  client.SetQueue(TEST_QUEUE "_threads");
+  for (int i = 0; i < 10; i++) {
+    stringstream request;
+    stringstream response;
+    request << "examplerequest" << i;
+    response << "exampleresponse" << i;
+    handler2.response = response.str();
+    string result;
+    client.SendRPCMessage(request.str(), result);
+    CHECK(handler2.request == request.str());
+    CHECK(result == response.str());
+  }
+
+  CHECK(server2.StopListening() == true);
+  CHECK(server2.StopListening() == true);
+}
+
 TEST_CASE_METHOD(F, "test_redis_client_timeout", TEST_MODULE) {
   RedisClient client2(TEST_HOST, TEST_PORT, "invalid_queue");
   client2.SetTimeout(1);
@@ -204,4 +333,124 @@ TEST_CASE_METHOD(F, "test_redis_server_longrequest", TEST_MODULE) {
   free(str);
 }
 
+TEST_CASE_METHOD(F, "test_redis_stream_success", TEST_MODULE) {
+  RedisStreamServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_stream", "workers", "c1");
+  MockClientConnectionHandler handler2;
+  server2.SetHandler(&handler2);
+  CHECK(server2.StartListening() == true);
+
+  RedisStreamClient client2(TEST_HOST, TEST_PORT, TEST_QUEUE "_stream");
+  client2.SetTimeout(2);
+  for (int i = 0; i < 10; i++) {
+    stringstream request;
+    stringstream response;
+    request << "examplerequest" << i;
+    response << "exampleresponse" << i;
+    handler2.response = response.str();
+    string result;
+    client2.SendRPCMessage(request.str(), result);
+    CHECK(handler2.request == request.str());
+    CHECK(result == response.str());
+  }
+
+  CHECK(server2.StopListening() == true);
+
+  // Everything must have been acknowledged.
+  redisReply *reply = (redisReply *)redisCommand(con, "XPENDING %s %s", TEST_QUEUE "_stream", "workers");
+  REQUIRE(reply->type == REDIS_REPLY_ARRAY);
+  CHECK(reply->element[0]->integer == 0);
+  freeReplyObject(reply);
+}
+
+TEST_CASE_METHOD(F, "test_redis_stream_group", TEST_MODULE) {
+  RedisStreamServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_group", "workers", "c1", 2);
+  RedisStreamServer server3(TEST_HOST, TEST_PORT, TEST_QUEUE "_group", "workers", "c2");
+  MockClientConnectionHandler handler2;
+  handler2.response = "exampleresponse";
+  server2.SetHandler(&handler2);
+  server3.SetHandler(&handler2);
+  server2.SetBatchSize(4);
+  CHECK(server2.StartListening() == true);
+  CHECK(server3.StartListening() == true);
+
+  RedisStreamClient client2(TEST_HOST, TEST_PORT, TEST_QUEUE "_group");
+  client2.SetTimeout(2);
+  for (int i = 0; i < 20; i++) {
+    string result;
+    client2.SendRPCMessage("examplerequest", result);
+    CHECK(result == "exampleresponse");
+  }
+
+  CHECK(server2.StopListening() == true);
+  CHECK(server3.StopListening() == true);
+}
+
+TEST_CASE_METHOD(F, "test_redis_stream_redelivery", TEST_MODULE) {
+  redisReply *reply;
+  reply = (redisReply *)redisCommand(con, "XGROUP CREATE %s %s $ MKSTREAM", TEST_QUEUE "_redeliver", "workers");
+  freeReplyObject(reply);
+  reply = (redisReply *)redisCommand(con, "XADD %s * reply %s payload %s", TEST_QUEUE "_redeliver", TEST_QUEUE "_ret", "examplerequest");
+  freeReplyObject(reply);
+
+  // A consumer that reads the request and then dies without acknowledging it.
+  reply = (redisReply *)redisCommand(con, "XREADGROUP GROUP %s %s COUNT 1 STREAMS %s >", "workers", "dead", TEST_QUEUE "_redeliver");
+  freeReplyObject(reply);
+
+  RedisStreamServer server2(TEST_HOST, TEST_PORT, TEST_QUEUE "_redeliver", "workers", "c1");
+  MockClientConnectionHandler handler2;
+  handler2.response = "exampleresponse";
+  server2.SetHandler(&handler2);
+  server2.SetClaimTimeout(1);
+  CHECK(server2.StartListening() == true);
+
+  reply = (redisReply *)redisCommand(con, "XREAD COUNT 1 BLOCK 3000 STREAMS %s 0-0", TEST_QUEUE "_ret");
+  REQUIRE(reply->type == REDIS_REPLY_ARRAY);
+  redisReply *fields = reply->element[0]->element[1]->element[0]->element[1];
+  CHECK(string(fields->element[1]->str, fields->element[1]->len) == "exampleresponse");
+  freeReplyObject(reply);
+  CHECK(handler2.request == "examplerequest");
+
+  CHECK(server2.StopListening() == true);
+}
+
+TEST_CASE_METHOD(F, "test_redis_stream_notification", TEST_MODULE) {
+  RedisStreamServer connector(TEST_HOST, TEST_PORT, TEST_QUEUE "_notify", "workers", "c1");
+  TestServer server2(connector);
+  CHECK(server2.StartListening() == true);
+
+  RedisStreamClient client2(TEST_HOST, TEST_PORT, TEST_QUEUE "_notify");
+  client2.SetTimeout(5);
+  Client rpc(client2);
+
+  // Notifications return without waiting for the timeout.
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  Json::Value params;
+  params["value"] = 33;
+  rpc.CallNotification("initCounter", params);
+  BatchCall batch;
+  batch.addCall("incrementCounter", params, true);
+  batch.addCall("incrementCounter", params, true);
+  BatchResponse response = rpc.CallProcedures(batch);
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+  for (int i = 0; i < 200 && server2.getCnt() != 99; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(server2.getCnt() == 99);
+
+  // Method calls still wait for their reply.
+  params.clear();
+  params["name"] = "Peter";
+  CHECK(rpc.CallMethod("sayHello", params).asString() == "Hello: Peter!");
+
+  CHECK(server2.StopListening() == true);
+}
+
+TEST_CASE_METHOD(F, "test_redis_stream_client_timeout", TEST_MODULE) {
+  RedisStreamClient client2(TEST_HOST, TEST_PORT, "invalid_stream");
+  client2.SetTimeout(1);
+
+  string result;
+  CHECK_EXCEPTION_TYPE(client2.SendRPCMessage("examplerequest", result), JsonRpcException, check_exception1);
+}
+
 #endif
@@ -80,4 +80,25 @@ TEST_CASE("test_tcpsocket_client_invalid", TEST_MODULE) {
   CHECK_EXCEPTION_TYPE(client.SendRPCMessage("foobar", result), JsonRpcException, check_exception1);
 }
 
+TEST_CASE("test_tcpsocket_length_prefix", TEST_MODULE) {
+  TcpSocketServer server(IP, PORT + 1);
+  TcpSocketClient client(IP, PORT + 1);
+  MockClientConnectionHandler handler;
+  server.SetHandler(&handler);
+  CHECK(server.SetFraming(FRAMING_LENGTH_PREFIX));
+  CHECK(client.SetFraming(FRAMING_LENGTH_PREFIX));
+  REQUIRE(server.StartListening());
+
+  handler.response = "example\nresponse";
+  string result;
+  string request = "example\nrequest";
+  request.append(1, '\0');
+
+  client.SendRPCMessage(request, result);
+
+  CHECK(handler.request == request);
+  CHECK(result == handler.response);
+  server.StopListening();
+}
+
 #endif
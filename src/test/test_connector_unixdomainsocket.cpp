@@ -14,7 +14,12 @@
 #include <jsonrpccpp/server/connectors/unixdomainsocketserver.h>
 
 #include "checkexception.h"
+#include <chrono>
+#include <fcntl.h>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace jsonrpc;
 using namespace std;
@@ -53,6 +58,23 @@ TEST_CASE_METHOD(F, "test_unixdomainsocket_success", TEST_MODULE) {
   CHECK(result == expectedResult);
 }
 
+TEST_CASE_METHOD(F, "test_unixdomainsocket_notification_acknowledgement", TEST_MODULE) {
+  handler.response = "";
+  string result;
+  client.SendRPCMessage("examplenotification", result);
+  CHECK(result == "");
+
+  // Without acknowledgement the server closes the connection without writing anything.
+  server.SetAcknowledgeNotifications(false);
+  CHECK_EXCEPTION_TYPE(client.SendRPCMessage("examplenotification", result), JsonRpcException, check_exception1);
+  CHECK(handler.request == "examplenotification");
+
+  handler.response = "exampleresponse";
+  result.clear();
+  client.SendRPCMessage("examplerequest", result);
+  CHECK(result == "exampleresponse");
+}
+
 TEST_CASE("test_unixdomainsocket_server_multiplestart", TEST_MODULE) {
   string filename = "/tmp/somedomainsocket";
 
@@ -74,4 +96,107 @@ TEST_CASE("test_unixdomainsocket_client_invalid", TEST_MODULE) {
   CHECK_EXCEPTION_TYPE(client.SendRPCMessage("foobar", result), JsonRpcException, check_exception1);
 }
 
+TEST_CASE_METHOD(F, "test_unixdomainsocket_length_prefix", TEST_MODULE) {
+  CHECK(server.StopListening());
+  server.SetFraming(FRAMING_LENGTH_PREFIX);
+  client.SetFraming(FRAMING_LENGTH_PREFIX);
+  remove(filename.c_str());
+  REQUIRE(server.StartListening());
+
+  handler.response = "example\nresponse";
+  string result;
+  string request = "example\nrequest";
+
+  client.SendRPCMessage(request, result);
+
+  CHECK(handler.request == request);
+  CHECK(result == handler.response);
+}
+
+TEST_CASE("test_unixdomainsocket_max_queue_depth", TEST_MODULE) {
+  string filename = "/tmp/somedomainsocket";
+  remove(filename.c_str());
+  MockClientConnectionHandler handler;
+  handler.response = "exampleresponse";
+  handler.timeout = 300;
+
+  UnixDomainSocketServer server(filename, 1);
+  server.SetHandler(&handler);
+  server.SetMaxQueueDepth(1);
+  REQUIRE(server.StartListening());
+
+  // The first request occupies the only worker, the second one waits in the queue.
+  string results[2];
+  thread clients[2];
+  for (int i = 0; i < 2; i++) {
+    clients[i] = thread([&, i] {
+      UnixDomainSocketClient client(filename);
+      client.SendRPCMessage("examplerequest", results[i]);
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+  }
+
+  UnixDomainSocketClient client(filename);
+  string result;
+  client.SendRPCMessage("examplerequest", result);
+  Json::Value response;
+  istringstream(result) >> response;
+  CHECK(response["error"]["code"].asInt() == Errors::ERROR_SERVER_OVERLOADED);
+  CHECK(response["id"].isNull());
+
+  for (int i = 0; i < 2; i++) {
+    clients[i].join();
+    CHECK(results[i] == "exampleresponse");
+  }
+  CHECK(server.GetRejected() == 1);
+  CHECK(server.GetQueueDepth() == 0);
+  server.StopListening();
+}
+
+TEST_CASE("test_unixdomainsocket_reject_nonblocking", TEST_MODULE) {
+  UnixDomainSocketServer server("/tmp/somedomainsocket");
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  // A client that never reads, with no room left in the send buffer.
+  int flags = fcntl(fds[0], F_GETFL);
+  fcntl(fds[0], F_SETFL, flags | O_NONBLOCK);
+  char buffer[4096] = {0};
+  while (write(fds[0], buffer, sizeof(buffer)) > 0) {
+  }
+  fcntl(fds[0], F_SETFL, flags);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  server.RejectConnection(fds[0]);
+  CHECK(chrono::steady_clock::now() - start < chrono::seconds(1));
+
+  fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+  while (read(fds[1], buffer, sizeof(buffer)) > 0) {
+  }
+  CHECK(read(fds[1], buffer, sizeof(buffer)) == 0);
+  close(fds[1]);
+}
+
+TEST_CASE("test_unixdomainsocket_client_timeout", TEST_MODULE) {
+  string filename = "/tmp/somedomainsocket";
+  remove(filename.c_str());
+  MockClientConnectionHandler handler;
+  handler.response = "exampleresponse";
+  handler.timeout = 200;
+
+  UnixDomainSocketServer server(filename);
+  server.SetHandler(&handler);
+  REQUIRE(server.StartListening());
+
+  UnixDomainSocketClient client(filename);
+  client.SetTimeout(50);
+  string result;
+  CHECK_EXCEPTION_TYPE(client.SendRPCMessage("examplerequest", result), JsonRpcException, check_exception1);
+
+  client.SetTimeout(1000);
+  client.SendRPCMessage("examplerequest", result);
+  CHECK(result == "exampleresponse");
+  server.StopListening();
+}
+
 #endif
@@ -90,6 +90,25 @@ TEST_CASE("test_integration_http", TEST_MODULE) {
   server.StopListening();
 }
 
+TEST_CASE("test_integration_http_codec", TEST_MODULE) {
+  HttpServer sconn(TEST_PORT);
+  HttpClient cconn(CLIENT_URL);
+  StubServer server(sconn);
+  server.StartListening();
+  StubClient client(cconn);
+
+  client.SetCodec(CODEC_MSGPACK);
+  CHECK(client.addNumbers(3, 4) == 7);
+  CHECK(client.sayHello("Test") == "Hello Test");
+  client.SetCodec(CODEC_CBOR);
+  CHECK(client.addNumbers2(3.2, 4.2) == 7.4);
+  Json::Value result = client.buildObject("Test", 33);
+  CHECK(result["name"].asString() == "Test");
+  CHECK(result["age"].asInt() == 33);
+
+  server.StopListening();
+}
+
 #endif
 #ifdef UNIXDOMAINSOCKET_TESTING
 
@@ -121,6 +140,35 @@ TEST_CASE("test_integration_unixdomain", TEST_MODULE) {
   delete cconn;
   delete server;
 }
+
+TEST_CASE("test_integration_unixdomain_codec", TEST_MODULE) {
+  string filename = "/tmp/jrpcux_" + rand_alnum_str(10);
+  UnixDomainSocketServer sconn(filename);
+  sconn.SetFraming(FRAMING_LENGTH_PREFIX);
+  sconn.SetCodec(CODEC_MSGPACK);
+  UnixDomainSocketClient cconn(filename);
+  cconn.SetFraming(FRAMING_LENGTH_PREFIX);
+
+  StubServer server(sconn);
+  server.StartListening();
+  StubClient client(cconn);
+  client.SetCodec(CODEC_MSGPACK);
+
+  CHECK(client.addNumbers(3, 4) == 7);
+  CHECK(client.addNumbers2(3.2, 4.2) == 7.4);
+  CHECK(client.sayHello(string("Te\0st", 5)) == string("Hello Te\0st", 11));
+  client.notifyServer();
+
+  Json::Value params(Json::arrayValue);
+  params.append(1);
+  params.append(2);
+  BatchCall batch;
+  int id = batch.addCall("addNumbers", params);
+  BatchResponse response = client.CallProcedures(batch);
+  CHECK(response.getResult(id).asInt() == 3);
+
+  server.StopListening();
+}
 #endif
 #ifdef FILEDESCRIPTOR_TESTING
 
@@ -7,9 +7,14 @@
  * @license See attached LICENSE.txt
  ************************************************************************/
 
+#include "mockclientconnectionhandler.h"
 #include "mockserverconnector.h"
 #include "testserver.h"
 #include <catch2/catch.hpp>
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <thread>
 
 #define TEST_MODULE "[server]"
 
@@ -30,6 +35,41 @@ namespace testserver {
 
     F1() : server(c, JSONRPC_SERVER_V1) {}
   };
+
+  class BatchingServer : public TestServer {
+  public:
+    BatchingServer(AbstractServerConnector &connector) : TestServer(connector) {}
+    virtual ~BatchingServer() { this->StopNotifications(); }
+
+    vector<size_t> batches;
+
+  protected:
+    virtual void invokeNotificationBatch(const Procedure &proc, const std::vector<Json::Value> &inputs) {
+      this->batches.push_back(inputs.size());
+      TestServer::invokeNotificationBatch(proc, inputs);
+    }
+  };
+
+  class ContextServer : public TestServer {
+  public:
+    ContextServer(AbstractServerConnector &connector) : TestServer(connector) {}
+    virtual ~ContextServer() { this->StopNotifications(); }
+
+    vector<string> traceids;
+
+  protected:
+    virtual void invokeNotificationBatch(const Procedure &proc, const std::vector<Json::Value> &inputs) {
+      this->traceids.push_back(TraceContext::GetCurrent());
+      if (proc.GetProcedureName() == "initZero")
+        throw JsonRpcException(Errors::ERROR_RPC_INTERNAL_ERROR);
+      TestServer::invokeNotificationBatch(proc, inputs);
+    }
+  };
+
+  struct SpanCollector : public ITracer {
+    vector<TraceSpan> spans;
+    virtual void OnSpan(const TraceSpan &span) { spans.push_back(span); }
+  };
 } // namespace testserver
 using namespace testserver;
 
@@ -394,3 +434,732 @@ TEST_CASE("test_server_abstractserver", TEST_MODULE) {
   CHECK(server.StartListening() == true);
   CHECK(server.StopListening() == true);
 }
+
+TEST_CASE_METHOD(F, "test_server_statistics", TEST_MODULE) {
+  CHECK(server.GetStatistics() == NULL);
+  server.EnableStatistics();
+  REQUIRE(server.GetStatistics() != NULL);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7]}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"sub\",\"params\":[5,7]}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 3, \"method\": \"sub\",\"params\":{\"value1\":3}}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 4, \"method\": \"exceptionMethod\"}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 5, \"method\": \"sayHello2\"}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 6");
+
+  const ServerStatistics *statistics = server.GetStatistics();
+  const ProcedureStatistics *sub = statistics->Find("sub");
+  REQUIRE(sub != NULL);
+  CHECK(sub->GetCalls() == 3);
+  CHECK(sub->GetErrors() == 1);
+  CHECK(sub->GetErrors(Errors::ERROR_RPC_INVALID_PARAMS) == 1);
+  CHECK(sub->GetLatency(PHASE_INVOKE).GetCount() == 2);
+  CHECK(sub->GetLatency(PHASE_PARSE).GetCount() == 3);
+  CHECK(sub->GetBytesOut() > 0);
+
+  const ProcedureStatistics *exception = statistics->Find("exceptionMethod");
+  REQUIRE(exception != NULL);
+  CHECK(exception->GetErrors(-32099) == 1);
+
+  CHECK(statistics->Find("sayHello2") == NULL);
+  CHECK(statistics->GetTotal().GetCalls() == 5);
+  CHECK(statistics->GetTotal().GetErrors() == 4);
+  CHECK(statistics->GetTotal().GetErrors(Errors::ERROR_RPC_METHOD_NOT_FOUND) == 1);
+  CHECK(statistics->GetTotal().GetErrors(Errors::ERROR_RPC_JSON_PARSE_ERROR) == 1);
+
+  // not exposed
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 7, \"method\": \"rpc.stats\"}");
+  CHECK(c.GetJsonResponse()["error"]["code"] == -32601);
+}
+
+TEST_CASE("test_server_statistics_exposed", TEST_MODULE) {
+  MockServerConnector c;
+  TestServer server(c, JSONRPC_SERVER_V1V2);
+  server.EnableStatistics(true);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7]}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"rpc.stats\"}");
+  Json::Value result = c.GetJsonResponse()["result"];
+  CHECK(result["procedures"]["sub"]["calls"].asUInt64() == 1);
+  CHECK(result["procedures"]["sub"]["latency"]["invoke"]["count"].asUInt64() == 1);
+  CHECK(result["total"]["calls"].asUInt64() == 2);
+  CHECK(result["total"]["errors"].asUInt64() == 0);
+
+  c.SetRequest("{\"id\": 3, \"method\": \"rpc.stats\", \"params\": null}");
+  CHECK(c.GetJsonResponse()["result"]["total"]["calls"].asUInt64() == 3);
+}
+
+TEST_CASE("test_server_statistics_histogram", TEST_MODULE) {
+  for (size_t i = 0; i < LatencyHistogram::GetBucketCount() - 1; i++) {
+    uint64_t upper = LatencyHistogram::GetBucketUpperBound(i);
+    CHECK(LatencyHistogram::GetBucketIndex(upper) == i);
+    CHECK(LatencyHistogram::GetBucketIndex(upper + 1) == i + 1);
+  }
+
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 100; i++) {
+    histogram.Record(i * 1000);
+  }
+  CHECK(histogram.GetCount() == 100);
+  CHECK(histogram.GetMax() == 100000);
+  CHECK(histogram.GetPercentile(50) >= 50000);
+  CHECK(histogram.GetPercentile(50) <= 50000 * 5 / 4);
+  CHECK(histogram.GetPercentile(100) >= 100000);
+  CHECK(histogram.GetPercentile(100) <= 100000 * 5 / 4);
+}
+
+TEST_CASE("test_server_statistics_size_histogram", TEST_MODULE) {
+  CHECK(SizeHistogram::GetBucketIndex(0) == 0);
+  CHECK(SizeHistogram::GetBucketIndex(1) == 0);
+  for (size_t i = 1; i < SizeHistogram::GetBucketCount() - 1; i++) {
+    uint64_t upper = SizeHistogram::GetBucketUpperBound(i);
+    CHECK(SizeHistogram::GetBucketIndex(upper) == i);
+    CHECK(SizeHistogram::GetBucketIndex(upper + 1) == i + 1);
+  }
+
+  SizeHistogram histogram;
+  histogram.Record(64);
+  histogram.Record(65);
+  histogram.Record(1000);
+  histogram.Record(static_cast<uint64_t>(1) << 50);
+  CHECK(histogram.GetCount() == 4);
+
+  string metrics;
+  histogram.ToOpenMetrics("body_size_bytes", "kind=\"request\"", 6, 10, metrics);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"32\"}") == string::npos);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"64\"} 1\n") != string::npos);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"128\"} 2\n") != string::npos);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"512\"} 2\n") != string::npos);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"1024\"} 3\n") != string::npos);
+  CHECK(metrics.find("body_size_bytes_bucket{kind=\"request\",le=\"+Inf\"} 4\n") != string::npos);
+  CHECK(metrics.find("body_size_bytes_count{kind=\"request\"} 4\n") != string::npos);
+}
+
+TEST_CASE("test_server_statistics_openmetrics", TEST_MODULE) {
+  ServerStatistics statistics;
+  statistics.Register("say\"Hello\"");
+  ProcedureStatistics *procedure = statistics.Find("say\"Hello\"");
+  procedure->RecordCall();
+  procedure->RecordCall();
+  procedure->RecordError(-32602);
+  procedure->RecordLatency(PHASE_INVOKE, 1500);
+  procedure->RecordLatency(PHASE_INVOKE, 5000000000ULL);
+
+  string metrics;
+  statistics.ToOpenMetrics(metrics);
+  CHECK(metrics.find("# TYPE jsonrpc_calls counter\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_calls_total{procedure=\"say\\\"Hello\\\"\"} 2\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_errors_total{procedure=\"say\\\"Hello\\\"\",code=\"-32602\"} 1\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_duration_seconds_bucket{procedure=\"say\\\"Hello\\\"\",phase=\"invoke\",le=\"1.024e-06\"} 0\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_duration_seconds_bucket{procedure=\"say\\\"Hello\\\"\",phase=\"invoke\",le=\"4.096e-06\"} 1\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_duration_seconds_bucket{procedure=\"say\\\"Hello\\\"\",phase=\"invoke\",le=\"+Inf\"} 2\n") != string::npos);
+  CHECK(metrics.find("jsonrpc_duration_seconds_count{procedure=\"say\\\"Hello\\\"\",phase=\"invoke\"} 2\n") != string::npos);
+  CHECK(metrics.find("# EOF") == string::npos);
+}
+
+TEST_CASE_METHOD(F, "test_server_tracing", TEST_MODULE) {
+  SpanCollector tracer;
+  server.SetTracer(&tracer);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 7, \"method\": \"sub\",\"params\":[5,7], \"traceparent\": \"trace-1\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  REQUIRE(tracer.spans.size() == 4);
+  CHECK(tracer.spans[0].stage == STAGE_PARSE);
+  CHECK(tracer.spans[1].stage == STAGE_VALIDATE);
+  CHECK(tracer.spans[2].stage == STAGE_INVOKE);
+  CHECK(tracer.spans[3].stage == STAGE_SERIALIZE);
+  for (size_t i = 0; i < tracer.spans.size(); i++) {
+    CHECK(tracer.spans[i].method == "sub");
+    CHECK(tracer.spans[i].id == 7);
+    CHECK(tracer.spans[i].traceid == "trace-1");
+    CHECK(tracer.spans[i].start <= tracer.spans[i].end);
+  }
+
+  // invalid requests are not invoked
+  tracer.spans.clear();
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 8, \"method\": \"sayHello2\"}");
+  REQUIRE(tracer.spans.size() == 3);
+  CHECK(tracer.spans[2].stage == STAGE_SERIALIZE);
+
+  // the trace id of the calling thread is used without one in the request
+  tracer.spans.clear();
+  {
+    TraceContext context("trace-2");
+    c.SetRequest("[{\"jsonrpc\":\"2.0\", \"id\": 9, \"method\": \"sub\",\"params\":[5,7]}]");
+  }
+  REQUIRE(tracer.spans.size() == 4);
+  CHECK(tracer.spans[0].method == "");
+  CHECK(tracer.spans[2].method == "sub");
+  CHECK(tracer.spans[2].traceid == "trace-2");
+
+  tracer.spans.clear();
+  server.SetTracer(NULL);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 7, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(tracer.spans.empty());
+}
+
+TEST_CASE_METHOD(F, "test_server_result_cache", TEST_MODULE) {
+  CHECK(server.EnableCache("unknown", 0) == false);
+  CHECK(server.EnableCache("initCounter", 0) == false);
+  REQUIRE(server.EnableCache("getCounterValue", 0) == true);
+  ResultCache *cache = server.GetCache("getCounterValue");
+  REQUIRE(cache != NULL);
+  CHECK(server.GetCache("sub") == NULL);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\":3}}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"getCounterValue\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 3);
+
+  // served from the cache until invalidated
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\":1}}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"getCounterValue\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 3);
+  CHECK(c.GetJsonResponse()["id"].asInt() == 2);
+  CHECK(cache->GetHits() == 1);
+  CHECK(cache->GetMisses() == 1);
+
+  cache->Invalidate(Json::nullValue);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 3, \"method\": \"getCounterValue\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 4);
+  CHECK(cache->GetMisses() == 2);
+}
+
+TEST_CASE("test_server_result_cache_lru", TEST_MODULE) {
+  ResultCache cache(2, 0, 1);
+  Json::Value a, b;
+  a["x"] = 1;
+  a["y"] = 2;
+  b["y"] = 2;
+  b["x"] = 1;
+  CHECK(ResultCache::GetKey(a) == ResultCache::GetKey(b));
+
+  Json::Value result;
+  CHECK(cache.Get("1", result) == false);
+  cache.Put("1", 1);
+  cache.Put("2", 2);
+  CHECK(cache.Get("1", result) == true);
+  CHECK(result == 1);
+
+  // "2" is the least recently used one now
+  cache.Put("3", 3);
+  CHECK(cache.GetSize() == 2);
+  CHECK(cache.Get("2", result) == false);
+  CHECK(cache.Get("1", result) == true);
+  CHECK(cache.Get("3", result) == true);
+
+  cache.Put("3", 33);
+  CHECK(cache.Get("3", result) == true);
+  CHECK(result == 33);
+  CHECK(cache.GetSize() == 2);
+
+  cache.Clear();
+  CHECK(cache.GetSize() == 0);
+  CHECK(cache.GetHits() == 4);
+  CHECK(cache.GetMisses() == 2);
+}
+
+TEST_CASE("test_server_result_cache_ttl", TEST_MODULE) {
+  ResultCache cache(16, 20);
+  Json::Value result;
+  cache.Put("1", 1);
+  CHECK(cache.Get("1", result) == true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  CHECK(cache.Get("1", result) == false);
+  CHECK(cache.GetSize() == 0);
+}
+
+TEST_CASE_METHOD(F, "test_server_coalescing", TEST_MODULE) {
+  CHECK(server.EnableCoalescing("unknown") == false);
+  REQUIRE(server.EnableCoalescing("getCounterValue") == true);
+  REQUIRE(server.GetCoalescing("getCounterValue") != NULL);
+  CHECK(server.GetCoalescing("sub") == NULL);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\":3}}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"getCounterValue\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 3);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\":1}}");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"getCounterValue\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 4);
+  CHECK(server.GetCoalescing("getCounterValue")->GetExecuted() == 2);
+  CHECK(server.GetCoalescing("getCounterValue")->GetShared() == 0);
+}
+
+TEST_CASE("test_server_singleflight", TEST_MODULE) {
+  SingleFlight flight;
+  std::atomic<bool> started(false);
+  std::atomic<int> executions(0);
+  std::function<void(Json::Value &)> call = [&](Json::Value &result) {
+    executions++;
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    result = 42;
+  };
+
+  Json::Value leaderResult;
+  bool leaderShared = true;
+  std::thread leader([&] { leaderShared = flight.Do("key", call, leaderResult); });
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  Json::Value results[4];
+  bool shared[4];
+  std::thread followers[4];
+  for (int i = 0; i < 4; i++) {
+    followers[i] = std::thread([&, i] { shared[i] = flight.Do("key", call, results[i]); });
+  }
+  leader.join();
+  for (int i = 0; i < 4; i++) {
+    followers[i].join();
+    CHECK(shared[i] == true);
+    CHECK(results[i] == 42);
+  }
+  CHECK(leaderShared == false);
+  CHECK(leaderResult == 42);
+  CHECK(executions == 1);
+  CHECK(flight.GetExecuted() == 1);
+  CHECK(flight.GetShared() == 4);
+
+  // nothing is kept once the call has finished
+  Json::Value result;
+  CHECK(flight.Do("key", call, result) == false);
+  CHECK(executions == 2);
+}
+
+TEST_CASE("test_server_singleflight_exception", TEST_MODULE) {
+  SingleFlight flight;
+  std::atomic<bool> started(false);
+  std::function<void(Json::Value &)> call = [&](Json::Value &result) {
+    (void)result;
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    throw JsonRpcException(-32099, "failed");
+  };
+
+  int leaderCode = 0;
+  std::thread leader([&] {
+    Json::Value result;
+    try {
+      flight.Do("key", call, result);
+    } catch (const JsonRpcException &e) {
+      leaderCode = e.GetCode();
+    }
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  Json::Value result;
+  int code = 0;
+  try {
+    flight.Do("key", call, result);
+  } catch (const JsonRpcException &e) {
+    code = e.GetCode();
+  }
+  leader.join();
+  CHECK(leaderCode == -32099);
+  CHECK(code == -32099);
+  CHECK(flight.GetExecuted() == 1);
+}
+
+TEST_CASE_METHOD(F, "test_server_concurrency_limit", TEST_MODULE) {
+  CHECK(server.SetConcurrencyLimit("unknown", 1) == false);
+  REQUIRE(server.SetConcurrencyLimit("sub", 1) == true);
+  ConcurrencyLimiter *limiter = server.GetConcurrencyLimit("sub");
+  REQUIRE(limiter != NULL);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  CHECK(limiter->GetInFlight() == 0);
+
+  // occupy the only slot
+  REQUIRE(limiter->TryAcquire() == true);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_SERVER_OVERLOADED);
+  CHECK(c.GetJsonResponse()["id"].asInt() == 2);
+  CHECK(limiter->GetRejected() == 1);
+
+  // other procedures are not affected
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 3, \"method\": \"add\",\"params\":{\"value1\":5,\"value2\":7}}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 12);
+
+  limiter->Release(0);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 4, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+}
+
+TEST_CASE("test_server_concurrency_limit_adaptive", TEST_MODULE) {
+  ConcurrencyLimiter limiter(2, 20, 10);
+  CHECK(limiter.GetLimit() == 20);
+
+  // slow calls shrink the limit by 10%, at most once per target latency
+  REQUIRE(limiter.TryAcquire());
+  limiter.Release(50000000);
+  CHECK(limiter.GetLimit() == 18);
+  REQUIRE(limiter.TryAcquire());
+  limiter.Release(50000000);
+  CHECK(limiter.GetLimit() == 18);
+
+  for (int i = 0; i < 20; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(11));
+    REQUIRE(limiter.TryAcquire());
+    limiter.Release(50000000);
+  }
+  CHECK(limiter.GetLimit() == 2);
+
+  // a limit's worth of fast calls grows it by one
+  for (int i = 0; i < 2; i++) {
+    REQUIRE(limiter.TryAcquire());
+    limiter.Release(1000);
+  }
+  CHECK(limiter.GetLimit() == 3);
+
+  REQUIRE(limiter.TryAcquire());
+  REQUIRE(limiter.TryAcquire());
+  REQUIRE(limiter.TryAcquire());
+  CHECK(limiter.TryAcquire() == false);
+  CHECK(limiter.GetInFlight() == 3);
+  CHECK(limiter.GetRejected() == 1);
+}
+
+TEST_CASE_METHOD(F, "test_server_deadline", TEST_MODULE) {
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 1000}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 0}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+  CHECK(c.GetJsonResponse()["id"].asInt() == 2);
+
+  // the time a message waited before it was processed counts against the deadline
+  {
+    ArrivalContext arrival(ITracer::Now() - 100000000ull);
+    c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 3, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 50}");
+    CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+    c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 4, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 1000}");
+    CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  }
+
+  c.SetRequest("[{\"jsonrpc\":\"2.0\", \"id\": 5, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 0},"
+               "{\"jsonrpc\":\"2.0\", \"id\": 6, \"method\": \"sub\",\"params\":[5,7]}]");
+  Json::Value response = c.GetJsonResponse();
+  REQUIRE(response.size() == 2);
+  CHECK(response[0]["error"]["code"].asInt() == Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+  CHECK(response[1]["result"].asInt() == -2);
+}
+
+TEST_CASE("test_server_cancellation_token", TEST_MODULE) {
+  CHECK(CancellationToken::GetCurrent() == NULL);
+  CHECK(CancellationToken::IsCurrentCancelled() == false);
+
+  CancellationToken unlimited;
+  CHECK(unlimited.IsCancelled() == false);
+  CHECK(unlimited.GetRemaining() == -1);
+
+  CancellationToken token(ITracer::Now() + 30000000ull);
+  CHECK(token.GetRemaining() <= 30);
+  {
+    CancellationScope scope(token);
+    CHECK(CancellationToken::GetCurrent() == &token);
+    {
+      CancellationScope inner(unlimited);
+      CHECK(CancellationToken::GetCurrent() == &unlimited);
+    }
+    CHECK(CancellationToken::IsCurrentCancelled() == false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    CHECK(CancellationToken::IsCurrentCancelled() == true);
+    CHECK(token.GetRemaining() == 0);
+  }
+  CHECK(CancellationToken::GetCurrent() == NULL);
+
+  unlimited.Cancel();
+  CHECK(unlimited.IsCancelled() == true);
+}
+
+TEST_CASE("test_server_codec", TEST_MODULE) {
+  MockServerConnector c;
+  TestServer server(c, JSONRPC_SERVER_V1V2);
+  Json::Value request;
+  request["jsonrpc"] = "2.0";
+  request["id"] = 1;
+  request["method"] = "sub";
+  request["params"].append(5);
+  request["params"].append(7);
+
+  codec_t codecs[] = {CODEC_MSGPACK, CODEC_CBOR};
+  for (size_t i = 0; i < 2; i++) {
+    string encoded, response;
+    Json::Value decoded;
+    Codec::Encode(request, codecs[i], encoded);
+    c.ProcessRequest(encoded, response, codecs[i]);
+    REQUIRE(Codec::Decode(response, codecs[i], decoded) == true);
+    CHECK(decoded["result"].asInt() == -2);
+    CHECK(decoded["id"].asInt() == 1);
+  }
+
+  // undecodable messages are answered with a parse error in the same encoding
+  string response;
+  Json::Value decoded;
+  c.ProcessRequest("\xc1", response, CODEC_MSGPACK);
+  REQUIRE(Codec::Decode(response, CODEC_MSGPACK, decoded) == true);
+  CHECK(decoded["error"]["code"].asInt() == Errors::ERROR_RPC_JSON_PARSE_ERROR);
+
+  // the connector's codec is used by default
+  c.SetCodec(CODEC_CBOR);
+  string encoded;
+  Codec::Encode(request, CODEC_CBOR, encoded);
+  c.ProcessRequest(encoded, response);
+  REQUIRE(Codec::Decode(response, CODEC_CBOR, decoded) == true);
+  CHECK(decoded["result"].asInt() == -2);
+}
+
+TEST_CASE("test_server_codec_transcoding", TEST_MODULE) {
+  // Handlers that only implement HandleRequest see JSON text.
+  MockClientConnectionHandler handler;
+  handler.response = "{\"result\":[1,2]}";
+  Json::Value request;
+  request["method"] = "x";
+
+  string encoded, response;
+  Json::Value decoded;
+  Codec::Encode(request, CODEC_MSGPACK, encoded);
+  handler.HandleEncodedRequest(encoded, response, CODEC_MSGPACK);
+  CHECK(handler.request == "{\"method\":\"x\"}");
+  REQUIRE(Codec::Decode(response, CODEC_MSGPACK, decoded) == true);
+  CHECK(decoded["result"][1].asInt() == 2);
+}
+
+TEST_CASE_METHOD(F, "test_server_lazy_parsing", TEST_MODULE) {
+  server.SetLazyParsing(true);
+  server.EnableStatistics();
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  c.SetRequest("{\"params\":{\"value1\":5,\"value2\":7}, \"method\": \"add\", \"jsonrpc\":\"2.0\", \"id\": \"x\"}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == 12);
+  CHECK(c.GetJsonResponse()["id"].asString() == "x");
+
+  // malformed params of a rejected call are never looked at
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 2, \"method\": \"unknown\",\"params\":[1,,2]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_METHOD_NOT_FOUND);
+  CHECK(c.GetJsonResponse()["id"].asInt() == 2);
+  c.SetRequest("{\"id\": 3, \"method\": \"sub\",\"params\":[1,,2]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_INVALID_REQUEST);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 4, \"method\": \"sub\",\"params\":[5,7], \"deadline\": 0}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_SERVER_DEADLINE_EXCEEDED);
+  CHECK(server.GetStatistics()->Find("sub")->GetErrors(Errors::ERROR_SERVER_DEADLINE_EXCEEDED) == 1);
+
+  // but they are once the call is accepted
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 5, \"method\": \"sub\",\"params\":[1,,2]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_JSON_PARSE_ERROR);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 6, \"method\": \"sub\",\"params\":[5]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_INVALID_PARAMS);
+
+  // saturated procedures are rejected up front
+  REQUIRE(server.SetConcurrencyLimit("sub", 1) == true);
+  ConcurrencyLimiter *limiter = server.GetConcurrencyLimit("sub");
+  REQUIRE(limiter->TryAcquire() == true);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 7, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_SERVER_OVERLOADED);
+  CHECK(limiter->GetRejected() == 1);
+  limiter->Release(0);
+
+  // everything else takes the regular path
+  c.SetRequest("[{\"jsonrpc\":\"2.0\", \"id\": 8, \"method\": \"sub\",\"params\":[5,7]}]");
+  CHECK(c.GetJsonResponse()[0]["result"].asInt() == -2);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", /* comment */ \"id\": 9, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"params\":{\"value\": 33");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_JSON_PARSE_ERROR);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\": 33}}");
+  CHECK(server.getCnt() == 33);
+  CHECK(c.GetResponse() == "");
+}
+
+TEST_CASE("test_server_lazy_parsing_hybrid", TEST_MODULE) {
+  MockServerConnector c;
+  TestServer server(c, JSONRPC_SERVER_V1V2);
+  server.SetLazyParsing(true);
+
+  c.SetRequest("{\"id\": 1, \"method\": \"sub\",\"params\":[5,7]}");
+  CHECK(c.GetJsonResponse()["result"].asInt() == -2);
+  CHECK(c.GetJsonResponse().isMember("jsonrpc") == false);
+  c.SetRequest("{\"id\": 2, \"method\": \"unknown\",\"params\":[1,,2]}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_METHOD_NOT_FOUND);
+  CHECK(c.GetJsonResponse().isMember("jsonrpc") == false);
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"id\": 3, \"method\": \"sayHello\",\"params\":{\"name\":\"Peter\"}}");
+  CHECK(c.GetJsonResponse()["result"].asString() == "Hello: Peter!");
+  CHECK(c.GetJsonResponse()["jsonrpc"].asString() == "2.0");
+}
+
+TEST_CASE_METHOD(F, "test_server_async_notifications", TEST_MODULE) {
+  CHECK(server.GetNotificationQueue() == NULL);
+  server.EnableAsyncNotifications();
+  REQUIRE(server.GetNotificationQueue() != NULL);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\": 33}}");
+  CHECK(c.GetResponse() == "");
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 33}}");
+  CHECK(c.GetResponse() == "");
+  c.SetRequest("[{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}},"
+               "{\"jsonrpc\":\"2.0\", \"id\": 1, \"method\": \"sub\",\"params\":[5,7]}]");
+  CHECK(c.GetJsonResponse().size() == 1);
+  CHECK(c.GetJsonResponse()[0]["result"].asInt() == -2);
+
+  // Notifications are still validated before they are queued.
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": \"x\"}}");
+  CHECK(c.GetJsonResponse()["error"]["code"].asInt() == Errors::ERROR_RPC_INVALID_PARAMS);
+
+  CHECK(server.StopListening() == true);
+  CHECK(server.GetNotificationQueue()->GetPending() == 0);
+  CHECK(server.getCnt() == 67);
+}
+
+TEST_CASE("test_server_async_notifications_batch", TEST_MODULE) {
+  MockServerConnector c;
+  BatchingServer server(c);
+  server.EnableAsyncNotifications(NOTIFICATION_QUEUE_DEFAULT_CAPACITY, 8);
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\": 0}}");
+  server.GetNotificationQueue()->Flush();
+  for (int i = 0; i < 20; i++)
+    c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}}");
+  server.GetNotificationQueue()->Flush();
+
+  CHECK(server.getCnt() == 20);
+  size_t handled = 0;
+  for (size_t i = 0; i < server.batches.size(); i++) {
+    CHECK(server.batches[i] <= 8);
+    handled += server.batches[i];
+  }
+  CHECK(handled == 21);
+}
+
+TEST_CASE("test_server_async_notifications_stop", TEST_MODULE) {
+  MockServerConnector c;
+  {
+    BatchingServer server(c);
+    server.EnableAsyncNotifications(NOTIFICATION_QUEUE_DEFAULT_CAPACITY, 4);
+    c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initCounter\",\"params\":{\"value\": 0}}");
+    for (int i = 0; i < 20; i++)
+      c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}}");
+
+    // Queued notifications are handled before the thread stops.
+    server.StopNotifications();
+    CHECK(server.GetNotificationQueue() == NULL);
+    CHECK(server.getCnt() == 20);
+    c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}}");
+    CHECK(server.getCnt() == 21);
+    server.StopNotifications();
+
+    // The destructor stops the queue while batches is still there.
+    server.EnableAsyncNotifications(NOTIFICATION_QUEUE_DEFAULT_CAPACITY, 4);
+    for (int i = 0; i < 20; i++)
+      c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}}");
+  }
+}
+
+TEST_CASE("test_server_async_notifications_accounting", TEST_MODULE) {
+  MockServerConnector c;
+  ContextServer server(c);
+  SpanCollector tracer;
+  server.EnableStatistics();
+  server.SetTracer(&tracer);
+  server.EnableAsyncNotifications();
+
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"incrementCounter\",\"params\":{\"value\": 1}, \"traceparent\": \"trace-1\"}");
+  server.GetNotificationQueue()->Flush();
+  c.SetRequest("{\"jsonrpc\":\"2.0\", \"method\": \"initZero\", \"traceparent\": \"trace-2\"}");
+  server.GetNotificationQueue()->Flush();
+
+  // The queue's thread has the trace id of the request.
+  REQUIRE(server.traceids.size() == 2);
+  CHECK(server.traceids[0] == "trace-1");
+  CHECK(server.traceids[1] == "trace-2");
+
+  // The invocation is accounted when it happens, not when it is queued.
+  CHECK(server.GetStatistics()->Find("incrementCounter")->GetLatency(PHASE_INVOKE).GetCount() == 1);
+  CHECK(server.GetStatistics()->Find("initZero")->GetLatency(PHASE_INVOKE).GetCount() == 1);
+  CHECK(server.GetStatistics()->Find("initZero")->GetErrors(Errors::ERROR_RPC_INTERNAL_ERROR) == 1);
+  CHECK(server.GetStatistics()->GetTotal().GetErrors(Errors::ERROR_RPC_INTERNAL_ERROR) == 1);
+  CHECK(server.GetNotificationQueue()->GetFailed() == 1);
+
+  vector<TraceSpan> invocations;
+  for (size_t i = 0; i < tracer.spans.size(); i++) {
+    if (tracer.spans[i].stage == STAGE_INVOKE)
+      invocations.push_back(tracer.spans[i]);
+  }
+  REQUIRE(invocations.size() == 2);
+  CHECK(invocations[0].method == "incrementCounter");
+  CHECK(invocations[0].traceid == "trace-1");
+  CHECK(invocations[1].method == "initZero");
+  CHECK(invocations[1].traceid == "trace-2");
+}
+
+TEST_CASE("test_server_notification_queue", TEST_MODULE) {
+  Procedure a("a", PARAMS_BY_NAME, NULL);
+  Procedure b("b", PARAMS_BY_NAME, NULL);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  vector<string> calls;
+  NotificationQueue queue(
+      [&calls, opened](Procedure &proc, const std::vector<Json::Value> &inputs) {
+        stringstream call;
+        call << proc.GetProcedureName() << inputs.size();
+        calls.push_back(call.str());
+        if (calls.size() == 1)
+          opened.wait();
+        if (inputs[0] == "fail")
+          throw JsonRpcException(Errors::ERROR_RPC_INTERNAL_ERROR);
+      },
+      4, 3);
+
+  // Keep the thread busy with the first one while the others queue up.
+  CHECK(queue.Push(a, 1) == true);
+  while (queue.GetPending() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  CHECK(queue.Push(a, 2) == true);
+  CHECK(queue.Push(a, 3) == true);
+  CHECK(queue.Push(b, "fail") == true);
+  CHECK(queue.Push(a, 4) == true);
+  CHECK(queue.Push(a, 5) == false);
+  CHECK(queue.GetPending() == 4);
+
+  gate.set_value();
+  queue.Flush();
+  REQUIRE(calls.size() == 4);
+  CHECK(calls[0] == "a1");
+  CHECK(calls[1] == "a2");
+  CHECK(calls[2] == "b1");
+  CHECK(calls[3] == "a1");
+  CHECK(queue.GetFailed() == 1);
+}
+
+TEST_CASE("test_server_notification_queue_discard", TEST_MODULE) {
+  Procedure a("a", PARAMS_BY_NAME, NULL);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  vector<Json::Value> handled;
+  std::thread opener;
+  {
+    NotificationQueue queue(
+        [&handled, opened](Procedure &, const std::vector<Json::Value> &inputs) {
+          handled.push_back(inputs[0]);
+          opened.wait();
+        },
+        4, 1);
+    CHECK(queue.Push(a, 1) == true);
+    while (queue.GetPending() > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CHECK(queue.Push(a, 2) == true);
+    CHECK(queue.Push(a, 3) == true);
+
+    // Lets the running notification finish while the queue is destroyed.
+    opener = std::thread([&gate] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      gate.set_value();
+    });
+  }
+  opener.join();
+  // Notifications still queued are discarded instead of handled.
+  REQUIRE(handled.size() == 1);
+  CHECK(handled[0] == 1);
+}
@@ -18,6 +18,15 @@
 #include <stubgenerator/server/cppserverstubgenerator.h>
 #include <stubgenerator/stubgeneratorfactory.h>
 
+#include "gen/abstractdispatchstubserver.h"
+#include "gen/abstracttablestubserver.h"
+#include "gen/abstracttypedstubserver.h"
+#include "gen/directstubclient.h"
+#include "gen/stubclient.h"
+#include "gen/typedstubclient.h"
+#include "mockclientconnector.h"
+#include "mockserverconnector.h"
+#include <algorithm>
 #include <sstream>
 
 using namespace jsonrpc;
@@ -39,6 +48,75 @@ namespace teststubgen {
       fclose(stderr);
     }
   };
+
+  class DispatchStubServer : public AbstractDispatchStubServer {
+  public:
+    DispatchStubServer(AbstractServerConnector &connector) : AbstractDispatchStubServer(connector), notified(0) {}
+
+    virtual std::string sayHello(const std::string &name) { return "Hello " + name; }
+    virtual void notifyServer() { this->notified++; }
+    virtual int addNumbers(int param1, int param2) { return param1 + param2; }
+    virtual double addNumbers2(double param1, double param2) { return param1 + param2; }
+    virtual bool isEqual(const std::string &str1, const std::string &str2) { return str1 == str2; }
+    virtual Json::Value buildObject(const std::string &name, int age) {
+      Json::Value result;
+      result["name"] = name;
+      result["age"] = age;
+      return result;
+    }
+    virtual std::string methodWithoutParameters() { return "foo"; }
+
+    int notified;
+  };
+
+  class TableStubServer : public AbstractTableStubServer {
+  public:
+    TableStubServer(AbstractServerConnector &connector) : AbstractTableStubServer(connector), notified(0) {}
+
+    virtual std::string sayHello(const std::string &name) { return "Hello " + name; }
+    virtual void notifyServer() { this->notified++; }
+    virtual int addNumbers(int param1, int param2) { return param1 + param2; }
+    virtual double addNumbers2(double param1, double param2) { return param1 + param2; }
+    virtual bool isEqual(const std::string &str1, const std::string &str2) { return str1 == str2; }
+    virtual Json::Value buildObject(const std::string &name, int age) {
+      Json::Value result;
+      result["name"] = name;
+      result["age"] = age;
+      return result;
+    }
+    virtual std::string methodWithoutParameters() { return "foo"; }
+
+    int notified;
+  };
+
+  class TypedStubServer : public typed::AbstractTypedStubServer {
+  public:
+    TypedStubServer(AbstractServerConnector &connector) : typed::AbstractTypedStubServer(connector) {}
+
+    virtual Json::Int64 addUser(bool, const typed::User &user) {
+      this->users.push_back(user);
+      return user.id;
+    }
+    virtual typed::User getUser(Json::Int64 id) {
+      for (size_t i = 0; i < this->users.size(); i++) {
+        if (this->users[i].id == id)
+          return this->users[i];
+      }
+      throw JsonRpcException(-32099, "unknown user");
+    }
+    virtual std::vector<typed::User> findUsers(const std::vector<std::string> &names) {
+      std::vector<typed::User> result;
+      for (size_t i = 0; i < this->users.size(); i++) {
+        if (std::find(names.begin(), names.end(), this->users[i].name) != names.end())
+          result.push_back(this->users[i]);
+      }
+      return result;
+    }
+    virtual void storeMatrix(const std::vector<std::vector<int>> &rows) { this->rows = rows; }
+
+    std::vector<typed::User> users;
+    std::vector<std::vector<int>> rows;
+  };
 } // namespace teststubgen
 
 using namespace teststubgen;
@@ -104,6 +182,273 @@ TEST_CASE("test stubgen cppserver", TEST_MODULE) {
   CHECK(result.find("#endif //JSONRPC_CPP_STUB_NS1_NS2_TESTSTUBSERVER_H_") != string::npos);
 }
 
+TEST_CASE("test_stubgen_cppserver_dispatch", TEST_MODULE) {
+  stringstream stream;
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  CPPServerStubGenerator stubgen("ns1::ns2::TestStubServer", procedures, stream);
+  stubgen.setSwitchDispatch(true);
+  stubgen.generateStub();
+  string result = stream.str();
+
+  CHECK(result.find("bindAndAdd") == string::npos);
+  CHECK(result.find("this->addDispatchedProcedure(jsonrpc::Procedure(\"test.method\","
+                    " jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_STRING, "
+                    "\"name\",jsonrpc::JSON_STRING, NULL), PROCEDURE_test_method);") != string::npos);
+  CHECK(result.find("PROCEDURE_test_method,") != string::npos);
+  CHECK(result.find("lookupProcedure") == string::npos);
+  CHECK(result.find("switch (proc.GetDispatchId())") != string::npos);
+  CHECK(result.find("case PROCEDURE_test_notification:") != string::npos);
+  CHECK(result.find("virtual void invokeMethod(const jsonrpc::Procedure &proc, const Json::Value &request, Json::Value &response)") != string::npos);
+  CHECK(result.find("this->test_methodI(request, response);") != string::npos);
+  CHECK(result.find("this->test_notificationI(request);") != string::npos);
+  CHECK(result.find("jsonrpc::AbstractServer<TestStubServer>::invokeMethod(proc, request, response);") != string::npos);
+  CHECK(result.find("jsonrpc::AbstractServer<TestStubServer>::invokeNotification(proc, request);") != string::npos);
+}
+
+TEST_CASE("test_stubgen_cppserver_dispatch_calls", TEST_MODULE) {
+  MockServerConnector connector;
+  DispatchStubServer server(connector);
+
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"sayHello\",\"params\":{\"name\":\"Peter\"}}");
+  CHECK(connector.GetJsonResponse()["result"] == "Hello Peter");
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"addNumbers\",\"params\":[3,4]}");
+  CHECK(connector.GetJsonResponse()["result"] == 7);
+  // Procedures with names of the same length are told apart.
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"buildObject\",\"params\":[\"peter\",1990]}");
+  CHECK(connector.GetJsonResponse()["result"]["age"] == 1990);
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"addNumbers2\",\"params\":[3.5,4]}");
+  CHECK(connector.GetJsonResponse()["result"] == 7.5);
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"methodWithoutParameters\"}");
+  CHECK(connector.GetJsonResponse()["result"] == "foo");
+
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"method\":\"notifyServer\"}");
+  CHECK(connector.GetResponse() == "");
+  CHECK(server.notified == 1);
+
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":6,\"method\":\"sayHellO\",\"params\":{\"name\":\"Peter\"}}");
+  CHECK(connector.GetJsonResponse()["error"]["code"] == Errors::ERROR_RPC_METHOD_NOT_FOUND);
+
+  CHECK(server.EnableCache("addNumbers") == true);
+  CHECK(server.EnableCache("notifyServer") == false);
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"addNumbers\",\"params\":[3,4]}");
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":8,\"method\":\"addNumbers\",\"params\":[3,4]}");
+  CHECK(connector.GetJsonResponse()["result"] == 7);
+  CHECK(server.GetCache("addNumbers")->GetHits() == 1);
+}
+
+TEST_CASE("test_stubgen_cppserver_tables", TEST_MODULE) {
+  stringstream stream;
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  CPPServerStubGenerator stubgen("ns1::ns2::TestStubServer", procedures, stream);
+  stubgen.setDescriptorTables(true);
+  stubgen.generateStub();
+  string result = stream.str();
+
+  CHECK(result.find("static constexpr jsonrpc::ParameterDescriptor test_methodParameters[] = {{\"name\", jsonrpc::JSON_STRING, NULL}};") != string::npos);
+  CHECK(result.find("static constexpr jsonrpc::ProcedureDescriptor procedures[] = {") != string::npos);
+  CHECK(result.find("{\"test.method\", jsonrpc::RPC_METHOD, jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_STRING, test_methodParameters, 1},") != string::npos);
+  CHECK(result.find("{\"testmethod5\", jsonrpc::RPC_METHOD, jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_ARRAY, NULL, 0},") != string::npos);
+  CHECK(result.find("this->bindAndAddMethod(jsonrpc::Procedure(procedures[0]), &ns1::ns2::TestStubServer::test_methodI);") != string::npos);
+  CHECK(result.find("this->bindAndAddNotification(jsonrpc::Procedure(procedures[1]), &ns1::ns2::TestStubServer::test_notificationI);") != string::npos);
+
+  stream.str("");
+  stubgen.setSwitchDispatch(true);
+  stubgen.generateStub();
+  result = stream.str();
+  CHECK(result.find("bindAndAdd") == string::npos);
+  CHECK(result.find("this->addDispatchedProcedure(jsonrpc::Procedure(procedures[0]), PROCEDURE_test_method);") != string::npos);
+}
+
+TEST_CASE("test_stubgen_cppserver_tables_calls", TEST_MODULE) {
+  MockServerConnector connector;
+  TableStubServer server(connector);
+
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"sayHello\",\"params\":{\"name\":\"Peter\"}}");
+  CHECK(connector.GetJsonResponse()["result"] == "Hello Peter");
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"addNumbers\",\"params\":[3,4]}");
+  CHECK(connector.GetJsonResponse()["result"] == 7);
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"methodWithoutParameters\"}");
+  CHECK(connector.GetJsonResponse()["result"] == "foo");
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"method\":\"notifyServer\"}");
+  CHECK(server.notified == 1);
+
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"sayHello\",\"params\":{\"name\":3}}");
+  CHECK(connector.GetJsonResponse()["error"]["code"] == Errors::ERROR_RPC_INVALID_PARAMS);
+  connector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"addNumbers\",\"params\":[3]}");
+  CHECK(connector.GetJsonResponse()["error"]["code"] == Errors::ERROR_RPC_INVALID_PARAMS);
+}
+
+TEST_CASE("test_stubgen_cppclient_direct", TEST_MODULE) {
+  stringstream stream;
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  CPPClientStubGenerator stubgen("ns1::ns2::TestStubClient", procedures, stream);
+  stubgen.setDirectParams(true);
+  stubgen.generateStub();
+  string result = stream.str();
+
+  CHECK(result.find("Json::Value p;") == string::npos);
+  CHECK(result.find("jsonrpc::ParameterWriter p(jsonrpc::PARAMS_BY_NAME);") != string::npos);
+  CHECK(result.find("p.Add(\"name\", name);") != string::npos);
+  CHECK(result.find("Json::Value result = this->CallMethod(\"test.method\",p);") != string::npos);
+}
+
+TEST_CASE("test_stubgen_cppclient_direct_calls", TEST_MODULE) {
+  MockClientConnector connector;
+  StubClient client(connector);
+  DirectStubClient direct(connector);
+
+  connector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"Hello Peter\"}");
+  CHECK(direct.sayHello("Peter") == "Hello Peter");
+  Json::Value request = connector.GetJsonRequest();
+  client.sayHello("Peter");
+  CHECK(request == connector.GetJsonRequest());
+
+  connector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":7.5}");
+  CHECK(direct.addNumbers2(3.25, 4.25) == 7.5);
+  request = connector.GetJsonRequest();
+  client.addNumbers2(3.25, 4.25);
+  CHECK(request == connector.GetJsonRequest());
+
+  connector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{}}");
+  direct.buildObject("pe\"ter", 1990);
+  request = connector.GetJsonRequest();
+  client.buildObject("pe\"ter", 1990);
+  CHECK(request == connector.GetJsonRequest());
+
+  connector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"foo\"}");
+  CHECK(direct.methodWithoutParameters() == "foo");
+  CHECK(connector.GetJsonRequest().isMember("params") == false);
+
+  direct.notifyServer();
+  request = connector.GetJsonRequest();
+  client.notifyServer();
+  CHECK(request == connector.GetJsonRequest());
+}
+
+TEST_CASE("test_stubgen_cpp_typed", TEST_MODULE) {
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("typedspec.json");
+  stringstream server;
+  CPPServerStubGenerator serverstub("ns1::ns2::TestStubServer", procedures, server);
+  serverstub.generateStub();
+  string result = server.str();
+
+  CHECK(result.find("#include <jsonrpccpp/common/jsonconversion.h>") != string::npos);
+  CHECK(result.find("#ifndef JSONRPC_CPP_STRUCT_NS1_NS2_USER") != string::npos);
+  CHECK(result.find("struct Address") < result.find("struct User"));
+  CHECK(result.find("std::vector<Address> previous;") != string::npos);
+  CHECK(result.find("bool has_previous;") != string::npos);
+  CHECK(result.find("if (!FromJson(value[\"address\"], target.address))") != string::npos);
+  CHECK(result.find("if (!FromJson(request[\"user\"], param_user))") != string::npos);
+  CHECK(result.find("response = ToJson(this->getUser(request[\"id\"].asInt64()));") != string::npos);
+  CHECK(result.find("virtual std::vector<User> findUsers(const std::vector<std::string>& param01) = 0;") != string::npos);
+  CHECK(result.find("virtual void storeMatrix(const std::vector<std::vector<int>>& rows) = 0;") != string::npos);
+
+  stringstream client;
+  CPPClientStubGenerator clientstub("ns1::ns2::TestStubClient", procedures, client);
+  clientstub.generateStub();
+  result = client.str();
+
+  CHECK(result.find("#ifndef JSONRPC_CPP_STRUCT_NS1_NS2_ADDRESS") != string::npos);
+  CHECK(result.find("p[\"user\"] = ToJson(user);") != string::npos);
+  CHECK(result.find("p.append(jsonrpc::ToJson(param01));") != string::npos);
+  CHECK(result.find("if (jsonrpc::FromJson(result, converted))") != string::npos);
+  CHECK(result.find("Json::Int64 addUser(bool notify, const User& user)") != string::npos);
+  CHECK(result.find("class Batch") == string::npos);
+
+  stringstream batch;
+  CPPClientStubGenerator batchstub("ns1::ns2::TestStubClient", procedures, batch);
+  batchstub.setBatch(true);
+  batchstub.generateStub();
+  result = batch.str();
+  CHECK(result.find("class Batch : public jsonrpc::TypedBatch") != string::npos);
+  CHECK(result.find("Batch &getUser(Json::Int64 id, jsonrpc::BatchResult<User> *result = NULL)") != string::npos);
+  CHECK(result.find("this->addNotification(\"storeMatrix\", p);") != string::npos);
+  CHECK(result.find("Batch batch() { return Batch(*this); }") != string::npos);
+  CHECK(result.find("Async(") == string::npos);
+
+  stringstream async;
+  CPPClientStubGenerator asyncstub("ns1::ns2::TestStubClient", procedures, async);
+  asyncstub.setAsync(true);
+  asyncstub.generateStub();
+  result = async.str();
+  CHECK(result.find("std::future<User> getUserAsync(Json::Int64 id)") != string::npos);
+  CHECK(result.find("return this->CallMethodAsync<std::vector<User>>(\"findUsers\", p);") != string::npos);
+  CHECK(result.find("std::future<void> storeMatrixAsync(const std::vector<std::vector<int>>& rows)") != string::npos);
+
+  // Specs without $type generate the same stubs as before.
+  procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  stringstream plain;
+  CPPServerStubGenerator plainstub("TestStubServer", procedures, plain);
+  plainstub.generateStub();
+  CHECK(plain.str().find("jsonconversion.h") == string::npos);
+  CHECK(plain.str().find("struct ") == string::npos);
+}
+
+TEST_CASE("test_stubgen_cpp_typed_calls", TEST_MODULE) {
+  MockServerConnector serverConnector;
+  TypedStubServer server(serverConnector);
+
+  serverConnector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"addUser\",\"params\":{\"notify\":true,\"user\":{\"name\":\"peter\","
+                             "\"id\":9007199254740993,\"admin\":true,\"address\":{\"street\":\"Main Street\",\"number\":1},\"tags\":[\"a\",\"b\"]}}}");
+  CHECK(serverConnector.GetJsonResponse()["result"].asInt64() == 9007199254740993LL);
+  REQUIRE(server.users.size() == 1);
+  CHECK(server.users[0].address.street == "Main Street");
+  CHECK(server.users[0].address.has_zip == false);
+  CHECK(server.users[0].tags.size() == 2);
+  CHECK(server.users[0].has_previous == false);
+
+  // Nested mismatches are rejected before the method is called.
+  serverConnector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"addUser\",\"params\":{\"notify\":true,\"user\":{\"name\":\"peter\","
+                             "\"id\":1,\"admin\":true,\"address\":{\"street\":3,\"number\":1},\"tags\":[]}}}");
+  CHECK(serverConnector.GetJsonResponse()["error"]["code"] == Errors::ERROR_RPC_INVALID_PARAMS);
+  CHECK(server.users.size() == 1);
+
+  serverConnector.SetRequest("{\"jsonrpc\":\"2.0\",\"method\":\"storeMatrix\",\"params\":{\"rows\":[[1,2],[3]]}}");
+  REQUIRE(server.rows.size() == 2);
+  CHECK(server.rows[1][0] == 3);
+
+  serverConnector.SetRequest("{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"findUsers\",\"params\":[[\"peter\"]]}");
+  Json::Value found = serverConnector.GetJsonResponse()["result"];
+  REQUIRE(found.size() == 1);
+  CHECK(found[0]["address"]["street"] == "Main Street");
+  CHECK(found[0].isMember("previous") == false);
+
+  MockClientConnector clientConnector;
+  typed::TypedStubClient client(clientConnector);
+  clientConnector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":" + serverConnector.GetJsonResponse()["result"][0].toStyledString() + "}");
+  typed::User user = client.getUser(9007199254740993LL);
+  CHECK(clientConnector.GetJsonRequest()["params"]["id"].asInt64() == 9007199254740993LL);
+  CHECK(user.name == "peter");
+  CHECK(user.tags[1] == "b");
+
+  user.has_previous = true;
+  user.previous.push_back(user.address);
+  clientConnector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":1}");
+  client.addUser(false, user);
+  CHECK(clientConnector.GetJsonRequest()["params"]["user"]["previous"][0]["street"] == "Main Street");
+
+  clientConnector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":[{\"name\":\"peter\"}]}");
+  CHECK_THROWS_AS(client.findUsers(vector<string>(1, "peter")), JsonRpcException);
+
+  // Typed batches convert each result on its own.
+  jsonrpc::BatchResult<typed::User> single;
+  jsonrpc::BatchResult<vector<typed::User>> list;
+  jsonrpc::BatchResult<Json::Int64> added;
+  clientConnector.SetResponse("[{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":" + found[0].toStyledString() + "},{\"jsonrpc\":\"2.0\",\"id\":2,\"result\":" +
+                              found.toStyledString() + "},{\"jsonrpc\":\"2.0\",\"id\":3,\"result\":\"1\"}]");
+  client.batch().getUser(1, &single).findUsers(vector<string>(1, "peter"), &list).addUser(true, user, &added).storeMatrix(server.rows).send();
+  CHECK(clientConnector.GetJsonRequest().size() == 4);
+  CHECK(single.Get().address.street == "Main Street");
+  REQUIRE(list.Get().size() == 1);
+  CHECK(list.Get()[0].tags.size() == 2);
+  CHECK(added.GetErrorCode() == Errors::ERROR_CLIENT_INVALID_RESPONSE);
+
+  clientConnector.SetResponse("{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":" + found[0].toStyledString() + "}");
+  future<typed::User> pending = client.getUserAsync(1);
+  CHECK(pending.get().address.street == "Main Street");
+  CHECK(clientConnector.GetJsonRequest()["method"] == "getUser");
+}
+
 TEST_CASE("test_stubgen_jsclient", TEST_MODULE) {
   stringstream stream;
   vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
@@ -123,6 +468,26 @@ TEST_CASE("test_stubgen_jsclient", TEST_MODULE) {
                     "callbackError)") != string::npos);
 
   CHECK(JSClientStubGenerator::class2Filename("TestClass") == "testclass.js");
+  CHECK(result.find("fetch(") == string::npos);
+}
+
+TEST_CASE("test_stubgen_jsclient_fetch", TEST_MODULE) {
+  stringstream stream;
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  JSClientStubGenerator stubgen("TestStubClient", procedures, stream);
+  stubgen.setFetch(true);
+  stubgen.generateStub();
+  string result = stream.str();
+
+  CHECK(result.find("function TestStubClient(url) {") != string::npos);
+  CHECK(result.find("$.ajax") == string::npos);
+  CHECK(result.find("fetch(url, {") != string::npos);
+  CHECK(result.find("Promise.resolve().then(flush);") != string::npos);
+  CHECK(result.find("TestStubClient.prototype.test_method = function(name) {") != string::npos);
+  CHECK(result.find("return this.doRPC(\"test.method\", params, true);") != string::npos);
+  CHECK(result.find("TestStubClient.prototype.testmethod3 = function(param01, param02, param03) {") != string::npos);
+  CHECK(result.find("TestStubClient.prototype.testmethod5 = function() {") != string::npos);
+  CHECK(result.find("return this.doRPC(\"testmethod6\", params, false);") != string::npos);
 }
 
 TEST_CASE("test_stubgen_pyclient", TEST_MODULE) {
@@ -141,6 +506,26 @@ TEST_CASE("test_stubgen_pyclient", TEST_MODULE) {
   CHECK(result.find("def test_notification2(self, object, values):") != string::npos);
 
   CHECK(PythonClientStubGenerator::class2Filename("TestClass") == "testclass.py");
+  CHECK(result.find("async def") == string::npos);
+}
+
+TEST_CASE("test_stubgen_pyclient_asyncio", TEST_MODULE) {
+  stringstream stream;
+  vector<Procedure> procedures = SpecificationParser::GetProceduresFromFile("testspec6.json");
+  PythonClientStubGenerator stubgen("TestStubClient", procedures, stream);
+  stubgen.setAsyncio(true);
+  stubgen.generateStub();
+  string result = stream.str();
+
+  CHECK(result.find("jsonrpc_pyclient") == string::npos);
+  CHECK(result.find("import asyncio") != string::npos);
+  CHECK(result.find("class TestStubClient(object):") != string::npos);
+  CHECK(result.find("def __init__(self, url, max_batch=100):") != string::npos);
+  CHECK(result.find("async def test_method(self, name):") != string::npos);
+  CHECK(result.find("result = await self._call('test.method', parameters, False)") != string::npos);
+  CHECK(result.find("async def test_notification2(self, object, values):") != string::npos);
+  CHECK(result.find("await self._call('test.notification2', parameters, True)") != string::npos);
+  CHECK(result.find("HTTP/1.1\\r\\n") != string::npos);
 }
 
 TEST_CASE("test_stubgen_indentation", TEST_MODULE) {
@@ -210,6 +595,34 @@ TEST_CASE_METHOD(F, "test_stubgen_factory_success", TEST_MODULE) {
   StubGeneratorFactory::deleteStubGenerators(stubgens);
 }
 
+TEST_CASE_METHOD(F, "test_stubgen_factory_options", TEST_MODULE) {
+  vector<StubGenerator *> stubgens;
+  vector<Procedure> procedures;
+  const char *argv[13] = {"jsonrpcstub",           "testspec6.json",      "--cpp-server=TestServer", "--cpp-server-dispatch",
+                          "--cpp-server-tables",     "--cpp-client=TestClient", "--cpp-client-direct", "--cpp-client-batch",
+                          "--cpp-client-async",      "--js-client=TestClient",  "--js-client-fetch",   "--py-client=TestClient",
+                          "--py-client-asyncio"};
+
+  CHECK(StubGeneratorFactory::createStubGenerators(13, (char **)argv, procedures, stubgens, stdout, stderr) == true);
+  CHECK(stubgens.size() == 4);
+  StubGeneratorFactory::deleteStubGenerators(stubgens);
+}
+
+TEST_CASE_METHOD(F, "test_stubgen_factory_speccache", TEST_MODULE) {
+  const char *argv[3] = {"jsonrpcstub", "typedspec.json", "--spec-cache=typedspec.bin"};
+  CHECK(StubGeneratorFactory::createStubGenerators(3, (char **)argv, procedures, stubgens, stdout, stderr) == true);
+  CHECK(stubgens.empty());
+
+  vector<Procedure> loaded = SpecificationParser::GetProceduresFromFile("typedspec.bin");
+  REQUIRE(loaded.size() == procedures.size());
+  CHECK(loaded[0].GetProcedureName() == procedures[0].GetProcedureName());
+  CHECK(loaded[0].GetParameterSchema("user").GetFields().size() == 6);
+  remove("typedspec.bin");
+
+  const char *argv2[3] = {"jsonrpcstub", "typedspec.json", "--spec-cache=/a/b/c/typedspec.bin"};
+  CHECK(StubGeneratorFactory::createStubGenerators(3, (char **)argv2, procedures, stubgens, stdout, stderr) == false);
+}
+
 TEST_CASE_METHOD(F, "test_stubgen_factory_fileoverride", TEST_MODULE) {
   vector<StubGenerator *> stubgens;
   vector<Procedure> procedures;